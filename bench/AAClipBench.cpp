@@ -80,6 +80,55 @@ private:
     using INHERITED = Benchmark;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// This bench applies the same complex AA clip path over and over (e.g. once per frame), while the
+// rect clip around it changes. The AA clip for the path is found in SkAAClipCache rather than
+// scan converted each time, unless the path is volatile.
+class RepeatedAAClipPathBench : public Benchmark {
+    SkString fName;
+    SkPath   fClipPath;
+    SkRect   fDrawRect;
+
+public:
+    RepeatedAAClipPathBench(bool isVolatile) {
+        fName.printf("aaclip_repeated_path%s", isVolatile ? "_volatile" : "");
+
+        // A 32 point star with curved edges.
+        const int kPoints = 32;
+        for (int i = 0; i < 2 * kPoints; ++i) {
+            SkScalar angle = i * SK_ScalarPI / kPoints;
+            SkScalar r = (i & 1) ? 60.5f : 190.5f;
+            SkPoint pt = {200 + r * SkScalarCos(angle), 200 + r * SkScalarSin(angle)};
+            if (i == 0) {
+                fClipPath.moveTo(pt);
+            } else {
+                fClipPath.quadTo({200 + r * SkScalarSin(angle), 200 - r * SkScalarCos(angle)}, pt);
+            }
+        }
+        fClipPath.close();
+        fClipPath.setIsVolatile(isVolatile);
+        fDrawRect.setWH(400, 400);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        this->setupPaint(&paint);
+
+        for (int i = 0; i < loops; ++i) {
+            canvas->save();
+            // The device bounds of the clip change, but always hold the whole path.
+            canvas->clipRect(SkRect::MakeWH(420 + (i % 4) * 10, 420 + (i % 3) * 10));
+            canvas->clipPath(fClipPath, SkClipOp::kIntersect, true);
+            canvas->drawRect(fDrawRect, paint);
+            canvas->restore();
+        }
+    }
+private:
+    using INHERITED = Benchmark;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // This bench tests out nested clip stacks. It is intended to simulate
 // how WebKit nests clips.
@@ -251,5 +300,7 @@ DEF_BENCH(return new AAClipBench(false, false);)
 DEF_BENCH(return new AAClipBench(false, true);)
 DEF_BENCH(return new AAClipBench(true, false);)
 DEF_BENCH(return new AAClipBench(true, true);)
+DEF_BENCH(return new RepeatedAAClipPathBench(false);)
+DEF_BENCH(return new RepeatedAAClipPathBench(true);)
 DEF_BENCH(return new NestedAAClipBench(false);)
 DEF_BENCH(return new NestedAAClipBench(true);)
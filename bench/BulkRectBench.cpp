@@ -22,7 +22,8 @@
 enum class ImageMode {
     kShared, // 1. One shared image referenced by every rectangle
     kUnique, // 2. Unique image for every rectangle
-    kNone    // 3. No image, solid color shading per rectangle
+    kNone,   // 3. No image, solid color shading per rectangle
+    kColor   // 4. No image, one solid color shared by every rectangle
 };
 //   X
 enum class DrawMode {
@@ -40,7 +41,9 @@ enum class RectangleLayout {
 template<int kRectCount, RectangleLayout kLayout, ImageMode kImageMode, DrawMode kDrawMode>
 class BulkRectBench : public Benchmark {
 public:
-    static_assert(kImageMode == ImageMode::kNone || kDrawMode != DrawMode::kQuad,
+    inline static constexpr bool kSolidColor = kImageMode == ImageMode::kNone ||
+                                               kImageMode == ImageMode::kColor;
+    static_assert(kSolidColor || kDrawMode != DrawMode::kQuad,
                   "kQuad only supported for solid color draws");
 
     inline static constexpr int kWidth      = 1024;
@@ -48,13 +51,13 @@ public:
 
     // There will either be 0 images, 1 image, or 1 image per rect
     inline static constexpr int kImageCount = kImageMode == ImageMode::kShared ?
-            1 : (kImageMode == ImageMode::kNone ? 0 : kRectCount);
+            1 : (kSolidColor ? 0 : kRectCount);
 
     bool isSuitableFor(Backend backend) override {
-        if (kDrawMode == DrawMode::kBatch && kImageMode == ImageMode::kNone) {
-            // Currently the bulk color quad API is only available on
-            // skgpu::ganesh::SurfaceDrawContext
-            return backend == kGPU_Backend;
+        if (kDrawMode == DrawMode::kBatch && kSolidColor) {
+            // The bulk color quad API is only available on skgpu::ganesh::SurfaceDrawContext and,
+            // for raster, through SkCanvasPriv::DrawRects.
+            return backend == kGPU_Backend || backend == kRaster_Backend;
         } else {
             return this->INHERITED::isSuitableFor(backend);
         }
@@ -78,8 +81,10 @@ protected:
             fName.append("_sharedimage");
         } else if (kImageMode == ImageMode::kUnique) {
             fName.append("_uniqueimages");
-        } else {
+        } else if (kImageMode == ImageMode::kNone) {
             fName.append("_solidcolor");
+        } else {
+            fName.append("_sharedcolor");
         }
         if (kDrawMode == DrawMode::kBatch) {
             fName.append("_batch");
@@ -91,7 +96,7 @@ protected:
     }
 
     void drawImagesBatch(SkCanvas* canvas) const {
-        SkASSERT(kImageMode != ImageMode::kNone);
+        SkASSERT(!kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kBatch);
 
         SkCanvas::ImageSetEntry batch[kRectCount];
@@ -113,7 +118,7 @@ protected:
     }
 
     void drawImagesRef(SkCanvas* canvas) const {
-        SkASSERT(kImageMode != ImageMode::kNone);
+        SkASSERT(!kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kRef);
 
         SkPaint paint;
@@ -130,11 +135,16 @@ protected:
     }
 
     void drawSolidColorsBatch(SkCanvas* canvas) const {
-        SkASSERT(kImageMode == ImageMode::kNone);
+        SkASSERT(kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kBatch);
 
         auto context = canvas->recordingContext();
-        SkASSERT(context);
+        if (!context) {
+            SkPaint paint;
+            paint.setAntiAlias(true);
+            SkCanvasPriv::DrawRects(canvas, fRects, fColors, paint);
+            return;
+        }
 
         GrQuadSetEntry batch[kRectCount];
         for (int i = 0; i < kRectCount; ++i) {
@@ -157,7 +167,7 @@ protected:
     }
 
     void drawSolidColorsRef(SkCanvas* canvas) const {
-        SkASSERT(kImageMode == ImageMode::kNone);
+        SkASSERT(kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kRef || kDrawMode == DrawMode::kQuad);
 
         SkPaint paint;
@@ -211,7 +221,11 @@ protected:
             // in the benchmark.
             SkASSERT(SkRect::MakeWH(kWidth, kHeight).contains(fRects[i]));
 
-            fColors[i] = {rand.nextF(), rand.nextF(), rand.nextF(), 1.f};
+            if (kImageMode == ImageMode::kColor && i > 0) {
+                fColors[i] = fColors[0];
+            } else {
+                fColors[i] = {rand.nextF(), rand.nextF(), rand.nextF(), 1.f};
+            }
         }
     }
 
@@ -245,7 +259,7 @@ protected:
 
     void onDraw(int loops, SkCanvas* canvas) override {
         for (int i = 0; i < loops; i++) {
-            if (kImageMode == ImageMode::kNone) {
+            if (kSolidColor) {
                 if (kDrawMode == DrawMode::kBatch) {
                     this->drawSolidColorsBatch(canvas);
                 } else {
@@ -279,7 +293,9 @@ protected:
     ADD_BENCH(n, layout, ImageMode::kUnique, DrawMode::kRef)                   \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kBatch)                 \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kRef)                   \
-    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)
+    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)                  \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kBatch)                 \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kRef)
 
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kRandom)
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kGrid)
@@ -13,9 +13,8 @@
 #include "src/base/SkUTF.h"
 #include "src/utils/SkCharToGlyphCache.h"
 
-enum {
-    NGLYPHS = 100
-};
+#include <string>
+#include <vector>
 
 namespace {
 struct Rec {
@@ -24,27 +23,35 @@ struct Rec {
     const SkFont&               fFont;
     const SkUnichar*            fText;
     int                         fCount;
+    const std::string&          fUTF8;
 };
 }  // namespace
 
 typedef void (*TypefaceProc)(const Rec& r);
 
 static void textToGlyphs_proc(const Rec& r) {
-    uint16_t glyphs[NGLYPHS];
-    SkASSERT(r.fCount <= NGLYPHS);
+    std::vector<uint16_t> glyphs(r.fCount);
+
+    for (int i = 0; i < r.fLoops; ++i) {
+        r.fFont.textToGlyphs(r.fText, r.fCount*4, SkTextEncoding::kUTF32, glyphs.data(), r.fCount);
+    }
+}
+
+static void utf8ToGlyphs_proc(const Rec& r) {
+    std::vector<uint16_t> glyphs(r.fCount);
 
     for (int i = 0; i < r.fLoops; ++i) {
-        r.fFont.textToGlyphs(r.fText, r.fCount*4, SkTextEncoding::kUTF32, glyphs, NGLYPHS);
+        r.fFont.textToGlyphs(r.fUTF8.data(), r.fUTF8.size(), SkTextEncoding::kUTF8,
+                             glyphs.data(), r.fCount);
     }
 }
 
 static void charsToGlyphs_proc(const Rec& r) {
-    uint16_t glyphs[NGLYPHS];
-    SkASSERT(r.fCount <= NGLYPHS);
+    std::vector<uint16_t> glyphs(r.fCount);
 
     SkTypeface* face = r.fFont.getTypefaceOrDefault();
     for (int i = 0; i < r.fLoops; ++i) {
-        face->unicharsToGlyphs(r.fText, r.fCount, glyphs);
+        face->unicharsToGlyphs(r.fText, r.fCount, glyphs.data());
     }
 }
 
@@ -65,26 +72,50 @@ static void findcache_proc(const Rec& r) {
     }
 }
 
+static void findcache_bulk_proc(const Rec& r) {
+    std::vector<uint16_t> glyphs(r.fCount);
+
+    for (int loop = 0; loop < r.fLoops; ++loop) {
+        r.fCache.findGlyphs(r.fText, r.fCount, glyphs.data());
+    }
+}
+
+enum class Text {
+    kBMP,    // random unichars from the whole BMP
+    kLatin,  // mostly ASCII, with some Latin-1 and Latin Extended-A
+};
+
 class CMAPBench : public Benchmark {
     TypefaceProc fProc;
     SkString     fName;
-    SkUnichar    fText[NGLYPHS];
+    std::vector<SkUnichar> fText;
+    std::string  fUTF8;
     SkFont       fFont;
     SkCharToGlyphCache fCache;
     int          fCount;
 
 public:
-    CMAPBench(TypefaceProc proc, const char name[], int count) {
-        SkASSERT(count <= NGLYPHS);
-
+    CMAPBench(TypefaceProc proc, const char name[], int count, Text text = Text::kBMP) {
         fProc = proc;
-        fName.printf("%s_%d", name, count);
+        fName.printf("%s_%d%s", name, count, text == Text::kLatin ? "_latin" : "");
         fCount = count;
 
         SkRandom rand;
         for (int i = 0; i < count; ++i) {
-            fText[i] = rand.nextU() & 0xFFFF;
-            fCache.addCharAndGlyph(fText[i], i);
+            SkUnichar c;
+            if (text == Text::kBMP) {
+                c = rand.nextU() & 0xFFFF;
+            } else {
+                c = rand.nextRangeU(0, 9) ? rand.nextRangeU(0x20, 0x7E)
+                                          : rand.nextRangeU(0xA0, 0x17F);
+            }
+            fText.push_back(c);
+            if (fCache.findGlyphIndex(c) < 0) {
+                fCache.addCharAndGlyph(c, i);
+            }
+
+            char utf8[SkUTF::kMaxBytesInUTF8Sequence];
+            fUTF8.append(utf8, SkUTF::ToUTF8(c, utf8));
         }
         fFont.setTypeface(SkTypeface::MakeDefault());
     }
@@ -99,7 +130,7 @@ protected:
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
-        fProc({fCache, loops, fFont, fText, fCount});
+        fProc({fCache, loops, fFont, fText.data(), fCount, fUTF8});
     }
 
 private:
@@ -122,3 +153,13 @@ DEF_BENCH( return new CMAPBench(textToGlyphs_proc, "font_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(charsToGlyphs_proc, "face_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(addcache_proc, "addcache_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(findcache_proc, "findcache_charToGlyph", BIG); )
+
+// Long runs of plain text, where the dense range and the bulk UTF-8 decode matter.
+constexpr int LARGE = 4096;
+
+DEF_BENCH( return new CMAPBench(textToGlyphs_proc, "font_charToGlyph", LARGE, Text::kLatin); )
+DEF_BENCH( return new CMAPBench(utf8ToGlyphs_proc, "font_utf8ToGlyph", LARGE, Text::kLatin); )
+DEF_BENCH( return new CMAPBench(charsToGlyphs_proc, "face_charToGlyph", LARGE, Text::kLatin); )
+DEF_BENCH( return new CMAPBench(findcache_proc, "findcache_charToGlyph", LARGE, Text::kLatin); )
+DEF_BENCH( return new CMAPBench(findcache_bulk_proc, "findcache_bulk_charToGlyph", LARGE,
+                                Text::kLatin); )
@@ -8,10 +8,12 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/gpu/GrRecordingContext.h"
 #include "include/gpu/ganesh/SkImageGanesh.h"
+#include "src/core/SkTaskGroup.h"
 #include "tools/Resources.h"
 
 // Exercise a blur filter connected to 5 inputs of the same merge filter.
@@ -56,6 +58,53 @@ private:
     using INHERITED = Benchmark;
 };
 
+// The same DAG, drawn concurrently into separate raster surfaces (like a threaded tile renderer).
+// Every draw hits the global SkImageFilterCache several times, so this measures contention on it.
+class ImageFilterDAGThreadedBench : public Benchmark {
+public:
+    ImageFilterDAGThreadedBench() {}
+
+protected:
+    const char* onGetName() override {
+        return "image_filter_dag_threaded";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < kNumThreads; ++i) {
+            fSurfaces[i] = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(400, 400));
+        }
+
+        sk_sp<SkImageFilter> blur(SkImageFilters::Blur(20.0f, 20.0f, nullptr));
+        sk_sp<SkImageFilter> inputs[kNumInputs];
+        for (int i = 0; i < kNumInputs; ++i) {
+            inputs[i] = blur;
+        }
+        fPaint.setImageFilter(SkImageFilters::Merge(inputs, kNumInputs));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkRect rect = SkRect::Make(SkIRect::MakeWH(400, 400));
+
+        for (int j = 0; j < loops; j++) {
+            SkTaskGroup().batch(kNumThreads, [&](int i) {
+                fSurfaces[i]->getCanvas()->drawRect(rect, fPaint);
+            });
+        }
+    }
+
+private:
+    static const int kNumInputs = 5;
+    static const int kNumThreads = 8;
+    sk_sp<SkSurface> fSurfaces[kNumThreads];
+    SkPaint fPaint;
+
+    using INHERITED = Benchmark;
+};
+
 class ImageMakeWithFilterDAGBench : public Benchmark {
 public:
     ImageMakeWithFilterDAGBench() {}
@@ -166,6 +215,7 @@ private:
 };
 
 DEF_BENCH(return new ImageFilterDAGBench;)
+DEF_BENCH(return new ImageFilterDAGThreadedBench;)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
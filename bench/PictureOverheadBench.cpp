@@ -7,8 +7,11 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRRect.h"
+#include "include/core/SkString.h"
+#include "include/effects/SkGradientShader.h"
 
 class ClipOverheadRecordingBench : public Benchmark {
 public:
@@ -40,3 +43,53 @@ private:
     }
 };
 DEF_BENCH( return new ClipOverheadRecordingBench; )
+
+// Records draws that share a few paints, which the picture keeps one copy of, or that each have a
+// paint of their own.
+class PaintOverheadRecordingBench : public Benchmark {
+public:
+    explicit PaintOverheadRecordingBench(bool shared) : fShared(shared) {
+        fName.printf("paint_overhead_recording_%s", shared ? "shared" : "unique");
+    }
+
+private:
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    void onDelayedSetup() override {
+        const SkPoint pts[] = {{0, 0}, {100, 100}};
+        const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+        fPaints[0].setColor(SK_ColorRED);
+        fPaints[1].setAntiAlias(true);
+        fPaints[2].setShader(
+                SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+        fPaints[3].setStyle(SkPaint::kStroke_Style);
+        fPaints[3].setStrokeWidth(2);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPictureRecorder rec;
+
+        for (int loop = 0; loop < loops; loop++) {
+            SkCanvas* canvas = rec.beginRecording({0,0, 2000,3000});
+
+            for (int i = 0; i < 1000; i++) {
+                SkPaint paint = fPaints[i % kPaintCount];
+                if (!fShared) {
+                    paint.setColor(0xFF000000 | i);
+                }
+                canvas->drawRect(SkRect::MakeXYWH(i % 100, i / 100, 50, 50), paint);
+            }
+
+            (void)rec.finishRecordingAsPicture();
+        }
+    }
+
+    static constexpr int kPaintCount = 4;
+
+    const bool fShared;
+    SkString fName;
+    SkPaint fPaints[kPaintCount];
+};
+DEF_BENCH( return new PaintOverheadRecordingBench(true); )
+DEF_BENCH( return new PaintOverheadRecordingBench(false); )
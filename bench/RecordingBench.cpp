@@ -34,16 +34,27 @@ SkIPoint PictureCentricBench::onGetSize() {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH)
+RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH,
+                               bool approximateBBH)
     : INHERITED(name, pic)
     , fUseBBH(useBBH)
-{}
+    , fApproximateBBH(approximateBBH)
+{
+    if (fUseBBH && fApproximateBBH) {
+        fName.append("_approx");
+    }
+}
 
 void RecordingBench::onDraw(int loops, SkCanvas*) {
-    SkRTreeFactory factory;
+    SkRTreeFactory rtreeFactory;
+    SkTileGridFactory gridFactory;
+    SkBBHFactory* factory = fApproximateBBH ? static_cast<SkBBHFactory*>(&gridFactory)
+                                            : &rtreeFactory;
+    const uint32_t flags = fApproximateBBH ? SkPictureRecorder::kApproximateBounds_RecordFlag : 0;
     SkPictureRecorder recorder;
     while (loops --> 0) {
-        fSrc->playback(recorder.beginRecording(fSrc->cullRect(), fUseBBH ? &factory : nullptr));
+        fSrc->playback(recorder.beginRecording(fSrc->cullRect(),
+                                               fUseBBH ? factory : nullptr, flags));
         (void)recorder.finishRecordingAsPicture();
     }
 }
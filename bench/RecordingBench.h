@@ -29,13 +29,15 @@ protected:
 
 class RecordingBench : public PictureCentricBench {
 public:
-    RecordingBench(const char* name, const SkPicture*, bool useBBH);
+    // With approximateBBH, the BBH is a tile grid filled with approximate bounds.
+    RecordingBench(const char* name, const SkPicture*, bool useBBH, bool approximateBBH = false);
 
 protected:
     void onDraw(int loops, SkCanvas*) override;
 
 private:
     bool fUseBBH;
+    bool fApproximateBBH;
 
     using INHERITED = PictureCentricBench;
 };
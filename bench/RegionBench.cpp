@@ -9,6 +9,8 @@
 #include "include/core/SkString.h"
 #include "src/base/SkRandom.h"
 
+#include <vector>
+
 static bool union_proc(SkRegion& a, SkRegion& b) {
     SkRegion result;
     return result.op(a, b, SkRegion::kUnion_Op);
@@ -116,6 +118,54 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Regions made of many small, disjoint rects (e.g. damage tracking or glyph coverage). These have
+// long scanlines where most intervals of one region fall between two intervals of the other.
+class GridRegionBench : public Benchmark {
+public:
+    typedef bool (*Proc)(SkRegion& a, SkRegion& b);
+
+    GridRegionBench(int count, Proc proc, const char name[]) : fProc(proc) {
+        fName.printf("region_%s_grid_%d", name, count);
+
+        SkRandom rand;
+        std::vector<SkIRect> a, b;
+        for (int i = 0; i < count; i++) {
+            a.push_back(this->randcell(rand));
+            b.push_back(this->randcell(rand));
+        }
+        fA.setRects(a.data(), (int)a.size());
+        fB.setRects(b.data(), (int)b.size());
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        Proc proc = fProc;
+        for (int i = 0; i < loops; ++i) {
+            proc(fA, fB);
+        }
+    }
+
+private:
+    // 2048x2048 split into 8x8 cells; each rect covers part of one cell.
+    SkIRect randcell(SkRandom& rand) {
+        int x = (rand.nextU() % 256) * 8;
+        int y = (rand.nextU() % 256) * 8;
+        return SkIRect::MakeXYWH(x, y, 1 + rand.nextU() % 6, 1 + rand.nextU() % 6);
+    }
+
+    SkRegion fA, fB;
+    Proc     fProc;
+    SkString fName;
+
+    using INHERITED = Benchmark;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define SMALL   16
@@ -129,3 +179,11 @@ DEF_BENCH(return new RegionBench(SMALL, containsrect_proc, "containsrect");)
 DEF_BENCH(return new RegionBench(SMALL, sectsrgn_proc, "intersectsrgn");)
 DEF_BENCH(return new RegionBench(SMALL, sectsrect_proc, "intersectsrect");)
 DEF_BENCH(return new RegionBench(SMALL, containsxy_proc, "containsxy");)
+
+#define GRID    10000
+
+DEF_BENCH(return new GridRegionBench(GRID, union_proc, "union");)
+DEF_BENCH(return new GridRegionBench(GRID, sect_proc, "intersect");)
+DEF_BENCH(return new GridRegionBench(GRID, diff_proc, "difference");)
+DEF_BENCH(return new GridRegionBench(GRID, sectsrgn_proc, "intersectsrgn");)
+DEF_BENCH(return new GridRegionBench(GRID, containsxy_proc, "containsxy");)
@@ -12,17 +12,32 @@
 
 namespace {
 struct ShaperBench : public Benchmark {
-    ShaperBench(const char* r, const char* n) : fResource(r), fName(n) {}
+    ShaperBench(const char* r, const char* n, bool cached = true)
+        : fResource(r), fName(n), fCached(cached) {}
     std::unique_ptr<SkShaper> fShaper;
     sk_sp<SkData> fData;
     const char* fResource;
     const char* fName;
+    bool fCached;
+    size_t fPrevCacheLimit = 0;
     const char* onGetName() override { return fName; }
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
     void onDelayedSetup() override {
         fShaper = SkShaper::Make();
         fData = GetResourceAsData(fResource);
     }
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        if (!fCached) {
+            fPrevCacheLimit = SkShaper::SetHarfBuzzShapeCacheLimit(0);
+        }
+    }
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        if (!fCached) {
+            SkShaper::SetHarfBuzzShapeCacheLimit(fPrevCacheLimit);
+        }
+    }
+#endif
     void onDraw(int loops, SkCanvas*) override {
         if (!fData || !fShaper) { return; }
         SkFont font;
@@ -74,4 +89,10 @@ SHAPER_BENCH(tifnagh)
 SHAPER_BENCH(vai)
 #undef SHAPER_BENCH
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+// The same text without the HarfBuzz shape cache, to compare against.
+DEF_BENCH(return new ShaperBench("text/english.txt", "shaper_english_uncached", false);)
+DEF_BENCH(return new ShaperBench("text/arabic.txt", "shaper_arabic_uncached", false);)
+#endif
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
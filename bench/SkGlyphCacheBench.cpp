@@ -10,10 +10,12 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/chromium/SkChromeRemoteGlyphCache.h"
 #include "src/base/SkTLazy.h"
+#include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
 #include "src/core/SkTaskGroup.h"
 #include "src/core/SkTextBlobTrace.h"
@@ -120,6 +122,72 @@ DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
 
+// Rasterizes all the glyphs of a cold strike, either one at a time or with prefetchImages.
+// The portable typeface can rasterize on several threads at once; the default one (FreeType on
+// most platforms) can't, so prefetchImages should make its images serially.
+class SkGlyphCachePrefetchBench : public Benchmark {
+public:
+    SkGlyphCachePrefetchBench(bool threaded, bool portable)
+            : fThreaded(threaded), fPortable(portable) {
+        fName.printf("SkGlyphCachePrefetch%s%s", threaded ? "Threaded" : "Serial",
+                     portable ? "" : "_default");
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = fThreaded ? SkExecutor::MakeFIFOThreadPool() : nullptr;
+        fFont.setEdging(SkFont::Edging::kAntiAlias);
+        fFont.setSubpixel(true);
+        fFont.setSize(48);
+        if (fPortable) {
+            fFont.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+        }
+        for (uint32_t subpixel = 0; subpixel < 4; subpixel++) {
+            for (int c = ' '; c < 'z'; c++) {
+                fGlyphIDs.emplace_back(fFont.unicharToGlyph(c), subpixel, 0u);
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint defaultPaint;
+        auto strikeSpec = SkStrikeSpec::MakeMask(
+                fFont, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+        SkStrikeCache strikeCache;
+        std::vector<const SkGlyph*> glyphs(fGlyphIDs.size());
+        for (int work = 0; work < loops; work++) {
+            SkStrike strike{&strikeCache, strikeSpec, strikeSpec.createScalerContext(), nullptr,
+                            nullptr};
+            if (fThreaded) {
+                strike.prefetchImages(fGlyphIDs, fExecutor.get());
+            }
+            (void)strike.prepareImages(fGlyphIDs, glyphs.data());
+        }
+    }
+
+private:
+    const bool fThreaded;
+    const bool fPortable;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkFont fFont;
+    std::vector<SkPackedGlyphID> fGlyphIDs;
+};
+
+DEF_BENCH( return new SkGlyphCachePrefetchBench(false, true); )
+DEF_BENCH( return new SkGlyphCachePrefetchBench(true, true); )
+DEF_BENCH( return new SkGlyphCachePrefetchBench(false, false); )
+DEF_BENCH( return new SkGlyphCachePrefetchBench(true, false); )
+
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
                            public SkStrikeClient::DiscardableHandleManager {
@@ -140,6 +140,8 @@ static DEFINE_string(zoom, "1.0,0",
                      "Comma-separated zoomMax,zoomPeriodMs factors for a periodic SKP zoom "
                      "function that ping-pongs between 1.0 and zoomMax.");
 static DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
+static DEFINE_bool(approxBBH, false,
+                   "Build SKP BBHs as tile grids of approximate bounds, instead of R-trees?");
 static DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
 static DEFINE_int(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 static DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
@@ -940,7 +942,7 @@ public:
             fBenchType  = "recording";
             fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
             fSKPOps   = pic->approximateOpCount();
-            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh);
+            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh, FLAGS_approxBBH);
         }
 
         // Add all .skps as DeserializePictureBenchs.
@@ -969,11 +971,15 @@ public:
 
                 if (FLAGS_bbh) {
                     // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
-                    SkRTreeFactory factory;
+                    SkRTreeFactory rtreeFactory;
+                    SkTileGridFactory gridFactory;
                     SkPictureRecorder recorder;
-                    pic->playback(recorder.beginRecording(pic->cullRect().width(),
-                                                          pic->cullRect().height(),
-                                                          &factory));
+                    pic->playback(recorder.beginRecording(
+                            SkRect::MakeWH(pic->cullRect().width(), pic->cullRect().height()),
+                            FLAGS_approxBBH ? static_cast<SkBBHFactory*>(&gridFactory)
+                                            : &rtreeFactory,
+                            FLAGS_approxBBH ? SkPictureRecorder::kApproximateBounds_RecordFlag
+                                            : 0));
                     pic = recorder.finishRecordingAsPicture();
                 }
                 SkString name = SkOSPath::Basename(path.c_str());
@@ -9,6 +9,7 @@
 #define SkBBHFactory_DEFINED
 
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkScalar.h"
 #include "include/core/SkTypes.h"
 
 // TODO(kjlubick) fix client users and then make this a forward declare
@@ -64,4 +65,20 @@ public:
     sk_sp<SkBBoxHierarchy> operator()() const override;
 };
 
+/**
+ *  Makes grids of tileSize x tileSize tiles over the bounds of a picture's ops, listing the ops
+ *  that start in each tile. They're about as quick to build as R-trees, and quickest to search
+ *  with queries that cover few tiles, as ops found in several tiles have to be sorted. Ops larger
+ *  than a few tiles are searched one by one.
+ */
+class SK_API SkTileGridFactory : public SkBBHFactory {
+public:
+    explicit SkTileGridFactory(SkScalar tileSize = 128) : fTileSize(tileSize) {}
+
+    sk_sp<SkBBoxHierarchy> operator()() const override;
+
+private:
+    SkScalar fTileSize;
+};
+
 #endif
@@ -81,6 +81,17 @@ public:
      */
     static void PurgePinnedFontCache();
 
+    /**
+     *  Opt-in persistent font cache. When a directory is set, strikes created after that start
+     *  with the glyph metrics, masks and paths written to the directory by an earlier process,
+     *  instead of making them again. WriteFontCacheToDirectory() writes the glyphs of the
+     *  strikes currently in the font cache, so call it before purging the cache or exiting.
+     *  Stored glyphs are only reused for typefaces with the same names, style and 'head' table.
+     *  Passing nullptr turns the persistent cache off.
+     */
+    static void SetFontCacheDirectory(const char* path);
+    static void WriteFontCacheToDirectory();
+
     /**
      *  This function returns the memory used for temporary images and other resources.
      */
@@ -94,6 +105,16 @@ public:
     static size_t GetResourceCacheTotalByteLimit();
     static size_t SetResourceCacheTotalByteLimit(size_t newLimit);
 
+    /**
+     *  These functions get/set a sub-budget, within the total limit, for one category of entries
+     *  in the resource cache (e.g. "bitmap", "mipmap", "rrect-blur", "yuv-planes"). When a
+     *  category exceeds its sub-budget only its own entries are purged, so one kind of workload
+     *  cannot flush the others. Zero (the default) means the category is only bound by the total
+     *  limit. Per-category usage, hits, misses and evictions are reported by DumpMemoryStatistics.
+     */
+    static size_t GetResourceCacheCategoryByteLimit(const char* category);
+    static size_t SetResourceCacheCategoryByteLimit(const char* category, size_t newLimit);
+
     /**
      *  For debugging purposes, this will attempt to purge the resource cache. It
      *  does not change the limit.
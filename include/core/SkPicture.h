@@ -82,6 +82,23 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Returns SkPicture that plays back data written by serializeIndexed(), or nullptr if data
+        is not valid. data is used in place and must stay unchanged while the result, or any
+        SkPicture drawn by it, is alive; SkData::MakeFromFileName() maps a file for this.
+
+        Only the index of the top level picture is read here. Paints, paths, images, text blobs
+        and nested SkPicture are read from data when playback first uses them, and draw
+        commands outside of the SkCanvas clip are skipped without reading them.
+
+        procs->fPictureProc is not used.
+
+        @param data   indexed serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture playing back data
+    */
+    static sk_sp<SkPicture> MakeFromIndexedData(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -178,6 +195,18 @@ public:
     */
     void serialize(SkWStream* stream, const SkSerialProcs* procs = nullptr) const;
 
+    /** Returns storage containing SkData describing SkPicture in the indexed format read by
+        MakeFromIndexedData(). Besides the drawing commands and the objects they use, the data
+        has the offset of each object and the bounds of each draw command, so that a large
+        picture can be played back without reading more of it than is drawn.
+
+        procs->fPictureProc is not used.
+
+        @param procs  custom serial data encoders; may be nullptr
+        @return       storage containing indexed SkPicture
+    */
+    sk_sp<SkData> serializeIndexed(const SkSerialProcs* procs = nullptr) const;
+
     /** Returns a placeholder SkPicture. Result does not draw, and contains only
         cull SkRect, a hint of its bounds. Result is immutable; it cannot be changed
         later. Result identifier is unique.
@@ -239,6 +268,7 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkIndexedPicture;
     friend class SkPicturePriv;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
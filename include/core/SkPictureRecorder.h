@@ -12,6 +12,7 @@
 #include "include/core/SkPicture.h"
 #include "include/core/SkRefCnt.h"
 
+#include <cstdint>
 #include <memory>
 
 #ifdef SK_BUILD_FOR_ANDROID_FRAMEWORK
@@ -34,6 +35,13 @@ public:
     enum FinishFlags {
     };
 
+    enum RecordFlags {
+        // Fill the BBH with bounds that are quicker to compute, for pictures with many ops.
+        // They're looser for ops drawn inside layers whose paint moves pixels, e.g. with an image
+        // filter: all of them are bounded by what the outermost of those layers draws.
+        kApproximateBounds_RecordFlag = 1 << 0,
+    };
+
     /** Returns the canvas that records the drawing commands.
         @param bounds the cull rect used when recording this picture. Any drawing the falls outside
                       of this rect is undefined, and may be drawn or it may not.
@@ -41,9 +49,11 @@ public:
         @param recordFlags optional flags that control recording.
         @return the canvas.
     */
-    SkCanvas* beginRecording(const SkRect& bounds, sk_sp<SkBBoxHierarchy> bbh);
+    SkCanvas* beginRecording(const SkRect& bounds, sk_sp<SkBBoxHierarchy> bbh,
+                             uint32_t recordFlags = 0);
 
-    SkCanvas* beginRecording(const SkRect& bounds, SkBBHFactory* bbhFactory = nullptr);
+    SkCanvas* beginRecording(const SkRect& bounds, SkBBHFactory* bbhFactory = nullptr,
+                             uint32_t recordFlags = 0);
 
     SkCanvas* beginRecording(SkScalar width, SkScalar height,
                              SkBBHFactory* bbhFactory = nullptr) {
@@ -105,6 +115,7 @@ private:
     bool                        fActivelyRecording;
     SkRect                      fCullRect;
     sk_sp<SkBBoxHierarchy>      fBBH;
+    uint32_t                    fRecordFlags;
     std::unique_ptr<SkRecorder> fRecorder;
     sk_sp<SkRecord>             fRecord;
 
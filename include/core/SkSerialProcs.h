@@ -14,6 +14,7 @@
 #include <cstddef>
 
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPicture;
 class SkTypeface;
@@ -80,6 +81,10 @@ struct SK_API SkDeserialProcs {
     // parameters and returns a bool). Given that there are only two valid implementations of that
     // proc, we just insert the bool directly.
     bool                    fAllowSkSL = true;
+
+    // If set, the images of a picture are decoded on this executor while the rest of the picture
+    // is read, so fImageProc may be called from several threads at once and must be thread safe.
+    SkExecutor*             fExecutor = nullptr;
 };
 
 #endif
@@ -58,6 +58,10 @@ public:
         // If set, all rendering will have dithering enabled
         // Currently this only impacts GPU backends
         kAlwaysDither_Flag              = 1 << 2,
+        // If set, pictures and drawables drawn to a raster surface are rendered once into an
+        // image, and drawn from it again while they and the matrix, clip and color space they're
+        // drawn with don't change. Each is drawn as if it was in a layer of its own.
+        kCachePictures_Flag             = 1 << 3,
     };
     /** Deprecated alias used by Chromium. Will be removed. */
     static const Flags kUseDistanceFieldFonts_Flag = kUseDeviceIndependentFonts_Flag;
@@ -84,6 +88,10 @@ public:
         return SkToBool(fFlags & kAlwaysDither_Flag);
     }
 
+    bool isCachePictures() const {
+        return SkToBool(fFlags & kCachePictures_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry;
     }
@@ -256,6 +256,7 @@ private:
 
     friend class sktext::GlyphRunList;
     friend class SkTextBlobBuilder;
+    friend class SkTextBlobBuilderPriv;
     friend class SkTextBlobPriv;
     friend class SkTextBlobRunIterator;
 
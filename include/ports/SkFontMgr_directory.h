@@ -18,4 +18,11 @@ class SkFontMgr;
  */
 SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir);
 
+/** Like SkFontMgr_New_Custom_Directory, but keeps the family names and styles found in the font
+ *  files in an index file at indexPath. Files whose size and modification time match the index
+ *  aren't opened until one of their typefaces is used, so making the font manager again is
+ *  quick. The index is rewritten when files are added, changed or removed.
+ */
+SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath);
+
 #endif // SkFontMgr_directory_DEFINED
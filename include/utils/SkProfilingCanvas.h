@@ -0,0 +1,258 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkProfilingCanvas_DEFINED
+#define SkProfilingCanvas_DEFINED
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkCanvasVirtualEnforcer.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkTypes.h"
+#include "include/utils/SkNWayCanvas.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sktext {
+class GlyphRunList;
+namespace gpu { class Slug; }
+}
+
+class GrRecordingContext;
+class SkBlender;
+class SkData;
+class SkDrawable;
+class SkImage;
+class SkM44;
+class SkMesh;
+class SkPaint;
+class SkPath;
+class SkPicture;
+class SkPixmap;
+class SkRRect;
+class SkRegion;
+class SkShader;
+class SkSurface;
+class SkSurfaceProps;
+class SkTextBlob;
+class SkVertices;
+class SkWStream;
+enum class SkBlendMode;
+enum class SkClipOp;
+struct SkDrawShadowRec;
+struct SkPoint;
+struct SkRSXform;
+
+/** \class SkProfilingCanvas
+
+    A proxy canvas that times each draw it forwards to the wrapped canvas, e.g. while a picture is
+    played back into it, and sums the times up by op, paint kind and the area of the device the
+    draw may touch. Nested pictures and drawables are played back through it, so that each of
+    their draws is timed too; the wrapped canvas only sees what they draw. Matrix changes and
+    saves are forwarded without being timed.
+
+    When the "disabled-by-default-skia.profile" trace category is enabled, each timed draw is also
+    added to the SkEventTracer as a complete event named after its op.
+*/
+class SK_API SkProfilingCanvas : public SkCanvasVirtualEnforcer<SkNWayCanvas> {
+public:
+    /**
+     * The new SkProfilingCanvas forwards to the specified canvas, starting with its matrix and
+     * clip bounds.
+     */
+    SkProfilingCanvas(SkCanvas* canvas);
+
+    enum class Op {
+        kDrawPaint,
+        kDrawBehind,
+        kDrawPoints,
+        kDrawRect,
+        kDrawRRect,
+        kDrawDRRect,
+        kDrawRegion,
+        kDrawOval,
+        kDrawArc,
+        kDrawPath,
+        kDrawImage,
+        kDrawImageRect,
+        kDrawImageLattice,
+        kDrawAtlas,
+        kDrawVertices,
+        kDrawMesh,
+        kDrawPatch,
+        kDrawTextBlob,
+        kDrawSlug,
+        kDrawShadowRec,
+        kDrawEdgeAAQuad,
+        kDrawEdgeAAImageSet,
+        kSaveLayer,
+        kRestore,       // Restores of saves, which only pop the matrix and clip.
+        kRestoreLayer,  // Restores of layers, which draw them.
+        kClipRect,
+        kClipRRect,
+        kClipPath,
+        kClipShader,
+        kClipRegion,
+
+        kLast = kClipRegion,
+    };
+    static constexpr int kOpCount = static_cast<int>(Op::kLast) + 1;
+
+    // What the draw's paint fills with. Paints with an image or mask filter are kFiltered whatever
+    // their shader, and the restores of layers take the kind of the layer's paint.
+    enum class PaintKind {
+        kNone,      // No paint, e.g. for clips and images drawn without one.
+        kColor,
+        kGradient,
+        kImage,
+        kOther,     // Any other shader.
+        kFiltered,
+
+        kLast = kFiltered,
+    };
+    static constexpr int kPaintKindCount = static_cast<int>(PaintKind::kLast) + 1;
+
+    // Draws are bucketed by the number of device pixels they may touch: those that can't touch
+    // any are in bucket 0, and bucket b > 0 holds those touching [4^(b-1), 4^b) pixels, or more
+    // for the last bucket. Draws without bounds, and with paints whose bounds can't be computed,
+    // may touch the whole clip.
+    static constexpr int kAreaBuckets = 17;
+
+    struct Stats {
+        int    fCount      = 0;
+        double fTotalNanos = 0;
+        double fMaxNanos   = 0;
+    };
+
+    const Stats& stats(Op op, PaintKind kind, int areaBucket) const {
+        return fStats[StatsIndex(op, kind, areaBucket)];
+    }
+    // The stats of every draw of this op.
+    Stats stats(Op) const;
+    void resetStats();
+
+    /**
+     * Writes the stats as a JSON object with the total count and time, and a "stats" array of an
+     * object per op, paint kind and area bucket drawn, by decreasing total time.
+     */
+    void writeJSON(SkWStream*) const;
+
+    static const char* OpName(Op);
+    static const char* PaintKindName(PaintKind);
+
+    // Forwarded to the wrapped canvas.
+    SkISize getBaseLayerSize() const override { return proxy()->getBaseLayerSize(); }
+    GrRecordingContext* recordingContext() override { return proxy()->recordingContext(); }
+
+protected:
+    void willSave() override;
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec&) override;
+    bool onDoSaveBehind(const SkRect*) override;
+    void willRestore() override;
+
+    void didConcat44(const SkM44&) override;
+    void didSetM44(const SkM44&) override;
+    void didScale(SkScalar, SkScalar) override;
+    void didTranslate(SkScalar, SkScalar) override;
+
+    void onDrawPaint(const SkPaint&) override;
+    void onDrawBehind(const SkPaint&) override;
+    void onDrawPoints(PointMode, size_t count, const SkPoint pts[], const SkPaint&) override;
+    void onDrawRect(const SkRect&, const SkPaint&) override;
+    void onDrawRRect(const SkRRect&, const SkPaint&) override;
+    void onDrawDRRect(const SkRRect&, const SkRRect&, const SkPaint&) override;
+    void onDrawRegion(const SkRegion&, const SkPaint&) override;
+    void onDrawOval(const SkRect&, const SkPaint&) override;
+    void onDrawArc(const SkRect&, SkScalar, SkScalar, bool, const SkPaint&) override;
+    void onDrawPath(const SkPath&, const SkPaint&) override;
+
+    void onDrawImage2(const SkImage*, SkScalar, SkScalar, const SkSamplingOptions&,
+                      const SkPaint*) override;
+    void onDrawImageRect2(const SkImage*, const SkRect&, const SkRect&, const SkSamplingOptions&,
+                          const SkPaint*, SrcRectConstraint) override;
+    void onDrawImageLattice2(const SkImage*, const Lattice&, const SkRect&, SkFilterMode,
+                             const SkPaint*) override;
+    void onDrawAtlas2(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int,
+                      SkBlendMode, const SkSamplingOptions&, const SkRect*, const SkPaint*) override;
+
+    void onDrawVerticesObject(const SkVertices*, SkBlendMode, const SkPaint&) override;
+#ifdef SK_ENABLE_SKSL
+    void onDrawMesh(const SkMesh&, sk_sp<SkBlender>, const SkPaint&) override;
+#endif
+    void onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                     const SkPoint texCoords[4], SkBlendMode, const SkPaint& paint) override;
+    void onDrawPicture(const SkPicture*, const SkMatrix*, const SkPaint*) override;
+    void onDrawDrawable(SkDrawable*, const SkMatrix*) override;
+
+    void onDrawGlyphRunList(const sktext::GlyphRunList&, const SkPaint&) override;
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                        const SkPaint& paint) override;
+#if defined(SK_GANESH)
+    void onDrawSlug(const sktext::gpu::Slug* slug) override;
+#endif
+    void onDrawAnnotation(const SkRect& rect, const char key[], SkData* value) override;
+    void onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) override;
+
+    void onDrawEdgeAAQuad(const SkRect&, const SkPoint[4], QuadAAFlags, const SkColor4f&,
+                          SkBlendMode) override;
+    void onDrawEdgeAAImageSet2(const ImageSetEntry[], int count, const SkPoint[], const SkMatrix[],
+                               const SkSamplingOptions&,const SkPaint*, SrcRectConstraint) override;
+
+    void onClipRect(const SkRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipRRect(const SkRRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipPath(const SkPath&, SkClipOp, ClipEdgeStyle) override;
+    void onClipShader(sk_sp<SkShader>, SkClipOp) override;
+    void onClipRegion(const SkRegion&, SkClipOp) override;
+    void onResetClip() override;
+
+    // Forwarded to the wrapped canvas.
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo&, const SkSurfaceProps&) override;
+    bool onPeekPixels(SkPixmap* pixmap) override;
+    bool onAccessTopLayerPixels(SkPixmap* pixmap) override;
+    SkImageInfo onImageInfo() const override;
+    bool onGetProps(SkSurfaceProps* props, bool top) const override;
+
+private:
+    class AutoProfile;
+
+    // What a save leaves for its restore to be profiled with.
+    struct SaveRec {
+        bool      fLayer;
+        PaintKind fKind;
+        double    fArea;
+    };
+
+    static int StatsIndex(Op op, PaintKind kind, int areaBucket) {
+        SkASSERT(0 <= areaBucket && areaBucket < kAreaBuckets);
+        return (static_cast<int>(op) * kPaintKindCount + static_cast<int>(kind)) * kAreaBuckets +
+               areaBucket;
+    }
+
+    SkCanvas* proxy() const { SkASSERT(fList.size() == 1); return fList[0]; }
+
+    // The number of device pixels that a draw of these local bounds with this paint may touch.
+    double deviceArea(const SkRect* localBounds, const SkPaint* paint);
+
+    const uint8_t* fTraceCategory;
+    // The device clip bounds and matrix, cached until the clip or matrix changes.
+    bool fDeviceStateDirty = true;
+    SkIRect fClipBounds;
+    SkMatrix fLocalToDevice;
+    std::vector<Stats> fStats;
+    std::vector<SaveRec> fSaves;
+
+    using INHERITED = SkCanvasVirtualEnforcer<SkNWayCanvas>;
+};
+
+#endif
@@ -5,6 +5,7 @@
 
 #if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
 
+#include "include/core/SkExecutor.h"
 #include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/Paragraph.h"
 #include "modules/skparagraph/src/ParagraphBuilderImpl.h"
@@ -46,15 +47,75 @@ struct ParagraphBench : public Benchmark {
         SkCanvas* canvas = rec.beginRecording({0,0, 2000,3000});
         while (loops-- > 0) {
             paragraph->layout(fWidth);
-            auto impl = static_cast<ParagraphImpl*>(paragraph.get());
             paragraph->paint(canvas, 0, 0);
             paragraph->markDirty();
-            impl->resetCache();
+            fontCollection->getParagraphCache()->reset();
+        }
+    }
+};
+
+// Lays out a batch of paragraphs sharing one font collection and one SkUnicode,
+// either serially or on a thread pool.
+struct ParagraphLayoutAllBench : public Benchmark {
+    static constexpr int kParagraphCount = 64;
+
+    ParagraphLayoutAllBench(bool threaded)
+            : fThreaded(threaded)
+            , fName(threaded ? "paragraph_layoutall_threaded" : "paragraph_layoutall_serial") {}
+    bool fThreaded;
+    const char* fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<FontCollection> fFontCollection;
+    std::vector<std::unique_ptr<Paragraph>> fParagraphs;
+    std::vector<Paragraph*> fParagraphPtrs;
+    std::vector<SkScalar> fWidths;
+
+    const char* onGetName() override { return fName; }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        auto data = GetResourceAsData("text/english.txt");
+        if (!data) {
+            return;
+        }
+        fExecutor = fThreaded ? SkExecutor::MakeFIFOThreadPool() : nullptr;
+
+        // Every layout should do the work; the cache would turn all but the first into lookups
+        fFontCollection = sk_make_sp<FontCollection>();
+        fFontCollection->setDefaultFontManager(SkFontMgr::RefDefault());
+        fFontCollection->getParagraphCache()->turnOn(false);
+
+        ParagraphStyle paragraph_style;
+        paragraph_style.turnHintingOff();
+        ParagraphBuilderImpl builder(paragraph_style, fFontCollection);
+
+        // Paragraphs of different lengths made of the prefixes of the text
+        const char* text = (const char*)data->data();
+        const size_t size = data->size();
+        for (int i = 0; i < kParagraphCount; ++i) {
+            builder.Reset();
+            builder.addText(text, size * (i + 1) / kParagraphCount);
+            fParagraphs.push_back(builder.Build());
+            fParagraphPtrs.push_back(fParagraphs.back().get());
+            fWidths.push_back(200 + 10 * (i % 16));
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (fParagraphs.empty()) {
+            return;
+        }
+        while (loops-- > 0) {
+            for (auto& paragraph : fParagraphs) {
+                paragraph->markDirty();
+            }
+            Paragraph::LayoutAll(fParagraphPtrs, fWidths, fExecutor.get());
         }
     }
 };
 }  // namespace
 
+DEF_BENCH(return new ParagraphLayoutAllBench(false);)
+DEF_BENCH(return new ParagraphLayoutAllBench(true);)
+
 #define PARAGRAPH_BENCH(X) DEF_BENCH(return new ParagraphBench(50000, "text/" #X ".txt", "paragraph_" #X);)
 //PARAGRAPH_BENCH(arabic)
 //PARAGRAPH_BENCH(emoji)
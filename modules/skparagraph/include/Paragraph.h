@@ -2,6 +2,7 @@
 #ifndef Paragraph_DEFINED
 #define Paragraph_DEFINED
 
+#include "include/core/SkSpan.h"
 #include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/Metrics.h"
 #include "modules/skparagraph/include/ParagraphStyle.h"
@@ -9,6 +10,7 @@
 #include <unordered_set>
 
 class SkCanvas;
+class SkExecutor;
 
 namespace skia {
 namespace textlayout {
@@ -40,6 +42,18 @@ public:
 
     virtual void layout(SkScalar width) = 0;
 
+    /** Lays out each paragraph to its width, running the layouts on the executor, and returns
+     *  when all of them are done. The paragraphs may share a FontCollection and an SkUnicode
+     *  but each paragraph must be given only once.
+     *
+     * @param paragraphs      paragraphs to lay out
+     * @param widths          a width for each paragraph
+     * @param executor        an executor to run the layouts on; if null they run serially
+     */
+    static void LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor);
+
     virtual void paint(SkCanvas* canvas, SkScalar x, SkScalar y) = 0;
 
     virtual void paint(ParagraphPainter* painter, SkScalar x, SkScalar y) = 0;
@@ -79,6 +93,19 @@ public:
     virtual void updateForegroundPaint(size_t from, size_t to, SkPaint paint) = 0;
     virtual void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) = 0;
 
+    /** Experimental: replaces the text in [from:to) (UTF-8 code units) with the given text;
+     *  the new text gets the style of the text right before it. When possible only the words
+     *  around the edit are shaped again, and the next layout with the same width keeps
+     *  the lines above the last hard line break before them.
+     *
+     * @param from            the start of the replaced text
+     * @param to              the end of the replaced text
+     * @param text            UTF-8 text to insert
+     * @return                false (and no changes) if the range is out of the text,
+     *                        splits a code point or covers a placeholder
+     */
+    virtual bool updateText(size_t from, size_t to, const SkString& text) = 0;
+
     enum VisitorFlags {
         kWhiteSpace_VisitorFlag = 1 << 0,
     };
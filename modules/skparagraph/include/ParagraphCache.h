@@ -2,11 +2,13 @@
 #ifndef ParagraphCache_DEFINED
 #define ParagraphCache_DEFINED
 
+#include "include/core/SkString.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
 #include "src/core/SkLRUCache.h"
+#include <atomic>
 #include <functional>  // std::function
-
-#define PARAGRAPH_CACHE_STATS
+#include <memory>
 
 namespace skia {
 namespace textlayout {
@@ -25,40 +27,69 @@ public:
     bool updateParagraph(ParagraphImpl* paragraph);
     bool findParagraph(ParagraphImpl* paragraph);
 
+    struct Statistics {
+        int fRequests = 0;      // findParagraph() and updateParagraph() calls
+        int fHits = 0;          // findParagraph() calls that found the paragraph
+        int fMisses = 0;        // findParagraph() calls that did not
+        int fAdditions = 0;     // updateParagraph() calls that added the paragraph
+        int fEvictions = 0;     // entries purged to stay within the budget
+        int fEntries = 0;
+        size_t fBytesUsed = 0;
+        size_t fByteLimit = 0;
+    };
+    Statistics statistics() const;
+
+    // The budget is split evenly between the shards, each purging its least recently used
+    // paragraphs once it goes over its share.
+    size_t byteLimit() const { return fByteLimit.load(std::memory_order_relaxed); }
+    void setByteLimit(size_t bytes);
+
     // For testing
     void setChecker(std::function<void(ParagraphImpl* impl, const char*, bool)> checker) {
         fChecker = std::move(checker);
     }
     void printStatistics();
     void turnOn(bool value) { fCacheIsOn = value; }
-    int count() { return fLRUCacheMap.count(); }
+    int count() { return this->statistics().fEntries; }
 
     bool isPossiblyTextEditing(ParagraphImpl* paragraph);
 
  private:
 
     struct Entry;
-    void updateFrom(const ParagraphImpl* paragraph, Entry* entry);
     void updateTo(ParagraphImpl* paragraph, const Entry* entry);
 
-     mutable SkMutex fParagraphMutex;
-     std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
+    std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
 
-    static const int kMaxEntries = 128;
+    static constexpr int kShardCount = 8;
+    static constexpr size_t kDefaultByteLimit = 8 * 1024 * 1024;
 
     struct KeyHash {
         uint32_t operator()(const ParagraphCacheKey& key) const;
     };
 
-    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap;
+    // Paragraphs are spread between the shards by the hash of their key, so that laying out
+    // different paragraphs on different threads rarely waits on the same lock.
+    struct Shard {
+        Shard();
+        void purgeAsNeeded(size_t byteLimit) SK_REQUIRES(fMutex);
+
+        mutable SkMutex fMutex;
+        SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap
+                SK_GUARDED_BY(fMutex);
+        size_t fBytesUsed SK_GUARDED_BY(fMutex) = 0;
+        Statistics fStats SK_GUARDED_BY(fMutex);
+    };
+    Shard& shardFor(const ParagraphCacheKey& key);
+
+    Shard fShards[kShardCount];
+    std::atomic<size_t> fByteLimit;
     bool fCacheIsOn;
-    ParagraphCacheValue* fLastCachedValue;
 
-#ifdef PARAGRAPH_CACHE_STATS
-    int fTotalRequests;
-    int fCacheMisses;
-    int fHashMisses; // cache hit but hash table missed
-#endif
+    // The start and the end of the text most recently added, to recognize text being edited.
+    SkMutex fLastCachedMutex;
+    SkString fLastCachedPrefix SK_GUARDED_BY(fLastCachedMutex);
+    SkString fLastCachedSuffix SK_GUARDED_BY(fLastCachedMutex);
 };
 
 }  // namespace textlayout
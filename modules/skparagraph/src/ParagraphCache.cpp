@@ -4,6 +4,9 @@
 #include "modules/skparagraph/include/FontArguments.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
+#include "src/core/SkChecksum.h"
+
+#include <limits>
 
 using namespace skia_private;
 
@@ -27,6 +30,10 @@ namespace {
 
 }  // namespace
 
+// A paragraph sharing this many bytes at its start or end with the last one cached looks like text
+// being edited, and is not worth caching.
+#define NOCACHE_PREFIX_LENGTH 40
+
 class ParagraphCacheKey {
 public:
     ParagraphCacheKey(const ParagraphImpl* paragraph)
@@ -54,6 +61,10 @@ public:
 
     const SkString& text() const { return fText; }
 
+    size_t approximateBytesUsed() const {
+        return fText.size() + fPlaceholders.size_bytes() + fTextStyles.size_bytes();
+    }
+
 private:
     static uint32_t mix(uint32_t hash, uint32_t data);
     uint32_t computeHash() const;
@@ -69,23 +80,51 @@ class ParagraphCacheValue {
 public:
     ParagraphCacheValue(ParagraphCacheKey&& key, const ParagraphImpl* paragraph)
         : fKey(std::move(key))
-        , fRuns(paragraph->fRuns)
         , fClusters(paragraph->fClusters)
-        , fClustersIndexFromCodeUnit(paragraph->fClustersIndexFromCodeUnit)
         , fCodeUnitProperties(paragraph->fCodeUnitProperties)
         , fWords(paragraph->fWords)
         , fBidiRegions(paragraph->fBidiRegions)
         , fHasLineBreaks(paragraph->fHasLineBreaks)
         , fHasWhitespacesInside(paragraph->fHasWhitespacesInside)
-        , fTrailingSpaces(paragraph->fTrailingSpaces) { }
+        , fTrailingSpaces(paragraph->fTrailingSpaces) {
+        fRuns.reserve_exact(paragraph->fRuns.size());
+        for (const Run& run : paragraph->fRuns) {
+            fRuns.push_back(run.shaped());
+        }
+        // Cluster indices are less than the int count of clusters, so they fit in 32 bits.
+        fClustersIndexFromCodeUnit.reserve_exact(paragraph->fClustersIndexFromCodeUnit.size());
+        for (size_t index : paragraph->fClustersIndexFromCodeUnit) {
+            fClustersIndexFromCodeUnit.push_back(index == EMPTY_INDEX ? kEmptyIndex
+                                                                      : SkTo<uint32_t>(index));
+        }
+    }
+
+    size_t approximateBytesUsed() const {
+        size_t bytes = sizeof(*this) + fKey.approximateBytesUsed();
+        for (const Run::Shaped& run : fRuns) {
+            // The glyph data is shared with the paragraphs using it, but it lives as long as we do.
+            bytes += sizeof(run) + sizeof(Run::GlyphData) +
+                     run.fGlyphData->glyphs.size() * (sizeof(SkGlyphID) + sizeof(uint32_t) +
+                                                      2 * sizeof(SkPoint));
+        }
+        bytes += fClusters.size_bytes() +
+                 fClustersIndexFromCodeUnit.size_bytes() +
+                 fCodeUnitProperties.size_bytes() +
+                 fWords.size() * sizeof(size_t) +
+                 fBidiRegions.size() * sizeof(SkUnicode::BidiRegion);
+        return bytes;
+    }
+
+    static constexpr uint32_t kEmptyIndex = std::numeric_limits<uint32_t>::max();
 
     // Input == key
     ParagraphCacheKey fKey;
 
-    // Shaped results
-    TArray<Run, false> fRuns;
+    // Shaped results, stored compactly: the runs without their layout state, sharing the glyph
+    // data, and the cluster index of each code unit in 32 bits.
+    TArray<Run::Shaped> fRuns;
     TArray<Cluster, true> fClusters;
-    TArray<size_t, true> fClustersIndexFromCodeUnit;
+    TArray<uint32_t, true> fClustersIndexFromCodeUnit;
     // ICU results
     TArray<SkUnicode::CodeUnitFlags, true> fCodeUnitProperties;
     std::vector<size_t> fWords;
@@ -233,51 +272,101 @@ bool ParagraphCacheKey::operator==(const ParagraphCacheKey& other) const {
 
 struct ParagraphCache::Entry {
 
-    Entry(ParagraphCacheValue* value) : fValue(value) {}
+    Entry(ParagraphCacheValue* value)
+        : fValue(value), fBytesUsed(value->approximateBytesUsed()) {}
     std::unique_ptr<ParagraphCacheValue> fValue;
+    size_t fBytesUsed;
 };
 
+ParagraphCache::Shard::Shard()
+    // Entries are limited by the byte budget rather than by count.
+    : fLRUCacheMap(std::numeric_limits<int>::max()) {}
+
+void ParagraphCache::Shard::purgeAsNeeded(size_t byteLimit) {
+    while (fBytesUsed > byteLimit) {
+        std::unique_ptr<Entry>* lru = fLRUCacheMap.peekLRU();
+        if (!lru) {
+            break;
+        }
+        fBytesUsed -= (*lru)->fBytesUsed;
+        fLRUCacheMap.removeLRU();
+        ++fStats.fEvictions;
+    }
+}
+
 ParagraphCache::ParagraphCache()
     : fChecker([](ParagraphImpl* impl, const char*, bool){ })
-    , fLRUCacheMap(kMaxEntries)
+    , fByteLimit(kDefaultByteLimit)
     , fCacheIsOn(true)
-    , fLastCachedValue(nullptr)
-#ifdef PARAGRAPH_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
 { }
 
 ParagraphCache::~ParagraphCache() { }
 
+ParagraphCache::Shard& ParagraphCache::shardFor(const ParagraphCacheKey& key) {
+    // The LRU maps index by the low bits of the hash; mix them so every shard uses all of its map.
+    return fShards[SkChecksum::Mix(key.hash()) % kShardCount];
+}
+
 void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
+    const ParagraphCacheValue* value = entry->fValue.get();
 
     paragraph->fRuns.clear();
-    paragraph->fRuns = entry->fValue->fRuns;
-    paragraph->fClusters = entry->fValue->fClusters;
-    paragraph->fClustersIndexFromCodeUnit = entry->fValue->fClustersIndexFromCodeUnit;
-    paragraph->fCodeUnitProperties = entry->fValue->fCodeUnitProperties;
-    paragraph->fWords = entry->fValue->fWords;
-    paragraph->fBidiRegions = entry->fValue->fBidiRegions;
-    paragraph->fHasLineBreaks = entry->fValue->fHasLineBreaks;
-    paragraph->fHasWhitespacesInside = entry->fValue->fHasWhitespacesInside;
-    paragraph->fTrailingSpaces = entry->fValue->fTrailingSpaces;
-    for (auto& run : paragraph->fRuns) {
-        run.setOwner(paragraph);
+    paragraph->fRuns.reserve_exact(value->fRuns.size());
+    for (const Run::Shaped& run : value->fRuns) {
+        paragraph->fRuns.push_back(Run(paragraph, run));
     }
+    paragraph->fClusters = value->fClusters;
+    paragraph->fClustersIndexFromCodeUnit.clear();
+    paragraph->fClustersIndexFromCodeUnit.reserve_exact(value->fClustersIndexFromCodeUnit.size());
+    for (uint32_t index : value->fClustersIndexFromCodeUnit) {
+        paragraph->fClustersIndexFromCodeUnit.push_back(
+                index == ParagraphCacheValue::kEmptyIndex ? EMPTY_INDEX : index);
+    }
+    paragraph->fCodeUnitProperties = value->fCodeUnitProperties;
+    paragraph->fWords = value->fWords;
+    paragraph->fBidiRegions = value->fBidiRegions;
+    paragraph->fHasLineBreaks = value->fHasLineBreaks;
+    paragraph->fHasWhitespacesInside = value->fHasWhitespacesInside;
+    paragraph->fTrailingSpaces = value->fTrailingSpaces;
     for (auto& cluster : paragraph->fClusters) {
         cluster.setOwner(paragraph);
     }
 }
 
+ParagraphCache::Statistics ParagraphCache::statistics() const {
+    Statistics total;
+    for (const Shard& shard : fShards) {
+        SkAutoMutexExclusive lock(shard.fMutex);
+        total.fRequests += shard.fStats.fRequests;
+        total.fHits += shard.fStats.fHits;
+        total.fMisses += shard.fStats.fMisses;
+        total.fAdditions += shard.fStats.fAdditions;
+        total.fEvictions += shard.fStats.fEvictions;
+        total.fEntries += shard.fLRUCacheMap.count();
+        total.fBytesUsed += shard.fBytesUsed;
+    }
+    total.fByteLimit = this->byteLimit();
+    return total;
+}
+
+void ParagraphCache::setByteLimit(size_t bytes) {
+    fByteLimit.store(bytes, std::memory_order_relaxed);
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive lock(shard.fMutex);
+        shard.purgeAsNeeded(bytes / kShardCount);
+    }
+}
+
 void ParagraphCache::printStatistics() {
+    Statistics stats = this->statistics();
     SkDebugf("--- Paragraph Cache ---\n");
-    SkDebugf("Total requests: %d\n", fTotalRequests);
-    SkDebugf("Cache misses: %d\n", fCacheMisses);
-    SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ? 100.f * fCacheMisses / fTotalRequests : 0.f);
-    int cacheHits = fTotalRequests - fCacheMisses;
-    SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+    SkDebugf("Total requests: %d\n", stats.fRequests);
+    SkDebugf("Cache misses: %d\n", stats.fMisses);
+    int lookups = stats.fHits + stats.fMisses;
+    SkDebugf("Cache miss %%: %f\n", (lookups > 0) ? 100.f * stats.fMisses / lookups : 0.f);
+    SkDebugf("Entries: %d (%zu bytes of %zu)\n", stats.fEntries, stats.fBytesUsed,
+             stats.fByteLimit);
+    SkDebugf("Evictions: %d\n", stats.fEvictions);
     SkDebugf("---------------------\n");
 }
 
@@ -286,35 +375,34 @@ void ParagraphCache::abandon() {
 }
 
 void ParagraphCache::reset() {
-    SkAutoMutexExclusive lock(fParagraphMutex);
-#ifdef PARAGRAPH_CACHE_STATS
-    fTotalRequests = 0;
-    fCacheMisses = 0;
-    fHashMisses = 0;
-#endif
-    fLRUCacheMap.reset();
-    fLastCachedValue = nullptr;
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive lock(shard.fMutex);
+        shard.fStats = Statistics();
+        shard.fLRUCacheMap.reset();
+        shard.fBytesUsed = 0;
+    }
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    fLastCachedPrefix.reset();
+    fLastCachedSuffix.reset();
 }
 
 bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(key);
+    SkAutoMutexExclusive lock(shard.fMutex);
+    ++shard.fStats.fRequests;
+    std::unique_ptr<Entry>* entry = shard.fLRUCacheMap.find(key);
 
     if (!entry) {
         // We have a cache miss
-#ifdef PARAGRAPH_CACHE_STATS
-        ++fCacheMisses;
-#endif
+        ++shard.fStats.fMisses;
         fChecker(paragraph, "missingParagraph", true);
         return false;
     }
+    ++shard.fStats.fHits;
     updateTo(paragraph, entry->get());
     fChecker(paragraph, "foundParagraph", true);
     return true;
@@ -324,23 +412,41 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
-
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(key);
+    SkAutoMutexExclusive lock(shard.fMutex);
+    ++shard.fStats.fRequests;
+
+    std::unique_ptr<Entry>* entry = shard.fLRUCacheMap.find(key);
     if (!entry) {
         // isTooMuchMemoryWasted(paragraph) not needed for now
         if (isPossiblyTextEditing(paragraph)) {
             // Skip this paragraph
             return false;
         }
-        ParagraphCacheValue* value = new ParagraphCacheValue(std::move(key), paragraph);
-        fLRUCacheMap.insert(value->fKey, std::make_unique<Entry>(value));
+        auto newEntry = std::make_unique<Entry>(new ParagraphCacheValue(std::move(key), paragraph));
+        const size_t shardLimit = this->byteLimit() / kShardCount;
+        if (newEntry->fBytesUsed > shardLimit) {
+            // It would push everything else out of the shard
+            return false;
+        }
+        shard.fBytesUsed += newEntry->fBytesUsed;
+        ParagraphCacheValue* value = newEntry->fValue.get();
+        shard.fLRUCacheMap.insert(value->fKey, std::move(newEntry));
+        ++shard.fStats.fAdditions;
+        shard.purgeAsNeeded(shardLimit);
         fChecker(paragraph, "addedParagraph", true);
-        fLastCachedValue = value;
+
+        SkAutoMutexExclusive lastLock(fLastCachedMutex);
+        const SkString& text = value->fKey.text();
+        if (text.size() >= NOCACHE_PREFIX_LENGTH) {
+            fLastCachedPrefix.set(text.c_str(), NOCACHE_PREFIX_LENGTH);
+            fLastCachedSuffix.set(text.c_str() + text.size() - NOCACHE_PREFIX_LENGTH,
+                                  NOCACHE_PREFIX_LENGTH);
+        } else {
+            fLastCachedPrefix.reset();
+            fLastCachedSuffix.reset();
+        }
         return true;
     } else {
         // We do not have to update the paragraph
@@ -349,26 +455,21 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
 }
 
 // Special situation: (very) long paragraph that is close to the last formatted paragraph
-#define NOCACHE_PREFIX_LENGTH 40
 bool ParagraphCache::isPossiblyTextEditing(ParagraphImpl* paragraph) {
-    if (fLastCachedValue == nullptr) {
-        return false;
-    }
-
-    auto& lastText = fLastCachedValue->fKey.text();
     auto& text = paragraph->fText;
+    SkAutoMutexExclusive lock(fLastCachedMutex);
 
-    if ((lastText.size() < NOCACHE_PREFIX_LENGTH) || (text.size() < NOCACHE_PREFIX_LENGTH)) {
+    if (fLastCachedPrefix.isEmpty() || (text.size() < NOCACHE_PREFIX_LENGTH)) {
         // Either last text or the current are too short
         return false;
     }
 
-    if (std::strncmp(lastText.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedPrefix.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same starts
         return true;
     }
 
-    if (std::strncmp(lastText.c_str() + lastText.size() - NOCACHE_PREFIX_LENGTH, &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedSuffix.c_str(), &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same ends
         return true;
     }
@@ -1,6 +1,7 @@
 // Copyright 2019 Google LLC.
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMetrics.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPictureRecorder.h"
@@ -20,6 +21,7 @@
 #include "modules/skparagraph/src/TextLine.h"
 #include "modules/skparagraph/src/TextWrapper.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkTaskGroup.h"
 #include <math.h>
 #include <algorithm>
 #include <utility>
@@ -64,6 +66,26 @@ Paragraph::Paragraph(ParagraphStyle style, sk_sp<FontCollection> fonts)
             , fExceededMaxLines(0)
 { }
 
+void Paragraph::LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor) {
+    SkASSERT(paragraphs.size() == widths.size());
+    if (executor == nullptr) {
+        for (size_t i = 0; i < paragraphs.size(); ++i) {
+            paragraphs[i]->layout(widths[i]);
+        }
+        return;
+    }
+
+    // Layouts only share the font collection (which locks its own caches) and the unicode
+    // instance (which is stateless), so the paragraphs can be laid out independently
+    SkTaskGroup tasks(*executor);
+    tasks.batch(SkToInt(paragraphs.size()), [&](int i) {
+        paragraphs[i]->layout(widths[i]);
+    });
+    tasks.wait();
+}
+
 ParagraphImpl::ParagraphImpl(const SkString& text,
                              ParagraphStyle style,
                              TArray<Block, true> blocks,
@@ -150,6 +172,7 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
     }
 
     if (fState < kShaped) {
+        fResumeLineBreakingFrom = EMPTY_INDEX;
         // Check if we have the text in the cache and don't need to shape it again
         if (!fFontCollection->getParagraphCache()->findParagraph(this)) {
             if (fState < kIndexed) {
@@ -198,8 +221,15 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
         this->resetContext();
         this->resolveStrut();
         this->computeEmptyMetrics();
-        this->fLines.clear();
+        // Justified lines cannot be formatted twice
+        if (fResumeLineBreakingFrom == EMPTY_INDEX || fOldWidth != floorWidth ||
+            fParagraphStyle.effective_align() == TextAlign::kJustify) {
+            fResumeLineBreakingFrom = EMPTY_INDEX;
+            this->fLines.clear();
+            this->fLineBreakResumePoints.clear();
+        }
         this->breakShapedTextIntoLines(floorWidth);
+        fResumeLineBreakingFrom = EMPTY_INDEX;
         fState = kLineBroken;
     }
 
@@ -1083,6 +1113,329 @@ void ParagraphImpl::updateBackgroundPaint(size_t from, size_t to, SkPaint paint)
     }
 }
 
+bool ParagraphImpl::updateText(size_t from, size_t to, const SkString& text) {
+#if defined(SK_UNICODE_CLIENT_IMPLEMENTATION)
+    // The text properties come from the client and only describe the original text
+    return false;
+#else
+    auto isCodePointStart = [this](size_t index) {
+        return index == fText.size() || (fText[index] & 0xC0) != 0x80;
+    };
+    if (from > to || to > fText.size() || !isCodePointStart(from) || !isCodePointStart(to) ||
+        SkUTF::CountUTF8(text.c_str(), text.size()) < 0) {
+        return false;
+    }
+    for (auto& placeholder : fPlaceholders) {
+        if (placeholder.fRange.width() > 0 &&
+            from < placeholder.fRange.end && to > placeholder.fRange.start) {
+            return false;
+        }
+    }
+
+    // Only the simple (and the most common for editing) case is shaped locally
+    bool reshapeLocally = fState >= kShaped &&
+                          fUnresolvedGlyphs == 0 &&
+                          fPlaceholders.size() == 1 &&
+                          fParagraphStyle.getTextDirection() == TextDirection::kLtr &&
+                          fText.size() - (to - from) + text.size() > 0;
+    for (auto& block : fTextStyles) {
+        reshapeLocally &= SkScalarNearlyZero(block.fStyle.getLetterSpacing()) &&
+                          SkScalarNearlyZero(block.fStyle.getWordSpacing());
+    }
+    for (auto& run : fRuns) {
+        reshapeLocally &= run.leftToRight() && !run.isPlaceholder();
+    }
+
+    const auto oldState = fState;
+    const auto oldTextSize = fText.size();
+    auto oldRuns = std::move(fRuns);
+    auto oldClusters = std::move(fClusters);
+    auto oldClustersIndexFromCodeUnit = std::move(fClustersIndexFromCodeUnit);
+    auto oldFontSwitches = std::move(fFontSwitches);
+    fRuns.clear();
+    fClusters.clear();
+    fClustersIndexFromCodeUnit.clear();
+    fFontSwitches.clear();
+
+    this->replaceText(from, to, text);
+
+    // All the text indexing is done again (it's much cheaper than shaping)
+    fBidiRegions.clear();
+    fWords.clear();
+    fHasLineBreaks = false;
+    fHasWhitespacesInside = false;
+    fUTF8IndexForUTF16Index.clear();
+    fUTF16IndexForUTF8Index.clear();
+    fFillUTF16MappingOnce = std::make_unique<SkOnce>();
+    fPicture = nullptr;
+    fResumeLineBreakingFrom = EMPTY_INDEX;
+    fState = kUnknown;
+
+    if (!reshapeLocally || !this->computeCodeUnitProperties()) {
+        fLines.clear();
+        fLineBreakResumePoints.clear();
+        return true;
+    }
+    fState = kIndexed;
+
+    TextIndex reshapedStart;
+    if (!this->reshapeAroundEdit(TextRange(from, from + text.size()), oldTextSize,
+                                 oldRuns, oldClusters, oldClustersIndexFromCodeUnit,
+                                 oldFontSwitches, &reshapedStart)) {
+        fRuns.clear();
+        fFontSwitches.clear();
+        fLines.clear();
+        fLineBreakResumePoints.clear();
+        return true;
+    }
+
+    fClustersIndexFromCodeUnit.push_back_n(fText.size() + 1, EMPTY_INDEX);
+    this->applySpacingAndBuildClusterTable();
+    fState = kShaped;
+
+    // The lines above the last hard line break before the reshaped text are still valid;
+    // the next layout (with the same width) only breaks the text below it
+    if (oldState >= kLineBroken) {
+        for (int i = fLineBreakResumePoints.size() - 1; i >= 0; --i) {
+            auto& resumePoint = fLineBreakResumePoints[i];
+            if (resumePoint.fLine <= SkToSizeT(fLines.size()) &&
+                oldClusters[resumePoint.fCluster].textRange().start <= reshapedStart) {
+                fLines.pop_back_n(fLines.size() - resumePoint.fLine);
+                fLineBreakResumePoints.pop_back_n(fLineBreakResumePoints.size() - i - 1);
+                fResumeLineBreakingFrom = i;
+                break;
+            }
+        }
+    }
+    if (fResumeLineBreakingFrom == EMPTY_INDEX) {
+        fLines.clear();
+        fLineBreakResumePoints.clear();
+    }
+    return true;
+#endif
+}
+
+void ParagraphImpl::replaceText(size_t from, size_t to, const SkString& text) {
+    const auto removed = to - from;
+    const auto inserted = text.size();
+    fText.remove(from, removed);
+    fText.insert(from, text.c_str(), inserted);
+
+    // The inserted text gets the style of the text right before it
+    auto moveIndex = [=](size_t index) -> size_t {
+        if (index == 0 || index < from) {
+            return index;
+        } else if (index >= to) {
+            return index - removed + inserted;
+        }
+        return from + inserted;
+    };
+    int blockCount = 0;
+    for (auto& block : fTextStyles) {
+        block.fRange = TextRange(moveIndex(block.fRange.start), moveIndex(block.fRange.end));
+        if (block.fRange.width() > 0) {
+            fTextStyles[blockCount++] = block;
+        }
+    }
+    fTextStyles.pop_back_n(fTextStyles.size() - blockCount);
+
+    // Placeholders cannot be edited; they only move (and so does the text between them)
+    TextIndex textBefore = 0;
+    for (auto& placeholder : fPlaceholders) {
+        if (placeholder.fRange.width() == 0 || placeholder.fRange.end > from) {
+            placeholder.fRange = TextRange(placeholder.fRange.start - removed + inserted,
+                                           placeholder.fRange.end - removed + inserted);
+        }
+        placeholder.fTextBefore = TextRange(textBefore, placeholder.fRange.start);
+        textBefore = placeholder.fRange.end;
+    }
+}
+
+// Shapes the words around the edit again and puts them between the old runs
+// (that are only cut and moved); returns false if it cannot be done locally
+bool ParagraphImpl::reshapeAroundEdit(TextRange edited,
+                                      size_t oldTextSize,
+                                      const TArray<Run, false>& oldRuns,
+                                      const TArray<Cluster, true>& oldClusters,
+                                      const TArray<size_t, true>& oldClustersIndexFromCodeUnit,
+                                      const TArray<ResolvedFontDescriptor>& oldFontSwitches,
+                                      TextIndex* reshapedStart) {
+    if (oldRuns.empty()) {
+        return false;
+    }
+    for (auto& bidiRegion : fBidiRegions) {
+        if (bidiRegion.level % 2 != 0) {
+            return false;
+        }
+    }
+
+    // Extend the edit to the closest line break opportunities (that is, to whole words);
+    // we ignore kerning over the spaces and the line breaks
+    auto isBreak = [this](TextIndex index) {
+        return index == 0 || index == fText.size() ||
+               this->codeUnitHasProperty(index, SkUnicode::CodeUnitFlags::kSoftLineBreakBefore) ||
+               this->codeUnitHasProperty(index, SkUnicode::CodeUnitFlags::kHardLineBreakBefore);
+    };
+    TextIndex start = edited.start;
+    while (!isBreak(start)) {
+        --start;
+    }
+    TextIndex end = edited.end;
+    while (!isBreak(end)) {
+        ++end;
+    }
+    const TextIndex oldEnd = end + oldTextSize - fText.size();
+    const TextIndex textShift = end - oldEnd;
+
+    // The old runs can only be cut between glyph clusters
+    auto findOldCluster = [&](TextIndex index) -> const Cluster* {
+        auto clusterIndex = oldClustersIndexFromCodeUnit[index];
+        if (clusterIndex == EMPTY_INDEX || oldClusters[clusterIndex].fTextRange.start != index) {
+            return nullptr;
+        }
+        return &oldClusters[clusterIndex];
+    };
+    auto oldPosition = [&](const Cluster* cluster) {
+        return cluster->fRunIndex == EMPTY_RUN ? oldRuns.back().posX(oldRuns.back().size())
+                                               : oldRuns[cluster->fRunIndex].posX(cluster->fStart);
+    };
+    const Cluster* startCluster = findOldCluster(start);
+    const Cluster* endCluster = findOldCluster(oldEnd);
+    if (startCluster == nullptr || endCluster == nullptr) {
+        return false;
+    }
+
+    std::unique_ptr<ParagraphImpl> reshaped;
+    if (end > start) {
+        TArray<Block, true> blocks;
+        for (auto& block : fTextStyles) {
+            auto blockStart = std::max(block.fRange.start, start);
+            auto blockEnd = std::min(block.fRange.end, end);
+            if (blockStart < blockEnd) {
+                blocks.emplace_back(blockStart - start, blockEnd - start, block.fStyle);
+            }
+        }
+        TArray<Placeholder, true> placeholders;
+        placeholders.emplace_back(end - start, end - start, PlaceholderStyle(),
+                                  fParagraphStyle.getTextStyle(),
+                                  BlockRange(0, blocks.size()), TextRange(0, end - start));
+        reshaped = std::make_unique<ParagraphImpl>(SkString(fText.c_str() + start, end - start),
+                                                   fParagraphStyle,
+                                                   std::move(blocks),
+                                                   std::move(placeholders),
+                                                   fFontCollection,
+                                                   fUnicode);
+        reshaped->fClustersIndexFromCodeUnit.push_back_n(end - start + 1, EMPTY_INDEX);
+        if (!reshaped->computeCodeUnitProperties() ||
+            !reshaped->shapeTextIntoEndlessLine() ||
+            reshaped->fUnresolvedGlyphs != 0 ||
+            reshaped->fRuns.empty()) {
+            return false;
+        }
+        for (auto& run : reshaped->fRuns) {
+            if (!run.leftToRight() || run.isPlaceholder()) {
+                return false;
+            }
+        }
+    }
+
+    // The runs before the edit stay where they are (the last one may lose its end)
+    const SkScalar startX = oldPosition(startCluster);
+    const size_t splitRun = startCluster->fRunIndex == EMPTY_RUN ? SkToSizeT(oldRuns.size())
+                                                                 : startCluster->fRunIndex;
+    for (size_t i = 0; i < splitRun; ++i) {
+        fRuns.emplace_back(oldRuns[i]);
+    }
+    for (auto& fontSwitch : oldFontSwitches) {
+        if (fontSwitch.fTextStart < start) {
+            fFontSwitches.push_back(fontSwitch);
+        }
+    }
+    if (splitRun < SkToSizeT(oldRuns.size()) && startCluster->fStart > 0) {
+        auto& run = oldRuns[splitRun];
+        this->appendRunPiece(&fRuns, run, GlyphRange(0, startCluster->fStart),
+                             run.fClusterStart, 0);
+    }
+
+    // The new runs follow them
+    SkScalar endX = startX;
+    if (reshaped) {
+        for (auto& run : reshaped->fRuns) {
+            this->appendRunPiece(&fRuns, run, GlyphRange(0, run.size()),
+                                 run.fClusterStart + start, startX);
+        }
+        for (auto& fontSwitch : reshaped->fFontSwitches) {
+            fFontSwitches.emplace_back(fontSwitch.fTextStart + start, fontSwitch.fFont);
+        }
+        auto& lastRun = reshaped->fRuns.back();
+        endX += lastRun.posX(lastRun.size());
+    }
+
+    // And the runs after the edit move after the new runs
+    if (endCluster->fRunIndex != EMPTY_RUN) {
+        const SkScalar shiftX = endX - oldPosition(endCluster);
+        for (size_t i = endCluster->fRunIndex; i < SkToSizeT(oldRuns.size()); ++i) {
+            auto& run = oldRuns[i];
+            auto firstGlyph = i == endCluster->fRunIndex ? endCluster->fStart : 0;
+            this->appendRunPiece(&fRuns, run, GlyphRange(firstGlyph, run.size()),
+                                 run.fClusterStart + textShift, shiftX);
+        }
+        const ResolvedFontDescriptor* fontAtEnd = nullptr;
+        for (auto& fontSwitch : oldFontSwitches) {
+            if (fontSwitch.fTextStart <= oldEnd) {
+                fontAtEnd = &fontSwitch;
+            } else {
+                if (fontAtEnd != nullptr) {
+                    fFontSwitches.emplace_back(end, fontAtEnd->fFont);
+                    fontAtEnd = nullptr;
+                }
+                fFontSwitches.emplace_back(fontSwitch.fTextStart + textShift, fontSwitch.fFont);
+            }
+        }
+        if (fontAtEnd != nullptr) {
+            fFontSwitches.emplace_back(end, fontAtEnd->fFont);
+        }
+    }
+
+    *reshapedStart = start;
+    return true;
+}
+
+// Copies glyphs [glyphs.start:glyphs.end) of a left-to-right run into a new run
+void ParagraphImpl::appendRunPiece(TArray<Run, false>* runs,
+                                   const Run& run,
+                                   GlyphRange glyphs,
+                                   TextIndex clusterStart,
+                                   SkScalar shiftX) {
+    SkASSERT(run.leftToRight() && !run.isPlaceholder());
+    auto textStart = run.fClusterIndexes[glyphs.start];
+    auto textEnd = run.fClusterIndexes[glyphs.end];
+    const SkShaper::RunHandler::RunInfo info = {
+            run.fFont,
+            run.fBidiLevel,
+            SkVector::Make(run.posX(glyphs.end) - run.posX(glyphs.start), run.fAdvance.fY),
+            glyphs.width(),
+            SkShaper::RunHandler::Range(textStart, textEnd - textStart)
+    };
+    auto& piece = runs->emplace_back(this,
+                                     info,
+                                     clusterStart,
+                                     run.fHeightMultiplier,
+                                     run.fUseHalfLeading,
+                                     run.fBaselineShift,
+                                     runs->size(),
+                                     run.posX(glyphs.start) + shiftX);
+    for (size_t i = glyphs.start; i <= glyphs.end; ++i) {
+        auto index = i - glyphs.start;
+        if (i < glyphs.end) {
+            piece.fGlyphs[index] = run.fGlyphs[i];
+        }
+        piece.fClusterIndexes[index] = run.fClusterIndexes[i];
+        piece.fPositions[index] = run.fPositions[i] + SkVector::Make(shiftX, 0);
+        piece.fOffsets[index] = run.fOffsets[i];
+    }
+}
+
 TArray<TextIndex> ParagraphImpl::countSurroundingGraphemes(TextRange textRange) const {
     textRange = textRange.intersection({0, fText.size()});
     TArray<TextIndex> graphemes;
@@ -1131,7 +1484,7 @@ TextIndex ParagraphImpl::findPreviousGlyphClusterBoundary(TextIndex utf8) const
 }
 
 void ParagraphImpl::ensureUTF16Mapping() {
-    fillUTF16MappingOnce([&] {
+    (*fFillUTF16MappingOnce)([&] {
         fUnicode->extractUtfConversionMapping(
                 this->text(),
                 [&](size_t index) { fUTF8IndexForUTF16Index.emplace_back(index); },
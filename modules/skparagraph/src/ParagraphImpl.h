@@ -69,6 +69,18 @@ struct ResolvedFontDescriptor {
     TextIndex fTextStart;
 };
 
+// The line breaker can restart from the first line after a hard line break: nothing above it
+// depends on the text below it. These are the totals it has collected by then.
+struct LineBreakResumePoint {
+    size_t fLine;
+    ClusterIndex fCluster;
+    SkScalar fHeight;
+    SkScalar fMinIntrinsicWidth;
+    SkScalar fMaxIntrinsicWidth;
+    SkScalar fLongestLine;
+    SkScalar fMaxWidthWithTrailingSpaces;
+};
+
 enum InternalState {
   kUnknown = 0,
   kIndexed = 1,     // Text is indexed
@@ -208,6 +220,7 @@ public:
     void updateFontSize(size_t from, size_t to, SkScalar fontSize) override;
     void updateForegroundPaint(size_t from, size_t to, SkPaint paint) override;
     void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) override;
+    bool updateText(size_t from, size_t to, const SkString& text) override;
 
     void visit(const Visitor&) override;
 
@@ -249,6 +262,17 @@ private:
 
     void computeEmptyMetrics();
 
+    void replaceText(size_t from, size_t to, const SkString& text);
+    bool reshapeAroundEdit(TextRange edited,
+                           size_t oldTextSize,
+                           const skia_private::TArray<Run, false>& oldRuns,
+                           const skia_private::TArray<Cluster, true>& oldClusters,
+                           const skia_private::TArray<size_t, true>& oldClustersIndexFromCodeUnit,
+                           const skia_private::TArray<ResolvedFontDescriptor>& oldFontSwitches,
+                           TextIndex* reshapedStart);
+    void appendRunPiece(skia_private::TArray<Run, false>* runs, const Run& run,
+                        GlyphRange glyphs, TextIndex clusterStart, SkScalar shiftX);
+
     // Input
     skia_private::TArray<StyleBlock<SkScalar>> fLetterSpaceStyles;
     skia_private::TArray<StyleBlock<SkScalar>> fWordSpaceStyles;
@@ -272,11 +296,15 @@ private:
     // They are filled lazily whenever they need and cached
     skia_private::TArray<TextIndex, true> fUTF8IndexForUTF16Index;
     skia_private::TArray<size_t, true> fUTF16IndexForUTF8Index;
-    SkOnce fillUTF16MappingOnce;
+    // SkOnce cannot be rearmed, so updateText(), which changes the text they map, replaces it.
+    std::unique_ptr<SkOnce> fFillUTF16MappingOnce = std::make_unique<SkOnce>();
     size_t fUnresolvedGlyphs;
     std::unordered_set<SkUnichar> fUnresolvedCodepoints;
 
     skia_private::TArray<TextLine, false> fLines;   // kFormatted   (cached: width, max lines, ellipsis, text align)
+    skia_private::TArray<LineBreakResumePoint, true> fLineBreakResumePoints;  // kLineBroken
+    // Set by updateText when the lines above this resume point are still valid
+    size_t fResumeLineBreakingFrom = EMPTY_INDEX;
     sk_sp<SkPicture> fPicture;          // kRecorded    (cached: text styles)
 
     skia_private::TArray<ResolvedFontDescriptor> fFontSwitches;
@@ -58,6 +58,41 @@ Run::Run(ParagraphImpl* owner,
     fPlaceholderIndex = std::numeric_limits<size_t>::max();
 }
 
+Run::Run(ParagraphImpl* owner, const Shaped& shaped)
+    : fOwner(owner)
+    , fTextRange(shaped.fTextRange)
+    , fClusterRange(shaped.fClusterRange)
+    , fFont(shaped.fFont)
+    , fPlaceholderIndex(shaped.fPlaceholderIndex)
+    , fIndex(shaped.fIndex)
+    , fAdvance(shaped.fAdvance)
+    , fOffset(shaped.fOffset)
+    , fClusterStart(shaped.fClusterStart)
+    , fUtf8Range(shaped.fUtf8Range)
+    , fGlyphData(shaped.fGlyphData)
+    , fGlyphs(fGlyphData->glyphs)
+    , fPositions(fGlyphData->positions)
+    , fOffsets(fGlyphData->offsets)
+    , fClusterIndexes(fGlyphData->clusterIndexes)
+    , fFontMetrics(shaped.fFontMetrics)
+    , fHeightMultiplier(shaped.fHeightMultiplier)
+    , fUseHalfLeading(shaped.fUseHalfLeading)
+    , fBaselineShift(shaped.fBaselineShift)
+    , fCorrectAscent(shaped.fCorrectAscent)
+    , fCorrectDescent(shaped.fCorrectDescent)
+    , fCorrectLeading(shaped.fCorrectLeading)
+    , fEllipsis(shaped.fEllipsis)
+    , fBidiLevel(shaped.fBidiLevel)
+{ }
+
+Run::Shaped Run::shaped() const {
+    SkASSERT(fJustificationShifts.empty());
+    return { fTextRange, fClusterRange, fFont, fPlaceholderIndex, fIndex, fAdvance, fOffset,
+             fClusterStart, fUtf8Range, fGlyphData, fFontMetrics, fHeightMultiplier,
+             fBaselineShift, fCorrectAscent, fCorrectDescent, fCorrectLeading, fUseHalfLeading,
+             fEllipsis, fBidiLevel };
+}
+
 void Run::calculateMetrics() {
     fCorrectAscent = fFontMetrics.fAscent - fFontMetrics.fLeading * 0.5;
     fCorrectDescent = fFontMetrics.fDescent + fFontMetrics.fLeading * 0.5;
@@ -87,16 +122,32 @@ SkShaper::RunHandler::Buffer Run::newRunBuffer() {
 
 void Run::copyTo(SkTextBlobBuilder& builder, size_t pos, size_t size) const {
     SkASSERT(pos + size <= this->size());
-    const auto& blobBuffer = builder.allocRunPos(fFont, SkToInt(size));
-    sk_careful_memcpy(blobBuffer.glyphs, fGlyphs.data() + pos, size * sizeof(SkGlyphID));
-
-    for (size_t i = 0; i < size; ++i) {
+    auto positionAt = [&](size_t i) {
         auto point = fPositions[i + pos];
         if (!fJustificationShifts.empty()) {
             point.fX += fJustificationShifts[i + pos].fX;
         }
-        point += fOffsets[i + pos];
-        blobBuffer.points()[i] = point;
+        return point + fOffsets[i + pos];
+    };
+
+    // Only store the x positions when the glyphs share the baseline (the usual case)
+    bool horizontal = size > 0;
+    const SkScalar y = horizontal ? positionAt(0).fY : 0;
+    for (size_t i = 1; horizontal && i < size; ++i) {
+        horizontal = positionAt(i).fY == y;
+    }
+
+    const auto& blobBuffer = horizontal ? builder.allocRunPosH(fFont, SkToInt(size), y)
+                                        : builder.allocRunPos(fFont, SkToInt(size));
+    sk_careful_memcpy(blobBuffer.glyphs, fGlyphs.data() + pos, size * sizeof(SkGlyphID));
+
+    for (size_t i = 0; i < size; ++i) {
+        auto point = positionAt(i);
+        if (horizontal) {
+            blobBuffer.pos[i] = point.fX;
+        } else {
+            blobBuffer.points()[i] = point;
+        }
     }
 }
 
@@ -170,6 +170,7 @@ private:
     friend class TextLine;
     friend class InternalLineMetrics;
     friend class ParagraphCache;
+    friend class ParagraphCacheValue;
     friend class OneLineShaper;
 
     ParagraphImpl* fOwner;
@@ -193,6 +194,33 @@ private:
         skia_private::STArray<64, uint32_t, true> clusterIndexes;
     };
     std::shared_ptr<GlyphData> fGlyphData;
+
+    // What shaping produced for a run, without its owner or anything a layout adds to it, and
+    // sharing the glyph data. ParagraphCache keeps these instead of whole runs.
+    struct Shaped {
+        TextRange fTextRange;
+        ClusterRange fClusterRange;
+        SkFont fFont;
+        size_t fPlaceholderIndex;
+        size_t fIndex;
+        SkVector fAdvance;
+        SkVector fOffset;
+        TextIndex fClusterStart;
+        SkShaper::RunHandler::Range fUtf8Range;
+        std::shared_ptr<GlyphData> fGlyphData;
+        SkFontMetrics fFontMetrics;
+        SkScalar fHeightMultiplier;
+        SkScalar fBaselineShift;
+        SkScalar fCorrectAscent;
+        SkScalar fCorrectDescent;
+        SkScalar fCorrectLeading;
+        bool fUseHalfLeading;
+        bool fEllipsis;
+        uint8_t fBidiLevel;
+    };
+    Run(ParagraphImpl* owner, const Shaped& shaped);
+    Shaped shaped() const;
+
     skia_private::STArray<64, SkGlyphID, true>& fGlyphs;
     skia_private::STArray<64, SkPoint, true>& fPositions;
     skia_private::STArray<64, SkPoint, true>& fOffsets;
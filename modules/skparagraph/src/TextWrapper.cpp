@@ -301,6 +301,19 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
     auto start = span.begin();
     InternalLineMetrics maxRunMetrics;
     bool needEllipsis = false;
+    if (parent->fResumeLineBreakingFrom != EMPTY_INDEX) {
+        // The lines above the resume point are already there
+        const auto& resumePoint = parent->fLineBreakResumePoints[parent->fResumeLineBreakingFrom];
+        fEndLine.clean();
+        fEndLine.startFrom(start + resumePoint.fCluster, 0);
+        fLineNumber = resumePoint.fLine + 1;
+        fHeight = resumePoint.fHeight;
+        fMinIntrinsicWidth = resumePoint.fMinIntrinsicWidth;
+        fMaxIntrinsicWidth = resumePoint.fMaxIntrinsicWidth;
+        parent->fLongestLine = resumePoint.fLongestLine;
+        parent->fMaxWidthWithTrailingSpaces = resumePoint.fMaxWidthWithTrailingSpaces;
+        firstLine = false;
+    }
     while (fEndLine.endCluster() != end) {
 
         this->lookAhead(maxWidth, end, parent->getApplyRoundingHack());
@@ -411,6 +424,17 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
         fEndLine.startFrom(startLine, pos);
         parent->fMaxWidthWithTrailingSpaces = std::max(parent->fMaxWidthWithTrailingSpaces, widthWithSpaces);
 
+        if (fHardLineBreak && startLine != end && unlimitedLines && !hasEllipsis) {
+            // Nothing above this line depends on the text below it
+            parent->fLineBreakResumePoints.push_back({SkToSizeT(parent->lines().size()),
+                                                      SkToSizeT(startLine - start),
+                                                      fHeight,
+                                                      fMinIntrinsicWidth,
+                                                      fMaxIntrinsicWidth,
+                                                      parent->fLongestLine,
+                                                      parent->fMaxWidthWithTrailingSpaces});
+        }
+
         if (hasEllipsis && unlimitedLines) {
             // There is one case when we need an ellipsis on a separate line
             // after a line break when width is infinite
@@ -7,6 +7,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkPaint.h"
@@ -5046,6 +5047,63 @@ UNIX_ONLY_TEST(SkParagraph_CacheText, reporter) {
     test("text3", 2, false);
 }
 
+UNIX_ONLY_TEST(SkParagraph_CacheStatistics, reporter) {
+    ParagraphCache cache;
+    cache.turnOn(true);
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    auto test = [&](const char* text) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        builder.pushStyle(text_style);
+        builder.addText(text, strlen(text));
+        builder.pop();
+        auto paragraph = builder.Build();
+        // Shape the paragraph without the font collection's own cache.
+        fontCollection->getParagraphCache()->turnOn(false);
+        paragraph->layout(TestCanvasWidth);
+        fontCollection->getParagraphCache()->turnOn(true);
+
+        auto impl = static_cast<ParagraphImpl*>(paragraph.get());
+        if (!cache.findParagraph(impl)) {
+            cache.updateParagraph(impl);
+        }
+    };
+
+    test("text1");
+    test("text2");
+    test("text1");
+    test("text3");
+
+    ParagraphCache::Statistics stats = cache.statistics();
+    REPORTER_ASSERT(reporter, stats.fRequests == 7);
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fMisses == 3);
+    REPORTER_ASSERT(reporter, stats.fAdditions == 3);
+    REPORTER_ASSERT(reporter, stats.fEntries == 3);
+    REPORTER_ASSERT(reporter, stats.fEvictions == 0);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed > 0);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed <= stats.fByteLimit);
+
+    // Shrinking the budget purges what no longer fits.
+    cache.setByteLimit(0);
+    stats = cache.statistics();
+    REPORTER_ASSERT(reporter, stats.fEntries == 0);
+    REPORTER_ASSERT(reporter, stats.fEvictions == 3);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed == 0);
+
+    // Nothing is added while there is no budget.
+    test("text4");
+    REPORTER_ASSERT(reporter, cache.count() == 0);
+}
+
 UNIX_ONLY_TEST(SkParagraph_CacheFonts, reporter) {
     ParagraphCache cache;
     cache.turnOn(true);
@@ -7118,6 +7176,238 @@ DEF_TEST(SkParagraph_lineMetricsAfterUpdate, reporter) {
     REPORTER_ASSERT(reporter, lm.size() == 2);
 }
 
+UNIX_ONLY_TEST(SkParagraph_UpdateText, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+    fontCollection->disableFontFallback();
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(40);
+    text_style.setColor(SK_ColorBLACK);
+
+    auto build = [&](const SkString& text) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        builder.pushStyle(text_style);
+        builder.addText(text.c_str(), text.size());
+        auto paragraph = builder.Build();
+        paragraph->layout(TestCanvasWidth);
+        return paragraph;
+    };
+
+    // The runs after an edit are moved, not shaped again, so the sums can differ a little
+    auto nearlyEqual = [](SkScalar a, SkScalar b) { return SkScalarNearlyEqual(a, b, 0.01f); };
+
+    // The edited paragraph has to look exactly like the one built from the edited text
+    auto check = [&](Paragraph* edited, const SkString& text) {
+        auto expected = build(text);
+        edited->layout(TestCanvasWidth);
+        auto editedImpl = static_cast<ParagraphImpl*>(edited);
+        auto expectedImpl = static_cast<ParagraphImpl*>(expected.get());
+        REPORTER_ASSERT(reporter, editedImpl->text().size() == text.size() &&
+                                  memcmp(editedImpl->text().data(), text.c_str(), text.size()) == 0);
+        REPORTER_ASSERT(reporter, nearlyEqual(edited->getHeight(), expected->getHeight()));
+        REPORTER_ASSERT(reporter, nearlyEqual(edited->getMaxIntrinsicWidth(),
+                                                      expected->getMaxIntrinsicWidth()));
+        REPORTER_ASSERT(reporter, nearlyEqual(edited->getMinIntrinsicWidth(),
+                                                      expected->getMinIntrinsicWidth()));
+        REPORTER_ASSERT(reporter, nearlyEqual(edited->getLongestLine(),
+                                                      expected->getLongestLine()));
+
+        auto editedLines = editedImpl->lines();
+        auto expectedLines = expectedImpl->lines();
+        REPORTER_ASSERT(reporter, editedLines.size() == expectedLines.size());
+        for (size_t i = 0; i < std::min(editedLines.size(), expectedLines.size()); ++i) {
+            REPORTER_ASSERT(reporter, editedLines[i].text() == expectedLines[i].text());
+            REPORTER_ASSERT(reporter, editedLines[i].clusters() == expectedLines[i].clusters());
+            REPORTER_ASSERT(reporter, nearlyEqual(editedLines[i].offset().fY,
+                                                          expectedLines[i].offset().fY));
+            REPORTER_ASSERT(reporter, nearlyEqual(editedLines[i].width(),
+                                                          expectedLines[i].width()));
+        }
+
+        auto editedClusters = editedImpl->clusters();
+        auto expectedClusters = expectedImpl->clusters();
+        REPORTER_ASSERT(reporter, editedClusters.size() == expectedClusters.size());
+        for (size_t i = 0; i < std::min(editedClusters.size(), expectedClusters.size()); ++i) {
+            REPORTER_ASSERT(reporter, editedClusters[i].textRange() == expectedClusters[i].textRange());
+            REPORTER_ASSERT(reporter, nearlyEqual(editedClusters[i].width(),
+                                                          expectedClusters[i].width()));
+        }
+
+        for (int x = 0; x < 600; x += 50) {
+            for (int y = 0; y < 100; y += 20) {
+                auto editedPos = edited->getGlyphPositionAtCoordinate(x, y);
+                auto expectedPos = expected->getGlyphPositionAtCoordinate(x, y);
+                REPORTER_ASSERT(reporter, editedPos.position == expectedPos.position);
+                REPORTER_ASSERT(reporter, editedPos.affinity == expectedPos.affinity);
+            }
+        }
+        auto editedRects = edited->getRectsForRange(0, text.size(), RectHeightStyle::kTight,
+                                                    RectWidthStyle::kTight);
+        auto expectedRects = expected->getRectsForRange(0, text.size(), RectHeightStyle::kTight,
+                                                        RectWidthStyle::kTight);
+        REPORTER_ASSERT(reporter, editedRects.size() == expectedRects.size());
+        for (size_t i = 0; i < std::min(editedRects.size(), expectedRects.size()); ++i) {
+            REPORTER_ASSERT(reporter, nearlyEqual(editedRects[i].rect.fLeft,
+                                                          expectedRects[i].rect.fLeft));
+            REPORTER_ASSERT(reporter, nearlyEqual(editedRects[i].rect.fRight,
+                                                          expectedRects[i].rect.fRight));
+            REPORTER_ASSERT(reporter, nearlyEqual(editedRects[i].rect.fTop,
+                                                          expectedRects[i].rect.fTop));
+        }
+    };
+
+    SkString text("The first line of the text\n"
+                  "The quick brown fox jumps over the lazy dog and keeps running far away\n"
+                  "The last line");
+    auto paragraph = build(text);
+    auto impl = static_cast<ParagraphImpl*>(paragraph.get());
+    REPORTER_ASSERT(reporter, impl->lines().size() > 3);
+
+    // Typing inside a word of the second hard line keeps the lines above it
+    const size_t quick = text.find("quick");
+    REPORTER_ASSERT(reporter, paragraph->updateText(quick + 2, quick + 2, SkString("a")));
+    text.insert(quick + 2, "a");
+    REPORTER_ASSERT(reporter, impl->state() == kShaped);
+    REPORTER_ASSERT(reporter, impl->lines().size() == 1);
+    check(paragraph.get(), text);
+
+    // Deleting a space merges two words
+    const size_t fox = text.find(" fox");
+    REPORTER_ASSERT(reporter, paragraph->updateText(fox, fox + 1, SkString()));
+    text.remove(fox, 1);
+    check(paragraph.get(), text);
+
+    // Replacing a few words with more text pushes the rest to the next lines
+    const size_t lazy = text.find("lazy");
+    REPORTER_ASSERT(reporter, paragraph->updateText(lazy, lazy + 4,
+                                                    SkString("very very sleepy and lazy")));
+    text.remove(lazy, 4);
+    text.insert(lazy, "very very sleepy and lazy");
+    check(paragraph.get(), text);
+
+    // Edits at the very beginning and the very end
+    REPORTER_ASSERT(reporter, paragraph->updateText(0, 0, SkString("Oh, ")));
+    text.prepend("Oh, ");
+    check(paragraph.get(), text);
+    REPORTER_ASSERT(reporter, paragraph->updateText(text.size(), text.size(), SkString("!")));
+    text.append("!");
+    check(paragraph.get(), text);
+
+    // Removing and adding hard line breaks
+    const size_t newLine = text.find("\n");
+    REPORTER_ASSERT(reporter, paragraph->updateText(newLine, newLine + 1, SkString(" ")));
+    text.remove(newLine, 1);
+    text.insert(newLine, " ");
+    check(paragraph.get(), text);
+    REPORTER_ASSERT(reporter, paragraph->updateText(newLine, newLine + 1, SkString("\n\n")));
+    text.remove(newLine, 1);
+    text.insert(newLine, "\n\n");
+    check(paragraph.get(), text);
+
+    // Text the edited paragraph could not shape locally
+    REPORTER_ASSERT(reporter, paragraph->updateText(4, 4, SkString("\xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D ")));
+    text.insert(4, "\xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D ");
+    check(paragraph.get(), text);
+
+    // Replacing everything
+    REPORTER_ASSERT(reporter, paragraph->updateText(0, text.size(), SkString("Short")));
+    check(paragraph.get(), SkString("Short"));
+
+    // Edits that cannot be done
+    REPORTER_ASSERT(reporter, !paragraph->updateText(3, 2, SkString("x")));
+    REPORTER_ASSERT(reporter, !paragraph->updateText(0, 6, SkString("x")));
+    REPORTER_ASSERT(reporter, !paragraph->updateText(0, 0, SkString("\xFF")));
+    REPORTER_ASSERT(reporter, paragraph->updateText(5, 5, SkString("\xC3\xA9")));
+    REPORTER_ASSERT(reporter, !paragraph->updateText(6, 6, SkString("x")));
+    check(paragraph.get(), SkString("Short\xC3\xA9"));
+
+    // The text around placeholders can be edited but the placeholders cannot
+    ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+    builder.pushStyle(text_style);
+    builder.addText("Before ");
+    builder.addPlaceholder(PlaceholderStyle(20, 20, PlaceholderAlignment::kBaseline,
+                                            TextBaseline::kAlphabetic, 0));
+    builder.addText(" after");
+    auto withPlaceholder = builder.Build();
+    withPlaceholder->layout(TestCanvasWidth);
+    auto placeholderStart = static_cast<ParagraphImpl*>(withPlaceholder.get())
+                                    ->placeholders()[0].fRange.start;
+    REPORTER_ASSERT(reporter, !withPlaceholder->updateText(placeholderStart - 1,
+                                                           placeholderStart + 1, SkString()));
+    REPORTER_ASSERT(reporter, withPlaceholder->updateText(0, 6, SkString("Ahead")));
+    withPlaceholder->layout(TestCanvasWidth);
+    auto rects = withPlaceholder->getRectsForPlaceholders();
+    REPORTER_ASSERT(reporter, rects.size() == 1);
+    auto placeholders = static_cast<ParagraphImpl*>(withPlaceholder.get())->placeholders();
+    REPORTER_ASSERT(reporter, placeholders[0].fRange.start == placeholderStart - 1);
+    REPORTER_ASSERT(reporter, placeholders[1].fTextBefore.start == placeholders[0].fRange.end);
+}
+
+UNIX_ONLY_TEST(SkParagraph_LayoutAll, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(20);
+    text_style.setColor(SK_ColorBLACK);
+
+    const char* text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+                       "tempor incididunt ut labore et dolore magna aliqua. \u0627\u0644\u0639\u0631 "
+                       "Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi.";
+    const size_t textSize = strlen(text);
+
+    // One builder for all the paragraphs, so they share the SkUnicode too
+    constexpr int kCount = 48;
+    ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+    std::vector<std::unique_ptr<Paragraph>> serial, threaded;
+    std::vector<Paragraph*> threadedPtrs;
+    std::vector<SkScalar> widths;
+    for (int i = 0; i < kCount; ++i) {
+        for (auto* paragraphs : {&serial, &threaded}) {
+            builder.Reset();
+            builder.pushStyle(text_style);
+            builder.addText(text, textSize);
+            builder.addText(std::u16string(i % 5, u'x'));
+            paragraphs->push_back(builder.Build());
+        }
+        threadedPtrs.push_back(threaded.back().get());
+        widths.push_back(100 + 20 * (i % 12));
+    }
+
+    std::vector<Paragraph*> serialPtrs;
+    for (auto& paragraph : serial) {
+        serialPtrs.push_back(paragraph.get());
+    }
+    Paragraph::LayoutAll(serialPtrs, widths, nullptr);
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    Paragraph::LayoutAll(threadedPtrs, widths, executor.get());
+
+    for (int i = 0; i < kCount; ++i) {
+        auto expected = serial[i].get();
+        auto actual = threaded[i].get();
+        REPORTER_ASSERT(reporter, expected->getMaxWidth() == widths[i]);
+        REPORTER_ASSERT(reporter, actual->getMaxWidth() == widths[i]);
+        REPORTER_ASSERT(reporter, actual->lineNumber() == expected->lineNumber());
+        REPORTER_ASSERT(reporter, actual->getHeight() == expected->getHeight());
+        REPORTER_ASSERT(reporter, actual->getLongestLine() == expected->getLongestLine());
+        REPORTER_ASSERT(reporter, actual->getMinIntrinsicWidth() ==
+                                  expected->getMinIntrinsicWidth());
+        REPORTER_ASSERT(reporter, actual->getMaxIntrinsicWidth() ==
+                                  expected->getMaxIntrinsicWidth());
+    }
+}
+
 // Google logo is shown in one style (the first one)
 UNIX_ONLY_TEST(SkParagraph_MultiStyle_Logo, reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>(true);
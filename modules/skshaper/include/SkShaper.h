@@ -50,6 +50,9 @@ public:
     static std::unique_ptr<SkShaper> MakeShapeDontWrapOrReorder(std::unique_ptr<SkUnicode> unicode,
                                                                 sk_sp<SkFontMgr> = nullptr);
     static void PurgeHarfBuzzCache();
+    /** Sets the memory budget, in bytes, of the cache of shaped text segments shared by the
+        HarfBuzz shapers, and returns the previous budget. A budget of zero disables the cache. */
+    static size_t SetHarfBuzzShapeCacheLimit(size_t bytes);
     #endif
     #ifdef SK_SHAPER_CORETEXT_AVAILABLE
     static std::unique_ptr<SkShaper> MakeCoreText();
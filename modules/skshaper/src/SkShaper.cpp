@@ -250,6 +250,8 @@ void SkTextBlobBuilderRunHandler::commitRunBuffer(const RunInfo& info) {
         SkASSERT(fClusters[i] >= (unsigned)fClusterOffset);
         fClusters[i] -= fClusterOffset;
     }
+    // Horizontal text rarely needs per-glyph y, so keep only the x positions when possible.
+    SkTextBlobBuilderPriv::MakeLastRunHorizontal(&fBuilder);
     fCurrentPosition += info.fAdvance;
 }
 void SkTextBlobBuilderRunHandler::commitLine() {
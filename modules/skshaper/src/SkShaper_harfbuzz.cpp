@@ -28,12 +28,17 @@
 #include "include/private/base/SkTypeTraits.h"
 #include "modules/skshaper/include/SkShaper.h"
 #include "modules/skunicode/include/SkUnicode.h"
+#include "src/base/SkNoDestructor.h"
 #include "src/base/SkTDPQueue.h"
+#include "src/base/SkTInternalLList.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkLRUCache.h"
+#include "src/core/SkTHash.h"
 
 #include <hb.h>
 #include <hb-ot.h>
+#include <algorithm>
 #include <cstring>
 #include <locale>
 #include <memory>
@@ -1321,6 +1326,169 @@ static HBLockedFaceCache get_hbFace_cache() {
     return HBLockedFaceCache(gHBFaceCache, gHBFaceCacheMutex);
 }
 
+// Caches the glyphs HarfBuzz produces for a segment of text (typically a word when wrapping), so
+// that segments shaped over and over with the same font, direction, script, language and features
+// skip hb_shape. HarfBuzz only looks at a few code points of context on either side of the
+// segment, so that context is part of the key and a cached result is what hb_shape would produce.
+class HBShapeCache {
+public:
+    // HB_BUFFER_CONTEXT_LENGTH, the pre- and post-context kept by an hb_buffer_t.
+    static constexpr int kContextLength = 5;
+    // Longer segments rarely repeat, and would only crowd out the ones that do.
+    static constexpr size_t kMaxSegmentBytes = 256;
+    static constexpr size_t kDefaultByteLimit = 1024 * 1024;
+
+    struct Key {
+        SkFont fFont;
+        const char* fText;      // The segment and its context.
+        size_t fTextBytes;
+        size_t fSegmentStart;   // Offsets of the segment in fText.
+        size_t fSegmentEnd;
+        hb_direction_t fDirection;
+        hb_script_t fScript;
+        hb_language_t fLanguage;
+        STArray<4, hb_feature_t> fFeatures;  // Ranges relative to the segment.
+        uint32_t fHash;
+
+        void computeHash() {
+            struct {
+                SkTypefaceID fTypefaceID;
+                SkScalar fSize, fScaleX, fSkewX;
+                size_t fSegmentStart, fSegmentEnd;
+                hb_direction_t fDirection;
+                hb_script_t fScript;
+                hb_language_t fLanguage;
+            } fields;
+            memset(&fields, 0, sizeof(fields));
+            fields.fTypefaceID = fFont.getTypeface()->uniqueID();
+            fields.fSize = fFont.getSize();
+            fields.fScaleX = fFont.getScaleX();
+            fields.fSkewX = fFont.getSkewX();
+            fields.fSegmentStart = fSegmentStart;
+            fields.fSegmentEnd = fSegmentEnd;
+            fields.fDirection = fDirection;
+            fields.fScript = fScript;
+            fields.fLanguage = fLanguage;
+            fHash = SkChecksum::Hash32(&fields, sizeof(fields));
+            fHash = SkChecksum::Hash32(fText, fTextBytes, fHash);
+            fHash = SkChecksum::Hash32(fFeatures.data(), fFeatures.size_bytes(), fHash);
+        }
+
+        bool operator==(const Key& that) const {
+            return fHash == that.fHash &&
+                   fTextBytes == that.fTextBytes &&
+                   fSegmentStart == that.fSegmentStart &&
+                   fSegmentEnd == that.fSegmentEnd &&
+                   fDirection == that.fDirection &&
+                   fScript == that.fScript &&
+                   fLanguage == that.fLanguage &&
+                   fFeatures.size() == that.fFeatures.size() &&
+                   fFont == that.fFont &&
+                   0 == memcmp(fText, that.fText, fTextBytes) &&
+                   0 == memcmp(fFeatures.data(), that.fFeatures.data(), fFeatures.size_bytes());
+        }
+    };
+
+    // The shaped glyphs of a segment, with clusters relative to the start of the segment.
+    struct Glyphs : public SkNVRefCnt<Glyphs> {
+        explicit Glyphs(size_t numGlyphs)
+            : fGlyphs(new ShapedGlyph[numGlyphs]), fNumGlyphs(numGlyphs) {}
+
+        std::unique_ptr<ShapedGlyph[]> fGlyphs;
+        size_t fNumGlyphs;
+        SkVector fAdvance;
+    };
+
+    static HBShapeCache& Get() {
+        static SkNoDestructor<HBShapeCache> gCache;
+        return *gCache;
+    }
+
+    sk_sp<const Glyphs> find(const Key& key) {
+        SkAutoMutexExclusive lock(fMutex);
+        Entry** found = fMap.find(key);
+        if (!found) {
+            return nullptr;
+        }
+        Entry* entry = *found;
+        if (entry != fLRU.head()) {
+            fLRU.remove(entry);
+            fLRU.addToHead(entry);
+        }
+        return entry->fGlyphs;
+    }
+
+    void add(const Key& key, sk_sp<const Glyphs> glyphs) {
+        SkAutoMutexExclusive lock(fMutex);
+        if (fByteLimit == 0 || fMap.find(key)) {
+            return;
+        }
+        Entry* entry = new Entry(key, std::move(glyphs));
+        fMap.set(entry);
+        fLRU.addToHead(entry);
+        fBytes += entry->fBytes;
+        this->purgeAsNeeded();
+    }
+
+    size_t setByteLimit(size_t byteLimit) {
+        SkAutoMutexExclusive lock(fMutex);
+        size_t prevLimit = fByteLimit;
+        fByteLimit = byteLimit;
+        this->purgeAsNeeded();
+        return prevLimit;
+    }
+
+    void purge() {
+        SkAutoMutexExclusive lock(fMutex);
+        while (fLRU.tail()) {
+            this->remove(fLRU.tail());
+        }
+    }
+
+private:
+    struct Entry {
+        Entry(const Key& key, sk_sp<const Glyphs> glyphs)
+            : fText(new char[key.fTextBytes]), fKey(key), fGlyphs(std::move(glyphs)) {
+            // The key refers to the caller's text; give it a copy that lives as long as it does.
+            memcpy(fText.get(), key.fText, key.fTextBytes);
+            fKey.fText = fText.get();
+            fBytes = sizeof(Entry) + key.fTextBytes + fKey.fFeatures.size_bytes() +
+                     sizeof(Glyphs) + fGlyphs->fNumGlyphs * sizeof(ShapedGlyph);
+        }
+
+        std::unique_ptr<char[]> fText;
+        Key fKey;
+        sk_sp<const Glyphs> fGlyphs;
+        size_t fBytes;
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    struct Traits {
+        static const Key& GetKey(const Entry* e) { return e->fKey; }
+        static uint32_t Hash(const Key& key) { return key.fHash; }
+    };
+
+    void purgeAsNeeded() SK_REQUIRES(fMutex) {
+        while (fBytes > fByteLimit && fLRU.tail()) {
+            this->remove(fLRU.tail());
+        }
+    }
+
+    void remove(Entry* entry) SK_REQUIRES(fMutex) {
+        fMap.remove(entry->fKey);
+        fLRU.remove(entry);
+        fBytes -= entry->fBytes;
+        delete entry;
+    }
+
+    SkMutex fMutex;
+    THashTable<Entry*, Key, Traits> fMap SK_GUARDED_BY(fMutex);
+    SkTInternalLList<Entry> fLRU SK_GUARDED_BY(fMutex);
+    size_t fBytes SK_GUARDED_BY(fMutex) = 0;
+    size_t fByteLimit SK_GUARDED_BY(fMutex) = kDefaultByteLimit;
+};
+
 ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
                                   size_t const utf8Bytes,
                                   char const * const utf8Start,
@@ -1335,6 +1503,83 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     ShapedRun run(RunHandler::Range(utf8Start - utf8, utf8runLength),
                   font.currentFont(), bidi.currentLevel(), nullptr, 0);
 
+    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
+    hb_script_t hbScript = hb_script_from_iso15924_tag((hb_tag_t)script.currentScript());
+    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
+    // The user must provide a language, but may provide data hb_language_from_string cannot use.
+    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
+    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
+    if (hbLanguage == HB_LANGUAGE_INVALID) {
+        hbLanguage = fUndefinedLanguage;
+    }
+
+    STArray<32, hb_feature_t> hbFeatures;
+    for (const auto& feature : SkSpan(features, featuresSize)) {
+        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
+                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
+        {
+            continue;
+        }
+        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
+                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
+        {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
+        } else {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
+        }
+    }
+
+    // Look for the segment in the shape cache, keyed by the segment and the context around it.
+    const unsigned segmentStart = SkTo<unsigned>(utf8Start - utf8);
+    const unsigned segmentEnd   = SkTo<unsigned>(utf8End   - utf8);
+    HBShapeCache::Key cacheKey;
+    const bool cacheable = utf8runLength <= HBShapeCache::kMaxSegmentBytes;
+    if (cacheable) {
+        const char* contextStart = utf8Start;
+        for (int i = 0; i < HBShapeCache::kContextLength && contextStart > utf8; ++i) {
+            do {
+                --contextStart;
+            } while (contextStart > utf8 && (*contextStart & 0xC0) == 0x80);
+        }
+        const char* contextEnd = utf8End;
+        for (int i = 0; i < HBShapeCache::kContextLength && contextEnd < utf8 + utf8Bytes; ++i) {
+            utf8_next(&contextEnd, utf8 + utf8Bytes);
+        }
+
+        cacheKey.fFont = font.currentFont();
+        cacheKey.fText = contextStart;
+        cacheKey.fTextBytes = contextEnd - contextStart;
+        cacheKey.fSegmentStart = utf8Start - contextStart;
+        cacheKey.fSegmentEnd = utf8End - contextStart;
+        cacheKey.fDirection = direction;
+        cacheKey.fScript = hbScript;
+        cacheKey.fLanguage = hbLanguage;
+        for (hb_feature_t feature : hbFeatures) {
+            if (feature.start != HB_FEATURE_GLOBAL_START || feature.end != HB_FEATURE_GLOBAL_END) {
+                // Only clusters within the segment can be affected.
+                feature.start = std::max(feature.start, segmentStart) - segmentStart;
+                feature.end = std::min(feature.end, segmentEnd) - segmentStart;
+            }
+            cacheKey.fFeatures.push_back(feature);
+        }
+        cacheKey.computeHash();
+
+        if (sk_sp<const HBShapeCache::Glyphs> cached = HBShapeCache::Get().find(cacheKey)) {
+            run = ShapedRun(RunHandler::Range(utf8Start - utf8, utf8runLength),
+                            font.currentFont(), bidi.currentLevel(),
+                            std::unique_ptr<ShapedGlyph[]>(new ShapedGlyph[cached->fNumGlyphs]),
+                            cached->fNumGlyphs, cached->fAdvance);
+            memcpy(run.fGlyphs.get(), cached->fGlyphs.get(),
+                   cached->fNumGlyphs * sizeof(ShapedGlyph));
+            for (size_t i = 0; i < cached->fNumGlyphs; ++i) {
+                run.fGlyphs[i].fCluster += segmentStart;
+            }
+            return run;
+        }
+    }
+
     hb_buffer_t* buffer = fBuffer.get();
     SkAutoTCallVProc<hb_buffer_t, hb_buffer_clear_contents> autoClearBuffer(buffer);
     hb_buffer_set_content_type(buffer, HB_BUFFER_CONTENT_TYPE_UNICODE);
@@ -1359,16 +1604,8 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     // Add postcontext.
     hb_buffer_add_utf8(buffer, utf8Current, utf8 + utf8Bytes - utf8Current, 0, 0);
 
-    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
     hb_buffer_set_direction(buffer, direction);
-    hb_buffer_set_script(buffer, hb_script_from_iso15924_tag((hb_tag_t)script.currentScript()));
-    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
-    // The user must provide a language, but may provide data hb_language_from_string cannot use.
-    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
-    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
-    if (hbLanguage == HB_LANGUAGE_INVALID) {
-        hbLanguage = fUndefinedLanguage;
-    }
+    hb_buffer_set_script(buffer, hbScript);
     hb_buffer_set_language(buffer, hbLanguage);
     hb_buffer_guess_segment_properties(buffer);
 
@@ -1392,24 +1629,6 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
         return run;
     }
 
-    STArray<32, hb_feature_t> hbFeatures;
-    for (const auto& feature : SkSpan(features, featuresSize)) {
-        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
-                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
-        {
-            continue;
-        }
-        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
-                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
-        {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
-        } else {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
-        }
-    }
-
     hb_shape(hbFont.get(), buffer, hbFeatures.data(), hbFeatures.size());
     unsigned len = hb_buffer_get_length(buffer);
     if (len == 0) {
@@ -1461,6 +1680,16 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     }
     run.fAdvance = runAdvance;
 
+    if (cacheable) {
+        auto glyphs = sk_make_sp<HBShapeCache::Glyphs>(len);
+        memcpy(glyphs->fGlyphs.get(), run.fGlyphs.get(), len * sizeof(ShapedGlyph));
+        for (unsigned i = 0; i < len; i++) {
+            glyphs->fGlyphs[i].fCluster -= segmentStart;
+        }
+        glyphs->fAdvance = runAdvance;
+        HBShapeCache::Get().add(cacheKey, std::move(glyphs));
+    }
+
     return run;
 }
 
@@ -1545,6 +1774,13 @@ std::unique_ptr<SkShaper> SkShaper::MakeShapeDontWrapOrReorder(std::unique_ptr<S
 }
 
 void SkShaper::PurgeHarfBuzzCache() {
-    HBLockedFaceCache cache = get_hbFace_cache();
-    cache.reset();
+    {
+        HBLockedFaceCache cache = get_hbFace_cache();
+        cache.reset();
+    }
+    HBShapeCache::Get().purge();
+}
+
+size_t SkShaper::SetHarfBuzzShapeCacheLimit(size_t bytes) {
+    return HBShapeCache::Get().setByteLimit(bytes);
 }
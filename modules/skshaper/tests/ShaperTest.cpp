@@ -21,6 +21,7 @@
 #include <cinttypes>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace {
 struct RunHandler final : public SkShaper::RunHandler {
@@ -193,4 +194,63 @@ SHAPER_TEST(taitham)
 SHAPER_TEST(tamil)
 #undef SHAPER_TEST
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+namespace {
+// Records every glyph, position and cluster of the shaped text.
+struct RecordingRunHandler final : public SkShaper::RunHandler {
+    std::vector<SkGlyphID> fGlyphs;
+    std::vector<SkPoint> fPositions;
+    std::vector<uint32_t> fClusters;
+
+    void beginLine() override {}
+    void runInfo(const RunInfo&) override {}
+    void commitRunInfo() override {}
+    Buffer runBuffer(const RunInfo& info) override {
+        size_t offset = fGlyphs.size();
+        fGlyphs.resize(offset + info.glyphCount);
+        fPositions.resize(offset + info.glyphCount);
+        fClusters.resize(offset + info.glyphCount);
+        return {fGlyphs.data() + offset, fPositions.data() + offset, nullptr,
+                fClusters.data() + offset, {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo&) override {}
+    void commitLine() override {}
+};
+}  // namespace
+
+// The shape cache must not change what is shaped, including for scripts whose shaping depends on
+// the text around each word.
+DEF_TEST(Shaper_harfbuzz_shape_cache, r) {
+    SkFont font(SkTypeface::MakeDefault());
+    for (const char* resource : {"text/english.txt", "text/arabic.txt", "text/devanagari.txt"}) {
+        auto data = GetResourceAsData(resource);
+        if (!data) {
+            ERRORF(r, "Could not get resource %s.", resource);
+            return;
+        }
+        const char* utf8 = (const char*)data->data();
+        auto shaper = SkShaper::MakeShaperDrivenWrapper();
+        if (!shaper) {
+            ERRORF(r, "Could not create shaper.");
+            return;
+        }
+
+        size_t prevLimit = SkShaper::SetHarfBuzzShapeCacheLimit(0);
+        RecordingRunHandler uncached;
+        shaper->shape(utf8, data->size(), font, true, 400, &uncached);
+
+        SkShaper::SetHarfBuzzShapeCacheLimit(1024 * 1024);
+        SkShaper::PurgeHarfBuzzCache();
+        for (int i = 0; i < 2; ++i) {  // Fill the cache, then shape from it.
+            RecordingRunHandler cached;
+            shaper->shape(utf8, data->size(), font, true, 400, &cached);
+            REPORTER_ASSERT(r, cached.fGlyphs == uncached.fGlyphs, "%s", resource);
+            REPORTER_ASSERT(r, cached.fPositions == uncached.fPositions, "%s", resource);
+            REPORTER_ASSERT(r, cached.fClusters == uncached.fClusters, "%s", resource);
+        }
+        SkShaper::SetHarfBuzzShapeCacheLimit(prevLimit);
+    }
+}
+#endif
+
 #endif  // defined(SKSHAPER_IMPLEMENTATION) && !defined(SK_BUILD_FOR_GOOGLE3)
@@ -275,6 +275,17 @@ class SKUNICODE_API SkUnicode {
 
         static std::unique_ptr<SkUnicode> MakeIcuBasedUnicode();
 
+        /** Wraps the unicode so that the results of computeCodeUnitFlags, getBidiRegions and
+         *  getWords are kept in a cache, by text, that the wrapper shares with all its copies.
+         *  Laying out the same text again (in another width, style or component) then doesn't
+         *  analyze it again. Safe to use from several threads, each with its own copy.
+         *
+         *  @param unicode    the unicode that does the analysis
+         *  @param byteLimit  the least recently used results are purged above this
+         */
+        static std::unique_ptr<SkUnicode> MakeCachedUnicode(std::unique_ptr<SkUnicode> unicode,
+                                                            size_t byteLimit = 4 * 1024 * 1024);
+
         static std::unique_ptr<SkUnicode> MakeClientBasedUnicode(
                 SkSpan<char> text,
                 std::vector<SkUnicode::Position> words,
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkString.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "modules/skunicode/include/SkUnicode.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkLRUCache.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace skia_private;
+
+namespace {
+
+// The results of analyzing a text, by the text and whatever else they depend on.
+class SkUnicodeAnalysisCache {
+public:
+    enum class Kind : uint8_t {
+        kCodeUnitFlagsUTF8,
+        kCodeUnitFlagsUTF16,
+        kBidiRegions,
+        kWords,
+    };
+
+    // Keys made for lookups only view the text and locale; the copies that the cache keeps own
+    // theirs.
+    class Key {
+    public:
+        Key(Kind kind, int option, const char* locale, const void* text, size_t byteLength)
+                : fKind(kind)
+                , fOption(option)
+                , fLocale(locale ? locale : "")
+                , fText(static_cast<const char*>(text), byteLength) {
+            fHash = SkChecksum::Hash32(fText.data(), fText.size(),
+                                       SkChecksum::Hash32(fLocale.data(), fLocale.size(),
+                                                          (uint32_t)fKind << 16 | fOption));
+        }
+
+        Key(const Key& that)
+                : fKind(that.fKind)
+                , fOption(that.fOption)
+                , fHash(that.fHash)
+                , fStorage(new char[that.fLocale.size() + that.fText.size()]) {
+            char* locale = fStorage.get();
+            char* text = std::copy(that.fLocale.begin(), that.fLocale.end(), locale);
+            std::copy(that.fText.begin(), that.fText.end(), text);
+            fLocale = std::string_view(locale, that.fLocale.size());
+            fText = std::string_view(text, that.fText.size());
+        }
+        Key& operator=(const Key&) = delete;
+
+        bool operator==(const Key& that) const {
+            return fHash == that.fHash && fKind == that.fKind && fOption == that.fOption &&
+                   fLocale == that.fLocale && fText == that.fText;
+        }
+
+        uint32_t hash() const { return fHash; }
+        size_t bytesUsed() const { return sizeof(Key) + fLocale.size() + fText.size(); }
+
+    private:
+        Kind fKind;
+        int fOption;  // replaceTabs or the text direction
+        std::string_view fLocale;
+        std::string_view fText;
+        uint32_t fHash;
+        std::unique_ptr<char[]> fStorage;
+    };
+
+    struct Value {
+        TArray<SkUnicode::CodeUnitFlags, true> fCodeUnitFlags;
+        std::vector<SkUnicode::BidiRegion> fBidiRegions;
+        std::vector<SkUnicode::Position> fWords;
+
+        size_t bytesUsed() const {
+            return sizeof(Value) +
+                   fCodeUnitFlags.size() * sizeof(SkUnicode::CodeUnitFlags) +
+                   fBidiRegions.size() * sizeof(SkUnicode::BidiRegion) +
+                   fWords.size() * sizeof(SkUnicode::Position);
+        }
+    };
+
+    explicit SkUnicodeAnalysisCache(size_t byteLimit)
+            // Entries are limited by the byte budget rather than by count.
+            : fLRU(std::numeric_limits<int>::max())
+            , fByteLimit(byteLimit) {}
+
+    // Copies the value out, so the caller doesn't hold the lock while using it.
+    bool find(const Key& key, Value* value) {
+        SkAutoMutexExclusive lock(fMutex);
+        Entry* entry = fLRU.find(key);
+        if (!entry) {
+            return false;
+        }
+        *value = entry->fValue;
+        return true;
+    }
+
+    void add(const Key& key, Value value) {
+        const size_t bytes = key.bytesUsed() + value.bytesUsed();
+        if (bytes > fByteLimit) {
+            return;
+        }
+        SkAutoMutexExclusive lock(fMutex);
+        if (fLRU.find(key)) {
+            // Another thread analyzed the same text at the same time.
+            return;
+        }
+        fLRU.insert(key, Entry{std::move(value), bytes});
+        fBytesUsed += bytes;
+        while (fBytesUsed > fByteLimit) {
+            fBytesUsed -= fLRU.peekLRU()->fBytesUsed;
+            fLRU.removeLRU();
+        }
+    }
+
+private:
+    struct Entry {
+        Value fValue;
+        size_t fBytesUsed;
+    };
+    struct KeyHash {
+        uint32_t operator()(const Key& key) const { return key.hash(); }
+    };
+
+    SkMutex fMutex;
+    SkLRUCache<Key, Entry, KeyHash> fLRU SK_GUARDED_BY(fMutex);
+    size_t fBytesUsed SK_GUARDED_BY(fMutex) = 0;
+    const size_t fByteLimit;
+};
+
+class SkUnicode_cached : public SkUnicode {
+public:
+    SkUnicode_cached(std::unique_ptr<SkUnicode> unicode,
+                     std::shared_ptr<SkUnicodeAnalysisCache> cache)
+            : fUnicode(std::move(unicode)), fCache(std::move(cache)) {}
+
+    ~SkUnicode_cached() override = default;
+
+    std::unique_ptr<SkUnicode> copy() override {
+        std::unique_ptr<SkUnicode> unicode = fUnicode->copy();
+        if (!unicode) {
+            return nullptr;
+        }
+        return std::make_unique<SkUnicode_cached>(std::move(unicode), fCache);
+    }
+
+    SkString toUpper(const SkString& str) override { return fUnicode->toUpper(str); }
+
+    std::unique_ptr<SkBidiIterator> makeBidiIterator(const uint16_t text[], int count,
+                                                     SkBidiIterator::Direction dir) override {
+        return fUnicode->makeBidiIterator(text, count, dir);
+    }
+    std::unique_ptr<SkBidiIterator> makeBidiIterator(const char text[], int count,
+                                                     SkBidiIterator::Direction dir) override {
+        return fUnicode->makeBidiIterator(text, count, dir);
+    }
+    std::unique_ptr<SkBreakIterator> makeBreakIterator(const char locale[],
+                                                       BreakType breakType) override {
+        return fUnicode->makeBreakIterator(locale, breakType);
+    }
+    std::unique_ptr<SkBreakIterator> makeBreakIterator(BreakType breakType) override {
+        return fUnicode->makeBreakIterator(breakType);
+    }
+
+    bool getBidiRegions(const char utf8[],
+                        int utf8Units,
+                        TextDirection dir,
+                        std::vector<BidiRegion>* results) override {
+        using Kind = SkUnicodeAnalysisCache::Kind;
+        SkUnicodeAnalysisCache::Key key(Kind::kBidiRegions, (int)dir, nullptr, utf8, utf8Units);
+        SkUnicodeAnalysisCache::Value value;
+        if (fCache->find(key, &value)) {
+            *results = std::move(value.fBidiRegions);
+            return true;
+        }
+        if (!fUnicode->getBidiRegions(utf8, utf8Units, dir, results)) {
+            return false;
+        }
+        value.fBidiRegions = *results;
+        fCache->add(key, std::move(value));
+        return true;
+    }
+
+    bool getWords(const char utf8[], int utf8Units, const char* locale,
+                  std::vector<Position>* results) override {
+        using Kind = SkUnicodeAnalysisCache::Kind;
+        SkUnicodeAnalysisCache::Key key(Kind::kWords, 0, locale, utf8, utf8Units);
+        SkUnicodeAnalysisCache::Value value;
+        if (fCache->find(key, &value)) {
+            *results = std::move(value.fWords);
+            return true;
+        }
+        if (!fUnicode->getWords(utf8, utf8Units, locale, results)) {
+            return false;
+        }
+        value.fWords = *results;
+        fCache->add(key, std::move(value));
+        return true;
+    }
+
+    bool computeCodeUnitFlags(char utf8[], int utf8Units, bool replaceTabs,
+                              TArray<SkUnicode::CodeUnitFlags, true>* results) override {
+        return this->computeCodeUnitFlags(SkUnicodeAnalysisCache::Kind::kCodeUnitFlagsUTF8,
+                                          utf8, utf8Units, replaceTabs, results);
+    }
+
+    bool computeCodeUnitFlags(char16_t utf16[], int utf16Units, bool replaceTabs,
+                              TArray<SkUnicode::CodeUnitFlags, true>* results) override {
+        return this->computeCodeUnitFlags(SkUnicodeAnalysisCache::Kind::kCodeUnitFlagsUTF16,
+                                          utf16, utf16Units, replaceTabs, results);
+    }
+
+    void reorderVisual(const BidiLevel runLevels[],
+                       int levelsCount,
+                       int32_t logicalFromVisual[]) override {
+        fUnicode->reorderVisual(runLevels, levelsCount, logicalFromVisual);
+    }
+
+private:
+    template <typename CodeUnit>
+    bool computeCodeUnitFlags(SkUnicodeAnalysisCache::Kind kind,
+                              CodeUnit text[], int units, bool replaceTabs,
+                              TArray<SkUnicode::CodeUnitFlags, true>* results) {
+        SkUnicodeAnalysisCache::Key key(kind, replaceTabs, nullptr, text,
+                                        units * sizeof(CodeUnit));
+        SkUnicodeAnalysisCache::Value value;
+        if (fCache->find(key, &value)) {
+            *results = std::move(value.fCodeUnitFlags);
+            if (replaceTabs) {
+                // Replace them as the analysis would have.
+                for (int i = 0; i < units; ++i) {
+                    if (SkUnicode::isTabulation((*results)[i])) {
+                        text[i] = ' ';
+                    }
+                }
+            }
+            return true;
+        }
+        // The key only views the text, so copy it before the analysis replaces the tabs.
+        const SkUnicodeAnalysisCache::Key textKey = key;
+        if (!fUnicode->computeCodeUnitFlags(text, units, replaceTabs, results)) {
+            return false;
+        }
+        value.fCodeUnitFlags = *results;
+        fCache->add(textKey, std::move(value));
+        return true;
+    }
+
+    std::unique_ptr<SkUnicode> fUnicode;
+    std::shared_ptr<SkUnicodeAnalysisCache> fCache;
+};
+
+}  // namespace
+
+std::unique_ptr<SkUnicode> SkUnicode::MakeCachedUnicode(std::unique_ptr<SkUnicode> unicode,
+                                                        size_t byteLimit) {
+    if (!unicode) {
+        return nullptr;
+    }
+    return std::make_unique<SkUnicode_cached>(
+            std::move(unicode), std::make_shared<SkUnicodeAnalysisCache>(byteLimit));
+}
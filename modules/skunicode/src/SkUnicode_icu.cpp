@@ -18,7 +18,8 @@
 #include "modules/skunicode/src/SkUnicode_icu.h"
 #include "modules/skunicode/src/SkUnicode_icu_bidi.h"
 #include "src/base/SkUTF.h"
-#include "src/core/SkTHash.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkLRUCache.h"
 #include <unicode/umachine.h>
 #include <functional>
 #include <string>
@@ -113,11 +114,112 @@ static UBreakIteratorType convertType(SkUnicode::BreakType type) {
     }
 }
 
+// Opening a break iterator loads its rules, so one is opened for each type and locale and the
+// others are cloned from it. Iterators go back to the pool when they are no longer used, so
+// breaking text again doesn't have to allocate one either.
+class SkIcuBreakIteratorCache {
+    struct Key {
+        SkUnicode::BreakType fType;
+        SkString fLocale;
+
+        bool operator==(const Key& that) const {
+            return fType == that.fType && fLocale == that.fLocale;
+        }
+    };
+    struct KeyHash {
+        uint32_t operator()(const Key& key) const {
+            return SkChecksum::Hash32(key.fLocale.c_str(), key.fLocale.size(),
+                                      SkToU32(key.fType));
+        }
+    };
+    struct Pool {
+        ICUBreakIterator fPrototype;
+        std::vector<ICUBreakIterator> fIdle;
+    };
+    // Enough for a few threads breaking text at the same time.
+    static constexpr size_t kMaxIdlePerPool = 4;
+    // Enough for each type of break in a few locales. The least recently used pool is closed
+    // to make room for another.
+    static constexpr int kMaxPools = 16;
+
+    SkLRUCache<Key, Pool, KeyHash> fPools{kMaxPools};
+    SkMutex fPoolsMutex;
+
+ public:
+    static SkIcuBreakIteratorCache& get() {
+        static SkIcuBreakIteratorCache instance;
+        return instance;
+    }
+
+    // A break iterator that goes back to the pool when the lease is destroyed.
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&&) = default;
+        Lease& operator=(Lease&&) = default;
+        ~Lease() {
+            if (fIterator) {
+                SkIcuBreakIteratorCache::get().giveBack(std::move(fKey), std::move(fIterator));
+            }
+        }
+
+        UBreakIterator* get() const { return fIterator.get(); }
+        explicit operator bool() const { return fIterator != nullptr; }
+
+    private:
+        friend class SkIcuBreakIteratorCache;
+        Lease(Key key, ICUBreakIterator iterator)
+                : fKey(std::move(key)), fIterator(std::move(iterator)) {}
+
+        Key fKey;
+        ICUBreakIterator fIterator;
+    };
+
+    // A null locale is the default locale.
+    Lease makeBreakIterator(SkUnicode::BreakType type, const char* locale = nullptr) {
+        Key key{type, SkString(locale ? locale : sk_uloc_getDefault())};
+        UErrorCode status = U_ZERO_ERROR;
+        SkAutoMutexExclusive lock(fPoolsMutex);
+        Pool* pool = fPools.find(key);
+        if (!pool) {
+            ICUBreakIterator prototype(sk_ubrk_open(convertType(type), key.fLocale.c_str(),
+                                                    nullptr, 0, &status));
+            if (U_FAILURE(status)) {
+                SkDEBUGF("Break error: %s", sk_u_errorName(status));
+                return Lease();
+            }
+            pool = fPools.insert(key, Pool{std::move(prototype), {}});
+        }
+        if (!pool->fIdle.empty()) {
+            ICUBreakIterator iterator = std::move(pool->fIdle.back());
+            pool->fIdle.pop_back();
+            return Lease(std::move(key), std::move(iterator));
+        }
+        ICUBreakIterator iterator(sk_ubrk_clone(pool->fPrototype.get(), &status));
+        if (U_FAILURE(status)) {
+            SkDEBUGF("Break error: %s", sk_u_errorName(status));
+            return Lease();
+        }
+        return Lease(std::move(key), std::move(iterator));
+    }
+
+private:
+    void giveBack(Key key, ICUBreakIterator iterator) {
+        SkAutoMutexExclusive lock(fPoolsMutex);
+        Pool* pool = fPools.find(key);
+        if (pool && pool->fIdle.size() < kMaxIdlePerPool) {
+            // The iterator still points at the text it was last given, which every user
+            // replaces before breaking.
+            pool->fIdle.push_back(std::move(iterator));
+        }
+    }
+};
+
 class SkBreakIterator_icu : public SkBreakIterator {
-    ICUBreakIterator fBreakIterator;
+    SkIcuBreakIteratorCache::Lease fBreakIterator;
     Position fLastResult;
  public:
-    explicit SkBreakIterator_icu(ICUBreakIterator iter)
+    explicit SkBreakIterator_icu(SkIcuBreakIteratorCache::Lease iter)
             : fBreakIterator(std::move(iter))
             , fLastResult(0) {}
     Position first() override { return fLastResult = sk_ubrk_first(fBreakIterator.get()); }
@@ -163,43 +265,6 @@ class SkBreakIterator_icu : public SkBreakIterator {
     }
 };
 
-class SkIcuBreakIteratorCache {
-    THashMap<SkUnicode::BreakType, ICUBreakIterator> fBreakCache;
-    SkMutex fBreakCacheMutex;
-
- public:
-    static SkIcuBreakIteratorCache& get() {
-        static SkIcuBreakIteratorCache instance;
-        return instance;
-    }
-
-    ICUBreakIterator makeBreakIterator(SkUnicode::BreakType type) {
-        UErrorCode status = U_ZERO_ERROR;
-        ICUBreakIterator* cachedIterator;
-        {
-            SkAutoMutexExclusive lock(fBreakCacheMutex);
-            cachedIterator = fBreakCache.find(type);
-            if (!cachedIterator) {
-                ICUBreakIterator newIterator(sk_ubrk_open(convertType(type), sk_uloc_getDefault(),
-                                                          nullptr, 0, &status));
-                if (U_FAILURE(status)) {
-                    SkDEBUGF("Break error: %s", sk_u_errorName(status));
-                } else {
-                    cachedIterator = fBreakCache.set(type, std::move(newIterator));
-                }
-            }
-        }
-        ICUBreakIterator iterator;
-        if (cachedIterator) {
-            iterator.reset(sk_ubrk_clone(cachedIterator->get(), &status));
-            if (U_FAILURE(status)) {
-                SkDEBUGF("Break error: %s", sk_u_errorName(status));
-            }
-        }
-        return iterator;
-    }
-};
-
 class SkUnicode_icu : public SkUnicode {
 
     std::unique_ptr<SkUnicode> copy() override {
@@ -210,7 +275,7 @@ class SkUnicode_icu : public SkUnicode {
 
         UErrorCode status = U_ZERO_ERROR;
 
-        ICUBreakIterator iterator = SkIcuBreakIteratorCache::get().makeBreakIterator(BreakType::kWords);
+        auto iterator = SkIcuBreakIteratorCache::get().makeBreakIterator(BreakType::kWords, locale);
         if (!iterator) {
             SkDEBUGF("Break error: %s", sk_u_errorName(status));
             return false;
@@ -251,7 +316,7 @@ class SkUnicode_icu : public SkUnicode {
         }
         SkASSERT(text);
 
-        ICUBreakIterator iterator = SkIcuBreakIteratorCache::get().makeBreakIterator(type);
+        auto iterator = SkIcuBreakIteratorCache::get().makeBreakIterator(type);
         if (!iterator) {
             return false;
         }
@@ -323,11 +388,8 @@ public:
     }
     std::unique_ptr<SkBreakIterator> makeBreakIterator(const char locale[],
                                                        BreakType breakType) override {
-        UErrorCode status = U_ZERO_ERROR;
-        ICUBreakIterator iterator(sk_ubrk_open(convertType(breakType), locale, nullptr, 0,
-                                               &status));
-        if (U_FAILURE(status)) {
-            SkDEBUGF("Break error: %s", sk_u_errorName(status));
+        auto iterator = SkIcuBreakIteratorCache::get().makeBreakIterator(breakType, locale);
+        if (!iterator) {
             return nullptr;
         }
         return std::unique_ptr<SkBreakIterator>(new SkBreakIterator_icu(std::move(iterator)));
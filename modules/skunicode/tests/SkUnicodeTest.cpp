@@ -13,6 +13,8 @@
 #include "modules/skunicode/include/SkUnicode.h"
 #include "tests/Test.h"
 
+#include <cstring>
+#include <memory>
 #include <vector>
 
 using namespace skia_private;
@@ -199,3 +201,148 @@ UNIX_ONLY_TEST(SkUnicode_ReorderVisual, reporter) {
     reorder({1}, {0});
     reorder({0, 1, 0, 1}, {0, 1, 2, 3});
 }
+
+UNIX_ONLY_TEST(SkUnicode_BreakIteratorLocales, reporter) {
+    auto icu = SkUnicode::Make();
+    const char text[] = "one two three";
+    const std::vector<SkUnicode::Position> expected = {0, 3, 4, 7, 8, 13};
+    // More locales than the break iterators are kept for, and then the first one again.
+    const char* locales[] = {"en", "de", "fr", "es", "it", "pt", "nl", "sv", "da", "nb", "fi",
+                             "pl", "cs", "hu", "ro", "tr", "el", "ru", "uk", "en"};
+    for (const char* locale : locales) {
+        // Two at a time, so that one is cloned while the other is in use.
+        auto first = icu->makeBreakIterator(locale, SkUnicode::BreakType::kWords);
+        auto second = icu->makeBreakIterator(locale, SkUnicode::BreakType::kWords);
+        REPORTER_ASSERT(reporter, first && second);
+        if (!first || !second) {
+            return;
+        }
+        for (SkBreakIterator* iter : {first.get(), second.get()}) {
+            REPORTER_ASSERT(reporter, iter->setText(text, strlen(text)));
+            std::vector<SkUnicode::Position> breaks;
+            for (auto pos = iter->first(); !iter->isDone(); pos = iter->next()) {
+                breaks.push_back(pos);
+            }
+            REPORTER_ASSERT(reporter, breaks == expected, "%s", locale);
+        }
+    }
+}
+
+namespace {
+// Counts the analysis calls that reach the wrapped unicode.
+class CountingUnicode : public SkUnicode {
+public:
+    CountingUnicode(std::unique_ptr<SkUnicode> unicode, std::shared_ptr<int> calls)
+            : fUnicode(std::move(unicode)), fCalls(std::move(calls)) {}
+
+    SkString toUpper(const SkString& str) override { return fUnicode->toUpper(str); }
+    std::unique_ptr<SkBidiIterator> makeBidiIterator(const uint16_t text[], int count,
+                                                     SkBidiIterator::Direction dir) override {
+        return fUnicode->makeBidiIterator(text, count, dir);
+    }
+    std::unique_ptr<SkBidiIterator> makeBidiIterator(const char text[], int count,
+                                                     SkBidiIterator::Direction dir) override {
+        return fUnicode->makeBidiIterator(text, count, dir);
+    }
+    std::unique_ptr<SkBreakIterator> makeBreakIterator(const char locale[],
+                                                       BreakType type) override {
+        return fUnicode->makeBreakIterator(locale, type);
+    }
+    std::unique_ptr<SkBreakIterator> makeBreakIterator(BreakType type) override {
+        return fUnicode->makeBreakIterator(type);
+    }
+    bool getBidiRegions(const char utf8[], int utf8Units, TextDirection dir,
+                        std::vector<BidiRegion>* results) override {
+        ++*fCalls;
+        return fUnicode->getBidiRegions(utf8, utf8Units, dir, results);
+    }
+    bool getWords(const char utf8[], int utf8Units, const char* locale,
+                  std::vector<Position>* results) override {
+        ++*fCalls;
+        return fUnicode->getWords(utf8, utf8Units, locale, results);
+    }
+    bool computeCodeUnitFlags(char utf8[], int utf8Units, bool replaceTabs,
+                              TArray<SkUnicode::CodeUnitFlags, true>* results) override {
+        ++*fCalls;
+        return fUnicode->computeCodeUnitFlags(utf8, utf8Units, replaceTabs, results);
+    }
+    bool computeCodeUnitFlags(char16_t utf16[], int utf16Units, bool replaceTabs,
+                              TArray<SkUnicode::CodeUnitFlags, true>* results) override {
+        ++*fCalls;
+        return fUnicode->computeCodeUnitFlags(utf16, utf16Units, replaceTabs, results);
+    }
+    void reorderVisual(const BidiLevel runLevels[], int levelsCount,
+                       int32_t logicalFromVisual[]) override {
+        fUnicode->reorderVisual(runLevels, levelsCount, logicalFromVisual);
+    }
+    std::unique_ptr<SkUnicode> copy() override {
+        return std::make_unique<CountingUnicode>(fUnicode->copy(), fCalls);
+    }
+
+private:
+    std::unique_ptr<SkUnicode> fUnicode;
+    std::shared_ptr<int> fCalls;
+};
+}  // namespace
+
+UNIX_ONLY_TEST(SkUnicode_Cached, reporter) {
+    auto calls = std::make_shared<int>(0);
+    auto cached = SkUnicode::MakeCachedUnicode(
+            std::make_unique<CountingUnicode>(SkUnicode::Make(), calls));
+    auto icu = SkUnicode::Make();
+
+    const SkString original("one\ttwo three\nfour \xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D five");
+    auto check = [&](SkUnicode* unicode, int expectedCalls) {
+        SkString text = original;
+        SkString expectedText = original;
+        TArray<SkUnicode::CodeUnitFlags, true> flags, expectedFlags;
+        REPORTER_ASSERT(reporter, unicode->computeCodeUnitFlags(
+                text.data(), text.size(), /*replaceTabs=*/true, &flags));
+        icu->computeCodeUnitFlags(
+                expectedText.data(), expectedText.size(), /*replaceTabs=*/true, &expectedFlags);
+        REPORTER_ASSERT(reporter, flags.size() == expectedFlags.size());
+        for (int i = 0; i < flags.size() && i < expectedFlags.size(); ++i) {
+            REPORTER_ASSERT(reporter, flags[i] == expectedFlags[i]);
+        }
+        // The tab is replaced whether or not the flags were cached.
+        REPORTER_ASSERT(reporter, text.equals(expectedText));
+
+        std::vector<SkUnicode::BidiRegion> regions, expectedRegions;
+        REPORTER_ASSERT(reporter, unicode->getBidiRegions(
+                original.c_str(), original.size(), SkUnicode::TextDirection::kLTR, &regions));
+        icu->getBidiRegions(original.c_str(), original.size(), SkUnicode::TextDirection::kLTR,
+                            &expectedRegions);
+        REPORTER_ASSERT(reporter, regions.size() == expectedRegions.size());
+        for (size_t i = 0; i < regions.size() && i < expectedRegions.size(); ++i) {
+            REPORTER_ASSERT(reporter, regions[i].start == expectedRegions[i].start);
+            REPORTER_ASSERT(reporter, regions[i].end == expectedRegions[i].end);
+            REPORTER_ASSERT(reporter, regions[i].level == expectedRegions[i].level);
+        }
+
+        std::vector<SkUnicode::Position> words, expectedWords;
+        REPORTER_ASSERT(reporter, unicode->getWords(
+                original.c_str(), original.size(), "en", &words));
+        icu->getWords(original.c_str(), original.size(), "en", &expectedWords);
+        REPORTER_ASSERT(reporter, words == expectedWords);
+
+        REPORTER_ASSERT(reporter, *calls == expectedCalls, "%d != %d", *calls, expectedCalls);
+    };
+
+    check(cached.get(), 3);
+    // The second time and in a copy, the results come from the cache.
+    check(cached.get(), 3);
+    auto copy = cached->copy();
+    check(copy.get(), 3);
+
+    // Other text, options and directions are analyzed.
+    SkString other("other text");
+    TArray<SkUnicode::CodeUnitFlags, true> flags;
+    copy->computeCodeUnitFlags(other.data(), other.size(), /*replaceTabs=*/true, &flags);
+    SkString text = original;
+    copy->computeCodeUnitFlags(text.data(), text.size(), /*replaceTabs=*/false, &flags);
+    REPORTER_ASSERT(reporter, text.equals(original));
+    std::vector<SkUnicode::BidiRegion> regions;
+    copy->getBidiRegions(original.c_str(), original.size(), SkUnicode::TextDirection::kRTL,
+                         &regions);
+    REPORTER_ASSERT(reporter, *calls == 6);
+}
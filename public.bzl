@@ -220,6 +220,7 @@ SKIA_PUBLIC_HDRS = [
     "include/utils/SkPaintFilterCanvas.h",
     "include/utils/SkParse.h",
     "include/utils/SkParsePath.h",
+    "include/utils/SkProfilingCanvas.h",
     "include/utils/SkShadowUtils.h",
     "include/utils/SkTextUtils.h",
     "include/utils/SkTraceEventPhase.h",
@@ -354,6 +355,8 @@ BASE_SRCS_ALL = [
     "src/core/Sk4px.h",
     "src/core/SkAAClip.cpp",
     "src/core/SkAAClip.h",
+    "src/core/SkAAClipCache.cpp",
+    "src/core/SkAAClipCache.h",
     "src/core/SkATrace.cpp",
     "src/core/SkATrace.h",
     "src/core/SkAdvancedTypefaceMetrics.h",
@@ -502,6 +505,8 @@ BASE_SRCS_ALL = [
     "src/core/SkImageInfo.cpp",
     "src/core/SkImageInfoPriv.h",
     "src/core/SkImagePriv.h",
+    "src/core/SkIndexedPicture.cpp",
+    "src/core/SkIndexedPicture.h",
     "src/core/SkLRUCache.h",
     "src/core/SkLatticeIter.cpp",
     "src/core/SkLatticeIter.h",
@@ -568,9 +573,13 @@ BASE_SRCS_ALL = [
     "src/core/SkPicturePlayback.cpp",
     "src/core/SkPicturePlayback.h",
     "src/core/SkPicturePriv.h",
+    "src/core/SkPictureRasterCache.cpp",
+    "src/core/SkPictureRasterCache.h",
     "src/core/SkPictureRecord.cpp",
     "src/core/SkPictureRecord.h",
     "src/core/SkPictureRecorder.cpp",
+    "src/core/SkPictureStream.cpp",
+    "src/core/SkPictureStream.h",
     "src/core/SkPixelRef.cpp",
     "src/core/SkPixelRefPriv.h",
     "src/core/SkPixmap.cpp",
@@ -654,6 +663,8 @@ BASE_SRCS_ALL = [
     "src/core/SkStrike.h",
     "src/core/SkStrikeCache.cpp",
     "src/core/SkStrikeCache.h",
+    "src/core/SkStrikePersistentStore.cpp",
+    "src/core/SkStrikePersistentStore.h",
     "src/core/SkStrikeSpec.cpp",
     "src/core/SkStrikeSpec.h",
     "src/core/SkString.cpp",
@@ -678,6 +689,8 @@ BASE_SRCS_ALL = [
     "src/core/SkTextBlobTrace.cpp",
     "src/core/SkTextBlobTrace.h",
     "src/core/SkTextFormatParams.h",
+    "src/core/SkTileGrid.cpp",
+    "src/core/SkTileGrid.h",
     "src/core/SkTime.cpp",
     "src/core/SkTraceEvent.h",
     "src/core/SkTraceEventCommon.h",
@@ -1732,6 +1745,7 @@ BASE_SRCS_ALL = [
     "src/utils/SkPatchUtils.h",
     "src/utils/SkPolyUtils.cpp",
     "src/utils/SkPolyUtils.h",
+    "src/utils/SkProfilingCanvas.cpp",
     "src/utils/SkShaderUtils.cpp",
     "src/utils/SkShaderUtils.h",
     "src/utils/SkShadowTessellator.cpp",
@@ -2442,6 +2456,7 @@ SKOTTIE_SHAPER_SRCS = [
 # Stubs, pending SkUnicode fission
 SKUNICODE_ICU_BUILTIN_SRCS = [
     "modules/skunicode/src/SkUnicode.cpp",
+    "modules/skunicode/src/SkUnicode_cached.cpp",
     "modules/skunicode/src/SkUnicode_icu.cpp",
     "modules/skunicode/src/SkUnicode_icu.h",
     "modules/skunicode/src/SkUnicode_icu_bidi.cpp",
@@ -2451,6 +2466,7 @@ SKUNICODE_ICU_BUILTIN_SRCS = [
 
 SKUNICODE_ICU_RUNTIME_SRCS = [
     "modules/skunicode/src/SkUnicode.cpp",
+    "modules/skunicode/src/SkUnicode_cached.cpp",
     "modules/skunicode/src/SkUnicode_icu.cpp",
     "modules/skunicode/src/SkUnicode_icu.h",
     "modules/skunicode/src/SkUnicode_icu_bidi.cpp",
@@ -2460,6 +2476,7 @@ SKUNICODE_ICU_RUNTIME_SRCS = [
 
 SKUNICODE_CLIENT_SRCS = [
     "modules/skunicode/src/SkUnicode.cpp",
+    "modules/skunicode/src/SkUnicode_cached.cpp",
     "modules/skunicode/src/SkUnicode_client.cpp",
     "modules/skunicode/src/SkUnicode_icu_bidi.cpp",
     "modules/skunicode/src/SkUnicode_icu_bidi.h",
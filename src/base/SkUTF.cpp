@@ -4,6 +4,7 @@
 #include "src/base/SkUTF.h"
 
 #include "include/private/base/SkTFitsIn.h"
+#include "src/base/SkVx.h"
 
 static constexpr inline int32_t left_shift(int32_t value, int32_t shift) {
     return (int32_t) ((uint32_t) value << shift);
@@ -42,6 +43,14 @@ static bool utf8_type_is_valid_leading_byte(int type) { return type > 0; }
 
 static bool utf8_byte_is_continuation(uint8_t c) { return utf8_byte_type(c) == 0; }
 
+static constexpr int kASCIIRun = 16;
+
+// Returns true if the kASCIIRun bytes at utf8 are all ASCII.
+static bool utf8_is_ascii_run(const char* utf8) {
+    // Compare rather than mask: any() expects lanes that are all zeros or all ones.
+    return !any(skvx::Vec<kASCIIRun, uint8_t>::Load(utf8) >= 0x80);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int SkUTF::CountUTF8(const char* utf8, size_t byteLength) {
@@ -51,6 +60,11 @@ int SkUTF::CountUTF8(const char* utf8, size_t byteLength) {
     int count = 0;
     const char* stop = utf8 + byteLength;
     while (utf8 < stop) {
+        if (stop - utf8 >= kASCIIRun && utf8_is_ascii_run(utf8)) {
+            utf8 += kASCIIRun;
+            count += kASCIIRun;
+            continue;
+        }
         int type = utf8_byte_type(*(const uint8_t*)utf8);
         if (!utf8_type_is_valid_leading_byte(type) || utf8 + type > stop) {
             return -1;  // Sequence extends beyond end.
@@ -283,6 +297,40 @@ int SkUTF::UTF8ToUTF16(uint16_t dst[], int dstCapacity, const char src[], size_t
     return dstLength;
 }
 
+int SkUTF::UTF8ToUTF32(SkUnichar dst[], int dstCapacity, const char src[], size_t srcByteLength) {
+    if (!dst) {
+        dstCapacity = 0;
+    }
+
+    int dstLength = 0;
+    const char* endSrc = src + srcByteLength;
+    while (src < endSrc) {
+        if (endSrc - src >= kASCIIRun && utf8_is_ascii_run(src)) {
+            if (dstCapacity - dstLength >= kASCIIRun) {
+                skvx::cast<int32_t>(skvx::Vec<kASCIIRun, uint8_t>::Load(src))
+                        .store(dst + dstLength);
+            } else {
+                for (int i = 0; i < kASCIIRun && dstLength + i < dstCapacity; ++i) {
+                    dst[dstLength + i] = (uint8_t)src[i];
+                }
+            }
+            src += kASCIIRun;
+            dstLength += kASCIIRun;
+            continue;
+        }
+
+        SkUnichar uni = NextUTF8(&src, endSrc);
+        if (uni < 0) {
+            return -1;
+        }
+        if (dstLength < dstCapacity) {
+            dst[dstLength] = uni;
+        }
+        dstLength += 1;
+    }
+    return dstLength;
+}
+
 int SkUTF::UTF16ToUTF8(char dst[], int dstCapacity, const uint16_t src[], size_t srcLength) {
     if (!dst) {
         dstCapacity = 0;
@@ -1282,6 +1282,13 @@ bool SkAAClip::setRect(const SkIRect& bounds) {
     return true;
 }
 
+size_t SkAAClip::approximateBytesUsed() const {
+    if (this->isEmpty()) {
+        return 0;
+    }
+    return sizeof(RunHead) + fRunHead->fRowCount * sizeof(YOffset) + fRunHead->fDataSize;
+}
+
 bool SkAAClip::isRect() const {
     if (this->isEmpty()) {
         return false;
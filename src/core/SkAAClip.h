@@ -13,6 +13,7 @@
 #include "include/private/base/SkAssert.h"
 #include "src/base/SkAutoMalloc.h"
 #include "src/core/SkBlitter.h"
+#include <cstddef>
 #include <cstdint>
 
 class SkPath;
@@ -35,6 +36,9 @@ public:
     // If true, getBounds() can be used in place of this clip.
     bool isRect() const;
 
+    // Returns the number of bytes held by the clip's (possibly shared) run data.
+    size_t approximateBytesUsed() const;
+
     bool setEmpty();
     bool setRect(const SkIRect&);
     bool setPath(const SkPath&, const SkIRect& bounds, bool doAA = true);
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkAAClipCache.h"
+
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPath.h"
+#include "include/private/SkIDChangeListener.h"
+#include "src/core/SkAAClip.h"
+#include "src/core/SkPathPriv.h"
+#include "src/core/SkResourceCache.h"
+
+#include <utility>
+
+#define CHECK_LOCAL(localCache, localName, globalName, ...) \
+    ((localCache) ? localCache->localName(__VA_ARGS__) : SkResourceCache::globalName(__VA_ARGS__))
+
+namespace {
+static unsigned gAAClipKeyNamespaceLabel;
+
+uint64_t make_shared_id(uint32_t pathGenID) {
+    uint64_t sharedID = SkSetFourByteTag('a', 'a', 'c', 'p');
+    return (sharedID << 32) | pathGenID;
+}
+
+struct AAClipKey : public SkResourceCache::Key {
+public:
+    AAClipKey(const SkPath& path, const SkMatrix& matrix, bool doAA)
+        : fFillTypeAndAA(((int32_t)path.getFillType() << 1) | (doAA ? 1 : 0)) {
+        matrix.get9(fMatrix);
+        this->init(&gAAClipKeyNamespaceLabel, make_shared_id(path.getGenerationID()),
+                   sizeof(fMatrix) + sizeof(fFillTypeAndAA));
+    }
+
+    SkScalar fMatrix[9];
+    int32_t  fFillTypeAndAA;
+};
+
+// Purges the path's entries once it is edited or destroyed, so they don't linger until they age
+// out of the LRU.
+class PathChangeListener : public SkIDChangeListener {
+public:
+    explicit PathChangeListener(uint64_t sharedID) : fSharedID(sharedID) {}
+
+    void changed() override { SkResourceCache::PostPurgeSharedID(fSharedID); }
+
+private:
+    uint64_t fSharedID;
+};
+
+// Returns bounds that hold the path once mapped to device space, or an empty rect if its clip
+// always fills the bounds it is built for (inverse fills).
+SkIRect device_ibounds(const SkPath& path, const SkMatrix& matrix) {
+    if (path.isInverseFillType()) {
+        return SkIRect::MakeEmpty();
+    }
+    return matrix.mapRect(path.getBounds()).roundOut();
+}
+
+struct AAClipRec : public SkResourceCache::Rec {
+    AAClipRec(const AAClipKey& key, const SkIRect& bounds, const SkIRect& pathBounds,
+              const SkAAClip& clip, sk_sp<PathChangeListener> listener)
+        : fKey(key)
+        , fBounds(bounds)
+        , fPathBounds(pathBounds)
+        , fClip(clip)
+        , fListener(std::move(listener)) {}
+
+    ~AAClipRec() override {
+        // The path may outlive us; don't let its listener list grow with dead entries.
+        fListener->markShouldDeregister();
+    }
+
+    AAClipKey                 fKey;
+    SkIRect                   fBounds;      // the bounds passed to setPath()
+    SkIRect                   fPathBounds;  // device bounds of the path, if inside fBounds
+    SkAAClip                  fClip;
+    sk_sp<PathChangeListener> fListener;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fClip.approximateBytesUsed(); }
+    const char* getCategory() const override { return "aaclip"; }
+
+    struct Result {
+        SkIRect   fBounds;
+        SkAAClip* fClip;
+    };
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const AAClipRec& rec = static_cast<const AAClipRec&>(baseRec);
+        Result* result = static_cast<Result*>(contextData);
+        if (rec.fBounds != result->fBounds &&
+            (rec.fPathBounds.isEmpty() || !result->fBounds.contains(rec.fPathBounds))) {
+            // Built for other bounds, so it can't answer this. The caller will replace it.
+            return false;
+        }
+        // This only shares the run data, so it's cheap to do under the cache's lock.
+        *result->fClip = rec.fClip;
+        return true;
+    }
+};
+} // namespace
+
+bool SkAAClipCache::ShouldCache(const SkPath& path, const SkMatrix& matrix) {
+    // Simple shapes (rects, rrects, ovals) are quick to scan convert and are usually rebuilt from
+    // scratch for each draw, so caching them would only churn the cache.
+    static constexpr int kMinVerbsToCache = 16;
+    return !path.isVolatile() && !matrix.hasPerspective() &&
+           path.countVerbs() >= kMinVerbsToCache;
+}
+
+bool SkAAClipCache::Find(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds,
+                         bool doAA, SkAAClip* clip, SkResourceCache* localCache) {
+    AAClipKey key(path, matrix, doAA);
+    AAClipRec::Result result = {bounds, clip};
+    return CHECK_LOCAL(localCache, find, Find, key, AAClipRec::Visitor, &result);
+}
+
+void SkAAClipCache::Add(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds,
+                        bool doAA, const SkAAClip& clip, SkResourceCache* localCache) {
+    AAClipKey key(path, matrix, doAA);
+    SkIRect pathBounds = device_ibounds(path, matrix);
+    if (!bounds.contains(pathBounds)) {
+        pathBounds.setEmpty();
+    }
+    auto listener = sk_make_sp<PathChangeListener>(key.getSharedID());
+    SkPathPriv::AddGenIDChangeListener(path, listener);
+    CHECK_LOCAL(localCache, add, Add,
+                new AAClipRec(key, bounds, pathBounds, clip, std::move(listener)));
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAAClipCache_DEFINED
+#define SkAAClipCache_DEFINED
+
+#include "include/core/SkRect.h"
+
+class SkAAClip;
+class SkMatrix;
+class SkPath;
+class SkResourceCache;
+
+/**
+ *  Caches the SkAAClip built for a path, so that a complex clip that is applied again (on the same
+ *  or another canvas, e.g. every frame) does not have to be scan converted again.
+ *
+ *  Entries are keyed by the path's generation ID, fill type, the matrix that maps it to device
+ *  space and whether it was antialiased. Each entry remembers the device bounds it was built for.
+ *  When those bounds held the whole path, the clip doesn't depend on them, so the entry answers
+ *  any request whose bounds hold the whole path too; e.g. when only the device or the enclosing
+ *  clip rect changes between frames. Otherwise the bounds must match exactly: antialiased scan
+ *  conversion of a path that crosses the clip is not exactly the unclipped result intersected with
+ *  the clip, so we don't derive one from the other.
+ */
+class SkAAClipCache {
+public:
+    /**
+     *  Returns true and sets clip to the result of clip->setPath(path transformed by matrix,
+     *  bounds, doAA), if a suitable entry is found.
+     */
+    static bool Find(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds, bool doAA,
+                     SkAAClip* clip, SkResourceCache* localCache = nullptr);
+
+    /**
+     *  Adds the result of setPath(path transformed by matrix, bounds, doAA) to the cache. The
+     *  entry is purged when the path is modified or deleted.
+     */
+    static void Add(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds, bool doAA,
+                    const SkAAClip& clip, SkResourceCache* localCache = nullptr);
+
+    /**
+     *  Volatile paths, paths that are cheap to rasterize and perspective matrices are not worth
+     *  caching.
+     */
+    static bool ShouldCache(const SkPath& path, const SkMatrix& matrix);
+};
+
+#endif
@@ -9,11 +9,16 @@
 
 #include "include/core/SkRect.h"
 #include "src/core/SkRTree.h"
+#include "src/core/SkTileGrid.h"
 
 sk_sp<SkBBoxHierarchy> SkRTreeFactory::operator()() const {
     return sk_make_sp<SkRTree>();
 }
 
+sk_sp<SkBBoxHierarchy> SkTileGridFactory::operator()() const {
+    return sk_make_sp<SkTileGrid>(fTileSize);
+}
+
 void SkBBoxHierarchy::insert(const SkRect rects[], const Metadata[], int N) {
     // Ignore Metadata.
     this->insert(rects, N);
@@ -361,6 +361,19 @@ void SkBitmapDevice::drawRect(const SkRect& r, const SkPaint& paint) {
     LOOP_TILER( drawRect(r, paint), Bounder(r, paint))
 }
 
+void SkBitmapDevice::drawRects(SkSpan<const SkRect> rects, const SkColor4f colors[],
+                               const SkPaint& paint) {
+    // Only compute the union of the rects if the tiler can use it.
+    SkRect bounds = SkRect::MakeEmpty();
+    if (SkDrawTiler::NeedsTiling(this)) {
+        for (const SkRect& r : rects) {
+            bounds.join(r);
+        }
+    }
+    LOOP_TILER( drawRects(rects.data(), SkToInt(rects.size()), paint, colors),
+                bounds.isEmpty() ? nullptr : Bounder(bounds, paint).bounds())
+}
+
 void SkBitmapDevice::drawOval(const SkRect& oval, const SkPaint& paint) {
     // call the VIRTUAL version, so any subclasses who do handle drawPath aren't
     // required to override drawOval.
@@ -49,6 +49,7 @@
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkMatrixUtils.h"
 #include "src/core/SkPaintPriv.h"
+#include "src/core/SkPictureRasterCache.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkSurfacePriv.h"
 #include "src/core/SkTextBlobPriv.h"
@@ -2049,6 +2050,28 @@ void SkCanvas::onDrawRect(const SkRect& r, const SkPaint& paint) {
     }
 }
 
+// Defined here rather than in SkCanvasPriv.cpp, since it needs AutoLayerForImageFilter.
+void SkCanvasPriv::DrawRects(SkCanvas* canvas, SkSpan<const SkRect> rects,
+                             const SkColor4f colors[], const SkPaint& paint) {
+    if (rects.empty() || (!colors && paint.nothingToDraw())) {
+        return;
+    }
+
+    SkRect bounds = SkRect::MakeEmpty();
+    for (const SkRect& r : rects) {
+        SkASSERT(r.isSorted());
+        bounds.join(r);
+    }
+    if (canvas->internalQuickReject(bounds, paint)) {
+        return;
+    }
+
+    auto layer = canvas->aboutToDraw(canvas, paint, &bounds);
+    if (layer) {
+        canvas->topDevice()->drawRects(rects, colors, layer->paint());
+    }
+}
+
 void SkCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
     const SkRect bounds = SkRect::Make(region.getBounds());
     if (this->internalQuickReject(bounds, paint)) {
@@ -2620,6 +2643,11 @@ void SkCanvas::drawDrawable(SkDrawable* dr, const SkMatrix* matrix) {
 }
 
 void SkCanvas::onDrawDrawable(SkDrawable* dr, const SkMatrix* matrix) {
+#ifndef SK_DISABLE_SKPICTURE
+    if (fProps.isCachePictures() && SkPictureRasterCache::DrawDrawable(this, dr, matrix)) {
+        return;
+    }
+#endif
     // drawable bounds are no longer reliable (e.g. android displaylist)
     // so don't use them for quick-reject
     if (this->predrawNotify()) {
@@ -2798,6 +2826,10 @@ void SkCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
     if (this->internalQuickReject(picture->cullRect(), paint ? *paint : SkPaint{}, matrix)) {
         return;
     }
+    if (fProps.isCachePictures() &&
+        SkPictureRasterCache::DrawPicture(this, picture, matrix, paint)) {
+        return;
+    }
 
     SkAutoCanvasMatrixPaint acmp(this, matrix, paint, picture->cullRect());
     picture->playback(this);
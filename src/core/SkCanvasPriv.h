@@ -9,6 +9,8 @@
 #define SkCanvasPriv_DEFINED
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkSpan.h"
 #include "include/private/base/SkNoncopyable.h"
 
 class SkReadBuffer;
@@ -71,6 +73,13 @@ public:
         return canvas->topDevice();
     }
 
+    // Draws each rect with paint, or with the paint's color replaced by colors[i] if colors is not
+    // null, as one draw on the top device. On raster devices this shares the blitter between the
+    // rects. Note that this bypasses onDrawRect(), so it is only meant for canvases that draw to
+    // their device (e.g. a surface's canvas), not for recorders or other canvas subclasses.
+    static void DrawRects(SkCanvas*, SkSpan<const SkRect> rects, const SkColor4f colors[],
+                          const SkPaint& paint);
+
 #if GR_TEST_UTILS && defined(SK_GANESH)
     static skgpu::ganesh::SurfaceDrawContext* TopDeviceSurfaceDrawContext(SkCanvas*);
     static skgpu::ganesh::SurfaceFillContext* TopDeviceSurfaceFillContext(SkCanvas*);
@@ -120,10 +120,21 @@ void SkBaseDevice::drawRegion(const SkRegion& region, const SkPaint& paint) {
         return this->drawPath(path, paint, true);
     }
 
-    SkRegion::Iterator it(region);
-    while (!it.done()) {
-        this->drawRect(SkRect::Make(it.rect()), paint);
-        it.next();
+    skia_private::STArray<16, SkRect> rects;
+    for (SkRegion::Iterator it(region); !it.done(); it.next()) {
+        rects.push_back(SkRect::Make(it.rect()));
+    }
+    this->drawRects(rects, nullptr, paint);
+}
+
+void SkBaseDevice::drawRects(SkSpan<const SkRect> rects, const SkColor4f colors[],
+                             const SkPaint& paint) {
+    SkPaint rectPaint(paint);
+    for (size_t i = 0; i < rects.size(); ++i) {
+        if (colors) {
+            rectPaint.setColor4f(colors[i]);
+        }
+        this->drawRect(rects[i], rectPaint);
     }
 }
 
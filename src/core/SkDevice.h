@@ -14,6 +14,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkRegion.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkSpan.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/private/base/SkNoncopyable.h"
 #include "include/private/base/SkTArray.h"
@@ -280,6 +281,12 @@ protected:
                             const SkPoint[], const SkPaint& paint) = 0;
     virtual void drawRect(const SkRect& r,
                           const SkPaint& paint) = 0;
+    // Draws each rect with paint, or with the paint's color replaced by colors[i] if colors is
+    // not null. Default impl calls drawRect() for each.
+    virtual void drawRects(SkSpan<const SkRect> rects, const SkColor4f colors[],
+                           const SkPaint& paint);
+    // Default impl calls drawRects() with the region's rects, or drawPath() with its boundary
+    // path if the matrix or paint needs it.
     virtual void drawRegion(const SkRegion& r,
                             const SkPaint& paint);
     virtual void drawOval(const SkRect& oval,
@@ -471,6 +478,7 @@ protected:
 private:
     friend class SkAndroidFrameworkUtils;
     friend class SkCanvas;
+    friend class SkCanvasPriv;
     friend class SkDraw;
     friend class SkDrawBase;
     friend class SkSurface_Raster;
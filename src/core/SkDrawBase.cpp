@@ -249,6 +249,63 @@ void SkDrawBase::drawRect(const SkRect& prePaintRect, const SkPaint& paint,
     }
 }
 
+void SkDrawBase::drawRects(const SkRect rects[], int count, const SkPaint& paint,
+                           const SkColor4f colors[]) const {
+    SkDEBUGCODE(this->validate();)
+
+    if (fRC->isEmpty() || count <= 0) {
+        return;
+    }
+
+    SkPaint rectPaint(paint);
+    const SkMatrix& ctm = fMatrixProvider->localToDevice();
+    SkPoint strokeSize;
+    // For fills, the rect type only depends on the paint and matrix. Anything other than a plain
+    // fill takes the general path for each rect.
+    if (kFill_RectType != ComputeRectType(rects[0], paint, ctm, &strokeSize)) {
+        for (int i = 0; i < count; ++i) {
+            if (colors) {
+                rectPaint.setColor4f(colors[i]);
+            }
+            this->drawRect(rects[i], rectPaint);
+        }
+        return;
+    }
+
+    const SkRasterClip& clip = *fRC;
+    std::optional<SkAutoBlitterChoose> blitter;
+    for (int i = 0; i < count; ++i) {
+        SkASSERT(rects[i].isSorted());
+        if (colors && colors[i] != rectPaint.getColor4f()) {
+            rectPaint.setColor4f(colors[i]);
+            blitter.reset();
+        }
+
+        SkRect devRect;
+        ctm.mapPoints(rect_points(devRect), rect_points(rects[i]), 2);
+        devRect.sort();
+        if (SkPathPriv::TooBigForMath(devRect)) {
+            continue;
+        }
+        if (!SkRectPriv::FitsInFixed(devRect)) {
+            draw_rect_as_path(*this, rects[i], rectPaint, fMatrixProvider);
+            continue;
+        }
+        if (clip.quickReject(devRect.roundOut())) {
+            continue;
+        }
+
+        if (!blitter) {
+            blitter.emplace(*this, fMatrixProvider, rectPaint);
+        }
+        if (rectPaint.isAntiAlias()) {
+            SkScan::AntiFillRect(devRect, clip, blitter->get());
+        } else {
+            SkScan::FillRect(devRect, clip, blitter->get());
+        }
+    }
+}
+
 static SkScalar fast_len(const SkVector& vec) {
     SkScalar x = SkScalarAbs(vec.fX);
     SkScalar y = SkScalarAbs(vec.fY);
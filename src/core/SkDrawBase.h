@@ -9,6 +9,7 @@
 #define SkDrawBase_DEFINED
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -47,6 +48,13 @@ public:
     void    drawRect(const SkRect& rect, const SkPaint& paint) const {
         this->drawRect(rect, paint, nullptr, nullptr);
     }
+    /**
+     *  Draws each rect with paint, or with the paint's color replaced by colors[i] if colors is not
+     *  null. Filled rects that stay rects share one blitter (one per run of equal colors), rather
+     *  than paying for paint analysis and blitter construction per rect.
+     */
+    void    drawRects(const SkRect rects[], int count, const SkPaint&,
+                      const SkColor4f colors[] = nullptr) const;
     void    drawRRect(const SkRRect&, const SkPaint&) const;
     /**
      *  To save on mallocs, we allow a flag that tells us that srcPath is
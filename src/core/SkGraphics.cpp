@@ -84,6 +84,14 @@ void SkGraphics::PurgePinnedFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgePinned();
 }
 
+void SkGraphics::SetFontCacheDirectory(const char* path) {
+    SkStrikeCache::GlobalStrikeCache()->setPersistentStoreDirectory(path);
+}
+
+void SkGraphics::WriteFontCacheToDirectory() {
+    SkStrikeCache::GlobalStrikeCache()->writeToPersistentStore();
+}
+
 static SkGraphics::OpenTypeSVGDecoderFactory gSVGDecoderFactory = nullptr;
 
 SkGraphics::OpenTypeSVGDecoderFactory
@@ -7,12 +7,14 @@
 
 #include "src/core/SkImageFilterCache.h"
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkRefCnt.h"
-#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkOnce.h"
+#include "src/base/SkSharedMutex.h"
 #include "src/base/SkTInternalLList.h"
 #include "src/core/SkChecksum.h"
 #include "src/core/SkSpecialImage.h"
@@ -29,21 +31,37 @@ using namespace skia_private;
 
 namespace {
 
+// The cache is split into shards, selected by key hash, each behind its own reader/writer lock.
+// get() only takes a shard's lock in shared mode: instead of moving the hit to the head of the
+// LRU list (which would need the exclusive lock) it just marks the value as referenced. Those
+// promotions are applied in a batch by the next writer that needs to evict from the shard: a
+// referenced value at the tail gets a second chance at the head instead of being purged.
+// Values are stamped from a cache-wide clock when added or promoted, so each shard's LRU list is
+// ordered by stamp, and eviction always considers the tail with the oldest stamp of any shard.
+// Total size is tracked with an atomic, so set() never serializes on a cache-wide lock.
 class CacheImpl : public SkImageFilterCache {
 public:
     typedef SkImageFilterCacheKey Key;
     CacheImpl(size_t maxBytes) : fMaxBytes(maxBytes), fCurrentBytes(0) { }
     ~CacheImpl() override {
-        fLookup.foreach([&](Value* v) { delete v; });
+        for (Shard& shard : fShards) {
+            shard.fLookup.foreach([&](Value* v) { delete v; });
+        }
     }
     struct Value {
         Value(const Key& key, const skif::FilterResult& image,
               const SkImageFilter* filter)
-            : fKey(key), fImage(image), fFilter(filter) {}
+            : fKey(key), fImage(image), fFilter(filter)
+            , fBytes(image.image() ? image.image()->getSize() : 0)
+            , fReferenced(false) {}
 
         Key fKey;
         skif::FilterResult fImage;
         const SkImageFilter* fFilter;
+        size_t fBytes;
+        uint64_t fStamp = 0;
+        // Set by readers (under the shared lock), consumed by writers (under the exclusive lock).
+        mutable std::atomic<bool> fReferenced;
         static const Key& GetKey(const Value& v) {
             return v.fKey;
         }
@@ -56,13 +74,13 @@ public:
     bool get(const Key& key, skif::FilterResult* result) const override {
         SkASSERT(result);
 
-        SkAutoMutexExclusive mutex(fMutex);
-        if (Value* v = fLookup.find(key)) {
-            if (v != fLRU.head()) {
-                fLRU.remove(v);
-                fLRU.addToHead(v);
+        const Shard& shard = this->shardFor(key);
+        SkAutoSharedMutexShared lock(shard.fLock);
+        if (Value* v = shard.fLookup.find(key)) {
+            // Avoid dirtying the cache line when the value is already marked.
+            if (!v->fReferenced.load(std::memory_order_relaxed)) {
+                v->fReferenced.store(true, std::memory_order_relaxed);
             }
-
             *result = v->fImage;
             return true;
         }
@@ -71,61 +89,163 @@ public:
 
     void set(const Key& key, const SkImageFilter* filter,
              const skif::FilterResult& result) override {
-        SkAutoMutexExclusive mutex(fMutex);
-        if (Value* v = fLookup.find(key)) {
-            this->removeInternal(v);
-        }
-        Value* v = new Value(key, result, filter);
-        fLookup.add(v);
-        fLRU.addToHead(v);
-        fCurrentBytes += result.image() ? result.image()->getSize() : 0;
-        if (auto* values = fImageFilterValues.find(filter)) {
-            values->push_back(v);
-        } else {
-            fImageFilterValues.set(filter, {v});
-        }
-
-        while (fCurrentBytes > fMaxBytes) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            if (tail == v) {
-                break;
+        Shard& shard = this->shardFor(key);
+        uint64_t stamp;
+        {
+            SkAutoSharedMutexExclusive lock(shard.fLock);
+            if (Value* prev = shard.fLookup.find(key)) {
+                this->removeInternal(&shard, prev);
+            }
+            Value* v = new Value(key, result, filter);
+            v->fStamp = stamp = this->nextStamp();
+            shard.fLookup.add(v);
+            shard.fLRU.addToHead(v);
+            UpdateTailStamp(&shard);
+            fCurrentBytes.fetch_add(v->fBytes, std::memory_order_relaxed);
+            if (auto* values = shard.fImageFilterValues.find(filter)) {
+                values->push_back(v);
+            } else {
+                shard.fImageFilterValues.set(filter, {v});
             }
-            this->removeInternal(tail);
         }
+
+        this->purgeAsNeeded(stamp);
     }
 
     void purge() override {
-        SkAutoMutexExclusive mutex(fMutex);
-        while (fCurrentBytes > 0) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            this->removeInternal(tail);
+        for (Shard& shard : fShards) {
+            SkAutoSharedMutexExclusive lock(shard.fLock);
+            while (Value* tail = shard.fLRU.tail()) {
+                this->removeInternal(&shard, tail);
+            }
+            UpdateTailStamp(&shard);
         }
     }
 
     void purgeByImageFilter(const SkImageFilter* filter) override {
-        SkAutoMutexExclusive mutex(fMutex);
-        auto* values = fImageFilterValues.find(filter);
-        if (!values) {
-            return;
-        }
-        for (Value* v : *values) {
-            // We set the filter to be null so that removeInternal() won't delete from values while
-            // we're iterating over it.
-            v->fFilter = nullptr;
-            this->removeInternal(v);
+        for (Shard& shard : fShards) {
+            SkAutoSharedMutexExclusive lock(shard.fLock);
+            auto* values = shard.fImageFilterValues.find(filter);
+            if (!values) {
+                continue;
+            }
+            for (Value* v : *values) {
+                // We set the filter to be null so that removeInternal() won't delete from values
+                // while we're iterating over it.
+                v->fFilter = nullptr;
+                this->removeInternal(&shard, v);
+            }
+            shard.fImageFilterValues.remove(filter);
+            UpdateTailStamp(&shard);
         }
-        fImageFilterValues.remove(filter);
     }
 
-    SkDEBUGCODE(int count() const override { return fLookup.count(); })
+    SkDEBUGCODE(int count() const override {
+        int count = 0;
+        for (const Shard& shard : fShards) {
+            SkAutoSharedMutexShared lock(shard.fLock);
+            count += shard.fLookup.count();
+        }
+        return count;
+    })
 private:
-    void removeInternal(Value* v) {
+    static constexpr int kShardCount = 8;
+
+    struct Shard {
+        SkTDynamicHash<Value, Key>                          fLookup;
+        SkTInternalLList<Value>                             fLRU;
+        // Value* always points to an item in fLookup.
+        THashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
+        mutable SkSharedMutex                               fLock;
+        // The stamp of fLRU's tail (or UINT64_MAX if empty), so that eviction can pick the shard
+        // with the oldest value without taking every shard's lock. Written under fLock.
+        std::atomic<uint64_t>                               fTailStamp{UINT64_MAX};
+    };
+
+    static int shardIndex(const Key& key) {
+        // The lookup tables index by the low bits of the hash; mix them so that the values of a
+        // shard still spread over all of its table.
+        return SkChecksum::Mix(Value::Hash(key)) % kShardCount;
+    }
+    Shard& shardFor(const Key& key) { return fShards[shardIndex(key)]; }
+    const Shard& shardFor(const Key& key) const { return fShards[shardIndex(key)]; }
+
+    bool overBudget() const {
+        return fCurrentBytes.load(std::memory_order_relaxed) > fMaxBytes;
+    }
+
+    uint64_t nextStamp() { return fClock.fetch_add(1, std::memory_order_relaxed); }
+
+    // Must hold the shard's exclusive lock.
+    static void UpdateTailStamp(Shard* shard) {
+        const Value* tail = shard->fLRU.tail();
+        shard->fTailStamp.store(tail ? tail->fStamp : UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    // Evicts the globally oldest values until the cache is within budget, taking one shard lock
+    // at a time. The value stamped keepStamp, which the caller just added, is identified by its
+    // stamp rather than its address since another writer may free it once its shard is unlocked.
+    // It goes back to the head when it is the oldest, unless it is all that is left. Other values
+    // referenced since they were stamped get a second chance at the head, but only once per purge:
+    // values stamped since the purge started are evicted whether or not they are referenced, so
+    // readers can't keep the cache over budget.
+    void purgeAsNeeded(uint64_t keepStamp) {
+        const uint64_t purgeStart = fClock.load(std::memory_order_relaxed);
+        while (this->overBudget()) {
+            Shard* victim = nullptr;
+            uint64_t oldest = UINT64_MAX;
+            int nonEmptyShards = 0;
+            for (Shard& shard : fShards) {
+                const uint64_t stamp = shard.fTailStamp.load(std::memory_order_relaxed);
+                if (stamp != UINT64_MAX) {
+                    ++nonEmptyShards;
+                }
+                if (stamp < oldest) {
+                    oldest = stamp;
+                    victim = &shard;
+                }
+            }
+            if (!victim) {
+                return;
+            }
+
+            SkAutoSharedMutexExclusive lock(victim->fLock);
+            // Another writer may have changed the tail since we looked; it is still this shard's
+            // oldest value, which is good enough.
+            Value* tail = victim->fLRU.tail();
+            if (!tail) {
+                continue;
+            }
+            if (tail->fStamp == keepStamp) {
+                if (nonEmptyShards == 1 && tail == victim->fLRU.head()) {
+                    // Nothing else is left to purge.
+                    return;
+                }
+                keepStamp = this->promote(victim, tail);
+            } else if (tail->fStamp < purgeStart &&
+                       tail->fReferenced.exchange(false, std::memory_order_relaxed)) {
+                // Apply the deferred LRU promotion.
+                this->promote(victim, tail);
+            } else {
+                this->removeInternal(victim, tail);
+            }
+            UpdateTailStamp(victim);
+        }
+    }
+
+    // Must hold the shard's exclusive lock. Returns the value's new stamp.
+    uint64_t promote(Shard* shard, Value* v) {
+        v->fStamp = this->nextStamp();
+        shard->fLRU.remove(v);
+        shard->fLRU.addToHead(v);
+        return v->fStamp;
+    }
+
+    void removeInternal(Shard* shard, Value* v) {
         if (v->fFilter) {
-            if (auto* values = fImageFilterValues.find(v->fFilter)) {
+            if (auto* values = shard->fImageFilterValues.find(v->fFilter)) {
                 if (values->size() == 1 && (*values)[0] == v) {
-                    fImageFilterValues.remove(v->fFilter);
+                    shard->fImageFilterValues.remove(v->fFilter);
                 } else {
                     for (auto it = values->begin(); it != values->end(); ++it) {
                         if (*it == v) {
@@ -136,19 +256,16 @@ private:
                 }
             }
         }
-        fCurrentBytes -= v->fImage.image() ? v->fImage.image()->getSize() : 0;
-        fLRU.remove(v);
-        fLookup.remove(v->fKey);
+        fCurrentBytes.fetch_sub(v->fBytes, std::memory_order_relaxed);
+        shard->fLRU.remove(v);
+        shard->fLookup.remove(v->fKey);
         delete v;
     }
 private:
-    SkTDynamicHash<Value, Key>                          fLookup;
-    mutable SkTInternalLList<Value>                     fLRU;
-    // Value* always points to an item in fLookup.
-    THashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
+    Shard                                               fShards[kShardCount];
     size_t                                              fMaxBytes;
-    size_t                                              fCurrentBytes;
-    mutable SkMutex                                     fMutex;
+    std::atomic<size_t>                                 fCurrentBytes;
+    std::atomic<uint64_t>                               fClock{0};
 };
 
 } // namespace
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkIndexedPicture.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkStream.h"
+#include "include/private/base/SkAlign.h"
+#include "include/private/base/SkFloatBits.h"
+#include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPictureFlat.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkPtrRecorder.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkVerticesPriv.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[] = {'s', 'k', 'i', 'a', 'i', 'd', 'x', 'p'};
+constexpr uint32_t kTrailerTag = SkSetFourByteTag('i', 'd', 'x', 'p');
+
+struct Header {
+    char     fMagic[8];
+    uint32_t fVersion;
+    uint32_t fReserved;
+};
+
+struct Trailer {
+    uint32_t fTableOffset;
+    uint32_t fFactoriesOffset;
+    uint32_t fTypefacesOffset;
+    uint32_t fTag;
+};
+
+enum ResourceType {
+    kPaints,
+    kPaths,
+    kImages,
+    kTextBlobs,
+    kVertices,
+    kPictures,
+
+    kResourceTypeCount
+};
+
+using OpBounds = SkPicturePlayback::OpBounds;
+static_assert(sizeof(OpBounds) == 20, "OpBounds are written as they are in memory.");
+
+}  // namespace
+
+struct SkIndexedPicture::Table {
+    SkRect   fCullRect;
+    uint32_t fOpCount;
+    uint32_t fNestedOpCount;
+    uint32_t fOpsOffset;
+    uint32_t fOpsSize;
+    uint32_t fOpBoundsOffset;
+    uint32_t fOpBoundsCount;
+    // Each type of resource has an array of count + 1 offsets, the i-th resource being between
+    // the i-th and the next. Nested pictures instead have an array of the offsets of their
+    // tables, which come before this one.
+    struct {
+        uint32_t fOffset;
+        uint32_t fCount;
+    } fResources[kResourceTypeCount];
+};
+
+struct SkIndexedPicture::File : public SkNVRefCnt<File> {
+    sk_sp<SkData> fData;
+    SkDeserialProcs fProcs;
+    uint32_t fVersion;
+    // Holds the factories and typefaces, which are shared by all the pictures.
+    std::unique_ptr<SkPictureData> fShared;
+
+    // Returns the count integers at offset, or nullptr if they aren't all in the data.
+    const uint32_t* u32s(uint32_t offset, size_t count) const {
+        if (!SkIsAlign4(offset) || offset > fData->size() ||
+            (fData->size() - offset) / sizeof(uint32_t) < count) {
+            return nullptr;
+        }
+        return reinterpret_cast<const uint32_t*>(fData->bytes() + offset);
+    }
+
+    bool readTable(uint32_t offset, Table* table) const {
+        static_assert(sizeof(Table) == (10 + 2 * kResourceTypeCount) * sizeof(uint32_t),
+                      "Tables are written as they are in memory, without padding.");
+        const uint32_t* words = this->u32s(offset, sizeof(Table) / sizeof(uint32_t));
+        if (!words) {
+            return false;
+        }
+        // The SkRect makes the table non-trivial, so it's read a field at a time.
+        auto next = [&words] { return *words++; };
+        auto nextFloat = [&next] { return SkBits2Float(next()); };
+        table->fCullRect = {nextFloat(), nextFloat(), nextFloat(), nextFloat()};
+        table->fOpCount = next();
+        table->fNestedOpCount = next();
+        table->fOpsOffset = next();
+        table->fOpsSize = next();
+        table->fOpBoundsOffset = next();
+        table->fOpBoundsCount = next();
+        for (auto& resources : table->fResources) {
+            resources.fOffset = next();
+            resources.fCount = next();
+        }
+
+        if (!table->fCullRect.isFinite() ||
+            !SkTFitsIn<int>(table->fOpCount) || !SkTFitsIn<int>(table->fNestedOpCount) ||
+            !this->u32s(table->fOpsOffset, table->fOpsSize / sizeof(uint32_t)) ||
+            !SkIsAlign4(table->fOpsSize) ||
+            !this->u32s(table->fOpBoundsOffset,
+                        (size_t)table->fOpBoundsCount * (sizeof(OpBounds) / sizeof(uint32_t)))) {
+            return false;
+        }
+        for (int type = 0; type < kResourceTypeCount; ++type) {
+            const uint32_t count = table->fResources[type].fCount;
+            if (!SkTFitsIn<int>(count) ||
+                !this->u32s(table->fResources[type].fOffset,
+                            type == kPictures ? count : (size_t)count + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setupBuffer(SkReadBuffer* buffer) const {
+        buffer->setVersion(fVersion);
+        buffer->setDeserialProcs(fProcs);
+        if (fShared->fFactoryPlayback) {
+            fShared->fFactoryPlayback->setupBuffer(*buffer);
+        }
+        fShared->fTFPlayback.setupBuffer(*buffer);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkIndexedPicture::Resources::Resources(sk_sp<const File> file, uint32_t tableOffset)
+        : fFile(std::move(file)), fTableOffset(tableOffset) {
+    Table table;
+    SkAssertResult(fFile->readTable(tableOffset, &table));
+
+    auto init = [&](auto* array, ResourceType type) {
+        using T = std::remove_reference_t<decltype(array->fValues[0])>;
+        array->fOffsets = fFile->u32s(table.fResources[type].fOffset, 0);
+        array->fCount = SkToInt(table.fResources[type].fCount);
+        array->fOnce = std::make_unique<SkOnce[]>(array->fCount);
+        array->fValues = std::make_unique<T[]>(array->fCount);
+    };
+    init(&fPaints, kPaints);
+    init(&fPaths, kPaths);
+    init(&fImages, kImages);
+    init(&fPictures, kPictures);
+    init(&fTextBlobs, kTextBlobs);
+    init(&fVertices, kVertices);
+}
+
+SkIndexedPicture::Resources::~Resources() = default;
+
+template <typename T, typename Read>
+const T* SkIndexedPicture::Resources::get(SkReadBuffer* reader, const Array<T>& array,
+                                          int index, Read&& read) const {
+    if (!reader->validateIndex(index, array.fCount)) {
+        return nullptr;
+    }
+    array.fOnce[index]([&] {
+        const uint32_t start = array.fOffsets[index],
+                       end   = array.fOffsets[index + 1];
+        if (start > end || !SkIsAlign4(end - start) ||
+            !fFile->u32s(start, (end - start) / sizeof(uint32_t))) {
+            return;
+        }
+        SkReadBuffer buffer(fFile->fData->bytes() + start, end - start);
+        fFile->setupBuffer(&buffer);
+        array.fValues[index] = read(buffer);
+        if (!buffer.isValid()) {
+            array.fValues[index] = T();
+        }
+    });
+    return &array.fValues[index];
+}
+
+// Paints, paths, pictures, text blobs and vertices are numbered from 1, images from 0.
+
+const SkPaint* SkIndexedPicture::Resources::paint(SkReadBuffer* reader, int index) const {
+    return this->get(reader, fPaints, index - 1, [](SkReadBuffer& buffer) {
+        return buffer.readPaint();
+    });
+}
+
+const SkPath* SkIndexedPicture::Resources::path(SkReadBuffer* reader, int index) const {
+    return this->get(reader, fPaths, index - 1, [](SkReadBuffer& buffer) {
+        SkPath path;
+        buffer.readPath(&path);
+        path.updateBoundsCache();
+        return path;
+    });
+}
+
+const SkImage* SkIndexedPicture::Resources::image(SkReadBuffer* reader, int index) const {
+    const sk_sp<SkImage>* image = this->get(reader, fImages, index, [](SkReadBuffer& buffer) {
+        return buffer.readImage();
+    });
+    return image ? image->get() : nullptr;
+}
+
+const SkPicture* SkIndexedPicture::Resources::picture(SkReadBuffer* reader, int index) const {
+    index -= 1;
+    if (!reader->validateIndex(index, fPictures.fCount)) {
+        return nullptr;
+    }
+    fPictures.fOnce[index]([&] {
+        // Tables only refer to those before them, so nested pictures can't draw themselves.
+        const uint32_t tableOffset = fPictures.fOffsets[index];
+        if (tableOffset < fTableOffset) {
+            fPictures.fValues[index] = MakeFromTable(fFile, tableOffset);
+        }
+    });
+    return fPictures.fValues[index].get();
+}
+
+const SkTextBlob* SkIndexedPicture::Resources::textBlob(SkReadBuffer* reader, int index) const {
+    const sk_sp<SkTextBlob>* blob = this->get(reader, fTextBlobs, index - 1,
+                                              [](SkReadBuffer& buffer) {
+        return SkTextBlobPriv::MakeFromBuffer(buffer);
+    });
+    return blob ? blob->get() : nullptr;
+}
+
+const SkVertices* SkIndexedPicture::Resources::vertices(SkReadBuffer* reader, int index) const {
+    const sk_sp<SkVertices>* vertices = this->get(reader, fVertices, index - 1,
+                                                  [](SkReadBuffer& buffer) {
+        return SkVerticesPriv::Decode(buffer);
+    });
+    return vertices ? vertices->get() : nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkIndexedPicture::SkIndexedPicture(sk_sp<const File> file, uint32_t tableOffset,
+                                   const Table& table)
+        : fFile(std::move(file))
+        , fTableOffset(tableOffset)
+        , fCullRect(table.fCullRect)
+        , fOpCount(SkToInt(table.fOpCount))
+        , fNestedOpCount(SkToInt(table.fNestedOpCount))
+        , fOpBytes(table.fOpsSize) {}
+
+SkIndexedPicture::~SkIndexedPicture() = default;
+
+sk_sp<SkPicture> SkIndexedPicture::MakeFromTable(sk_sp<const File> file, uint32_t tableOffset) {
+    Table table;
+    if (!file->readTable(tableOffset, &table)) {
+        return nullptr;
+    }
+    return sk_sp<SkPicture>(new SkIndexedPicture(std::move(file), tableOffset, table));
+}
+
+sk_sp<SkPicture> SkIndexedPicture::Make(sk_sp<SkData> data, const SkDeserialProcs& procs) {
+    if (!data || data->size() < sizeof(Header) + sizeof(Trailer) ||
+        !SkTFitsIn<uint32_t>(data->size()) || !SkIsAlign4(data->size()) ||
+        !SkIsAlign4(reinterpret_cast<uintptr_t>(data->data()))) {
+        return nullptr;
+    }
+    Header header;
+    Trailer trailer;
+    memcpy(&header, data->bytes(), sizeof(Header));
+    memcpy(&trailer, data->bytes() + data->size() - sizeof(Trailer), sizeof(Trailer));
+    if (0 != memcmp(header.fMagic, kMagic, sizeof(kMagic)) ||
+        header.fVersion < SkPicturePriv::kMin_Version ||
+        header.fVersion > SkPicturePriv::kCurrent_Version ||
+        trailer.fTag != kTrailerTag) {
+        return nullptr;
+    }
+
+    sk_sp<File> file = sk_make_sp<File>();
+    file->fData = std::move(data);
+    file->fProcs = procs;
+    file->fVersion = header.fVersion;
+
+    SkPictInfo info;
+    info.setVersion(header.fVersion);
+    file->fShared.reset(new SkPictureData(info));
+
+    // The factories and typefaces are written as they are in an SKP.
+    const size_t end = file->fData->size() - sizeof(Trailer);
+    const std::pair<uint32_t, uint32_t> sections[] = {
+        {SK_PICT_FACTORY_TAG,  trailer.fFactoriesOffset},
+        {SK_PICT_TYPEFACE_TAG, trailer.fTypefacesOffset},
+    };
+    for (auto [expectedTag, offset] : sections) {
+        if (offset > end) {
+            return nullptr;
+        }
+        SkMemoryStream stream(file->fData->bytes() + offset, end - offset, /*copyData=*/false);
+        uint32_t tag, size;
+        if (!stream.readU32(&tag) || tag != expectedTag || !stream.readU32(&size) ||
+            !file->fShared->parseStreamTag(&stream, tag, size, procs, nullptr, 0)) {
+            return nullptr;
+        }
+    }
+
+    return MakeFromTable(std::move(file), trailer.fTableOffset);
+}
+
+void SkIndexedPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    fDataOnce([this] {
+        Table table;
+        SkAssertResult(fFile->readTable(fTableOffset, &table));
+
+        SkPictInfo info;
+        info.setVersion(fFile->fVersion);
+        info.fCullRect = fCullRect;
+        fData.reset(new SkPictureData(info));
+        fData->fOpData = SkData::MakeSubset(fFile->fData.get(), table.fOpsOffset, table.fOpsSize);
+        fData->fLazy = std::make_unique<Resources>(fFile, fTableOffset);
+
+        fOpBounds = {reinterpret_cast<const OpBounds*>(fFile->fData->bytes() +
+                                                       table.fOpBoundsOffset),
+                     table.fOpBoundsCount};
+    });
+
+    SkPicturePlayback playback(fData.get());
+    playback.setOpBounds(fOpBounds);
+    playback.draw(canvas, callback, nullptr);
+}
+
+int SkIndexedPicture::approximateOpCount(bool nested) const {
+    return nested ? fNestedOpCount : fOpCount;
+}
+
+size_t SkIndexedPicture::approximateBytesUsed() const {
+    return sizeof(*this) + fOpBytes;
+}
+
+SkRect SkIndexedPicture::cullRect() const {
+    return fCullRect;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Finds the bounds of the draw ops of a picture. Its ops are played back into an SkRecord, noting
+// the records each op makes, and an op's bounds are those SkRecordFillBounds finds for them, which
+// are what a BBH would use. Ops that change the canvas state for later ops aren't given bounds,
+// so they're never skipped.
+static std::vector<OpBounds> find_op_bounds(const SkPictureData& data, const SkRect& cullRect,
+                                            int* opCount) {
+    struct Op {
+        uint32_t fOffset;
+        int fRecordsEnd;
+    };
+    // This is called before each op, when the playback knows the offset of the op before it.
+    class OpRecords final : public SkPicture::AbortCallback {
+    public:
+        OpRecords(const SkPicturePlayback* playback, const SkRecord* record)
+                : fPlayback(playback), fRecord(record) {}
+
+        bool abort() override {
+            if (fCount++ > 0) {
+                fOps.push_back({SkToU32(fPlayback->curOpID()), fRecord->count()});
+            }
+            return false;
+        }
+
+        const SkPicturePlayback* fPlayback;
+        const SkRecord* fRecord;
+        std::vector<Op> fOps;  // all but the last op
+        int fCount = 0;
+    };
+
+    SkRecord record;
+    SkRecorder recorder(&record, cullRect);
+    SkPicturePlayback playback(&data);
+    OpRecords opRecords(&playback, &record);
+    playback.draw(&recorder, &opRecords, nullptr);
+    *opCount = opRecords.fCount;
+
+    bool resetsClip = false;
+    for (int i = 0; i < record.count(); ++i) {
+        resetsClip |= record.visit(i, [](const auto& r) {
+            return std::decay_t<decltype(r)>::kType == SkRecords::ResetClip_Type;
+        });
+    }
+    if (resetsClip) {
+        // The clip when the picture is drawn doesn't bound what comes after resetting it.
+        return {};
+    }
+
+    std::vector<SkRect> bounds(record.count());
+    std::vector<SkBBoxHierarchy::Metadata> meta(record.count());
+    SkRecordFillBounds(cullRect, record, bounds.data(), meta.data());
+
+    std::vector<OpBounds> opBounds;
+    int begin = 0;
+    for (const Op& op : opRecords.fOps) {
+        // An op can be skipped if it only draws, or saves, draws and restores.
+        bool onlyDraws = op.fRecordsEnd > begin;
+        int saveDepth = 0;
+        SkRect unionBounds = SkRect::MakeEmpty();
+        for (int i = begin; i < op.fRecordsEnd && onlyDraws; ++i) {
+            record.visit(i, [&](const auto& r) {
+                using T = std::decay_t<decltype(r)>;
+                if (T::kType == SkRecords::Save_Type || T::kType == SkRecords::SaveLayer_Type ||
+                    T::kType == SkRecords::SaveBehind_Type) {
+                    saveDepth++;
+                } else if (T::kType == SkRecords::Restore_Type) {
+                    onlyDraws &= --saveDepth >= 0;
+                } else if (!(T::kTags & SkRecords::kDraw_Tag)) {
+                    onlyDraws &= saveDepth > 0;
+                }
+            });
+            unionBounds.join(bounds[i]);
+        }
+        if (onlyDraws && saveDepth == 0) {
+            opBounds.push_back({op.fOffset, unionBounds});
+        }
+        begin = op.fRecordsEnd;
+    }
+    return opBounds;
+}
+
+class SkIndexedPicture::Writer {
+public:
+    explicit Writer(const SkSerialProcs& procs) : fProcs(procs), fBufferProcs(procs) {
+        // Like SkPictureData::serialize(), resources refer to typefaces by index, and the
+        // typeface proc is only used when the typefaces are written.
+        fBufferProcs.fTypefaceProc = nullptr;
+        fBufferProcs.fTypefaceCtx = nullptr;
+    }
+
+    sk_sp<SkData> write(const SkPicture& picture) {
+        Header header;
+        memcpy(header.fMagic, kMagic, sizeof(kMagic));
+        header.fVersion = SkPicturePriv::kCurrent_Version;
+        header.fReserved = 0;
+        fStream.write(&header, sizeof(header));
+
+        Trailer trailer;
+        int nestedOpCount;
+        trailer.fTableOffset = this->writePicture(picture, &nestedOpCount);
+        trailer.fFactoriesOffset = this->offset();
+        SkPictureData::WriteFactories(&fStream, *fFactories);
+        this->pad();
+        trailer.fTypefacesOffset = this->offset();
+        SkPictureData::WriteTypefaces(&fStream, *fTypefaces, fProcs);
+        this->pad();
+        trailer.fTag = kTrailerTag;
+        fStream.write(&trailer, sizeof(trailer));
+
+        if (!SkTFitsIn<uint32_t>(fStream.bytesWritten())) {
+            return nullptr;
+        }
+        return fStream.detachAsData();
+    }
+
+private:
+    uint32_t offset() const { return static_cast<uint32_t>(fStream.bytesWritten()); }
+
+    void pad() {
+        static constexpr uint32_t kZero = 0;
+        fStream.write(&kZero, SkAlign4(fStream.bytesWritten()) - fStream.bytesWritten());
+    }
+
+    // Writes each resource to its own buffer, and returns the array of their offsets.
+    template <typename T, typename Write>
+    void writeResources(const skia_private::TArray<T>& resources, Write&& write,
+                        Table* table, ResourceType type) {
+        std::vector<uint32_t> offsets;
+        for (const T& resource : resources) {
+            offsets.push_back(this->offset());
+            SkBinaryWriteBuffer buffer;
+            buffer.setSerialProcs(fBufferProcs);
+            buffer.setFactoryRecorder(fFactories);
+            buffer.setTypefaceRecorder(fTypefaces);
+            write(buffer, resource);
+            buffer.writeToStream(&fStream);
+        }
+        offsets.push_back(this->offset());
+
+        table->fResources[type] = {this->offset(), SkToU32(resources.size())};
+        fStream.write(offsets.data(), offsets.size() * sizeof(uint32_t));
+    }
+
+    uint32_t writePicture(const SkPicture& picture, int* nestedOpCount) {
+        std::unique_ptr<SkPictureData> data(picture.backport());
+        Table table{};
+        table.fCullRect = picture.cullRect();
+
+        // Nested pictures are written first, so tables only refer to those before them.
+        std::vector<uint32_t> pictureTables;
+        int opCountOfNested = 0;
+        for (const sk_sp<const SkPicture>& nested : data->fPictures) {
+            int count;
+            pictureTables.push_back(this->writePicture(*nested, &count));
+            opCountOfNested += count;
+        }
+
+        table.fOpsOffset = this->offset();
+        table.fOpsSize = SkToU32(data->opData()->size());
+        fStream.write(data->opData()->data(), data->opData()->size());
+        this->pad();
+
+        writeResources(data->fPaints, [](SkWriteBuffer& buffer, const SkPaint& paint) {
+            buffer.writePaint(paint);
+        }, &table, kPaints);
+        writeResources(data->fPaths, [](SkWriteBuffer& buffer, const SkPath& path) {
+            buffer.writePath(path);
+        }, &table, kPaths);
+        writeResources(data->fImages, [](SkWriteBuffer& buffer, const sk_sp<const SkImage>& image) {
+            buffer.writeImage(image.get());
+        }, &table, kImages);
+        writeResources(data->fTextBlobs,
+                       [](SkWriteBuffer& buffer, const sk_sp<const SkTextBlob>& blob) {
+            SkTextBlobPriv::Flatten(*blob, buffer);
+        }, &table, kTextBlobs);
+        writeResources(data->fVertices,
+                       [](SkWriteBuffer& buffer, const sk_sp<const SkVertices>& vertices) {
+            vertices->priv().encode(buffer);
+        }, &table, kVertices);
+
+        table.fResources[kPictures] = {this->offset(), SkToU32(pictureTables.size())};
+        fStream.write(pictureTables.data(), pictureTables.size() * sizeof(uint32_t));
+
+        int opCount;
+        std::vector<OpBounds> opBounds = find_op_bounds(*data, table.fCullRect, &opCount);
+        table.fOpBoundsOffset = this->offset();
+        table.fOpBoundsCount = SkToU32(opBounds.size());
+        fStream.write(opBounds.data(), opBounds.size() * sizeof(OpBounds));
+
+        table.fOpCount = SkToU32(opCount);
+        table.fNestedOpCount = SkToU32(opCount + opCountOfNested);
+        *nestedOpCount = opCount + opCountOfNested;
+
+        const uint32_t tableOffset = this->offset();
+        fStream.write(&table, sizeof(Table));
+        return tableOffset;
+    }
+
+    const SkSerialProcs fProcs;
+    SkSerialProcs fBufferProcs;
+    sk_sp<SkFactorySet> fFactories = sk_make_sp<SkFactorySet>();
+    sk_sp<SkRefCntSet> fTypefaces = sk_make_sp<SkRefCntSet>();
+    SkDynamicMemoryWStream fStream;
+};
+
+sk_sp<SkData> SkIndexedPicture::Serialize(const SkPicture& picture, const SkSerialProcs& procs) {
+    return Writer(procs).write(picture);
+}
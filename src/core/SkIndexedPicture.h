@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkIndexedPicture_DEFINED
+#define SkIndexedPicture_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSpan.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkVertices.h"
+#include "include/private/base/SkOnce.h"
+#include "src/core/SkPicturePlayback.h"
+
+#include <cstdint>
+#include <memory>
+
+class SkCanvas;
+class SkPictureData;
+class SkReadBuffer;
+struct SkDeserialProcs;
+struct SkSerialProcs;
+
+// A picture played back in place from an indexed SKP, usually a mapped file. Unlike an SKP, which
+// is read into an SkRecord when it's made, the indexed format has a table for each picture with
+// the offsets of its ops and of each of its paints, paths, images, text blobs, vertices and
+// nested pictures. Making the picture only reads the table of the top level picture; resources
+// are deserialized the first time an op uses them, and nested pictures are made the first time
+// they're drawn. The table also has the bounds of the draw ops, and those outside of the clip
+// are skipped, so what is read scales with what is drawn.
+//
+// The data is laid out as follows, with every offset from its start and a multiple of 4:
+//   header:  "skiaidxp", picture format version, 0
+//   ops, resources and tables of the nested pictures, then those of the top level picture
+//   factories and typefaces, shared by every picture, as in an SKP
+//   trailer: offsets of the top level table, of the factories and of the typefaces, 'idxp'
+class SkIndexedPicture final : public SkPicture {
+public:
+    static sk_sp<SkData> Serialize(const SkPicture&, const SkSerialProcs&);
+    static sk_sp<SkPicture> Make(sk_sp<SkData>, const SkDeserialProcs&);
+
+    ~SkIndexedPicture() override;
+
+    void playback(SkCanvas*, AbortCallback*) const override;
+    int approximateOpCount(bool nested) const override;
+    size_t approximateBytesUsed() const override;
+    SkRect cullRect() const override;
+
+    struct File;
+
+    // The resources of a picture, read from the file the first time they're asked for. The
+    // indices are those written in the ops, and are checked like SkPictureData checks them.
+    class Resources {
+    public:
+        Resources(sk_sp<const File>, uint32_t tableOffset);
+        ~Resources();
+
+        const SkPaint* paint(SkReadBuffer*, int index) const;
+        const SkPath* path(SkReadBuffer*, int index) const;
+        const SkImage* image(SkReadBuffer*, int index) const;
+        const SkPicture* picture(SkReadBuffer*, int index) const;
+        const SkTextBlob* textBlob(SkReadBuffer*, int index) const;
+        const SkVertices* vertices(SkReadBuffer*, int index) const;
+
+    private:
+        template <typename T>
+        struct Array {
+            const uint32_t* fOffsets = nullptr;
+            int fCount = 0;
+            std::unique_ptr<SkOnce[]> fOnce;
+            std::unique_ptr<T[]> fValues;
+        };
+
+        template <typename T, typename Read>
+        const T* get(SkReadBuffer*, const Array<T>&, int index, Read&&) const;
+
+        const sk_sp<const File> fFile;
+        const uint32_t fTableOffset;
+        Array<SkPaint> fPaints;
+        Array<SkPath> fPaths;
+        Array<sk_sp<SkImage>> fImages;
+        Array<sk_sp<SkPicture>> fPictures;
+        Array<sk_sp<SkTextBlob>> fTextBlobs;
+        Array<sk_sp<SkVertices>> fVertices;
+    };
+
+private:
+    struct Table;
+    class Writer;
+
+    SkIndexedPicture(sk_sp<const File>, uint32_t tableOffset, const Table&);
+
+    static sk_sp<SkPicture> MakeFromTable(sk_sp<const File>, uint32_t tableOffset);
+
+    const sk_sp<const File> fFile;
+    const uint32_t fTableOffset;
+    const SkRect fCullRect;
+    const int fOpCount;
+    const int fNestedOpCount;
+    const size_t fOpBytes;
+
+    // The op data and resources are set up when the picture is first played back.
+    mutable SkOnce fDataOnce;
+    mutable std::unique_ptr<SkPictureData> fData;
+    mutable SkSpan<const SkPicturePlayback::OpBounds> fOpBounds;
+};
+
+#endif
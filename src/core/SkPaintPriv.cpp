@@ -8,6 +8,7 @@
 #include "include/core/SkPaint.h"
 
 #include "src/core/SkBlenderBase.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkPaintPriv.h"
 #include "src/core/SkPicturePriv.h"
@@ -312,3 +313,24 @@ SkPaint SkPaintPriv::Unflatten(SkReadBuffer& buffer) {
     }
     return paint;
 }
+
+uint32_t SkPaintPriv::Hash(const SkPaint& paint) {
+    const void* effects[] = {
+        paint.fPathEffect.get(),
+        paint.fShader.get(),
+        paint.fMaskFilter.get(),
+        paint.fColorFilter.get(),
+        paint.fBlender.get(),
+        paint.fImageFilter.get(),
+    };
+    // -0 and 0 are equal, so they must hash the same. Paints with NaNs are never equal to any,
+    // so those may hash however they do.
+    auto canonical = [](float v) { return v == 0 ? 0.f : v; };
+    const float values[] = {
+        canonical(paint.fColor4f.fR), canonical(paint.fColor4f.fG),
+        canonical(paint.fColor4f.fB), canonical(paint.fColor4f.fA),
+        canonical(paint.fWidth), canonical(paint.fMiterLimit),
+    };
+    uint32_t hash = SkChecksum::Hash32(effects, sizeof(effects), paint.fBitfieldsUInt);
+    return SkChecksum::Hash32(values, sizeof(values), hash);
+}
@@ -51,6 +51,9 @@ public:
     */
     static SkPaint Unflatten(SkReadBuffer& buffer);
 
+    // Hashes the fields compared by operator==, so equal paints have equal hashes.
+    static uint32_t Hash(const SkPaint&);
+
     // If this paint has any color filter, fold it into the shader and/or paint color
     // so that it draws the same but getColorFilter() returns nullptr.
     //
@@ -13,6 +13,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
 #include "src/core/SkCanvasPriv.h"
+#include "src/core/SkIndexedPicture.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
@@ -163,6 +164,11 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit);
 }
 
+sk_sp<SkPicture> SkPicture::MakeFromIndexedData(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs) {
+    return SkIndexedPicture::Make(std::move(data), procs ? *procs : SkDeserialProcs());
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
                                                SkTypefacePlayback* typefaces, int recursionLimit) {
     if (recursionLimit <= 0) {
@@ -250,6 +256,10 @@ sk_sp<SkData> SkPicture::serialize(const SkSerialProcs* procs) const {
     return stream.detachAsData();
 }
 
+sk_sp<SkData> SkPicture::serializeIndexed(const SkSerialProcs* procs) const {
+    return SkIndexedPicture::Serialize(*this, procs ? *procs : SkSerialProcs());
+}
+
 static sk_sp<SkData> custom_serialize(const SkPicture* picture, const SkSerialProcs& procs) {
     if (procs.fPictureProc) {
         auto data = procs.fPictureProc(const_cast<SkPicture*>(picture), procs.fPictureCtx);
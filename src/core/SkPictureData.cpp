@@ -7,6 +7,7 @@
 
 #include "src/core/SkPictureData.h"
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkString.h"
@@ -21,6 +22,7 @@
 #include "src/core/SkPtrRecorder.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTHash.h"
 #include "src/core/SkTextBlobPriv.h"
 #include "src/core/SkVerticesPriv.h"
@@ -71,6 +73,11 @@ SkPictureData::SkPictureData(const SkPictureRecord& record,
     this->initForPlayback();
 }
 
+SkPictureData::~SkPictureData() {
+    // A picture that failed to parse may still be decoding its images.
+    this->finishImageDecodes();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -449,6 +456,36 @@ bool new_array_from_buffer(SkReadBuffer& buffer, uint32_t inCount,
     return true;
 }
 
+// The encoded images are read here, but decoded by the executor while the tags after them and
+// any nested pictures are read. finishImageDecodes() waits for them before the data is used.
+void SkPictureData::startImageDecodes(SkReadBuffer& buffer, uint32_t count, SkExecutor* executor) {
+    if (!buffer.validate(fImages.empty() && fEncodedImages.empty() && SkTFitsIn<int>(count)) ||
+        !buffer.validateCanReadN<uint32_t>(count)) {
+        return;
+    }
+    fEncodedImages.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!buffer.readEncodedImage(&fEncodedImages[i])) {
+            fEncodedImages.clear();
+            return;
+        }
+    }
+    fImages.push_back_n(SkToInt(count));
+
+    fImageDecodes = std::make_unique<SkTaskGroup>(*executor);
+    fImageDecodes->batch(SkToInt(count), [this, procs = buffer.getDeserialProcs()](int i) {
+        fImages[i] = SkReadBuffer::DecodeImage(fEncodedImages[i], procs);
+    });
+}
+
+void SkPictureData::finishImageDecodes() {
+    if (fImageDecodes) {
+        fImageDecodes->wait();
+        fImageDecodes.reset();
+        fEncodedImages.clear();
+    }
+}
+
 void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t size) {
     switch (tag) {
         case SK_PICT_PAINT_BUFFER_TAG: {
@@ -489,7 +526,11 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
             new_array_from_buffer(buffer, size, fVertices, SkVerticesPriv::Decode);
             break;
         case SK_PICT_IMAGE_BUFFER_TAG:
-            new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            if (SkExecutor* executor = buffer.getDeserialProcs().fExecutor) {
+                this->startImageDecodes(buffer, size, executor);
+            } else {
+                new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            }
             break;
         case SK_PICT_READER_TAG: {
             // Preflight check that we can initialize all data from the buffer
@@ -530,6 +571,7 @@ SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
     if (!data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit)) {
         return nullptr;
     }
+    data->finishImageDecodes();
     return data.release();
 }
 
@@ -541,6 +583,7 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
     if (!data->parseBuffer(buffer)) {
         return nullptr;
     }
+    data->finishImageDecodes();
     return data.release();
 }
 
@@ -587,6 +630,9 @@ const SkPaint* SkPictureData::optionalPaint(SkReadBuffer* reader) const {
     if (index == 0) {
         return nullptr; // recorder wrote a zero for no paint (likely drawimage)
     }
+    if (fLazy) {
+        return fLazy->paint(reader, index);
+    }
     return reader->validate(index > 0 && index <= fPaints.size()) ?
         &fPaints[index - 1] : nullptr;
 }
@@ -21,6 +21,7 @@
 #include "include/core/SkTypes.h"
 #include "include/core/SkVertices.h"
 #include "include/private/base/SkTArray.h"
+#include "src/core/SkIndexedPicture.h"
 #include "src/core/SkPictureFlat.h"
 #include "src/core/SkReadBuffer.h"
 
@@ -30,11 +31,14 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
+class SkExecutor;
 class SkFactorySet;
 class SkPictureRecord;
 class SkRefCntSet;
 class SkStream;
+class SkTaskGroup;
 class SkWStream;
 class SkWriteBuffer;
 struct SkDeserialProcs;
@@ -97,6 +101,7 @@ public:
                                            SkTypefacePlayback*,
                                            int recursionLimit);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
+    ~SkPictureData();
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
     void flatten(SkWriteBuffer&) const;
@@ -117,16 +122,26 @@ public:
     const SkImage* getImage(SkReadBuffer* reader) const {
         // images are written base-0, unlike paths, pictures, drawables, etc.
         const int index = reader->readInt();
+        if (fLazy) {
+            return fLazy->image(reader, index);
+        }
         return reader->validateIndex(index, fImages.size()) ? fImages[index].get() : nullptr;
     }
 
     const SkPath& getPath(SkReadBuffer* reader) const {
         int index = reader->readInt();
+        if (fLazy) {
+            const SkPath* path = fLazy->path(reader, index);
+            return path ? *path : fEmptyPath;
+        }
         return reader->validate(index > 0 && index <= fPaths.size()) ?
                 fPaths[index - 1] : fEmptyPath;
     }
 
     const SkPicture* getPicture(SkReadBuffer* reader) const {
+        if (fLazy) {
+            return fLazy->picture(reader, reader->readInt());
+        }
         return read_index_base_1_or_null(reader, fPictures);
     }
 
@@ -142,6 +157,9 @@ public:
     const SkPaint& requiredPaint(SkReadBuffer* reader) const;
 
     const SkTextBlob* getTextBlob(SkReadBuffer* reader) const {
+        if (fLazy) {
+            return fLazy->textBlob(reader, reader->readInt());
+        }
         return read_index_base_1_or_null(reader, fTextBlobs);
     }
 
@@ -152,16 +170,24 @@ public:
 #endif
 
     const SkVertices* getVertices(SkReadBuffer* reader) const {
+        if (fLazy) {
+            return fLazy->vertices(reader, reader->readInt());
+        }
         return read_index_base_1_or_null(reader, fVertices);
     }
 
 private:
+    friend class SkIndexedPicture;
+    friend class SkPictureStreamPlayer;
+
     // these help us with reading/writing
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
                         const SkDeserialProcs&, SkTypefacePlayback*,
                         int recursionLimit);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
+    void startImageDecodes(SkReadBuffer&, uint32_t count, SkExecutor*);
+    void finishImageDecodes();
     void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly) const;
 
     skia_private::TArray<SkPaint> fPaints;
@@ -185,8 +211,15 @@ private:
     SkTypefacePlayback                 fTFPlayback;
     std::unique_ptr<SkFactoryPlayback> fFactoryPlayback;
 
+    // Set when the data is in an indexed SKP, whose resources are read on first use instead.
+    std::unique_ptr<SkIndexedPicture::Resources> fLazy;
+
     const SkPictInfo fInfo;
 
+    // Set while the images are decoded on SkDeserialProcs::fExecutor.
+    std::vector<SkReadBuffer::EncodedImage> fEncodedImages;
+    std::unique_ptr<SkTaskGroup> fImageDecodes;
+
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec, const SkSerialProcs&);
 
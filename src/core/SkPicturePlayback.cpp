@@ -61,6 +61,18 @@ static const SkRect* get_rect_ptr(SkReadBuffer* reader, SkRect* storage) {
 void SkPicturePlayback::draw(SkCanvas* canvas,
                              SkPicture::AbortCallback* callback,
                              SkReadBuffer* buffer) {
+    // Record this, so we can concat w/ it if we encounter a setMatrix()
+    SkM44 initialMatrix = canvas->getLocalToDevice();
+
+    SkAutoCanvasRestore acr(canvas, false);
+
+    this->drawPart(canvas, initialMatrix, callback, buffer);
+}
+
+void SkPicturePlayback::drawPart(SkCanvas* canvas,
+                                 const SkM44& initialMatrix,
+                                 SkPicture::AbortCallback* callback,
+                                 SkReadBuffer* buffer) {
     AutoResetOpID aroi(this);
     SkASSERT(0 == fCurOffset);
 
@@ -68,10 +80,8 @@ void SkPicturePlayback::draw(SkCanvas* canvas,
                         fPictureData->opData()->size());
     reader.setVersion(fPictureData->info().getVersion());
 
-    // Record this, so we can concat w/ it if we encounter a setMatrix()
-    SkM44 initialMatrix = canvas->getLocalToDevice();
-
-    SkAutoCanvasRestore acr(canvas, false);
+    const SkRect query = fOpBounds.empty() ? SkRect::MakeEmpty() : canvas->getLocalClipBounds();
+    size_t nextBounds = 0;
 
     while (!reader.eof() && reader.isValid()) {
         if (callback && callback->abort()) {
@@ -83,7 +93,8 @@ void SkPicturePlayback::draw(SkCanvas* canvas,
         uint32_t bits = reader.readInt();
         uint32_t op   = bits >> 24,
                  size = bits & 0xffffff;
-        if (size == 0xffffff) {
+        const bool hasLargeSize = size == 0xffffff;
+        if (hasLargeSize) {
             size = reader.readInt();
         }
 
@@ -91,6 +102,19 @@ void SkPicturePlayback::draw(SkCanvas* canvas,
             return;
         }
 
+        while (nextBounds < fOpBounds.size() && fOpBounds[nextBounds].fOffset < fCurOffset) {
+            nextBounds++;
+        }
+        if (nextBounds < fOpBounds.size() && fOpBounds[nextBounds].fOffset == fCurOffset &&
+            !hasLargeSize && !SkRect::Intersects(fOpBounds[nextBounds].fBounds, query)) {
+            // The size of an op includes its first word, which has been read.
+            if (!reader.validate(size >= 4)) {
+                return;
+            }
+            reader.skip(size - 4);
+            continue;
+        }
+
         this->handleOp(&reader, (DrawType)op, size, canvas, initialMatrix);
     }
 
@@ -10,6 +10,8 @@
 
 #include "include/core/SkM44.h"
 #include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSpan.h"
 #include "include/private/base/SkNoncopyable.h"
 #include "src/core/SkPictureFlat.h"
 
@@ -30,6 +32,21 @@ public:
 
     void draw(SkCanvas* canvas, SkPicture::AbortCallback*, SkReadBuffer* buffer);
 
+    // Plays back ops that are one part of what's drawn, as SkPictureStreamPlayer reads them. The
+    // canvas is left as the ops leave it, for the next part, and setMatrix() ops are relative to
+    // initialMatrix, the canvas' matrix before the first part.
+    void drawPart(SkCanvas* canvas, const SkM44& initialMatrix, SkPicture::AbortCallback*,
+                  SkReadBuffer* buffer);
+
+    // The bounds of the draw ops at some offsets in the op data, in the coordinates of the
+    // canvas when draw() is called. Ops whose bounds are outside of its clip are skipped without
+    // reading their parameters. The offsets must be increasing.
+    struct OpBounds {
+        uint32_t fOffset;
+        SkRect   fBounds;
+    };
+    void setOpBounds(SkSpan<const OpBounds> opBounds) { fOpBounds = opBounds; }
+
     // TODO: remove the curOp calls after cleaning up GrGatherDevice
     // Return the ID of the operation currently being executed when playing
     // back. 0 indicates no call is active.
@@ -38,6 +55,7 @@ public:
 
 private:
     const SkPictureData* fPictureData;
+    SkSpan<const OpBounds> fOpBounds;
 
     // The offset of the current operation when within the draw method
     size_t fCurOffset;
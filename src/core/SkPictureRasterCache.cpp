@@ -0,0 +1,385 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPictureRasterCache.h"
+
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkDevice.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkResourceCache.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace {
+static unsigned gPictureRasterKeyNamespaceLabel;
+static unsigned gDrawableRasterKeyNamespaceLabel;
+static unsigned gPictureSrcOverKeyNamespaceLabel;
+static unsigned gDrawableSrcOverKeyNamespaceLabel;
+
+bool picture_draws_with_src_over(const SkPicture* picture);
+
+// Whether an op draws the same into a transparent image that's then drawn with src-over as it
+// does when played back: it must blend with src-over, and must not read what's under it.
+struct DrawsWithSrcOver {
+    static bool SrcOver(const SkPaint* paint) {
+        return !paint || paint->asBlendMode() == SkBlendMode::kSrcOver;
+    }
+
+    bool operator()(const SkRecords::SaveLayer& op) {
+        return !op.backdrop &&
+               !(op.saveLayerFlags & SkCanvas::kInitWithPrevious_SaveLayerFlag) &&
+               SrcOver(op.paint);
+    }
+    bool operator()(const SkRecords::DrawPicture& op) {
+        return SrcOver(op.paint) && picture_draws_with_src_over(op.picture.get());
+    }
+    bool operator()(const SkRecords::DrawEdgeAAQuad& op) {
+        return op.mode == SkBlendMode::kSrcOver;
+    }
+    // These read or clear what's under them, or their blending isn't known until they're drawn.
+    bool operator()(const SkRecords::SaveBehind&) { return false; }
+    bool operator()(const SkRecords::DrawBehind&) { return false; }
+    bool operator()(const SkRecords::ResetClip&) { return false; }
+    bool operator()(const SkRecords::DrawDrawable&) { return false; }
+    bool operator()(const SkRecords::DrawSlug&) { return false; }
+
+    template <typename T>
+    std::enable_if_t<(T::kTags & SkRecords::kHasPaint_Tag) != 0, bool> operator()(const T& op) {
+        return SrcOver(op.paint);
+    }
+    template <typename T>
+    std::enable_if_t<(T::kTags & SkRecords::kHasPaint_Tag) == 0, bool> operator()(const T&) {
+        return true;
+    }
+};
+
+bool record_draws_with_src_over(const SkRecord& record) {
+    DrawsWithSrcOver visitor;
+    for (int i = 0; i < record.count(); ++i) {
+        if (!record.visit(i, visitor)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool analyze_picture(const SkPicture* picture) {
+    if (const SkBigPicture* bigPicture = SkPicturePriv::AsSkBigPicture(sk_ref_sp(picture))) {
+        return record_draws_with_src_over(*bigPicture->record());
+    }
+    SkRecord record;
+    SkRecorder recorder(&record, picture->cullRect());
+    picture->playback(&recorder);
+    return record_draws_with_src_over(record);
+}
+
+// Remembers whether a picture or drawable draws with src-over, so it's only analyzed once.
+struct SrcOverKey : public SkResourceCache::Key {
+public:
+    SrcOverKey(void* nameSpace, uint64_t sharedID, uint32_t contentID) : fContentID(contentID) {
+        this->init(nameSpace, sharedID, sizeof(fContentID));
+    }
+
+private:
+    uint32_t fContentID;
+};
+
+struct SrcOverRec : public SkResourceCache::Rec {
+    SrcOverRec(const SrcOverKey& key, bool srcOver) : fKey(key), fSrcOver(srcOver) {}
+
+    SrcOverKey fKey;
+    bool fSrcOver;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this); }
+    const char* getCategory() const override { return "picture-raster"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const SrcOverRec& rec = static_cast<const SrcOverRec&>(baseRec);
+        *static_cast<bool*>(context) = rec.fSrcOver;
+        return true;
+    }
+};
+
+// Returns the cached result, or analyze() and adds it.
+template <typename Analyze>
+bool find_or_analyze(const SrcOverKey& key, Analyze&& analyze) {
+    bool srcOver;
+    if (!SkResourceCache::Find(key, SrcOverRec::Visitor, &srcOver)) {
+        srcOver = analyze();
+        SkResourceCache::Add(new SrcOverRec(key, srcOver));
+    }
+    return srcOver;
+}
+
+bool picture_draws_with_src_over(const SkPicture* picture) {
+    const SrcOverKey key(&gPictureSrcOverKeyNamespaceLabel,
+                         SkPicturePriv::MakeSharedID(picture->uniqueID()),
+                         picture->uniqueID());
+    const bool srcOver = find_or_analyze(key, [&] { return analyze_picture(picture); });
+    // The result is purged when the picture is deleted.
+    SkPicturePriv::AddedToCache(picture);
+    return srcOver;
+}
+
+// Where a picture or drawable is rendered to be cached.  The integer part of the matrix's
+// translation is taken out of the matrix and the device bounds, and added back when the image is
+// drawn, so content that moves by whole pixels is drawn from the same image.
+struct Placement {
+    SkMatrix fMatrix;
+    SkIRect fBounds;    // of what is rendered, inside of the clip
+    SkIPoint fOffset;   // the integer translation
+    SkImageInfo fInfo;
+    SkSurfaceProps fProps;
+};
+
+bool place(SkCanvas* canvas, const SkMatrix& ctm, const SkRect& bounds, Placement* placement) {
+    // Only raster devices are cached, and only those on the canvas' pixel grid; a layer might not
+    // be, e.g. when it's scaled for an image filter.
+    SkBaseDevice* device = SkCanvasPriv::TopDevice(canvas);
+    SkPixmap pixmap;
+    if (!device->peekPixels(&pixmap) || !device->isPixelAlignedToGlobal() ||
+        ctm.hasPerspective() || !ctm.isFinite() || bounds.isEmpty()) {
+        return false;
+    }
+
+    const float tx = std::floor(ctm.getTranslateX()),
+                ty = std::floor(ctm.getTranslateY());
+    static constexpr float kMaxOffset = 1 << 24;
+    if (std::fabs(tx) > kMaxOffset || std::fabs(ty) > kMaxOffset) {
+        return false;
+    }
+    placement->fOffset = {(int)tx, (int)ty};
+    placement->fMatrix = ctm;
+    placement->fMatrix.postTranslate(-tx, -ty);
+
+    SkIRect deviceBounds = ctm.mapRect(bounds).roundOut();
+    if (!deviceBounds.intersect(canvas->getDeviceClipBounds())) {
+        return false;
+    }
+    placement->fBounds = deviceBounds.makeOffset(-placement->fOffset);
+
+    // The image needs alpha, to be drawn over what's under it.
+    SkColorType colorType = pixmap.colorType();
+    if (SkColorTypeIsAlwaysOpaque(colorType)) {
+        colorType = kN32_SkColorType;
+    }
+    placement->fInfo = SkImageInfo::Make(placement->fBounds.size(), colorType,
+                                         kPremul_SkAlphaType, pixmap.refColorSpace());
+    const size_t limit = SkResourceCache::GetEffectiveSingleAllocationByteLimit();
+    if (limit && placement->fInfo.computeMinByteSize() > limit) {
+        return false;
+    }
+
+    // Pictures and drawables nested in what's cached are drawn into its image.
+    const SkSurfaceProps& props = device->surfaceProps();
+    placement->fProps = SkSurfaceProps(props.flags() & ~SkSurfaceProps::kCachePictures_Flag,
+                                       props.pixelGeometry());
+    return true;
+}
+
+struct PictureRasterKey : public SkResourceCache::Key {
+public:
+    PictureRasterKey(void* nameSpace, uint64_t sharedID, uint32_t contentID,
+                     const Placement& placement)
+            : fContentID(contentID)
+            , fBounds(placement.fBounds)
+            , fColorType(placement.fInfo.colorType())
+            , fColorSpaceXYZHash(0)
+            , fColorSpaceTransferFnHash(0)
+            , fProps(placement.fProps) {
+        const SkMatrix& m = placement.fMatrix;
+        const SkScalar values[] = {m.getScaleX(), m.getSkewX(), m.getTranslateX(),
+                                   m.getSkewY(),  m.getScaleY(), m.getTranslateY()};
+        for (int i = 0; i < 6; ++i) {
+            fMatrix[i] = values[i] + 0.0f;  // -0 and 0 are the same key
+        }
+        if (SkColorSpace* colorSpace = placement.fInfo.colorSpace()) {
+            fColorSpaceXYZHash = colorSpace->toXYZD50Hash();
+            fColorSpaceTransferFnHash = colorSpace->transferFnHash();
+        }
+
+        static const size_t keySize = sizeof(fContentID) +
+                                      sizeof(fMatrix) +
+                                      sizeof(fBounds) +
+                                      sizeof(fColorType) +
+                                      sizeof(fColorSpaceXYZHash) +
+                                      sizeof(fColorSpaceTransferFnHash) +
+                                      sizeof(fProps);
+        // This better be packed.
+        SkASSERT(sizeof(uint32_t) * (&fEndOfStruct - &fContentID) == keySize);
+        this->init(nameSpace, sharedID, keySize);
+    }
+
+private:
+    uint32_t       fContentID;
+    SkScalar       fMatrix[6];
+    SkIRect        fBounds;
+    uint32_t       fColorType;
+    uint32_t       fColorSpaceXYZHash;
+    uint32_t       fColorSpaceTransferFnHash;
+    SkSurfaceProps fProps;
+
+    SkDEBUGCODE(uint32_t fEndOfStruct;)
+};
+
+struct PictureRasterRec : public SkResourceCache::Rec {
+    PictureRasterRec(const PictureRasterKey& key, sk_sp<SkImage> image)
+        : fKey(key)
+        , fImage(std::move(image)) {}
+
+    PictureRasterKey fKey;
+    sk_sp<SkImage> fImage;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        return sizeof(fKey) + fImage->imageInfo().computeMinByteSize();
+    }
+    const char* getCategory() const override { return "picture-raster"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const PictureRasterRec& rec = static_cast<const PictureRasterRec&>(baseRec);
+        *static_cast<sk_sp<SkImage>*>(context) = rec.fImage;
+        return true;
+    }
+};
+
+// Returns the image from the cache, or renders it with render(canvas, matrix) and adds it.  Only
+// what draws with src-over is rendered, so srcOver() is only asked when the image isn't cached.
+template <typename SrcOver, typename Render>
+sk_sp<SkImage> find_or_render(const PictureRasterKey& key, const Placement& placement,
+                              SrcOver&& srcOver, Render&& render) {
+    sk_sp<SkImage> image;
+    if (SkResourceCache::Find(key, PictureRasterRec::Visitor, &image)) {
+        return image;
+    }
+    if (!srcOver()) {
+        return nullptr;
+    }
+
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(placement.fInfo, &placement.fProps);
+    if (!surface) {
+        return nullptr;
+    }
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->translate(-placement.fBounds.left(), -placement.fBounds.top());
+    render(canvas, placement.fMatrix);
+    image = surface->makeImageSnapshot();
+    if (image) {
+        SkResourceCache::Add(new PictureRasterRec(key, image));
+    }
+    return image;
+}
+
+// Draws the image with the canvas' clip, where the content would have been drawn.
+void draw_image(SkCanvas* canvas, const SkImage* image, const Placement& placement) {
+    canvas->save();
+    canvas->resetMatrix();
+    canvas->drawImage(image,
+                      placement.fOffset.x() + placement.fBounds.left(),
+                      placement.fOffset.y() + placement.fBounds.top());
+    canvas->restore();
+}
+
+}  // namespace
+
+bool SkPictureRasterCache::DrawPicture(SkCanvas* canvas, const SkPicture* picture,
+                                       const SkMatrix* matrix, const SkPaint* paint) {
+    SkMatrix ctm = canvas->getTotalMatrix();
+    if (matrix) {
+        ctm.preConcat(*matrix);
+    }
+    Placement placement;
+    if (!place(canvas, ctm, picture->cullRect(), &placement)) {
+        return false;
+    }
+
+    PictureRasterKey key(&gPictureRasterKeyNamespaceLabel,
+                         SkPicturePriv::MakeSharedID(picture->uniqueID()),
+                         picture->uniqueID(),
+                         placement);
+    sk_sp<SkImage> image = find_or_render(key, placement,
+            [&] { return picture_draws_with_src_over(picture); },
+            [&](SkCanvas* c, const SkMatrix& m) {
+                c->concat(m);
+                picture->playback(c);
+            });
+    if (!image) {
+        return false;
+    }
+    // The cached images are purged when the picture is deleted.
+    SkPicturePriv::AddedToCache(picture);
+
+    // As in SkCanvas::onDrawPicture(), the paint applies to a layer.
+    SkAutoCanvasMatrixPaint acmp(canvas, matrix, paint, picture->cullRect());
+    draw_image(canvas, image.get(), placement);
+    return true;
+}
+
+bool SkPictureRasterCache::DrawDrawable(SkCanvas* canvas, SkDrawable* drawable,
+                                        const SkMatrix* matrix) {
+    SkMatrix ctm = canvas->getTotalMatrix();
+    if (matrix) {
+        ctm.preConcat(*matrix);
+    }
+    Placement placement;
+    if (!place(canvas, ctm, drawable->getBounds(), &placement)) {
+        return false;
+    }
+
+    // A drawable's generation ID is unique to what it draws, and changes when that does.  Its
+    // stale images aren't purged, and are left to age out of the cache.
+    PictureRasterKey key(&gDrawableRasterKeyNamespaceLabel, 0, drawable->getGenerationID(),
+                         placement);
+    const SrcOverKey srcOverKey(&gDrawableSrcOverKeyNamespaceLabel, 0,
+                                drawable->getGenerationID());
+    // What's recorded to be analyzed is played back, rather than drawing the drawable again.
+    sk_sp<SkPicture> snapshot;
+    sk_sp<SkImage> image = find_or_render(key, placement,
+            [&] {
+                return find_or_analyze(srcOverKey, [&] {
+                    snapshot = drawable->makePictureSnapshot();
+                    return snapshot && analyze_picture(snapshot.get());
+                });
+            },
+            [&](SkCanvas* c, const SkMatrix& m) {
+                c->concat(m);
+                c->clipRect(drawable->getBounds());
+                if (snapshot) {
+                    snapshot->playback(c);
+                } else {
+                    drawable->draw(c);
+                }
+            });
+    if (!image) {
+        return false;
+    }
+    draw_image(canvas, image.get(), placement);
+    return true;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureRasterCache_DEFINED
+#define SkPictureRasterCache_DEFINED
+
+class SkCanvas;
+class SkDrawable;
+class SkMatrix;
+class SkPaint;
+class SkPicture;
+
+// Draws pictures and drawables to raster canvases whose SkSurfaceProps have kCachePictures_Flag.
+// The first draw renders them into an image, which is kept in SkResourceCache and drawn instead
+// of playing them back until their content changes (a picture never does, a drawable does when
+// its generation ID changes), or they're drawn with a different matrix, clip or color space.
+// Matrices that only differ by whole pixels of translation share an image, as do clips that
+// contain all of what's drawn.
+//
+// The image is drawn as a layer would be, which is only the same as playing them back when they
+// blend with src-over and don't read what's under them, so what doesn't (e.g. another blend mode
+// or a backdrop filter) is played back instead.  A picture is analyzed for that once, a drawable
+// once per generation ID.  Drawables are only drawn inside of their bounds.
+class SkPictureRasterCache {
+public:
+    // These return false if the picture or drawable can't be cached on this canvas, e.g. it isn't
+    // a raster canvas, the matrix has perspective or it doesn't blend with src-over, in which case
+    // it should be played back.
+    static bool DrawPicture(SkCanvas*, const SkPicture*, const SkMatrix*, const SkPaint*);
+    static bool DrawDrawable(SkCanvas*, SkDrawable*, const SkMatrix*);
+};
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "src/core/SkPictureRecord.h"
 
+#include "include/core/SkDrawable.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkRSXform.h"
 #include "include/core/SkSurface.h"
@@ -293,6 +294,13 @@ size_t SkPictureRecord::recordRestoreOffsetPlaceholder() {
         return -1;
     }
 
+    size_t offset = fWriter.bytesWritten();
+    if (fRecordFlags & kStreaming_RecordFlag) {
+        // No offset; playback then never skips to the restore.
+        this->addInt(0);
+        return offset;
+    }
+
     // The RestoreOffset field is initially filled with a placeholder
     // value that points to the offset of the previous RestoreOffset
     // in the current stack level, thus forming a linked list so that
@@ -300,7 +308,6 @@ size_t SkPictureRecord::recordRestoreOffsetPlaceholder() {
     // restore command is recorded.
     int32_t prevOffset = fRestoreOffsetStack.back();
 
-    size_t offset = fWriter.bytesWritten();
     this->addInt(prevOffset);
     fRestoreOffsetStack.back() = SkToU32(offset);
     return offset;
@@ -350,12 +357,11 @@ size_t SkPictureRecord::recordClipRRect(const SkRRect& rrect, SkClipOp op, bool
 }
 
 void SkPictureRecord::onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) {
-    int pathID = this->addPathToHeap(path);
-    this->recordClipPath(pathID, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->recordClipPath(path, op, kSoft_ClipEdgeStyle == edgeStyle);
     this->INHERITED::onClipPath(path, op, edgeStyle);
 }
 
-size_t SkPictureRecord::recordClipPath(int pathID, SkClipOp op, bool doAA) {
+size_t SkPictureRecord::recordClipPath(const SkPath& path, SkClipOp op, bool doAA) {
     // op + path index + clip params
     size_t size = 3 * kUInt32Size;
     // recordRestoreOffsetPlaceholder doesn't always write an offset
@@ -364,7 +370,7 @@ size_t SkPictureRecord::recordClipPath(int pathID, SkClipOp op, bool doAA) {
         size += kUInt32Size;
     }
     size_t initialOffset = this->addDraw(CLIP_PATH, &size);
-    this->addInt(pathID);
+    this->addPath(path);
     this->addInt(ClipParams_pack(op, doAA));
     size_t offset = recordRestoreOffsetPlaceholder();
     this->validate(initialOffset, size);
@@ -615,6 +621,12 @@ void SkPictureRecord::onDrawPicture(const SkPicture* picture, const SkMatrix* ma
 }
 
 void SkPictureRecord::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
+    if (fRecordFlags & kStreaming_RecordFlag) {
+        // What the drawable draws now, since it's written before it can change.
+        this->onDrawPicture(drawable->makePictureSnapshot().get(), matrix, nullptr);
+        return;
+    }
+
     // op + drawable index
     size_t size = 2 * kUInt32Size;
     size_t initialOffset;
@@ -834,12 +846,28 @@ static int find_or_append(TArray<sk_sp<T>>& array, T* obj) {
     return array.size() - 1;
 }
 
+// When streaming, the array only has what hasn't been taken, and the indices of what has are
+// found by ID.
+template <typename T>
+static int find_or_append(TArray<sk_sp<T>>& array, THashMap<uint32_t, int>* indices, int taken,
+                          T* obj) {
+    if (int* index = indices->find(obj->uniqueID())) {
+        return *index;
+    }
+    array.push_back(sk_ref_sp(obj));
+    return *indices->set(obj->uniqueID(), taken + array.size() - 1);
+}
+
 sk_sp<SkSurface> SkPictureRecord::onNewSurface(const SkImageInfo& info, const SkSurfaceProps&) {
     return nullptr;
 }
 
 void SkPictureRecord::addImage(const SkImage* image) {
     // convention for images is 0-based index
+    if (fRecordFlags & kStreaming_RecordFlag) {
+        this->addInt(find_or_append(fImages, &fImageIndices, fImagesTaken, image));
+        return;
+    }
     this->addInt(find_or_append(fImages, image));
 }
 
@@ -875,6 +903,10 @@ void SkPictureRecord::addPatch(const SkPoint cubics[12]) {
 
 void SkPictureRecord::addPicture(const SkPicture* picture) {
     // follow the convention of recording a 1-based index
+    if (fRecordFlags & kStreaming_RecordFlag) {
+        this->addInt(find_or_append(fPictures, &fPictureIndices, fPicturesTaken, picture) + 1);
+        return;
+    }
     this->addInt(find_or_append(fPictures, picture) + 1);
 }
 
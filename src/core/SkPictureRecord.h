@@ -32,6 +32,14 @@
 
 class SkPictureRecord : public SkCanvasVirtualEnforcer<SkCanvas> {
 public:
+    enum RecordFlags {
+        // The ops are taken out in chunks as they're recorded, by SkPictureStreamRecorder. Clips
+        // don't point ahead to where their save level is restored, since that would mean
+        // rewriting ops already taken, and images and pictures are known by their ID rather than
+        // kept, so that their indices carry on from one chunk to the next.
+        kStreaming_RecordFlag = 1 << 0,
+    };
+
     SkPictureRecord(const SkISize& dimensions, uint32_t recordFlags);
 
     SkPictureRecord(const SkIRect& dimensions, uint32_t recordFlags);
@@ -85,6 +93,11 @@ public:
 protected:
     void addNoOp();
 
+    // When streaming, called before an op is recorded once chunkSize bytes of ops have been
+    // recorded since the ops were last taken.
+    void setChunkSize(size_t chunkSize) { fChunkSize = chunkSize; }
+    virtual void onChunkFull() {}
+
 private:
     void handleOptimization(int opt);
     size_t recordRestoreOffsetPlaceholder();
@@ -107,6 +120,9 @@ private:
      * operates in this manner.
      */
     size_t addDraw(DrawType drawType, size_t* size) {
+        if (fChunkSize && fWriter.bytesWritten() >= fChunkSize) {
+            this->onChunkFull();
+        }
         size_t offset = fWriter.bytesWritten();
 
         SkASSERT_RELEASE(this->predrawNotify());
@@ -235,7 +251,7 @@ protected:
     void recordScale(const SkMatrix& matrix);
     size_t recordClipRect(const SkRect& rect, SkClipOp op, bool doAA);
     size_t recordClipRRect(const SkRRect& rrect, SkClipOp op, bool doAA);
-    size_t recordClipPath(int pathID, SkClipOp op, bool doAA);
+    size_t recordClipPath(const SkPath& path, SkClipOp op, bool doAA);
     size_t recordClipRegion(const SkRegion& region, SkClipOp op);
     void recordSave();
     void recordSaveLayer(const SaveLayerRec&);
@@ -253,6 +269,11 @@ private:
 
     skia_private::TArray<sk_sp<const SkImage>>    fImages;
     skia_private::TArray<sk_sp<const SkPicture>>  fPictures;
+    // When streaming, the indices of the images and pictures by ID, and how many were taken.
+    skia_private::THashMap<uint32_t, int>         fImageIndices;
+    skia_private::THashMap<uint32_t, int>         fPictureIndices;
+    int                                           fImagesTaken = 0;
+    int                                           fPicturesTaken = 0;
     skia_private::TArray<sk_sp<SkDrawable>>       fDrawables;
     skia_private::TArray<sk_sp<const SkTextBlob>> fTextBlobs;
     skia_private::TArray<sk_sp<const SkVertices>> fVertices;
@@ -262,8 +283,10 @@ private:
 
     uint32_t fRecordFlags;
     int      fInitialSaveCount;
+    size_t   fChunkSize = 0;
 
     friend class SkPictureData;   // for SkPictureData's SkPictureRecord-based constructor
+    friend class SkPictureStreamRecorder;  // to take the ops and resources as they're recorded
 
     using INHERITED = SkCanvasVirtualEnforcer<SkCanvas>;
 };
@@ -22,17 +22,20 @@ using namespace skia_private;
 
 SkPictureRecorder::SkPictureRecorder() {
     fActivelyRecording = false;
+    fRecordFlags = 0;
     fRecorder = std::make_unique<SkRecorder>(nullptr, SkRect::MakeEmpty());
 }
 
 SkPictureRecorder::~SkPictureRecorder() {}
 
 SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
-                                            sk_sp<SkBBoxHierarchy> bbh) {
+                                            sk_sp<SkBBoxHierarchy> bbh,
+                                            uint32_t recordFlags) {
     const SkRect cullRect = userCullRect.isEmpty() ? SkRect::MakeEmpty() : userCullRect;
 
     fCullRect = cullRect;
     fBBH = std::move(bbh);
+    fRecordFlags = recordFlags;
 
     if (!fRecord) {
         fRecord.reset(new SkRecord);
@@ -42,14 +45,24 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
     return this->getRecordingCanvas();
 }
 
-SkCanvas* SkPictureRecorder::beginRecording(const SkRect& bounds, SkBBHFactory* factory) {
-    return this->beginRecording(bounds, factory ? (*factory)() : nullptr);
+SkCanvas* SkPictureRecorder::beginRecording(const SkRect& bounds, SkBBHFactory* factory,
+                                            uint32_t recordFlags) {
+    return this->beginRecording(bounds, factory ? (*factory)() : nullptr, recordFlags);
 }
 
 SkCanvas* SkPictureRecorder::getRecordingCanvas() {
     return fActivelyRecording ? fRecorder.get() : nullptr;
 }
 
+static void fill_bounds(uint32_t recordFlags, const SkRect& cullRect, const SkRecord& record,
+                        SkRect bounds[], SkBBoxHierarchy::Metadata meta[]) {
+    if (recordFlags & SkPictureRecorder::kApproximateBounds_RecordFlag) {
+        SkRecordFillApproximateBounds(cullRect, record, bounds, meta);
+    } else {
+        SkRecordFillBounds(cullRect, record, bounds, meta);
+    }
+}
+
 class SkEmptyPicture final : public SkPicture {
 public:
     void playback(SkCanvas*, AbortCallback*) const override { }
@@ -78,7 +91,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
         AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta);
+        fill_bounds(fRecordFlags, fCullRect, *fRecord, bounds.data(), meta);
 
         fBBH->insert(bounds.data(), meta, fRecord->count());
 
@@ -133,7 +146,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
         AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta);
+        fill_bounds(fRecordFlags, fCullRect, *fRecord, bounds.data(), meta);
         fBBH->insert(bounds.data(), meta, fRecord->count());
     }
 
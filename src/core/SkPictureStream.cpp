@@ -0,0 +1,488 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPictureStream.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkVertices.h"
+#include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkAutoMalloc.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPictureFlat.h"
+#include "src/core/SkPicturePlayback.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkPictureRecord.h"
+#include "src/core/SkPtrRecorder.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkStreamPriv.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkVerticesPriv.h"
+#include "src/core/SkWriteBuffer.h"
+
+#if defined(SK_GANESH)
+#include "include/private/chromium/Slug.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace skia_private;
+
+namespace {
+static constexpr char kMagic[] = "skiastrm";
+static constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+
+void write_tag_size(SkWriteBuffer& buffer, uint32_t tag, size_t size) {
+    buffer.writeUInt(tag);
+    buffer.writeUInt(SkToU32(size));
+}
+
+bool write_tag_size(SkWStream* stream, uint32_t tag, size_t size) {
+    return stream->write32(tag) && stream->write32(SkToU32(size));
+}
+
+// Forgets the indices of what was taken before the last 'retained', so that it's written again.
+void forget_indices_before(THashMap<uint32_t, int>* indices, int taken, int retained) {
+    const int first = taken - retained;
+    if (first <= 0) {
+        return;
+    }
+    TArray<uint32_t> forgotten;
+    indices->foreach([&](uint32_t id, const int* index) {
+        if (*index < first) {
+            forgotten.push_back(id);
+        }
+    });
+    for (uint32_t id : forgotten) {
+        indices->remove(id);
+    }
+}
+
+// Releases what comes before the last 'retained' of the array, from 'released' on.
+template <typename T>
+void release_before(TArray<sk_sp<T>>* array, int retained, int* released) {
+    for (; *released < array->size() - retained; ++*released) {
+        (*array)[*released].reset();
+    }
+}
+}  // namespace
+
+// Records as an SkPictureRecord does, but hands its ops to the recorder in chunks.
+class SkPictureStreamRecorder::Canvas final : public SkPictureRecord {
+public:
+    Canvas(SkPictureStreamRecorder* recorder, const SkIRect& bounds, size_t chunkSize)
+            : SkPictureRecord(bounds, kStreaming_RecordFlag)
+            , fRecorder(recorder) {
+        this->setChunkSize(std::max<size_t>(chunkSize, 1));
+    }
+
+private:
+    void onChunkFull() override { fRecorder->writeChunk(); }
+
+    SkPictureStreamRecorder* fRecorder;
+};
+
+SkPictureStreamRecorder::SkPictureStreamRecorder(SkWStream* stream,
+                                                 const SkRect& cullRect,
+                                                 const SkSerialProcs* procs,
+                                                 size_t chunkSize,
+                                                 int retainedResources)
+        : fStream(stream)
+        , fProcs(procs ? *procs : SkSerialProcs())
+        , fRetainedResources(std::max(retainedResources, 1))
+        , fFactories(sk_make_sp<SkFactorySet>())
+        , fTypefaces(sk_make_sp<SkRefCntSet>()) {
+    fWritesSucceeded = fStream->write(kMagic, kMagicSize) &&
+                       fStream->write32(SkPicturePriv::kCurrent_Version) &&
+                       fStream->write(&cullRect, sizeof(cullRect)) &&
+                       fStream->write32(fRetainedResources);
+
+    fCanvas = std::make_unique<Canvas>(this, cullRect.roundOut(), chunkSize);
+    fCanvas->beginRecording();
+}
+
+SkPictureStreamRecorder::~SkPictureStreamRecorder() {
+    this->finish();
+}
+
+SkCanvas* SkPictureStreamRecorder::getRecordingCanvas() {
+    return fCanvas.get();
+}
+
+bool SkPictureStreamRecorder::flush() {
+    if (fCanvas) {
+        this->writeChunk();
+    }
+    return fWritesSucceeded;
+}
+
+bool SkPictureStreamRecorder::finish() {
+    if (fCanvas) {
+        fCanvas->endRecording();
+        this->writeChunk();
+        fCanvas.reset();
+    }
+    return fWritesSucceeded;
+}
+
+// As SkPictureData::serialize() does, but for what's been recorded since the last chunk.
+void SkPictureStreamRecorder::writeChunk() {
+    SkPictureRecord* record = fCanvas.get();
+    if (record->fWriter.bytesWritten() == 0) {
+        return;
+    }
+
+    // The resources are flattened first, which adds their factories and typefaces to those of
+    // the stream; the typefaces are written with the typeface proc once they're all known.
+    SkSerialProcs bufferProcs = fProcs;
+    bufferProcs.fTypefaceProc = nullptr;
+    bufferProcs.fTypefaceCtx = nullptr;
+    SkBinaryWriteBuffer buffer;
+    buffer.setFactoryRecorder(fFactories);
+    buffer.setSerialProcs(bufferProcs);
+    buffer.setTypefaceRecorder(fTypefaces);
+
+    if (!record->fPaints.empty()) {
+        write_tag_size(buffer, SK_PICT_PAINT_BUFFER_TAG, record->fPaints.size());
+        for (const SkPaint& paint : record->fPaints) {
+            buffer.writePaint(paint);
+        }
+    }
+    if (record->fPaths.count() > 0) {
+        TArray<SkPath> paths(record->fPaths.count());
+        paths.push_back_n(record->fPaths.count());
+        const auto& indices = record->fPaths;
+        indices.foreach([&paths](const SkPath& path, int n) { paths[n - 1] = path; });
+        write_tag_size(buffer, SK_PICT_PATH_BUFFER_TAG, paths.size());
+        buffer.writeInt(paths.size());
+        for (const SkPath& path : paths) {
+            buffer.writePath(path);
+        }
+    }
+    if (!record->fTextBlobs.empty()) {
+        write_tag_size(buffer, SK_PICT_TEXTBLOB_BUFFER_TAG, record->fTextBlobs.size());
+        for (const auto& blob : record->fTextBlobs) {
+            SkTextBlobPriv::Flatten(*blob, buffer);
+        }
+    }
+#if defined(SK_GANESH)
+    if (!record->fSlugs.empty()) {
+        write_tag_size(buffer, SK_PICT_SLUG_BUFFER_TAG, record->fSlugs.size());
+        for (const auto& slug : record->fSlugs) {
+            slug->doFlatten(buffer);
+        }
+    }
+#endif
+    if (!record->fVertices.empty()) {
+        write_tag_size(buffer, SK_PICT_VERTICES_BUFFER_TAG, record->fVertices.size());
+        for (const auto& vertices : record->fVertices) {
+            vertices->priv().encode(buffer);
+        }
+    }
+    if (!record->fImages.empty()) {
+        write_tag_size(buffer, SK_PICT_IMAGE_BUFFER_TAG, record->fImages.size());
+        for (const auto& image : record->fImages) {
+            buffer.writeImage(image.get());
+        }
+    }
+    if (!record->fPictures.empty()) {
+        write_tag_size(buffer, SK_PICT_PICTURE_TAG, record->fPictures.size());
+        for (const auto& picture : record->fPictures) {
+            SkPicturePriv::Flatten(picture, buffer);
+        }
+    }
+
+    bool ok = true;
+    if (fFactories->count() > fFactoriesWritten) {
+        AutoTMalloc<SkFlattenable::Factory> factories(fFactories->count());
+        fFactories->copyToArray(factories.get());
+
+        size_t size = sizeof(uint32_t);  // for the count
+        for (int i = fFactoriesWritten; i < fFactories->count(); ++i) {
+            const char* name = SkFlattenable::FactoryToName(factories[i]);
+            const size_t length = name ? strlen(name) : 0;
+            size += SkWStream::SizeOfPackedUInt(length) + length;
+        }
+        ok = ok && write_tag_size(fStream, SK_PICT_FACTORY_TAG, size) &&
+             fStream->write32(fFactories->count() - fFactoriesWritten);
+        for (int i = fFactoriesWritten; i < fFactories->count(); ++i) {
+            const char* name = SkFlattenable::FactoryToName(factories[i]);
+            const size_t length = name ? strlen(name) : 0;
+            ok = ok && fStream->writePackedUInt(length) && fStream->write(name, length);
+        }
+        fFactoriesWritten = fFactories->count();
+    }
+    if (fTypefaces->count() > fTypefacesWritten) {
+        AutoTMalloc<SkTypeface*> typefaces(fTypefaces->count());
+        fTypefaces->copyToArray((SkRefCnt**)typefaces.get());
+
+        ok = ok && write_tag_size(fStream, SK_PICT_TYPEFACE_TAG,
+                                  fTypefaces->count() - fTypefacesWritten);
+        for (int i = fTypefacesWritten; i < fTypefaces->count(); ++i) {
+            sk_sp<SkData> data;
+            if (fProcs.fTypefaceProc) {
+                data = fProcs.fTypefaceProc(typefaces[i], fProcs.fTypefaceCtx);
+            }
+            if (data) {
+                ok = ok && fStream->write(data->data(), data->size());
+            } else {
+                typefaces[i]->serialize(fStream);
+            }
+        }
+        fTypefacesWritten = fTypefaces->count();
+    }
+    ok = ok && write_tag_size(fStream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten()) &&
+         buffer.writeToStream(fStream);
+
+    ok = ok && write_tag_size(fStream, SK_PICT_READER_TAG, record->fWriter.bytesWritten()) &&
+         record->fWriter.writeToStream(fStream) &&
+         fStream->write32(SK_PICT_EOF_TAG);
+    fStream->flush();
+    fWritesSucceeded = fWritesSucceeded && ok;
+
+    // The next chunk starts its own paints, paths, text blobs and vertices, and its images and
+    // pictures carry on from the indices of these. It can only refer to the last retained ones.
+    record->fWriter.rewindToOffset(0);
+    record->fPaints.clear();
+    record->fPaths.reset();
+    record->fTextBlobs.clear();
+#if defined(SK_GANESH)
+    record->fSlugs.clear();
+#endif
+    record->fVertices.clear();
+    record->fImagesTaken += record->fImages.size();
+    record->fImages.clear();
+    record->fPicturesTaken += record->fPictures.size();
+    record->fPictures.clear();
+    forget_indices_before(&record->fImageIndices, record->fImagesTaken, fRetainedResources);
+    forget_indices_before(&record->fPictureIndices, record->fPicturesTaken, fRetainedResources);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<SkPictureStreamPlayer> SkPictureStreamPlayer::Make(SkStream* stream,
+                                                                   const SkDeserialProcs* procs) {
+    char magic[kMagicSize];
+    uint32_t version;
+    SkRect cullRect;
+    uint32_t retainedResources;
+    if (!stream || stream->read(magic, kMagicSize) != kMagicSize ||
+        memcmp(magic, kMagic, kMagicSize) != 0 || !stream->readU32(&version) ||
+        version < SkPicturePriv::kMin_Version || version > SkPicturePriv::kCurrent_Version ||
+        stream->read(&cullRect, sizeof(cullRect)) != sizeof(cullRect) || !cullRect.isFinite() ||
+        !stream->readU32(&retainedResources) || retainedResources == 0 ||
+        !SkTFitsIn<int>(retainedResources)) {
+        return nullptr;
+    }
+    return std::unique_ptr<SkPictureStreamPlayer>(
+            new SkPictureStreamPlayer(stream, procs ? *procs : SkDeserialProcs(), version,
+                                      cullRect, SkToInt(retainedResources)));
+}
+
+SkPictureStreamPlayer::SkPictureStreamPlayer(SkStream* stream,
+                                             const SkDeserialProcs& procs,
+                                             uint32_t version,
+                                             const SkRect& cullRect,
+                                             int retainedResources)
+        : fStream(stream)
+        , fProcs(procs)
+        , fCullRect(cullRect)
+        , fRetainedResources(retainedResources) {
+    SkPictInfo info;
+    memcpy(info.fMagic, kMagic, kMagicSize);
+    info.setVersion(version);
+    info.fCullRect = cullRect;
+    fData.reset(new SkPictureData(info));
+}
+
+SkPictureStreamPlayer::~SkPictureStreamPlayer() = default;
+
+bool SkPictureStreamPlayer::playback(SkCanvas* canvas) {
+    // As SkPicturePlayback::draw() does, but across every chunk.
+    const SkM44 initialMatrix = canvas->getLocalToDevice();
+    SkAutoCanvasRestore acr(canvas, false);
+
+    while (!fStream->isAtEnd()) {
+        if (!this->readChunk()) {
+            return false;
+        }
+        SkReadBuffer status;
+        SkPicturePlayback playback(fData.get());
+        playback.drawPart(canvas, initialMatrix, nullptr, &status);
+        if (!status.isValid()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SkPictureStreamPlayer::readChunk() {
+    fData->fPaints.clear();
+    fData->fPaths.clear();
+    fData->fTextBlobs.clear();
+#if defined(SK_GANESH)
+    fData->fSlugs.clear();
+#endif
+    fData->fVertices.clear();
+    fData->fOpData.reset();
+    // The chunk can only refer to the images and pictures that were among the last retained ones
+    // when it was recorded.
+    release_before(&fData->fImages, fRetainedResources, &fImagesReleased);
+    release_before(&fData->fPictures, fRetainedResources, &fPicturesReleased);
+
+    for (;;) {
+        uint32_t tag, size;
+        if (!fStream->readU32(&tag)) {
+            return false;
+        }
+        if (tag == SK_PICT_EOF_TAG) {
+            break;
+        }
+        if (!fStream->readU32(&size)) {
+            return false;
+        }
+        switch (tag) {
+            case SK_PICT_FACTORY_TAG:
+                if (!this->readFactories()) {
+                    return false;
+                }
+                break;
+            case SK_PICT_TYPEFACE_TAG:
+                if (!this->readTypefaces(size)) {
+                    return false;
+                }
+                break;
+            case SK_PICT_BUFFER_SIZE_TAG:
+                if (!this->readResources(size)) {
+                    return false;
+                }
+                break;
+            case SK_PICT_READER_TAG:
+                if (fData->fOpData || StreamRemainingLengthIsBelow(fStream, size)) {
+                    return false;
+                }
+                fData->fOpData = SkData::MakeFromStream(fStream, size);
+                if (!fData->fOpData) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    if (!fData->fOpData) {
+        return false;
+    }
+    fData->initForPlayback();
+    return true;
+}
+
+bool SkPictureStreamPlayer::readFactories() {
+    uint32_t count;
+    if (!fStream->readU32(&count) || StreamRemainingLengthIsBelow(fStream, count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t length;
+        if (!fStream->readPackedUInt(&length) || StreamRemainingLengthIsBelow(fStream, length)) {
+            return false;
+        }
+        SkString name(length);
+        if (fStream->read(name.data(), length) != length) {
+            return false;
+        }
+        fFactories.push_back(SkFlattenable::NameToFactory(name.c_str()));
+    }
+    return true;
+}
+
+bool SkPictureStreamPlayer::readTypefaces(uint32_t count) {
+    if (StreamRemainingLengthIsBelow(fStream, count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (fStream->isAtEnd()) {
+            return false;
+        }
+        sk_sp<SkTypeface> typeface;
+        if (fProcs.fTypefaceProc) {
+            typeface = fProcs.fTypefaceProc(&fStream, sizeof(fStream), fProcs.fTypefaceCtx);
+        } else {
+            typeface = SkTypeface::MakeDeserialize(fStream);
+        }
+        if (!typeface) {
+            // As in an SKP, a typeface that can't be read is drawn with the default.
+            typeface = SkTypeface::MakeDefault();
+        }
+        fTypefaces.push_back(std::move(typeface));
+    }
+    return true;
+}
+
+bool SkPictureStreamPlayer::readResources(uint32_t size) {
+    if (StreamRemainingLengthIsBelow(fStream, size)) {
+        return false;
+    }
+    SkAutoMalloc storage(size);
+    if (fStream->read(storage.get(), size) != size) {
+        return false;
+    }
+
+    SkReadBuffer buffer(storage.get(), size);
+    buffer.setVersion(fData->info().getVersion());
+    buffer.setFactoryPlayback(fFactories.data(), fFactories.size());
+    buffer.setTypefaceArray(fTypefaces.data(), fTypefaces.size());
+    buffer.setDeserialProcs(fProcs);
+
+    while (!buffer.eof() && buffer.isValid()) {
+        const uint32_t tag = buffer.readUInt();
+        const uint32_t count = buffer.readUInt();
+        switch (tag) {
+            case SK_PICT_PAINT_BUFFER_TAG:
+            case SK_PICT_PATH_BUFFER_TAG:
+            case SK_PICT_TEXTBLOB_BUFFER_TAG:
+            case SK_PICT_SLUG_BUFFER_TAG:
+            case SK_PICT_VERTICES_BUFFER_TAG:
+                fData->parseBufferTag(buffer, tag, count);
+                break;
+            // The images and pictures are added to those of the chunks before.
+            case SK_PICT_IMAGE_BUFFER_TAG:
+                for (uint32_t i = 0; i < count && buffer.isValid(); ++i) {
+                    sk_sp<SkImage> image = buffer.readImage();
+                    if (buffer.validate(image != nullptr)) {
+                        fData->fImages.push_back(std::move(image));
+                    }
+                }
+                break;
+            case SK_PICT_PICTURE_TAG:
+                for (uint32_t i = 0; i < count && buffer.isValid(); ++i) {
+                    sk_sp<SkPicture> picture = SkPicturePriv::MakeFromBuffer(buffer);
+                    if (buffer.validate(picture != nullptr)) {
+                        fData->fPictures.push_back(std::move(picture));
+                    }
+                }
+                break;
+            default:
+                buffer.validate(false);
+                break;
+        }
+    }
+    return buffer.isValid();
+}
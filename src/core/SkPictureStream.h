@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureStream_DEFINED
+#define SkPictureStream_DEFINED
+
+#include "include/core/SkFlattenable.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkTArray.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class SkCanvas;
+class SkFactorySet;
+class SkPictureData;
+class SkRefCntSet;
+class SkStream;
+class SkWStream;
+
+// A picture written to a stream as it's recorded, for drawing that goes on for too long to keep
+// in memory until it's finished, as SkPictureRecorder does. The ops are written in chunks, each
+// once chunkSize bytes of them have been recorded, with the resources that they're the first to
+// use, and nothing but the IDs of the images and pictures is kept after that. The stream is
+// flushed after each chunk, so that what's written can be read while recording goes on.
+//
+// Typefaces and flattenable factories are written once per stream, and paints, paths, text blobs
+// and vertices once per chunk that uses them. Images and nested pictures are written once and
+// then referred to while they are among the last retainedResources of their kind written; after
+// that they are written again when they're drawn, so that the player only has to keep those.
+// Drawables are written as what they draw when they're drawn, and clips are not skipped over when
+// they're empty on playback. The ops and resources are those of an SKP, and the stream is laid
+// out as follows:
+//   header: "skiastrm", picture format version, cull rect, retainedResources
+//   chunks: factories and typefaces, a buffer of the other resources, then ops, and an EOF tag,
+//           each with the tags and sizes of an SKP
+class SkPictureStreamRecorder {
+public:
+    static constexpr size_t kDefaultChunkSize = 256 * 1024;
+    static constexpr int kDefaultRetainedResources = 32;
+
+    SkPictureStreamRecorder(SkWStream*, const SkRect& cullRect,
+                            const SkSerialProcs* = nullptr, size_t chunkSize = kDefaultChunkSize,
+                            int retainedResources = kDefaultRetainedResources);
+    // Finishes recording, if finish() hasn't been called.
+    ~SkPictureStreamRecorder();
+
+    // Returns nullptr once recording is finished.
+    SkCanvas* getRecordingCanvas();
+
+    // Writes what's been recorded so far and flushes the stream.
+    bool flush();
+
+    // Restores what's still saved, writes the rest and ends recording. Returns false if any
+    // write to the stream failed.
+    bool finish();
+
+private:
+    class Canvas;
+
+    void writeChunk();
+
+    SkWStream* fStream;
+    const SkSerialProcs fProcs;
+    const int fRetainedResources;
+    std::unique_ptr<Canvas> fCanvas;
+    // The factories and typefaces of the whole stream, and how many of each are written.
+    sk_sp<SkFactorySet> fFactories;
+    sk_sp<SkRefCntSet> fTypefaces;
+    int fFactoriesWritten = 0;
+    int fTypefacesWritten = 0;
+    bool fWritesSucceeded = true;
+};
+
+// Plays back what an SkPictureStreamRecorder wrote, reading and drawing one chunk at a time, so
+// that only the ops of one chunk, and the images and pictures that the recorder may still refer
+// to, are ever in memory.
+class SkPictureStreamPlayer {
+public:
+    // Returns nullptr if the stream doesn't start as an SkPictureStreamRecorder's does.
+    static std::unique_ptr<SkPictureStreamPlayer> Make(SkStream*,
+                                                       const SkDeserialProcs* = nullptr);
+    ~SkPictureStreamPlayer();
+
+    SkRect cullRect() const { return fCullRect; }
+
+    // Plays back the chunks left in the stream. Returns false if one of them was invalid or cut
+    // short, in which case those before it have been drawn; a recording that was never finished
+    // can still be drawn up to where it stopped.
+    bool playback(SkCanvas*);
+
+private:
+    SkPictureStreamPlayer(SkStream*, const SkDeserialProcs&, uint32_t version,
+                          const SkRect& cullRect, int retainedResources);
+
+    bool readChunk();
+    bool readFactories();
+    bool readTypefaces(uint32_t count);
+    bool readResources(uint32_t size);
+
+    SkStream* fStream;
+    const SkDeserialProcs fProcs;
+    const SkRect fCullRect;
+    const int fRetainedResources;
+    std::unique_ptr<SkPictureData> fData;
+    // The images and pictures before these have been released. Their slots are left empty, as
+    // the ops refer to them by index.
+    int fImagesReleased = 0;
+    int fPicturesReleased = 0;
+    skia_private::TArray<SkFlattenable::Factory> fFactories;
+    skia_private::TArray<sk_sp<SkTypeface>> fTypefaces;
+};
+
+#endif
@@ -10,22 +10,25 @@
 
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkRect.h"
+#include "src/base/SkMathPriv.h"
+#include "src/base/SkVx.h"
+
+#include <cstddef>
+#include <vector>
 
 /**
  * An R-Tree implementation. In short, it is a balanced n-ary tree containing a hierarchy of
  * bounding rectangles.
  *
- * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles.
- * This performs a bottom-up bulk load using the STR (sort-tile-recursive) algorithm.
- *
- * TODO: Experiment with other bulk-load algorithms (in particular the Hilbert pack variant,
- * which groups rects by position on the Hilbert curve, is probably worth a look). There also
- * exist top-down bulk load variants (VAMSplit, TopDownGreedy, etc).
- *
- * For more details see:
+ * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles. The tree is
+ * packed bottom-up: each node has kFanout children, except for the last node of each level, and
+ * the nodes are stored level by level in one array. Each node stores its children's bounds side by
+ * side, so a query tests several children against the query rect at once.
  *
- *  Beckmann, N.; Kriegel, H. P.; Schneider, R.; Seeger, B. (1990). "The R*-tree:
- *      an efficient and robust access method for points and rectangles"
+ * The leaves are kept in the order they were inserted, so that searches find the bounding boxes
+ * in that order, which is the order a picture's ops need to be drawn in. Sorting them along a
+ * space filling curve (e.g. Hilbert or STR packing) would make tighter nodes when the bounds
+ * aren't given in a reasonable x,y order, but every search would then have to sort its results.
  */
 class SkRTree : public SkBBoxHierarchy {
 public:
@@ -35,47 +38,75 @@ public:
     void search(const SkRect& query, std::vector<int>* results) const override;
     size_t bytesUsed() const override;
 
+    // Calls fn(int index) for each bounding box intersecting query, in increasing index order,
+    // without collecting them into a vector first.
+    template <typename Fn>
+    void visit(const SkRect& query, Fn&& fn) const {
+        if (fCount > 0 && query.fLeft < query.fRight && query.fTop < query.fBottom) {
+            this->visit(fRoot, fDepth - 1, query, fn);
+        }
+    }
+
     // Methods and constants below here are only public for tests.
 
     // Return the depth of the tree structure.
-    int getDepth() const { return fCount ? fRoot.fSubtree->fLevel + 1 : 0; }
+    int getDepth() const { return fDepth; }
     // Insertion count (not overall node count, which may be greater).
     int getCount() const { return fCount; }
 
-    // These values were empirically determined to produce reasonable performance in most cases.
-    static const int kMinChildren = 6,
-                     kMaxChildren = 11;
+    // The number of children of each node.
+    static constexpr int kFanout = 8;
 
 private:
-    struct Node;
-
-    struct Branch {
-        union {
-            Node* fSubtree;
-            int fOpIndex;
-        };
-        SkRect fBounds;
-    };
-
+    // The children are tested four at a time, which is as wide as SSE and NEON registers.
+    static constexpr int kLanes = 4;
+    static_assert(kFanout % kLanes == 0);
+    using Lanes = skvx::Vec<kLanes, float>;
+    using Mask  = skvx::Vec<kLanes, int32_t>;
+
+    // The bounds of each child are stored by side, so that a side of all of them can be loaded
+    // at once. Unused children have inverted infinite bounds, which never intersect anything.
     struct Node {
-        uint16_t fNumChildren;
-        uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
+        float fLeft[kFanout];
+        float fTop[kFanout];
+        float fRight[kFanout];
+        float fBottom[kFanout];
+        // Indices of bounding boxes for the leaves, and of nodes for the rest.
+        int   fChildren[kFanout];
     };
 
-    void search(Node* root, const SkRect& query, std::vector<int>* results) const;
-
-    // Consumes the input array.
-    Branch bulkLoad(std::vector<Branch>* branches, int level = 0);
-
-    // How many times will bulkLoad() call allocateNodeAtLevel()?
-    static int CountNodes(int branches);
-
-    Node* allocateNodeAtLevel(uint16_t level);
+    template <typename Fn>
+    void visit(int nodeIndex, int level, const SkRect& query, Fn& fn) const {
+        const Node& node = fNodes[nodeIndex];
+        // One bit for each child that intersects the query, by the same test as
+        // SkRect::Intersects(), given that neither rect is empty.
+        int mask = 0;
+        for (int i = 0; i < kFanout; i += kLanes) {
+            const Mask hits = (Lanes::Load(node.fLeft   + i) < query.fRight ) &
+                              (Lanes::Load(node.fTop    + i) < query.fBottom) &
+                              (Lanes::Load(node.fRight  + i) > query.fLeft  ) &
+                              (Lanes::Load(node.fBottom + i) > query.fTop   );
+            if (any(hits)) {
+                for (int lane = 0; lane < kLanes; ++lane) {
+                    mask |= (hits[lane] & 1) << (i + lane);
+                }
+            }
+        }
+        for (; mask; mask &= mask - 1) {
+            const int child = node.fChildren[SkCTZ(mask)];
+            if (level == 0) {
+                fn(child);
+            } else {
+                this->visit(child, level - 1, query, fn);
+            }
+        }
+    }
 
     // This is the count of data elements (rather than total nodes in the tree)
     int fCount;
-    Branch fRoot;
+    int fDepth;
+    int fRoot;
+    // The leaves first, then each level above them, and the root last.
     std::vector<Node> fNodes;
 };
 
@@ -7,6 +7,7 @@
 
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkPath.h"
+#include "src/core/SkAAClipCache.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkRegionPriv.h"
 
@@ -78,6 +79,40 @@ SkRasterClip::SkRasterClip(const SkPath& path, const SkIRect& bounds, bool doAA)
     SkDEBUGCODE(this->validate();)
 }
 
+// Sets aa to the path mapped by matrix and clipped to bounds. Complex paths that are clipped to
+// again and again (e.g. every frame) are looked up in, and added to, the SkAAClipCache.
+// Note that bounds is a copy: it's often our own clip's bounds, which setPath() changes.
+static void set_aa_path(SkAAClip* aa, const SkPath& path, const SkMatrix& matrix,
+                        const SkIRect bounds, bool doAA) {
+    const bool cacheable = SkAAClipCache::ShouldCache(path, matrix);
+    if (cacheable && SkAAClipCache::Find(path, matrix, bounds, doAA, aa)) {
+        return;
+    }
+
+    SkPath devPath;
+    path.transform(matrix, &devPath);
+    aa->setPath(devPath, bounds, doAA);
+    if (cacheable) {
+        SkAAClipCache::Add(path, matrix, bounds, doAA, *aa);
+    }
+}
+
+SkRasterClip::SkRasterClip(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds,
+                           bool doAA) {
+    if (doAA) {
+        fIsBW = false;
+        set_aa_path(&fAA, path, matrix, bounds, true);
+    } else {
+        fIsBW = true;
+        SkPath devPath;
+        path.transform(matrix, &devPath);
+        fBW.setPath(devPath, SkRegion(bounds));
+    }
+    fIsEmpty = this->computeIsEmpty();  // bounds might be empty, so compute
+    fIsRect = this->computeIsRect();
+    SkDEBUGCODE(this->validate();)
+}
+
 SkRasterClip::~SkRasterClip() {
     SkDEBUGCODE(this->validate();)
 }
@@ -178,9 +213,6 @@ bool SkRasterClip::op(const SkRRect& rrect, const SkMatrix& matrix, SkClipOp op,
 bool SkRasterClip::op(const SkPath& path, const SkMatrix& matrix, SkClipOp op, bool doAA) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
-    SkPath devPath;
-    path.transform(matrix, &devPath);
-
     // Since op is either intersect or difference, the clip is always shrinking; that means we can
     // always use our current bounds as the limiting factor for region/aaclip operations.
     if (this->isRect() && op == SkClipOp::kIntersect) {
@@ -191,13 +223,15 @@ bool SkRasterClip::op(const SkPath& path, const SkMatrix& matrix, SkClipOp op, b
             this->convertToAA();
         }
         if (fIsBW) {
+            SkPath devPath;
+            path.transform(matrix, &devPath);
             fBW.setPath(devPath, SkRegion(this->getBounds()));
         } else {
-            fAA.setPath(devPath, this->getBounds(), doAA);
+            set_aa_path(&fAA, path, matrix, this->getBounds(), doAA);
         }
         return this->updateCacheAndReturnNonEmpty();
     } else {
-        return this->op(SkRasterClip(devPath, this->getBounds(), doAA), op);
+        return this->op(SkRasterClip(path, matrix, this->getBounds(), doAA), op);
     }
 }
 
@@ -97,6 +97,9 @@ private:
     // if present, this augments the clip, not replaces it
     sk_sp<SkShader> fShader;
 
+    // Like SkRasterClip(devPath, bounds, doAA), but may reuse a cached AA clip for the path.
+    SkRasterClip(const SkPath& path, const SkMatrix& matrix, const SkIRect& bounds, bool doAA);
+
     bool computeIsEmpty() const {
         return fIsBW ? fBW.isEmpty() : fAA.isEmpty();
     }
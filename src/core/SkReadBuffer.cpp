@@ -392,41 +392,51 @@ static sk_sp<SkImage> add_mipmaps(sk_sp<SkImage> img, sk_sp<SkData> data,
 // If we see a corrupt stream, we return null (fail). If we just fail trying to decode
 // the image, we don't fail, but return a 1x1 empty image.
 sk_sp<SkImage> SkReadBuffer::readImage() {
-    uint32_t flags = this->read32();
-
-    std::optional<SkAlphaType> alphaType = std::nullopt;
-    if (flags & SkWriteBufferImageFlags::kUnpremul) {
-        alphaType = kUnpremul_SkAlphaType;
+    EncodedImage encoded;
+    if (!this->readEncodedImage(&encoded)) {
+        return nullptr;
     }
-    sk_sp<SkImage> image;
-    {
-        sk_sp<SkData> data = this->readByteArrayAsData();
-        if (!data) {
-            this->validate(false);
-            return nullptr;
-        }
-        image = deserialize_image(data, fProcs, alphaType);
+    return DecodeImage(encoded, fProcs);
+}
+
+bool SkReadBuffer::readEncodedImage(EncodedImage* encoded) {
+    encoded->fFlags = this->read32();
+
+    encoded->fData = this->readByteArrayAsData();
+    if (!encoded->fData) {
+        this->validate(false);
+        return false;
     }
 
     // This flag is not written by new SKPs anymore.
-    if (flags & SkWriteBufferImageFlags::kHasSubsetRect) {
-        SkIRect subset;
-        this->readIRect(&subset);
-        if (image) {
-            image = image->makeSubset(nullptr, subset);
-        }
+    if (encoded->fFlags & SkWriteBufferImageFlags::kHasSubsetRect) {
+        this->readIRect(&encoded->fSubset);
     }
 
-    if (flags & SkWriteBufferImageFlags::kHasMipmap) {
-        sk_sp<SkData> data = this->readByteArrayAsData();
-        if (!data) {
+    if (encoded->fFlags & SkWriteBufferImageFlags::kHasMipmap) {
+        encoded->fMipmaps = this->readByteArrayAsData();
+        if (!encoded->fMipmaps) {
             this->validate(false);
-            return nullptr;
-        }
-        if (image) {
-            image = add_mipmaps(image, data, fProcs, alphaType);
+            return false;
         }
     }
+    return this->isValid();
+}
+
+sk_sp<SkImage> SkReadBuffer::DecodeImage(const EncodedImage& encoded,
+                                         const SkDeserialProcs& procs) {
+    std::optional<SkAlphaType> alphaType = std::nullopt;
+    if (encoded.fFlags & SkWriteBufferImageFlags::kUnpremul) {
+        alphaType = kUnpremul_SkAlphaType;
+    }
+    sk_sp<SkImage> image = deserialize_image(encoded.fData, procs, alphaType);
+
+    if (image && (encoded.fFlags & SkWriteBufferImageFlags::kHasSubsetRect)) {
+        image = image->makeSubset(nullptr, encoded.fSubset);
+    }
+    if (image && encoded.fMipmaps) {
+        image = add_mipmaps(image, encoded.fMipmaps, procs, alphaType);
+    }
     return image ? image : MakeEmptyImage(1, 1);
 }
 
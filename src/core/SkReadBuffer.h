@@ -10,6 +10,7 @@
 
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkData.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkPaint.h"
@@ -171,6 +172,17 @@ public:
     sk_sp<SkImage> readImage();
     sk_sp<SkTypeface> readTypeface();
 
+    // readImage() in two steps, so that the decoding can be done later or on another thread:
+    // readEncodedImage() returns false if the data is corrupt, and DecodeImage() never fails.
+    struct EncodedImage {
+        uint32_t fFlags = 0;
+        sk_sp<SkData> fData;
+        SkIRect fSubset = SkIRect::MakeEmpty();
+        sk_sp<SkData> fMipmaps;
+    };
+    bool readEncodedImage(EncodedImage*);
+    static sk_sp<SkImage> DecodeImage(const EncodedImage&, const SkDeserialProcs&);
+
     void setTypefaceArray(sk_sp<SkTypeface> array[], int count) {
         fTFArray = array;
         fTFCount = count;
@@ -6,6 +6,8 @@
  */
 
 #include "include/core/SkImage.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkPaintPriv.h"
 #include "src/core/SkRecord.h"
 #include <algorithm>
 
@@ -14,6 +16,43 @@ SkRecord::~SkRecord() {
     for (int i = 0; i < this->count(); i++) {
         this->mutate(i, destroyer);
     }
+    // The interned paints are allocated without a destructor, as the table already knows them.
+    fPaints.foreach([](PaintEntry* entry) { entry->fValue->~SkPaint(); });
+}
+
+const SkPaint* SkRecord::intern(const SkPaint& paint) {
+    if (fLastPaint && *fLastPaint == paint) {
+        return fLastPaint;
+    }
+    if (!(paint == paint)) {
+        // A paint with a NaN isn't equal to any paint, not even itself, so it can't be shared.
+        fApproxBytesAllocated += sizeof(SkPaint);
+        return fAlloc.make<SkPaint>(paint);
+    }
+    const uint32_t hash = SkPaintPriv::Hash(paint);
+    if (const PaintEntry* found = fPaints.find({&paint, hash})) {
+        fLastPaint = found->fValue;
+    } else {
+        fLastPaint = new (this->alloc<SkPaint>()) SkPaint(paint);
+        fPaints.set({fLastPaint, hash});
+    }
+    return fLastPaint;
+}
+
+const SkRecords::TypedMatrix* SkRecord::intern(const SkMatrix& matrix) {
+    const SkRecords::TypedMatrix typed(matrix);
+    if (!(matrix == matrix)) {
+        return new (this->alloc<SkRecords::TypedMatrix>()) SkRecords::TypedMatrix(typed);
+    }
+    SkScalar values[9];
+    matrix.get9(values);
+    const uint32_t hash = SkChecksum::Hash32(values, sizeof(values));
+    if (const MatrixEntry* found = fMatrices.find({&typed, hash})) {
+        return found->fValue;
+    }
+    auto interned = new (this->alloc<SkRecords::TypedMatrix>()) SkRecords::TypedMatrix(typed);
+    fMatrices.set({interned, hash});
+    return interned;
 }
 
 void SkRecord::grow() {
@@ -23,7 +62,8 @@ void SkRecord::grow() {
 }
 
 size_t SkRecord::bytesUsed() const {
-    size_t bytes = fApproxBytesAllocated + sizeof(SkRecord);
+    size_t bytes = fApproxBytesAllocated + sizeof(SkRecord) +
+                   fPaints.approxBytesUsed() + fMatrices.approxBytesUsed();
     return bytes;
 }
 
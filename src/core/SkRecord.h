@@ -12,6 +12,7 @@
 #include "include/private/base/SkTemplates.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkTHash.h"
 
 // SkRecord represents a sequence of SkCanvas calls, saved for future use.
 // These future uses may include: replay, optimization, serialization, or combinations of those.
@@ -62,6 +63,11 @@ public:
         return (T*)fAlloc.makeArrayDefault<RawBytes>(count);
     }
 
+    // Returns a copy of paint or matrix to be shared by every op that records an equal one, so that
+    // each op only stores a pointer to it.  The copies are freed when the SkRecord is destroyed.
+    const SkPaint* intern(const SkPaint& paint);
+    const SkRecords::TypedMatrix* intern(const SkMatrix& matrix);
+
     // Add a new command of type T to the end of this SkRecord.
     // You are expected to placement new an object of type T onto this pointer.
     template <typename T>
@@ -126,6 +132,20 @@ private:
 
     void grow();
 
+    // An interned value and its hash, which is kept so the table doesn't hash values again as
+    // it grows.  These are their own keys, and a key looked up may point at any equal value.
+    template <typename T>
+    struct InternEntry {
+        const T* fValue;
+        uint32_t fHash;
+
+        bool operator==(const InternEntry& that) const {
+            return fHash == that.fHash && *fValue == *that.fValue;
+        }
+        static const InternEntry& GetKey(const InternEntry& entry) { return entry; }
+        static uint32_t Hash(const InternEntry& entry) { return entry.fHash; }
+    };
+
     // A typed pointer to some bytes in fAlloc.  visit() and mutate() allow polymorphic dispatch.
     struct Record {
         SkRecords::Type fType;
@@ -176,6 +196,14 @@ private:
     // chunks, returning a stable handle to that data for later retrieval.
     SkArenaAlloc fAlloc{256};
     size_t       fApproxBytesAllocated{0};
+
+    // The values returned by intern(), which live in fAlloc.  Runs of draws often use the same
+    // paint, so the last one is checked before the table.
+    using PaintEntry = InternEntry<SkPaint>;
+    using MatrixEntry = InternEntry<SkRecords::TypedMatrix>;
+    skia_private::THashTable<PaintEntry, PaintEntry, PaintEntry> fPaints;
+    skia_private::THashTable<MatrixEntry, MatrixEntry, MatrixEntry> fMatrices;
+    const SkPaint* fLastPaint{nullptr};
 };
 
 #endif//SkRecord_DEFINED
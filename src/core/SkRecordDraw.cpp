@@ -79,7 +79,7 @@ template <> void Draw::draw(const SaveBehind& r) {
 }
 
 template <> void Draw::draw(const DrawBehind& r) {
-    SkCanvasPriv::DrawBehind(fCanvas, r.paint);
+    SkCanvasPriv::DrawBehind(fCanvas, *r.paint);
 }
 
 DRAW(SetMatrix, setMatrix(fInitialCTM.asM33() * r.matrix))
@@ -99,8 +99,8 @@ template <> void Draw::draw(const ResetClip& r) {
     SkCanvasPriv::ResetClip(fCanvas);
 }
 
-DRAW(DrawArc, drawArc(r.oval, r.startAngle, r.sweepAngle, r.useCenter, r.paint))
-DRAW(DrawDRRect, drawDRRect(r.outer, r.inner, r.paint))
+DRAW(DrawArc, drawArc(r.oval, r.startAngle, r.sweepAngle, r.useCenter, *r.paint))
+DRAW(DrawDRRect, drawDRRect(r.outer, r.inner, *r.paint))
 DRAW(DrawImage, drawImage(r.image.get(), r.left, r.top, r.sampling, r.paint))
 
 template <> void Draw::draw(const DrawImageLattice& r) {
@@ -116,16 +116,16 @@ template <> void Draw::draw(const DrawImageLattice& r) {
 }
 
 DRAW(DrawImageRect, drawImageRect(r.image.get(), r.src, r.dst, r.sampling, r.paint, r.constraint))
-DRAW(DrawOval, drawOval(r.oval, r.paint))
-DRAW(DrawPaint, drawPaint(r.paint))
-DRAW(DrawPath, drawPath(r.path, r.paint))
-DRAW(DrawPatch, drawPatch(r.cubics, r.colors, r.texCoords, r.bmode, r.paint))
+DRAW(DrawOval, drawOval(r.oval, *r.paint))
+DRAW(DrawPaint, drawPaint(*r.paint))
+DRAW(DrawPath, drawPath(r.path, *r.paint))
+DRAW(DrawPatch, drawPatch(r.cubics, r.colors, r.texCoords, r.bmode, *r.paint))
 DRAW(DrawPicture, drawPicture(r.picture.get(), &r.matrix, r.paint))
-DRAW(DrawPoints, drawPoints(r.mode, r.count, r.pts, r.paint))
-DRAW(DrawRRect, drawRRect(r.rrect, r.paint))
-DRAW(DrawRect, drawRect(r.rect, r.paint))
-DRAW(DrawRegion, drawRegion(r.region, r.paint))
-DRAW(DrawTextBlob, drawTextBlob(r.blob.get(), r.x, r.y, r.paint))
+DRAW(DrawPoints, drawPoints(r.mode, r.count, r.pts, *r.paint))
+DRAW(DrawRRect, drawRRect(r.rrect, *r.paint))
+DRAW(DrawRect, drawRect(r.rect, *r.paint))
+DRAW(DrawRegion, drawRegion(r.region, *r.paint))
+DRAW(DrawTextBlob, drawTextBlob(r.blob.get(), r.x, r.y, *r.paint))
 #if defined(SK_GANESH)
 DRAW(DrawSlug, drawSlug(r.slug.get()))
 #else
@@ -134,9 +134,9 @@ template <> void Draw::draw(const DrawSlug&) {}
 #endif
 DRAW(DrawAtlas, drawAtlas(r.atlas.get(), r.xforms, r.texs, r.colors, r.count, r.mode, r.sampling,
                           r.cull, r.paint))
-DRAW(DrawVertices, drawVertices(r.vertices, r.bmode, r.paint))
+DRAW(DrawVertices, drawVertices(r.vertices, r.bmode, *r.paint))
 #ifdef SK_ENABLE_SKSL
-DRAW(DrawMesh, drawMesh(r.mesh, r.blender, r.paint))
+DRAW(DrawMesh, drawMesh(r.mesh, r.blender, *r.paint))
 #else
 // Turn draw into a nop.
 template <> void Draw::draw(const DrawMesh&) {}
@@ -180,17 +180,24 @@ template <> void Draw::draw(const DrawDrawable& r) {
 // the block, and control ops are stashed away for later.  When we finish the
 // block with a Restore, our bounds are complete, and we go back and fill them
 // in for all the control ops we stashed away.
+//
+// Exact bounds adjust each drawing op for the paints of all the SaveLayers it's inside, which
+// takes mapping it through every Save block's matrix and back.  Approximate bounds leave drawing
+// ops alone, and adjust the bounds of each SaveLayer block once for its paint when it's restored.
+// Every op inside a layer whose paint moves pixels is then given the bounds of the outermost such
+// layer, the area that all of its ops can draw to.
 class FillBounds : SkNoncopyable {
 public:
     FillBounds(const SkRect& cullRect, const SkRecord& record,
-               SkRect bounds[], SkBBoxHierarchy::Metadata meta[])
+               SkRect bounds[], SkBBoxHierarchy::Metadata meta[], bool approximate = false)
         : fCullRect(cullRect)
         , fBounds(bounds)
-        , fMeta(meta) {
+        , fMeta(meta)
+        , fApproximate(approximate) {
         fCTM = SkMatrix::I();
 
         // We push an extra save block to track the bounds of any top-level control operations.
-        fSaveStack.push_back({ 0, Bounds::MakeEmpty(), nullptr, fCTM });
+        fSaveStack.push_back({ 0, Bounds::MakeEmpty(), nullptr, fCTM, 0, false });
     }
 
     ~FillBounds() {
@@ -229,7 +236,7 @@ public:
         }
 
         // Adjust rect for all the paints from the SaveLayers we're inside.
-        if (!this->adjustForSaveLayerPaints(&rect)) {
+        if (!fApproximate && !this->adjustForSaveLayerPaints(&rect)) {
             // Same deal as above.
             return fCullRect;
         }
@@ -251,11 +258,13 @@ private:
         Bounds bounds;         // Bounds of everything in the block.
         const SkPaint* paint;  // Unowned.  If set, adjusts the bounds of all ops in this block.
         SkMatrix ctm;
+        int firstOp;           // The Save that starts this block.
+        bool movesPixels;      // Approximate bounds only: paint draws pixels somewhere else.
     };
 
     // Only Restore, SetMatrix, Concat, and Translate change the CTM.
     template <typename T> void updateCTM(const T&) {}
-    void updateCTM(const Restore& op)   { fCTM = op.matrix; }
+    void updateCTM(const Restore& op)   { fCTM = *op.matrix; }
     void updateCTM(const SetMatrix& op) { fCTM = op.matrix; }
     void updateCTM(const SetM44& op)    { fCTM = op.matrix.asM33(); }
     void updateCTM(const Concat44& op)  { fCTM.preConcat(op.matrix.asM33()); }
@@ -305,6 +314,9 @@ private:
             PaintMayAffectTransparentBlack(paint) ? fCullRect : Bounds::MakeEmpty();
         sb.paint = paint;
         sb.ctm = this->fCTM;
+        sb.firstOp = fCurrentOp;
+        sb.movesPixels = fApproximate && PaintMayMovePixels(paint);
+        fMovingLayers += sb.movesPixels;
 
         fSaveStack.push_back(sb);
         this->pushControl();
@@ -349,11 +361,35 @@ private:
         return false;
     }
 
+    // Whether a SaveLayer's paint can draw the layer's pixels outside of where they were drawn.
+    static bool PaintMayMovePixels(const SkPaint* paint) {
+        return paint && (paint->getImageFilter() || paint->getMaskFilter() ||
+                         paint->getPathEffect() || paint->getStyle() != SkPaint::kFill_Style);
+    }
+
     Bounds popSaveBlock() {
         // We're done the Save block.  Apply the block's bounds to all control ops inside it.
         SaveBounds sb = fSaveStack.back();
         fSaveStack.pop_back();
 
+        if (sb.movesPixels) {
+            // The ops inside weren't adjusted for this layer's paint, so adjust what they draw.
+            SkMatrix inverse;
+            if (!sb.ctm.invert(&inverse)) {
+                sb.bounds = fCullRect;
+            } else {
+                inverse.mapRect(&sb.bounds);
+                if (!AdjustForPaint(sb.paint, &sb.bounds)) {
+                    sb.bounds = fCullRect;
+                } else {
+                    sb.ctm.mapRect(&sb.bounds);
+                    if (!sb.bounds.intersect(fCullRect)) {
+                        sb.bounds = Bounds::MakeEmpty();
+                    }
+                }
+            }
+        }
+
         while (sb.controlOps --> 0) {
             this->popControl(sb.bounds);
         }
@@ -361,6 +397,13 @@ private:
         // This whole Save block may be part another Save block.
         this->updateSaveBounds(sb.bounds);
 
+        if (sb.movesPixels && --fMovingLayers == 0) {
+            // Any op inside the outermost of these layers may draw anywhere the layer does.
+            for (int i = sb.firstOp; i <= fCurrentOp; i++) {
+                fBounds[i] = sb.bounds;
+            }
+        }
+
         // If called from a real Restore (not a phony one for balance), it'll need the bounds.
         return sb.bounds;
     }
@@ -391,19 +434,19 @@ private:
     Bounds bounds(const DrawBehind&) const { return fCullRect; }
     Bounds bounds(const NoOp&)  const { return Bounds::MakeEmpty(); }    // NoOps don't draw.
 
-    Bounds bounds(const DrawRect& op) const { return this->adjustAndMap(op.rect, &op.paint); }
+    Bounds bounds(const DrawRect& op) const { return this->adjustAndMap(op.rect, op.paint); }
     Bounds bounds(const DrawRegion& op) const {
         SkRect rect = SkRect::Make(op.region.getBounds());
-        return this->adjustAndMap(rect, &op.paint);
+        return this->adjustAndMap(rect, op.paint);
     }
-    Bounds bounds(const DrawOval& op) const { return this->adjustAndMap(op.oval, &op.paint); }
+    Bounds bounds(const DrawOval& op) const { return this->adjustAndMap(op.oval, op.paint); }
     // Tighter arc bounds?
-    Bounds bounds(const DrawArc& op) const { return this->adjustAndMap(op.oval, &op.paint); }
+    Bounds bounds(const DrawArc& op) const { return this->adjustAndMap(op.oval, op.paint); }
     Bounds bounds(const DrawRRect& op) const {
-        return this->adjustAndMap(op.rrect.rect(), &op.paint);
+        return this->adjustAndMap(op.rrect.rect(), op.paint);
     }
     Bounds bounds(const DrawDRRect& op) const {
-        return this->adjustAndMap(op.outer.rect(), &op.paint);
+        return this->adjustAndMap(op.outer.rect(), op.paint);
     }
     Bounds bounds(const DrawImage& op) const {
         const SkImage* image = op.image.get();
@@ -419,29 +462,29 @@ private:
     }
     Bounds bounds(const DrawPath& op) const {
         return op.path.isInverseFillType() ? fCullRect
-                                           : this->adjustAndMap(op.path.getBounds(), &op.paint);
+                                           : this->adjustAndMap(op.path.getBounds(), op.paint);
     }
     Bounds bounds(const DrawPoints& op) const {
         SkRect dst;
         dst.setBounds(op.pts, op.count);
 
         // Pad the bounding box a little to make sure hairline points' bounds aren't empty.
-        SkScalar stroke = std::max(op.paint.getStrokeWidth(), 0.01f);
+        SkScalar stroke = std::max(op.paint->getStrokeWidth(), 0.01f);
         dst.outset(stroke/2, stroke/2);
 
-        return this->adjustAndMap(dst, &op.paint);
+        return this->adjustAndMap(dst, op.paint);
     }
     Bounds bounds(const DrawPatch& op) const {
         SkRect dst;
         dst.setBounds(op.cubics, SkPatchUtils::kNumCtrlPts);
-        return this->adjustAndMap(dst, &op.paint);
+        return this->adjustAndMap(dst, op.paint);
     }
     Bounds bounds(const DrawVertices& op) const {
-        return this->adjustAndMap(op.vertices->bounds(), &op.paint);
+        return this->adjustAndMap(op.vertices->bounds(), op.paint);
     }
     Bounds bounds(const DrawMesh& op) const {
 #ifdef SK_ENABLE_SKSL
-        return this->adjustAndMap(op.mesh.bounds(), &op.paint);
+        return this->adjustAndMap(op.mesh.bounds(), op.paint);
 #else
         return SkRect::MakeEmpty();
 #endif
@@ -471,7 +514,7 @@ private:
     Bounds bounds(const DrawTextBlob& op) const {
         SkRect dst = op.blob->bounds();
         dst.offset(op.x, op.y);
-        return this->adjustAndMap(dst, &op.paint);
+        return this->adjustAndMap(dst, op.paint);
     }
 
 #if defined(SK_GANESH)
@@ -553,6 +596,10 @@ private:
     // Parallel array to fBounds, holding metadata for each bounds rect.
     SkBBoxHierarchy::Metadata* fMeta;
 
+    // Whether to compute approximate bounds, and how many layers that move pixels we're inside.
+    const bool fApproximate;
+    int fMovingLayers = 0;
+
     // We walk fCurrentOp through the SkRecord,
     // as we go using updateCTM() to maintain the exact CTM (fCTM).
     int fCurrentOp;
@@ -575,3 +622,12 @@ void SkRecordFillBounds(const SkRect& cullRect, const SkRecord& record,
         }
     }
 }
+
+void SkRecordFillApproximateBounds(const SkRect& cullRect, const SkRecord& record,
+                                   SkRect bounds[], SkBBoxHierarchy::Metadata meta[]) {
+    SkRecords::FillBounds visitor(cullRect, record, bounds, meta, /*approximate=*/true);
+    for (int i = 0; i < record.count(); i++) {
+        visitor.setCurrentOp(i);
+        record.visit(i, visitor);
+    }
+}
@@ -21,6 +21,12 @@ class SkLayerInfo;
 void SkRecordFillBounds(const SkRect& cullRect, const SkRecord&,
                         SkRect bounds[], SkBBoxHierarchy::Metadata[]);
 
+// Like SkRecordFillBounds, but quicker and looser: ops aren't adjusted for the paints of the layers
+// they're inside, and all ops inside a layer whose paint moves pixels, e.g. with an image filter,
+// are bounded by what that layer draws.
+void SkRecordFillApproximateBounds(const SkRect& cullRect, const SkRecord&,
+                                   SkRect bounds[], SkBBoxHierarchy::Metadata[]);
+
 // Draw an SkRecord into an SkCanvas.  A convenience wrapper around SkRecords::Draw.
 void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePicts[],
                   SkDrawable* const drawables[], int drawableCount,
@@ -7,11 +7,20 @@
 
 #include "src/core/SkRecordOpts.h"
 
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTDArray.h"
+#include "include/private/base/SkTemplates.h"
 #include "src/core/SkCanvasPriv.h"
+#include "src/core/SkPaintPriv.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
 
+#include <new>
+
 using namespace SkRecords;
 
 // Most of the optimizations in this file are pattern-based.  These are all defined as structs with:
@@ -191,10 +200,10 @@ struct SaveLayerDrawRestoreNooper {
         }
 
         // A SaveLayer's bounds field is just a hint, so we should be free to ignore it.
-        SkPaint* layerPaint = match->first<SaveLayer>()->paint;
-        SkPaint* drawPaint = match->second<SkPaint>();
+        const SkPaint* layerPaint = match->first<SaveLayer>()->paint;
+        Interned<SkPaint>* drawPaint = match->second<Interned<SkPaint>>();
 
-        if (nullptr == layerPaint && effectively_srcover(drawPaint)) {
+        if (nullptr == layerPaint && effectively_srcover(drawPaint ? *drawPaint : nullptr)) {
             // There wasn't really any point to this SaveLayer at all.
             return KillSaveLayerAndRestore(record, begin);
         }
@@ -205,9 +214,11 @@ struct SaveLayerDrawRestoreNooper {
             return false;
         }
 
-        if (!fold_opacity_layer_color_to_paint(layerPaint, false /*isSaveLayer*/, drawPaint)) {
+        SkPaint folded = **drawPaint;
+        if (!fold_opacity_layer_color_to_paint(layerPaint, false /*isSaveLayer*/, &folded)) {
             return false;
         }
+        *drawPaint = record->intern(folded);
 
         return KillSaveLayerAndRestore(record, begin);
     }
@@ -243,7 +254,7 @@ struct SvgOpacityAndFilterLayerMergePass {
             return false;
         }
 
-        SkPaint* opacityPaint = match->first<SaveLayer>()->paint;
+        const SkPaint* opacityPaint = match->first<SaveLayer>()->paint;
         if (nullptr == opacityPaint) {
             // There wasn't really any point to this SaveLayer at all.
             return KillSaveLayerAndRestore(record, begin);
@@ -251,17 +262,19 @@ struct SvgOpacityAndFilterLayerMergePass {
 
         // This layer typically contains a filter, but this should work for layers with for other
         // purposes too.
-        SkPaint* filterLayerPaint = match->fourth<SaveLayer>()->paint;
-        if (filterLayerPaint == nullptr) {
+        SaveLayer* filterLayer = match->fourth<SaveLayer>();
+        if (filterLayer->paint == nullptr) {
             // We can just give the inner SaveLayer the paint of the outer SaveLayer.
             // TODO(mtklein): figure out how to do this clearly
             return false;
         }
 
+        SkPaint filterLayerPaint = *filterLayer->paint;
         if (!fold_opacity_layer_color_to_paint(opacityPaint, true /*isSaveLayer*/,
-                                               filterLayerPaint)) {
+                                               &filterLayerPaint)) {
             return false;
         }
+        filterLayer->paint = record->intern(filterLayerPaint);
 
         return KillSaveLayerAndRestore(record, begin);
     }
@@ -280,6 +293,304 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+using IsMatrixOp = Or<Is<SetMatrix>, Is<SetM44>, Is<Concat>, Is<Concat44>, Is<Scale>, Is<Translate>>;
+using IsClipOp = Or<Is<ClipRect>, Is<ClipRRect>, Is<ClipPath>, Is<ClipRegion>, Is<ClipShader>,
+                    Is<ResetClip>>;
+
+// Turns the first of two matrix changes into a NoOp when the second replaces the matrix.
+struct OverwrittenMatrixNooper {
+    typedef Pattern<IsMatrixOp,
+                    Greedy<Is<NoOp>>,
+                    Or<Is<SetMatrix>, Is<SetM44>>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match*, int begin, int end) {
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+// Turns a matrix or clip change into a NoOp when the Restore right after it undoes it.
+struct RestoredStateNooper {
+    typedef Pattern<Or<IsMatrixOp, IsClipOp>,
+                    Greedy<Is<NoOp>>,
+                    Is<Restore>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match*, int begin, int end) {
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+// Of two intersecting ClipRects with the same matrix and anti-aliasing, turns the one that
+// contains the other into a NoOp.
+struct ContainingClipRectNooper {
+    typedef Pattern<Is<ClipRect>,
+                    Greedy<Is<NoOp>>,
+                    Is<ClipRect>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match* match, int begin, int end) {
+        const ClipRect* first = match->first<ClipRect>();
+        const ClipRect* second = match->third<ClipRect>();
+        if (first->opAA.op() != SkClipOp::kIntersect ||
+            second->opAA.op() != SkClipOp::kIntersect ||
+            first->opAA.aa() != second->opAA.aa()) {
+            return false;
+        }
+        if (second->rect.contains(first->rect)) {
+            record->replace<NoOp>(end-1);
+            return true;
+        }
+        if (first->rect.contains(second->rect)) {
+            record->replace<NoOp>(begin);
+            return true;
+        }
+        return false;
+    }
+};
+
+void SkRecordNoopRedundantState(SkRecord* record) {
+    OverwrittenMatrixNooper overwritten;
+    RestoredStateNooper restored;
+    ContainingClipRectNooper clipRects;
+
+    // Each NoOp can uncover another match, so run until they stop changing things.
+    while (apply(&overwritten, record) || apply(&restored, record) || apply(&clipRects, record));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Finds draws that are entirely covered by a later opaque draw under the same matrix and clip.
+// The matrix the picture is drawn with doesn't matter: what is inside of a rect stays inside of
+// it whatever the matrix. Neither of the draws may be anti-aliased, as an anti-aliased draw can
+// touch pixels whose centers are outside of its geometry, and a pixel is only covered by a draw
+// that isn't anti-aliased if its center is inside of it.
+class OccludedDrawNooper {
+public:
+    void run(SkRecord* record) {
+        // Walk back from the end, keeping the rects of the opaque draws seen since the last
+        // change of matrix or clip.
+        fOccluders.clear();
+        for (int i = record->count(); i-- > 0;) {
+            if (record->mutate(i, *this)) {
+                record->replace<NoOp>(i);
+            }
+        }
+    }
+
+    // Returns true if the op is occluded by a later one.
+    template <typename T>
+    bool operator()(T* op) {
+        if (!(T::kTags & kDraw_Tag)) {
+            // Save, Restore, matrix and clip changes, and annotations, which aren't draws.
+            fOccluders.clear();
+        }
+        return false;
+    }
+    bool operator()(NoOp*) { return false; }
+    // These can read pixels outside of their bounds, through backdrop filters.
+    bool operator()(DrawPicture*) { fOccluders.clear(); return false; }
+    bool operator()(DrawDrawable*) { fOccluders.clear(); return false; }
+    bool operator()(DrawBehind*) { fOccluders.clear(); return false; }
+
+    bool operator()(DrawRect* op) {
+        const SkRect rect = op->rect.makeSorted();
+        if (this->isOccluded(rect, op->paint)) {
+            return true;
+        }
+        if (op->paint->getStyle() == SkPaint::kFill_Style &&
+            is_opaque(op->paint, SkPaintPriv::kNone_ShaderOverrideOpacity)) {
+            this->addOccluder(rect);
+        }
+        return false;
+    }
+    bool operator()(DrawOval* op) { return this->isOccluded(op->oval.makeSorted(), op->paint); }
+    bool operator()(DrawArc* op) { return this->isOccluded(op->oval.makeSorted(), op->paint); }
+    bool operator()(DrawRRect* op) { return this->isOccluded(op->rrect.rect(), op->paint); }
+    bool operator()(DrawDRRect* op) { return this->isOccluded(op->outer.rect(), op->paint); }
+    bool operator()(DrawRegion* op) {
+        return this->isOccluded(SkRect::Make(op->region.getBounds()), op->paint);
+    }
+    bool operator()(DrawPath* op) {
+        return !op->path.isInverseFillType() &&
+               this->isOccluded(op->path.getBounds(), op->paint);
+    }
+
+    bool operator()(DrawImage* op) {
+        const SkRect dst = SkRect::MakeXYWH(op->left, op->top,
+                                            op->image->width(), op->image->height());
+        if (this->isImageOccluded(dst, op->paint)) {
+            return true;
+        }
+        if (op->image->isOpaque() &&
+            is_opaque(op->paint, SkPaintPriv::kOpaque_ShaderOverrideOpacity)) {
+            this->addOccluder(dst);
+        }
+        return false;
+    }
+    bool operator()(DrawImageRect* op) {
+        const SkRect dst = op->dst.makeSorted();
+        if (this->isImageOccluded(dst, op->paint)) {
+            return true;
+        }
+        // Where the src rect is outside of the image, the dst rect isn't drawn.
+        if (op->image->isOpaque() &&
+            SkRect::Make(op->image->bounds()).contains(op->src) &&
+            is_opaque(op->paint, SkPaintPriv::kOpaque_ShaderOverrideOpacity)) {
+            this->addOccluder(dst);
+        }
+        return false;
+    }
+
+private:
+    // More would find a few more occluded draws, for a lot more time spent looking.
+    static constexpr int kMaxOccluders = 4;
+
+    static bool has_no_effects(const SkPaint& paint) {
+        return !paint.isAntiAlias() &&
+               !paint.getMaskFilter() &&
+               !paint.getImageFilter() &&
+               !paint.getPathEffect();
+    }
+
+    static bool is_opaque(const SkPaint* paint, SkPaintPriv::ShaderOverrideOpacity opacity) {
+        return (!paint || has_no_effects(*paint)) && SkPaintPriv::Overwrites(paint, opacity);
+    }
+
+    bool isOccluded(const SkRect& rect, const SkPaint* paint) const {
+        if (fOccluders.empty() || (paint && !has_no_effects(*paint))) {
+            return false;
+        }
+        SkRect bounds = rect;
+        if (paint && paint->getStyle() != SkPaint::kFill_Style) {
+            if (paint->getStrokeWidth() == 0) {
+                // Hairlines can touch pixels whose centers are outside of their geometry.
+                return false;
+            }
+            bounds = paint->computeFastBounds(rect, &bounds);
+        }
+        for (const SkRect& occluder : fOccluders) {
+            if (occluder.contains(bounds)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isImageOccluded(const SkRect& dst, const SkPaint* paint) const {
+        // Images are always filled, whatever the style of their paint.
+        if (!paint) {
+            return this->isOccluded(dst, nullptr);
+        }
+        SkPaint fill = *paint;
+        fill.setStyle(SkPaint::kFill_Style);
+        return this->isOccluded(dst, &fill);
+    }
+
+    void addOccluder(const SkRect& rect) {
+        if (!rect.isFinite() || rect.isEmpty()) {
+            return;
+        }
+        if (fOccluders.size() < kMaxOccluders) {
+            fOccluders.push_back(rect);
+            return;
+        }
+        // Keep the largest ones.
+        SkRect* smallest = &fOccluders[0];
+        for (SkRect& occluder : fOccluders) {
+            if (occluder.width() * occluder.height() < smallest->width() * smallest->height()) {
+                smallest = &occluder;
+            }
+        }
+        if (rect.width() * rect.height() > smallest->width() * smallest->height()) {
+            *smallest = rect;
+        }
+    }
+
+    skia_private::STArray<kMaxOccluders, SkRect> fOccluders;
+};
+
+void SkRecordNoopOccludedDraws(SkRecord* record) {
+    OccludedDrawNooper pass;
+    pass.run(record);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A run of DrawImageRects is drawn the same as a DrawEdgeAAImageSet of their images, when they
+// have the same paint, sampling and constraint. The paint can't have an image filter, which
+// would be applied to the whole set rather than to each image.
+static bool can_batch_image_rects(const DrawImageRect& a, const DrawImageRect& b) {
+    if (a.sampling != b.sampling || a.constraint != b.constraint) {
+        return false;
+    }
+    if (!a.paint || !b.paint) {
+        return !a.paint && !b.paint;
+    }
+    return !a.paint->getImageFilter() && !a.paint->getMaskFilter() && *a.paint == *b.paint;
+}
+
+void SkRecordBatchImageRects(SkRecord* record) {
+    // The bounds of a set are those of all of its images, so a set that is too large is
+    // culled less well by a bounding box hierarchy.
+    static constexpr int kMaxSetCount = 16;
+
+    int i = 0;
+    while (i < record->count()) {
+        Is<DrawImageRect> first;
+        if (!record->mutate(i, first)) {
+            ++i;
+            continue;
+        }
+
+        // Find the ops of the run, skipping NoOps.
+        SkTDArray<int> run;
+        run.push_back(i);
+        int next = i + 1;
+        for (; next < record->count() && run.size() < kMaxSetCount; ++next) {
+            Is<NoOp> noop;
+            if (record->mutate(next, noop)) {
+                continue;
+            }
+            Is<DrawImageRect> draw;
+            if (!record->mutate(next, draw) || !can_batch_image_rects(*first.get(), *draw.get())) {
+                break;
+            }
+            run.push_back(next);
+        }
+        if (run.size() < 2) {
+            i = next;
+            continue;
+        }
+
+        const unsigned aaFlags = first.get()->paint && first.get()->paint->isAntiAlias()
+                                         ? SkCanvas::kAll_QuadAAFlags
+                                         : SkCanvas::kNone_QuadAAFlags;
+        skia_private::AutoTArray<SkCanvas::ImageSetEntry> set(run.size());
+        for (int j = 0; j < run.size(); ++j) {
+            Is<DrawImageRect> draw;
+            record->mutate(run[j], draw);
+            set[j] = SkCanvas::ImageSetEntry(draw.get()->image, draw.get()->src, draw.get()->dst,
+                                             /*alpha=*/1, aaFlags);
+        }
+        const SkPaint* paint = first.get()->paint;
+        const SkSamplingOptions sampling = first.get()->sampling;
+        const SkCanvas::SrcRectConstraint constraint = first.get()->constraint;
+        const int count = run.size();
+
+        for (int j = 1; j < run.size(); ++j) {
+            record->replace<NoOp>(run[j]);
+        }
+        new (record->replace<DrawEdgeAAImageSet>(i)) DrawEdgeAAImageSet{
+                paint, std::move(set), count, nullptr, nullptr, sampling, constraint};
+        i = next;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
@@ -290,6 +601,10 @@ void SkRecordOptimize(SkRecord* record) {
     //     https://bugs.chromium.org/p/skia/issues/detail?id=5548
 //    SkRecordNoopSaveRestores(record);
 
+    // These only turn ops into NoOps, and don't touch Save or Restore.
+    SkRecordNoopRedundantState(record);
+    SkRecordNoopOccludedDraws(record);
+
     // Turn off this optimization completely for Android framework
     // because it makes the following Android CTS test fail:
     // android.uirendering.cts.testclasses.LayerTests#testSaveLayerClippedWithAlpha
@@ -297,6 +612,7 @@ void SkRecordOptimize(SkRecord* record) {
     SkRecordNoopSaveLayerDrawRestores(record);
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
+    SkRecordBatchImageRects(record);
 
     record->defrag();
 }
@@ -26,6 +26,19 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// Turns matrix and clip changes that no draw sees into no-ops: those replaced by a later
+// SetMatrix or undone by a Restore before anything uses them, and intersecting ClipRects that
+// contain another one with the same matrix.
+void SkRecordNoopRedundantState(SkRecord*);
+
+// Turns draws that are entirely covered by a later opaque draw, with no change of matrix or clip
+// in between, into no-ops.
+void SkRecordNoopOccludedDraws(SkRecord*);
+
+// Merges runs of DrawImageRects with the same paint, sampling and constraint into
+// DrawEdgeAAImageSets, which some backends draw as a single batch.
+void SkRecordBatchImageRects(SkRecord*);
+
 // Experimental optimizers
 void SkRecordOptimize2(SkRecord*);
 
@@ -40,18 +40,19 @@ private:
     type* fPtr;
 };
 
-// Matches any command that draws, and stores its paint.
+// Matches any command that draws, and stores its paint if it has one.  The paint is interned, so
+// it's changed by interning a new paint into the command.
 class IsDraw {
 public:
     IsDraw() : fPaint(nullptr) {}
 
-    typedef SkPaint type;
+    typedef Interned<SkPaint> type;
     type* get() { return fPaint; }
 
     template <typename T>
     std::enable_if_t<(T::kTags & kDrawWithPaint_Tag) == kDrawWithPaint_Tag, bool>
     operator()(T* draw) {
-        fPaint = AsPtr(draw->paint);
+        fPaint = draw->paint ? &draw->paint : nullptr;
         return true;
     }
 
@@ -68,10 +69,6 @@ public:
     }
 
 private:
-    // Abstracts away whether the paint is always part of the command or optional.
-    template <typename T> static T* AsPtr(SkRecords::Optional<T>& x) { return x; }
-    template <typename T> static T* AsPtr(T& x) { return &x; }
-
     type* fPaint;
 };
 
@@ -140,6 +140,15 @@ T* SkRecorder::copy(const T* src) {
     return new (fRecord->alloc<T>()) T(*src);
 }
 
+// Paints are interned by fRecord rather than copied into each op.  Optional ones stay nullptr.
+const SkPaint* SkRecorder::intern(const SkPaint& paint) {
+    return fRecord->intern(paint);
+}
+
+const SkPaint* SkRecorder::intern(const SkPaint* paint) {
+    return paint ? fRecord->intern(*paint) : nullptr;
+}
+
 // This copy() is for arrays.
 // It will work with POD or non-POD, though currently we only use it for POD.
 template <typename T>
@@ -174,43 +183,44 @@ char* SkRecorder::copy(const char* src) {
 }
 
 void SkRecorder::onDrawPaint(const SkPaint& paint) {
-    this->append<SkRecords::DrawPaint>(paint);
+    this->append<SkRecords::DrawPaint>(this->intern(paint));
 }
 
 void SkRecorder::onDrawBehind(const SkPaint& paint) {
-    this->append<SkRecords::DrawBehind>(paint);
+    this->append<SkRecords::DrawBehind>(this->intern(paint));
 }
 
 void SkRecorder::onDrawPoints(PointMode mode,
                               size_t count,
                               const SkPoint pts[],
                               const SkPaint& paint) {
-    this->append<SkRecords::DrawPoints>(paint, mode, SkToUInt(count), this->copy(pts, count));
+    this->append<SkRecords::DrawPoints>(
+            this->intern(paint), mode, SkToUInt(count), this->copy(pts, count));
 }
 
 void SkRecorder::onDrawRect(const SkRect& rect, const SkPaint& paint) {
-    this->append<SkRecords::DrawRect>(paint, rect);
+    this->append<SkRecords::DrawRect>(this->intern(paint), rect);
 }
 
 void SkRecorder::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
-    this->append<SkRecords::DrawRegion>(paint, region);
+    this->append<SkRecords::DrawRegion>(this->intern(paint), region);
 }
 
 void SkRecorder::onDrawOval(const SkRect& oval, const SkPaint& paint) {
-    this->append<SkRecords::DrawOval>(paint, oval);
+    this->append<SkRecords::DrawOval>(this->intern(paint), oval);
 }
 
 void SkRecorder::onDrawArc(const SkRect& oval, SkScalar startAngle, SkScalar sweepAngle,
                            bool useCenter, const SkPaint& paint) {
-    this->append<SkRecords::DrawArc>(paint, oval, startAngle, sweepAngle, useCenter);
+    this->append<SkRecords::DrawArc>(this->intern(paint), oval, startAngle, sweepAngle, useCenter);
 }
 
 void SkRecorder::onDrawRRect(const SkRRect& rrect, const SkPaint& paint) {
-    this->append<SkRecords::DrawRRect>(paint, rrect);
+    this->append<SkRecords::DrawRRect>(this->intern(paint), rrect);
 }
 
 void SkRecorder::onDrawDRRect(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint) {
-    this->append<SkRecords::DrawDRRect>(paint, outer, inner);
+    this->append<SkRecords::DrawDRRect>(this->intern(paint), outer, inner);
 }
 
 void SkRecorder::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
@@ -222,18 +232,18 @@ void SkRecorder::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
 }
 
 void SkRecorder::onDrawPath(const SkPath& path, const SkPaint& paint) {
-    this->append<SkRecords::DrawPath>(paint, path);
+    this->append<SkRecords::DrawPath>(this->intern(paint), path);
 }
 
 void SkRecorder::onDrawImage2(const SkImage* image, SkScalar x, SkScalar y,
                               const SkSamplingOptions& sampling, const SkPaint* paint) {
-    this->append<SkRecords::DrawImage>(this->copy(paint), sk_ref_sp(image), x, y, sampling);
+    this->append<SkRecords::DrawImage>(this->intern(paint), sk_ref_sp(image), x, y, sampling);
 }
 
 void SkRecorder::onDrawImageRect2(const SkImage* image, const SkRect& src, const SkRect& dst,
                                   const SkSamplingOptions& sampling, const SkPaint* paint,
                                   SrcRectConstraint constraint) {
-    this->append<SkRecords::DrawImageRect>(this->copy(paint), sk_ref_sp(image), src, dst,
+    this->append<SkRecords::DrawImageRect>(this->intern(paint), sk_ref_sp(image), src, dst,
                                            sampling, constraint);
 }
 
@@ -241,7 +251,7 @@ void SkRecorder::onDrawImageLattice2(const SkImage* image, const Lattice& lattic
                                      SkFilterMode filter, const SkPaint* paint) {
     int flagCount = lattice.fRectTypes ? (lattice.fXCount + 1) * (lattice.fYCount + 1) : 0;
     SkASSERT(lattice.fBounds);
-    this->append<SkRecords::DrawImageLattice>(this->copy(paint), sk_ref_sp(image),
+    this->append<SkRecords::DrawImageLattice>(this->intern(paint), sk_ref_sp(image),
            lattice.fXCount, this->copy(lattice.fXDivs, lattice.fXCount),
            lattice.fYCount, this->copy(lattice.fYDivs, lattice.fYCount),
            flagCount, this->copy(lattice.fRectTypes, flagCount),
@@ -250,7 +260,7 @@ void SkRecorder::onDrawImageLattice2(const SkImage* image, const Lattice& lattic
 
 void SkRecorder::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
                                 const SkPaint& paint) {
-    this->append<SkRecords::DrawTextBlob>(paint, sk_ref_sp(blob), x, y);
+    this->append<SkRecords::DrawTextBlob>(this->intern(paint), sk_ref_sp(blob), x, y);
 }
 
 #if defined(SK_GANESH)
@@ -271,26 +281,26 @@ void SkRecorder::onDrawGlyphRunList(
 
 void SkRecorder::onDrawPicture(const SkPicture* pic, const SkMatrix* matrix, const SkPaint* paint) {
     fApproxBytesUsedBySubPictures += pic->approximateBytesUsed();
-    this->append<SkRecords::DrawPicture>(this->copy(paint), sk_ref_sp(pic), matrix ? *matrix : SkMatrix::I());
+    this->append<SkRecords::DrawPicture>(this->intern(paint), sk_ref_sp(pic), matrix ? *matrix : SkMatrix::I());
 }
 
 void SkRecorder::onDrawVerticesObject(const SkVertices* vertices, SkBlendMode bmode,
                                       const SkPaint& paint) {
-    this->append<SkRecords::DrawVertices>(paint,
+    this->append<SkRecords::DrawVertices>(this->intern(paint),
                                           sk_ref_sp(const_cast<SkVertices*>(vertices)),
                                           bmode);
 }
 
 #ifdef SK_ENABLE_SKSL
 void SkRecorder::onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint) {
-    this->append<SkRecords::DrawMesh>(paint, mesh, std::move(blender));
+    this->append<SkRecords::DrawMesh>(this->intern(paint), mesh, std::move(blender));
 }
 #endif
 
 void SkRecorder::onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
                              const SkPoint texCoords[4], SkBlendMode bmode,
                              const SkPaint& paint) {
-    this->append<SkRecords::DrawPatch>(paint,
+    this->append<SkRecords::DrawPatch>(this->intern(paint),
            cubics ? this->copy(cubics, SkPatchUtils::kNumCtrlPts) : nullptr,
            colors ? this->copy(colors, SkPatchUtils::kNumCorners) : nullptr,
            texCoords ? this->copy(texCoords, SkPatchUtils::kNumCorners) : nullptr,
@@ -301,7 +311,7 @@ void SkRecorder::onDrawAtlas2(const SkImage* atlas, const SkRSXform xform[], con
                               const SkColor colors[], int count, SkBlendMode mode,
                               const SkSamplingOptions& sampling, const SkRect* cull,
                               const SkPaint* paint) {
-    this->append<SkRecords::DrawAtlas>(this->copy(paint),
+    this->append<SkRecords::DrawAtlas>(this->intern(paint),
            sk_ref_sp(atlas),
            this->copy(xform, count),
            this->copy(tex, count),
@@ -338,7 +348,7 @@ void SkRecorder::onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count,
         setCopy[i] = set[i];
     }
 
-    this->append<SkRecords::DrawEdgeAAImageSet>(this->copy(paint), std::move(setCopy), count,
+    this->append<SkRecords::DrawEdgeAAImageSet>(this->intern(paint), std::move(setCopy), count,
             this->copy(dstClips, totalDstClipCount),
             this->copy(preViewMatrices, totalMatrixCount), sampling, constraint);
 }
@@ -353,7 +363,7 @@ void SkRecorder::willSave() {
 
 SkCanvas::SaveLayerStrategy SkRecorder::getSaveLayerStrategy(const SaveLayerRec& rec) {
     this->append<SkRecords::SaveLayer>(this->copy(rec.fBounds)
-                    , this->copy(rec.fPaint)
+                    , this->intern(rec.fPaint)
                     , sk_ref_sp(rec.fBackdrop)
                     , rec.fSaveLayerFlags
                     , SkCanvasPriv::GetBackdropScaleFactor(rec));
@@ -366,7 +376,7 @@ bool SkRecorder::onDoSaveBehind(const SkRect* subset) {
 }
 
 void SkRecorder::didRestore() {
-    this->append<SkRecords::Restore>(this->getTotalMatrix());
+    this->append<SkRecords::Restore>(fRecord->intern(this->getTotalMatrix()));
 }
 
 void SkRecorder::didConcat44(const SkM44& m) {
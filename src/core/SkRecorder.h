@@ -168,6 +168,9 @@ private:
     template <typename T>
     T* copy(const T[], size_t count);
 
+    const SkPaint* intern(const SkPaint&);
+    const SkPaint* intern(const SkPaint*);
+
     template<typename T, typename... Args>
     void append(Args&&...);
 
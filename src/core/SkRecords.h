@@ -131,6 +131,21 @@ private:
 
 #undef ACT_AS_PTR
 
+// An Interned value is owned by the SkRecord, and shared by all of its ops that record an equal
+// value (see SkRecord::intern()), so it can't be changed in place; intern the new value instead.
+template <typename T>
+class Interned {
+public:
+    Interned() : fPtr(nullptr) {}
+    Interned(const T* ptr) : fPtr(ptr) {}
+    // Default copy and assign.
+
+    operator const T*() const { return fPtr; }
+    const T* operator->() const { return fPtr; }
+private:
+    const T* fPtr;
+};
+
 // SkPath::getBounds() isn't thread safe unless we precache the bounds in a singlethreaded context.
 // SkPath::cheapComputeDirection() is similar.
 // Recording is a convenient time to cache these, or we can delay it to between record and playback.
@@ -166,12 +181,12 @@ struct T {                              \
 RECORD(NoOp, 0)
 RECORD(Flush, 0)
 RECORD(Restore, 0,
-        TypedMatrix matrix)
+        Interned<TypedMatrix> matrix)
 RECORD(Save, 0)
 
 RECORD(SaveLayer, kHasPaint_Tag,
        Optional<SkRect> bounds;
-       Optional<SkPaint> paint;
+       Interned<SkPaint> paint;
        sk_sp<const SkImageFilter> backdrop;
        SkCanvas::SaveLayerFlags saveLayerFlags;
        SkScalar backdropScale)
@@ -228,13 +243,13 @@ RECORD(ResetClip, 0)
 
 // While not strictly required, if you have an SkPaint, it's fastest to put it first.
 RECORD(DrawArc, kDraw_Tag|kHasPaint_Tag,
-       SkPaint paint;
+       Interned<SkPaint> paint;
        SkRect oval;
        SkScalar startAngle;
        SkScalar sweepAngle;
        unsigned useCenter)
 RECORD(DrawDRRect, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkRRect outer;
         SkRRect inner)
 RECORD(DrawDrawable, kDraw_Tag,
@@ -242,13 +257,13 @@ RECORD(DrawDrawable, kDraw_Tag,
         SkRect worstCaseBounds;
         int32_t index)
 RECORD(DrawImage, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
-        Optional<SkPaint> paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkImage> image;
         SkScalar left;
         SkScalar top;
         SkSamplingOptions sampling)
 RECORD(DrawImageLattice, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
-        Optional<SkPaint> paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkImage> image;
         int xCount;
         PODArray<int> xDivs;
@@ -261,42 +276,42 @@ RECORD(DrawImageLattice, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
         SkRect dst;
         SkFilterMode filter)
 RECORD(DrawImageRect, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
-        Optional<SkPaint> paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkImage> image;
         SkRect src;
         SkRect dst;
         SkSamplingOptions sampling;
         SkCanvas::SrcRectConstraint constraint)
 RECORD(DrawOval, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkRect oval)
 RECORD(DrawPaint, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint)
+        Interned<SkPaint> paint)
 RECORD(DrawBehind, kDraw_Tag|kHasPaint_Tag,
-       SkPaint paint)
+       Interned<SkPaint> paint)
 RECORD(DrawPath, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         PreCachedPath path)
 RECORD(DrawPicture, kDraw_Tag|kHasPaint_Tag,
-        Optional<SkPaint> paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkPicture> picture;
         TypedMatrix matrix)
 RECORD(DrawPoints, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkCanvas::PointMode mode;
         unsigned count;
         PODArray<SkPoint> pts)
 RECORD(DrawRRect, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkRRect rrect)
 RECORD(DrawRect, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkRect rect)
 RECORD(DrawRegion, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         SkRegion region)
 RECORD(DrawTextBlob, kDraw_Tag|kHasText_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkTextBlob> blob;
         SkScalar x;
         SkScalar y)
@@ -307,13 +322,13 @@ RECORD(DrawSlug, kDraw_Tag|kHasText_Tag,
 RECORD(DrawSlug, 0)
 #endif
 RECORD(DrawPatch, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         PODArray<SkPoint> cubics;
         PODArray<SkColor> colors;
         PODArray<SkPoint> texCoords;
         SkBlendMode bmode)
 RECORD(DrawAtlas, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
-        Optional<SkPaint> paint;
+        Interned<SkPaint> paint;
         sk_sp<const SkImage> atlas;
         PODArray<SkRSXform> xforms;
         PODArray<SkRect> texs;
@@ -323,12 +338,12 @@ RECORD(DrawAtlas, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
         SkSamplingOptions sampling;
         Optional<SkRect> cull)
 RECORD(DrawVertices, kDraw_Tag|kHasPaint_Tag,
-        SkPaint paint;
+        Interned<SkPaint> paint;
         sk_sp<SkVertices> vertices;
         SkBlendMode bmode)
 #ifdef SK_ENABLE_SKSL
 RECORD(DrawMesh, kDraw_Tag|kHasPaint_Tag,
-       SkPaint paint;
+       Interned<SkPaint> paint;
        SkMesh mesh;
        sk_sp<SkBlender> blender)
 #else
@@ -348,7 +363,7 @@ RECORD(DrawEdgeAAQuad, kDraw_Tag,
        SkColor4f color;
        SkBlendMode mode)
 RECORD(DrawEdgeAAImageSet, kDraw_Tag|kHasImage_Tag|kHasPaint_Tag,
-       Optional<SkPaint> paint;
+       Interned<SkPaint> paint;
        skia_private::AutoTArray<SkCanvas::ImageSetEntry> set;
        int count;
        PODArray<SkPoint> dstClips;
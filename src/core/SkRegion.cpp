@@ -14,6 +14,7 @@
 #include "src/core/SkRegionPriv.h"
 
 #include <algorithm>
+#include <cstring>
 #include <utility>
 
 using namespace skia_private;
@@ -370,14 +371,20 @@ bool SkRegion::contains(int32_t x, int32_t y) const {
     const RunType* runs = fRunHead->findScanline(y);
 
     // Skip the Bottom and IntervalCount
+    const int intervals = runs[1];
     runs += 2;
 
+    // Long scanlines (e.g. damage regions made of many small rects) are worth a bsearch. The
+    // values L0 R0 L1 R1 ... are strictly increasing, so the first one greater than x is a Right
+    // (odd index) exactly when x is inside that interval.
+    constexpr int kMaxLinearSearchIntervals = 16;
+    if (intervals > kMaxLinearSearchIntervals) {
+        const RunType* upper = std::upper_bound(runs, runs + 2 * intervals, x);
+        return ((upper - runs) & 1) == 1;
+    }
+
     // Just walk this scanline, checking each interval. The X-sentinel will
     // appear as a left-inteval (runs[0]) and should abort the search.
-    //
-    // We could do a bsearch, using interval-count (runs[1]), but need to time
-    // when that would be worthwhile.
-    //
     for (;;) {
         if (x < runs[0]) {
             break;
@@ -649,14 +656,29 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Unioning rects one at a time rebuilds an ever-growing region for each rect, which is quadratic
+// for large inputs (e.g. damage tracking). Unioning the two halves recursively keeps the operands
+// balanced so each level of the recursion touches every scanline only once.
+static void union_rects(SkRegion* dst, const SkIRect rects[], int count) {
+    static constexpr int kLinearCount = 8;
+    if (count <= kLinearCount) {
+        dst->setRect(rects[0]);
+        for (int i = 1; i < count; i++) {
+            dst->op(rects[i], SkRegion::kUnion_Op);
+        }
+        return;
+    }
+    SkRegion rest;
+    union_rects(dst, rects, count >> 1);
+    union_rects(&rest, rects + (count >> 1), count - (count >> 1));
+    dst->op(rest, SkRegion::kUnion_Op);
+}
+
 bool SkRegion::setRects(const SkIRect rects[], int count) {
     if (0 == count) {
         this->setEmpty();
     } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
-        }
+        union_rects(this, rects, count);
     }
     return !this->isEmpty();
 }
@@ -668,148 +690,173 @@ bool SkRegion::setRects(const SkIRect rects[], int count) {
 #pragma warning ( disable : 4701 )
 #endif
 
-#ifdef SK_DEBUG
-static void assert_valid_pair(int left, int rite)
-{
-    SkASSERT(left == SkRegion_kRunTypeSentinel || left < rite);
-}
-#else
-    #define assert_valid_pair(left, rite)
-#endif
-
-struct spanRec {
-    const SkRegionPriv::RunType*    fA_runs;
-    const SkRegionPriv::RunType*    fB_runs;
-    int                         fA_left, fA_rite, fB_left, fB_rite;
-    int                         fLeft, fRite, fInside;
-
-    void init(const SkRegionPriv::RunType a_runs[],
-              const SkRegionPriv::RunType b_runs[]) {
-        fA_left = *a_runs++;
-        fA_rite = *a_runs++;
-        fB_left = *b_runs++;
-        fB_rite = *b_runs++;
+// Appends intervals to a scanline being built, coalescing an interval that starts exactly where
+// the previous one ended.
+class SpanWriter {
+public:
+    explicit SpanWriter(SkRegionPriv::RunType* dst) : fStart(dst), fDst(dst) {}
 
-        fA_runs = a_runs;
-        fB_runs = b_runs;
+    void append(int left, int rite) {
+        SkASSERT(left < rite);
+        if (fDst == fStart || *(fDst - 1) < left) {
+            *fDst++ = (SkRegionPriv::RunType)(left);
+            *fDst++ = (SkRegionPriv::RunType)(rite);
+        } else {
+            // update the right edge
+            *(fDst - 1) = (SkRegionPriv::RunType)(rite);
+        }
     }
 
-    bool done() const {
-        SkASSERT(fA_left <= SkRegion_kRunTypeSentinel);
-        SkASSERT(fB_left <= SkRegion_kRunTypeSentinel);
-        return fA_left == SkRegion_kRunTypeSentinel &&
-               fB_left == SkRegion_kRunTypeSentinel;
+    // Append 'count' [L R] intervals from a valid scanline. Within a scanline the intervals are
+    // already sorted and disjoint, so only the first one can touch what we've written so far.
+    void appendRun(const SkRegionPriv::RunType runs[], int count) {
+        if (count <= 0) {
+            return;
+        }
+        this->append(runs[0], runs[1]);
+        const int rest = 2 * (count - 1);
+        memcpy(fDst, runs + 2, rest * sizeof(SkRegionPriv::RunType));
+        fDst += rest;
     }
 
-    void next() {
-        assert_valid_pair(fA_left, fA_rite);
-        assert_valid_pair(fB_left, fB_rite);
+    SkRegionPriv::RunType* dst() const { return fDst; }
 
-        int     inside, left, rite SK_INIT_TO_AVOID_WARNING;
-        bool    a_flush = false;
-        bool    b_flush = false;
-
-        int a_left = fA_left;
-        int a_rite = fA_rite;
-        int b_left = fB_left;
-        int b_rite = fB_rite;
-
-        if (a_left < b_left) {
-            inside = 1;
-            left = a_left;
-            if (a_rite <= b_left) {   // [...] <...>
-                rite = a_rite;
-                a_flush = true;
-            } else { // [...<..]...> or [...<...>...]
-                rite = a_left = b_left;
-            }
-        } else if (b_left < a_left) {
-            inside = 2;
-            left = b_left;
-            if (b_rite <= a_left) {   // [...] <...>
-                rite = b_rite;
-                b_flush = true;
-            } else {    // [...<..]...> or [...<...>...]
-                rite = b_left = a_left;
-            }
-        } else {    // a_left == b_left
-            inside = 3;
-            left = a_left;  // or b_left
-            if (a_rite <= b_rite) {
-                rite = b_left = a_rite;
-                a_flush = true;
-            }
-            if (b_rite <= a_rite) {
-                rite = a_left = b_rite;
-                b_flush = true;
-            }
-        }
+private:
+    SkRegionPriv::RunType* const fStart;
+    SkRegionPriv::RunType*       fDst;
+};
 
-        if (a_flush) {
-            a_left = *fA_runs++;
-            a_rite = *fA_runs++;
+// Returns how many of the 'count' intervals in runs[] lie entirely at or before 'limit', i.e.
+// the length of the prefix whose Right <= limit.
+//
+// Most runs are short when both regions are equally fine-grained, so we gallop: probe intervals
+// 0, 2, 6, 14, ... until one ends past 'limit', then bsearch the last gap. Within a scanline the
+// right edges are strictly increasing, so this only ever reads intervals [0, count).
+static int count_intervals_before(const SkRegionPriv::RunType runs[], int count, int limit) {
+    int lo = 0;         // intervals [0, lo) all end at or before limit
+    int hi = count;     // intervals [hi, count) all end past limit
+    for (int step = 1; lo < hi; step *= 2) {
+        const int probe = std::min(lo + step, count) - 1;
+        if (runs[2 * probe + 1] > limit) {
+            hi = probe;
+            break;
         }
-        if (b_flush) {
-            b_left = *fB_runs++;
-            b_rite = *fB_runs++;
+        lo = probe + 1;
+    }
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) >> 1);
+        if (runs[2 * mid + 1] <= limit) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
-
-        SkASSERT(left <= rite);
-
-        // now update our state
-        fA_left = a_left;
-        fA_rite = a_rite;
-        fB_left = b_left;
-        fB_rite = b_rite;
-
-        fLeft = left;
-        fRite = rite;
-        fInside = inside;
     }
-};
-
-static int distance_to_sentinel(const SkRegionPriv::RunType* runs) {
-    const SkRegionPriv::RunType* ptr = runs;
-    while (*ptr != SkRegion_kRunTypeSentinel) { ptr += 2; }
-    return ptr - runs;
+    return lo;
 }
 
+/*  Merges one scanline from each of A and B into dst, keeping the pieces whose "inside" value
+ *  (1: only in A, 2: only in B, 3: in both) is in [min, max].
+ *
+ *  Rather than stepping one interval at a time, whenever one side's intervals all end before the
+ *  other side's current interval begins, the whole run of them is found with a galloping search and
+ *  either bulk-copied or skipped, depending on the op. This is the common case for regions made
+ *  of many small, mostly disjoint rects.
+ */
 static int operate_on_span(const SkRegionPriv::RunType a_runs[],
                            const SkRegionPriv::RunType b_runs[],
                            RunArray* array, int dstOffset,
                            int min, int max) {
-    // This is a worst-case for this span plus two for TWO terminating sentinels.
-    array->resizeToAtLeast(
-            dstOffset + distance_to_sentinel(a_runs) + distance_to_sentinel(b_runs) + 2);
-    SkRegionPriv::RunType* dst = &(*array)[dstOffset]; // get pointer AFTER resizing.
-
-    spanRec rec;
-    bool    firstInterval = true;
+    // The interval count precedes the intervals (see skip_intervals()).
+    const int a_count = a_runs[-1];
+    const int b_count = b_runs[-1];
+    SkASSERT(a_runs[2 * a_count] == SkRegion_kRunTypeSentinel);
+    SkASSERT(b_runs[2 * b_count] == SkRegion_kRunTypeSentinel);
 
-    rec.init(a_runs, b_runs);
-
-    while (!rec.done()) {
-        rec.next();
-
-        int left = rec.fLeft;
-        int rite = rec.fRite;
-
-        // add left,rite to our dst buffer (checking for coincidence
-        if ((unsigned)(rec.fInside - min) <= (unsigned)(max - min) &&
-                left < rite) {    // skip if equal
-            if (firstInterval || *(dst - 1) < left) {
-                *dst++ = (SkRegionPriv::RunType)(left);
-                *dst++ = (SkRegionPriv::RunType)(rite);
-                firstInterval = false;
+    // This is a worst-case for this span plus two for TWO terminating sentinels.
+    array->resizeToAtLeast(dstOffset + 2 * a_count + 2 * b_count + 2);
+    SpanWriter dst(&(*array)[dstOffset]); // get pointer AFTER resizing.
+
+    const bool keepA    = (unsigned)(1 - min) <= (unsigned)(max - min);
+    const bool keepB    = (unsigned)(2 - min) <= (unsigned)(max - min);
+    const bool keepBoth = (unsigned)(3 - min) <= (unsigned)(max - min);
+
+    const SkRegionPriv::RunType* const a_end = a_runs + 2 * a_count;
+    const SkRegionPriv::RunType* const b_end = b_runs + 2 * b_count;
+    const SkRegionPriv::RunType* a = a_runs;
+    const SkRegionPriv::RunType* b = b_runs;
+
+    // The current interval of each side. Its left edge may have been advanced past the
+    // original as we consume the parts that precede the other side's current interval.
+    int a_left = 0, a_rite = 0, b_left = 0, b_rite = 0;
+    if (a < a_end) { a_left = a[0]; a_rite = a[1]; }
+    if (b < b_end) { b_left = b[0]; b_rite = b[1]; }
+
+    while (a < a_end && b < b_end) {
+        if (a_rite <= b_left) {
+            // [...] [...] <...>  A's current interval (and maybe more) come before B's.
+            int n = 1 + count_intervals_before(a + 2, SkToInt(a_end - a - 2) >> 1, b_left);
+            if (keepA) {
+                dst.append(a_left, a_rite);
+                dst.appendRun(a + 2, n - 1);
+            }
+            a += 2 * n;
+            if (a < a_end) { a_left = a[0]; a_rite = a[1]; }
+        } else if (b_rite <= a_left) {
+            // <...> <...> [...]
+            int n = 1 + count_intervals_before(b + 2, SkToInt(b_end - b - 2) >> 1, a_left);
+            if (keepB) {
+                dst.append(b_left, b_rite);
+                dst.appendRun(b + 2, n - 1);
+            }
+            b += 2 * n;
+            if (b < b_end) { b_left = b[0]; b_rite = b[1]; }
+        } else if (a_left < b_left) {
+            // [...<..]...> or [...<...>...]
+            if (keepA) {
+                dst.append(a_left, b_left);
+            }
+            a_left = b_left;
+        } else if (b_left < a_left) {
+            // <...[..>...] or <...[...]...>
+            if (keepB) {
+                dst.append(b_left, a_left);
+            }
+            b_left = a_left;
+        } else {
+            // a_left == b_left
+            int rite = std::min(a_rite, b_rite);
+            if (keepBoth) {
+                dst.append(a_left, rite);
+            }
+            if (a_rite == rite) {
+                a += 2;
+                if (a < a_end) { a_left = a[0]; a_rite = a[1]; }
             } else {
-                // update the right edge
-                *(dst - 1) = (SkRegionPriv::RunType)(rite);
+                a_left = rite;
+            }
+            if (b_rite == rite) {
+                b += 2;
+                if (b < b_end) { b_left = b[0]; b_rite = b[1]; }
+            } else {
+                b_left = rite;
             }
         }
     }
-    SkASSERT(dst < &(*array)[array->count() - 1]);
-    *dst++ = SkRegion_kRunTypeSentinel;
-    return dst - &(*array)[0];
+
+    // At most one side has intervals left, and nothing of the other side overlaps them.
+    if (a < a_end && keepA) {
+        dst.append(a_left, a_rite);
+        dst.appendRun(a + 2, SkToInt(a_end - a - 2) >> 1);
+    }
+    if (b < b_end && keepB) {
+        dst.append(b_left, b_rite);
+        dst.appendRun(b + 2, SkToInt(b_end - b - 2) >> 1);
+    }
+
+    SkRegionPriv::RunType* end = dst.dst();
+    SkASSERT(end < &(*array)[array->count() - 1]);
+    *end++ = SkRegion_kRunTypeSentinel;
+    return end - &(*array)[0];
 }
 
 #if defined _WIN32
@@ -893,6 +940,8 @@ private:
 // want a unique value to signal that we exited due to quickExit
 #define QUICK_EXIT_TRUE_COUNT   (-1)
 
+// The interval counts of a_runs and b_runs must be computed, as they are in a region's runs:
+// operate_on_span() reads each scanline's count from just before its intervals.
 static int operate(const SkRegionPriv::RunType a_runs[],
                    const SkRegionPriv::RunType b_runs[],
                    RunArray* dst,
@@ -900,14 +949,8 @@ static int operate(const SkRegionPriv::RunType a_runs[],
                    bool quickExit) {
     const SkRegionPriv::RunType gEmptyScanline[] = {
         0,  // fake bottom value
-        0,  // zero intervals
+        0,  // zero intervals (operate_on_span() reads this, just before gSentinel)
         SkRegion_kRunTypeSentinel,
-        // just need a 2nd value, since spanRec.init() reads 2 values, even
-        // though if the first value is the sentinel, it ignores the 2nd value.
-        // w/o the 2nd value here, we might read uninitialized memory.
-        // This happens when we are using gSentinel, which is pointing at
-        // our sentinel value.
-        0
     };
     const SkRegionPriv::RunType* const gSentinel = &gEmptyScanline[2];
 
@@ -983,7 +1026,7 @@ static int operate(const SkRegionPriv::RunType a_runs[],
             a_runs = skip_intervals(a_runs);
             a_top = a_bot;
             a_bot = *a_runs++;
-            a_runs += 1;    // skip uninitialized intervalCount
+            a_runs += 1;    // skip the intervalCount (operate_on_span() reads it as runs[-1])
             if (a_bot == SkRegion_kRunTypeSentinel) {
                 a_top = a_bot;
             }
@@ -992,7 +1035,7 @@ static int operate(const SkRegionPriv::RunType a_runs[],
             b_runs = skip_intervals(b_runs);
             b_top = b_bot;
             b_bot = *b_runs++;
-            b_runs += 1;    // skip uninitialized intervalCount
+            b_runs += 1;    // skip the intervalCount (operate_on_span() reads it as runs[-1])
             if (b_bot == SkRegion_kRunTypeSentinel) {
                 b_top = b_bot;
             }
@@ -1549,27 +1592,22 @@ static void visit_pairs(int pairCount, int y, const int32_t pairs[],
     }
 }
 
-void SkRegionPriv::VisitSpans(const SkRegion& rgn,
-                              const std::function<void(const SkIRect&)>& visitor) {
+void SkRegionPriv::VisitBands(const SkRegion& rgn, const BandVisitor& visitor) {
     if (rgn.isEmpty()) {
         return;
     }
     if (rgn.isRect()) {
-        visitor(rgn.getBounds());
+        const SkIRect& r = rgn.getBounds();
+        const int32_t pair[] = { r.fLeft, r.fRight };
+        visitor(r.fTop, r.fBottom, pair, 1);
     } else {
         const int32_t* p = rgn.fRunHead->readonly_runs();
         int32_t top = *p++;
         int32_t bot = *p++;
         do {
             int pairCount = *p++;
-            if (pairCount == 1) {
-                visitor({ p[0], top, p[1], bot });
-                p += 2;
-            } else if (pairCount > 1) {
-                // we have to loop repeated in Y, sending each interval in Y -> X order
-                for (int y = top; y < bot; ++y) {
-                    visit_pairs(pairCount, y, p, visitor);
-                }
+            if (pairCount > 0) {
+                visitor(top, bot, p, pairCount);
                 p += pairCount * 2;
             }
             assert_sentinel(*p, true);
@@ -1582,3 +1620,17 @@ void SkRegionPriv::VisitSpans(const SkRegion& rgn,
     }
 }
 
+void SkRegionPriv::VisitSpans(const SkRegion& rgn,
+                              const std::function<void(const SkIRect&)>& visitor) {
+    VisitBands(rgn, [&](int top, int bot, const int32_t pairs[], int pairCount) {
+        if (pairCount == 1) {
+            visitor({ pairs[0], top, pairs[1], bot });
+        } else {
+            // we have to loop repeated in Y, sending each interval in Y -> X order
+            for (int y = top; y < bot; ++y) {
+                visit_pairs(pairCount, y, pairs, visitor);
+            }
+        }
+    });
+}
+
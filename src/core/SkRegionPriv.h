@@ -27,6 +27,13 @@ public:
     // of the rect may be 1. It should never be empty.
     static void VisitSpans(const SkRegion& rgn, const std::function<void(const SkIRect&)>&);
 
+    // Call the function with each horizontal band of the region, in Y ascending order, handing
+    // over all of the band's intervals at once as [Left Right] pairs in ascending X. The pairs
+    // point directly into the region's storage, and bands without intervals are skipped.
+    using BandVisitor = std::function<void(int top, int bottom, const int32_t pairs[],
+                                           int pairCount)>;
+    static void VisitBands(const SkRegion& rgn, const BandVisitor&);
+
 #ifdef SK_DEBUG
     static void Validate(const SkRegion& rgn);
 #endif
@@ -18,6 +18,9 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <utility>
 
 using namespace skia_private;
 
@@ -41,6 +44,13 @@ static inline bool SkShouldPostMessageToBus(
     #define SK_DEFAULT_IMAGE_CACHE_LIMIT     (32 * 1024 * 1024)
 #endif
 
+// The global cache can be split into independently locked shards (selected by key hash) so that
+// lookups from many threads don't all serialize on one mutex. Each shard gets an equal slice of
+// the total (and per-category) budget.
+#ifndef SK_RESOURCE_CACHE_SHARD_COUNT
+    #define SK_RESOURCE_CACHE_SHARD_COUNT    1
+#endif
+
 void SkResourceCache::Key::init(void* nameSpace, uint64_t sharedID, size_t dataSize) {
     SkASSERT(SkAlign4(dataSize) == dataSize);
 
@@ -77,6 +87,24 @@ namespace {
 class SkResourceCache::Hash :
     public THashTable<SkResourceCache::Rec*, SkResourceCache::Key, HashTraits> {};
 
+// The bytes used by all of the namespaces of a category, kept up to date as recs are added and
+// removed so that checking its budget is cheap.
+struct SkResourceCache::Category {
+    size_t fByteLimit = 0;  // 0 means only the total applies
+    size_t fBytesUsed = 0;
+};
+
+struct SkResourceCache::Namespace {
+    NamespaceStats fStats;
+    Category*      fCategory = nullptr;  // set with fStats.fCategory, by the first rec added
+};
+
+class SkResourceCache::NamespaceMap : public THashMap<void*, SkResourceCache::Namespace> {};
+
+// Categories are never removed, so Namespace can point to them.
+class SkResourceCache::CategoryMap :
+    public THashMap<SkString, std::unique_ptr<SkResourceCache::Category>> {};
+
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -84,6 +112,8 @@ void SkResourceCache::init() {
     fHead = nullptr;
     fTail = nullptr;
     fHash = new Hash;
+    fNamespaces = new NamespaceMap;
+    fCategories = new CategoryMap;
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
@@ -113,6 +143,8 @@ SkResourceCache::~SkResourceCache() {
         rec = next;
     }
     delete fHash;
+    delete fNamespaces;
+    delete fCategories;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -120,19 +152,41 @@ SkResourceCache::~SkResourceCache() {
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     this->checkMessages();
 
+    // A namespace is only tracked once it has had a rec added, so misses before then aren't
+    // counted.
+    Namespace* ns = fNamespaces->find(key.getNamespace());
     if (auto found = fHash->find(key)) {
         Rec* rec = *found;
+        SkASSERT(ns);
         if (visitor(*rec, context)) {
             this->moveToHead(rec);  // for our LRU
+            ns->fStats.fHits += 1;
             return true;
         } else {
             this->remove(rec);  // stale
-            return false;
         }
     }
+    if (ns) {
+        ns->fStats.fMisses += 1;
+    }
     return false;
 }
 
+SkResourceCache::Namespace* SkResourceCache::findOrCreateNamespace(void* nameSpace) {
+    if (Namespace* ns = fNamespaces->find(nameSpace)) {
+        return ns;
+    }
+    return fNamespaces->set(nameSpace, Namespace());
+}
+
+SkResourceCache::Category* SkResourceCache::findOrCreateCategory(const char* name) {
+    SkString key(name);
+    if (std::unique_ptr<Category>* category = fCategories->find(key)) {
+        return category->get();
+    }
+    return fCategories->set(std::move(key), std::make_unique<Category>())->get();
+}
+
 static void make_size_str(size_t size, SkString* str) {
     const char suffix[] = { 'b', 'k', 'm', 'g', 't', 0 };
     int i = 0;
@@ -163,6 +217,15 @@ void SkResourceCache::add(Rec* rec, void* payload) {
         }
     }
 
+    Namespace* ns = this->findOrCreateNamespace(rec->getKey().getNamespace());
+    if (!ns->fCategory) {
+        // The first rec of a namespace tells us which category (and so which sub-budget) the
+        // namespace belongs to.
+        ns->fStats.fCategory = rec->getCategory();
+        ns->fCategory = this->findOrCreateCategory(ns->fStats.fCategory);
+        ns->fStats.fByteLimit = ns->fCategory->fByteLimit;
+    }
+
     this->addToHead(rec);
     fHash->set(rec);
     rec->postAddInstall(payload);
@@ -176,7 +239,9 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     }
 
     // since the new rec may push us over-budget, we perform a purge check now
-    this->purgeAsNeeded();
+    int purged = this->purgeCategoryAsNeeded(ns->fCategory);
+    purged += this->purgeAsNeeded();
+    ns->fStats.fEvictionsCaused += purged;
 }
 
 void SkResourceCache::remove(Rec* rec) {
@@ -190,6 +255,13 @@ void SkResourceCache::remove(Rec* rec) {
     fTotalBytesUsed -= used;
     fCount -= 1;
 
+    Namespace* ns = fNamespaces->find(rec->getKey().getNamespace());
+    SkASSERT(ns && used <= ns->fStats.fBytesUsed && ns->fStats.fCount > 0);
+    SkASSERT(used <= ns->fCategory->fBytesUsed);
+    ns->fStats.fBytesUsed -= used;
+    ns->fStats.fCount -= 1;
+    ns->fCategory->fBytesUsed -= used;
+
     //SkDebugf("-RC count [%3d] bytes %d\n", fCount, fTotalBytesUsed);
 
     if (gDumpCacheTransactions) {
@@ -203,7 +275,7 @@ void SkResourceCache::remove(Rec* rec) {
     delete rec;
 }
 
-void SkResourceCache::purgeAsNeeded(bool forcePurge) {
+int SkResourceCache::purgeAsNeeded(bool forcePurge) {
     size_t byteLimit;
     int    countLimit;
 
@@ -215,6 +287,7 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         byteLimit = fTotalByteLimit;
     }
 
+    int purged = 0;
     Rec* rec = fTail;
     while (rec) {
         if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
@@ -223,10 +296,40 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
 
         Rec* prev = rec->fPrev;
         if (rec->canBePurged()) {
+            if (!forcePurge) {
+                fNamespaces->find(rec->getKey().getNamespace())->fStats.fEvictions += 1;
+            }
             this->remove(rec);
+            purged += 1;
         }
         rec = prev;
     }
+    return purged;
+}
+
+int SkResourceCache::purgeCategoryAsNeeded(Category* category) {
+    SkASSERT(category);
+    if (!category->fByteLimit || category->fBytesUsed <= category->fByteLimit) {
+        return 0;
+    }
+
+    // Only recs from this category are considered, oldest first, so exceeding a sub-budget
+    // never costs another category its entries.
+    int purged = 0;
+    Rec* rec = fTail;
+    while (rec && category->fBytesUsed > category->fByteLimit) {
+        Rec* prev = rec->fPrev;
+        if (rec->canBePurged()) {
+            Namespace* ns = fNamespaces->find(rec->getKey().getNamespace());
+            if (ns->fCategory == category) {
+                ns->fStats.fEvictions += 1;
+                this->remove(rec);
+                purged += 1;
+            }
+        }
+        rec = prev;
+    }
+    return purged;
 }
 
 //#define SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -294,6 +397,37 @@ size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
     return prevLimit;
 }
 
+size_t SkResourceCache::setCategoryByteLimit(const char* category, size_t newLimit) {
+    Category* cat = this->findOrCreateCategory(category);
+    size_t prevLimit = cat->fByteLimit;
+    cat->fByteLimit = newLimit;
+
+    // Namespaces we have already seen report the new limit now; others will on their first add.
+    fNamespaces->foreach([&](void*, Namespace* ns) {
+        if (ns->fCategory == cat) {
+            ns->fStats.fByteLimit = newLimit;
+        }
+    });
+    this->purgeCategoryAsNeeded(cat);
+    return prevLimit;
+}
+
+size_t SkResourceCache::getCategoryByteLimit(const char* category) const {
+    const std::unique_ptr<Category>* cat = fCategories->find(SkString(category));
+    return cat ? (*cat)->fByteLimit : 0;
+}
+
+SkResourceCache::NamespaceStats SkResourceCache::getNamespaceStats(void* nameSpace) const {
+    const Namespace* ns = fNamespaces->find(nameSpace);
+    return ns ? ns->fStats : NamespaceStats();
+}
+
+void SkResourceCache::visitNamespaceStats(StatsVisitor visitor, void* context) const {
+    fNamespaces->foreach([&](void* nameSpace, const Namespace* ns) {
+        visitor(nameSpace, ns->fStats, context);
+    });
+}
+
 SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
     this->checkMessages();
 
@@ -361,6 +495,12 @@ void SkResourceCache::addToHead(Rec* rec) {
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
 
+    Namespace* ns = fNamespaces->find(rec->getKey().getNamespace());
+    SkASSERT(ns && ns->fCategory);
+    ns->fStats.fBytesUsed += rec->bytesUsed();
+    ns->fStats.fCount += 1;
+    ns->fCategory->fBytesUsed += rec->bytesUsed();
+
     this->validate();
 }
 
@@ -408,6 +548,28 @@ void SkResourceCache::validate() const {
 
     SkASSERT(0 == count);
     SkASSERT(0 == used);
+
+    fNamespaces->foreach([&](void* nameSpace, const Namespace* ns) {
+        size_t nsUsed = 0;
+        int nsCount = 0;
+        for (const Rec* r = fHead; r; r = r->fNext) {
+            if (r->getKey().getNamespace() == nameSpace) {
+                nsUsed += r->bytesUsed();
+                nsCount += 1;
+            }
+        }
+        SkASSERT(nsUsed == ns->fStats.fBytesUsed);
+        SkASSERT(nsCount == ns->fStats.fCount);
+    });
+    fCategories->foreach([&](const SkString&, const std::unique_ptr<Category>* cat) {
+        size_t catUsed = 0;
+        fNamespaces->foreach([&](void*, const Namespace* ns) {
+            if (ns->fCategory == cat->get()) {
+                catUsed += ns->fStats.fBytesUsed;
+            }
+        });
+        SkASSERT(catUsed == (*cat)->fBytesUsed);
+    });
 }
 #endif
 
@@ -416,6 +578,13 @@ void SkResourceCache::dump() const {
 
     SkDebugf("SkResourceCache: count=%d bytes=%zu %s\n",
              fCount, fTotalBytesUsed, fDiscardableFactory ? "discardable" : "malloc");
+    fNamespaces->foreach([](void*, const Namespace* ns) {
+        const NamespaceStats* stats = &ns->fStats;
+        SkDebugf("    %-24s count=%d bytes=%zu limit=%zu hits=%llu misses=%llu evictions=%llu\n",
+                 stats->fCategory ? stats->fCategory : "(none)", stats->fCount,
+                 stats->fBytesUsed, stats->fByteLimit, (unsigned long long)stats->fHits,
+                 (unsigned long long)stats->fMisses, (unsigned long long)stats->fEvictions);
+    });
 }
 
 size_t SkResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
@@ -454,94 +623,173 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
+namespace {
+struct CacheShard {
+    SkMutex          fMutex;
+    SkResourceCache* fCache;
+};
+}  // namespace
+
+static constexpr int kShardCount = SK_RESOURCE_CACHE_SHARD_COUNT;
+static_assert(kShardCount >= 1, "need at least one resource cache shard");
+
+// Splits a global limit across the shards. A non-zero limit never rounds down to 0 ("no limit").
+static size_t shard_limit(size_t limit) {
+    return limit ? std::max<size_t>(limit / kShardCount, 1) : 0;
 }
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+static CacheShard* get_shards() {
+    static CacheShard* gShards = [] {
+        CacheShard* shards = new CacheShard[kShardCount];
+        for (int i = 0; i < kShardCount; ++i) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+            shards[i].fCache = new SkResourceCache(SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+            shards[i].fCache = new SkResourceCache(shard_limit(SK_DEFAULT_IMAGE_CACHE_LIMIT));
 #endif
+        }
+        return shards;
+    }();
+    return gShards;
+}
+
+static CacheShard& shard_for(const SkResourceCache::Key& key) {
+    // The shards' tables index by the low bits of the hash; mix them so each shard uses all of
+    // its table.
+    return get_shards()[SkChecksum::Mix(key.hash()) % kShardCount];
+}
+
+/** Calls fn(SkResourceCache*) on every shard, each while holding that shard's mutex. */
+template <typename Fn>
+static void for_each_shard(Fn&& fn) {
+    CacheShard* shards = get_shards();
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive am(shards[i].fMutex);
+        fn(shards[i].fCache);
     }
-    return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalBytesUsed();
+    size_t total = 0;
+    for_each_shard([&](SkResourceCache* cache) { total += cache->getTotalBytesUsed(); });
+    return total;
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalByteLimit();
+    size_t total = 0;
+    for_each_shard([&](SkResourceCache* cache) { total += cache->getTotalByteLimit(); });
+    return total;
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setTotalByteLimit(newLimit);
+    size_t prevLimit = 0;
+    for_each_shard([&](SkResourceCache* cache) {
+        prevLimit += cache->setTotalByteLimit(shard_limit(newLimit));
+    });
+    return prevLimit;
+}
+
+size_t SkResourceCache::SetCategoryByteLimit(const char* category, size_t newLimit) {
+    size_t prevLimit = 0;
+    for_each_shard([&](SkResourceCache* cache) {
+        prevLimit += cache->setCategoryByteLimit(category, shard_limit(newLimit));
+    });
+    return prevLimit;
+}
+
+size_t SkResourceCache::GetCategoryByteLimit(const char* category) {
+    size_t total = 0;
+    for_each_shard([&](SkResourceCache* cache) {
+        total += cache->getCategoryByteLimit(category);
+    });
+    return total;
+}
+
+void SkResourceCache::VisitNamespaceStats(StatsVisitor visitor, void* context) {
+    THashMap<void*, NamespaceStats> merged;
+    for_each_shard([&](SkResourceCache* cache) {
+        cache->fNamespaces->foreach([&](void* nameSpace, const Namespace* ns) {
+            const NamespaceStats* stats = &ns->fStats;
+            NamespaceStats* sum = merged.find(nameSpace);
+            if (!sum) {
+                sum = merged.set(nameSpace, NamespaceStats());
+            }
+            if (!sum->fCategory) {
+                sum->fCategory = stats->fCategory;
+            }
+            sum->fBytesUsed       += stats->fBytesUsed;
+            sum->fByteLimit       += stats->fByteLimit;
+            sum->fCount           += stats->fCount;
+            sum->fHits            += stats->fHits;
+            sum->fMisses          += stats->fMisses;
+            sum->fEvictions       += stats->fEvictions;
+            sum->fEvictionsCaused += stats->fEvictionsCaused;
+        });
+    });
+    merged.foreach([&](void* nameSpace, const NamespaceStats* stats) {
+        visitor(nameSpace, *stats, context);
+    });
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->discardableFactory();
+    CacheShard& shard = get_shards()[0];
+    SkAutoMutexExclusive am(shard.fMutex);
+    return shard.fCache->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->newCachedData(bytes);
+    CacheShard& shard = get_shards()[0];
+    SkAutoMutexExclusive am(shard.fMutex);
+    return shard.fCache->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->dump();
+    for_each_shard([](SkResourceCache* cache) { cache->dump(); });
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setSingleAllocationByteLimit(size);
+    size_t prevLimit = 0;
+    for_each_shard([&](SkResourceCache* cache) {
+        prevLimit = cache->setSingleAllocationByteLimit(size);
+    });
+    return prevLimit;
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getSingleAllocationByteLimit();
+    CacheShard& shard = get_shards()[0];
+    SkAutoMutexExclusive am(shard.fMutex);
+    return shard.fCache->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getEffectiveSingleAllocationByteLimit();
+    // Every rec lives in exactly one shard, so a single shard's budget is what caps it.
+    CacheShard& shard = get_shards()[0];
+    SkAutoMutexExclusive am(shard.fMutex);
+    return shard.fCache->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    for_each_shard([](SkResourceCache* cache) { cache->purgeAll(); });
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->checkMessages();
+    for_each_shard([](SkResourceCache* cache) { cache->checkMessages(); });
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->find(key, visitor, context);
+    CacheShard& shard = shard_for(key);
+    SkAutoMutexExclusive am(shard.fMutex);
+    return shard.fCache->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->add(rec, payload);
+    CacheShard& shard = shard_for(rec->getKey());
+    SkAutoMutexExclusive am(shard.fMutex);
+    shard.fCache->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->visitAll(visitor, context);
+    for_each_shard([&](SkResourceCache* cache) { cache->visitAll(visitor, context); });
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
@@ -567,6 +815,14 @@ size_t SkGraphics::SetResourceCacheTotalByteLimit(size_t newLimit) {
     return SkResourceCache::SetTotalByteLimit(newLimit);
 }
 
+size_t SkGraphics::GetResourceCacheCategoryByteLimit(const char* category) {
+    return SkResourceCache::GetCategoryByteLimit(category);
+}
+
+size_t SkGraphics::SetResourceCacheCategoryByteLimit(const char* category, size_t newLimit) {
+    return SkResourceCache::SetCategoryByteLimit(category, newLimit);
+}
+
 size_t SkGraphics::GetResourceCacheSingleAllocationByteLimit() {
     return SkResourceCache::GetSingleAllocationByteLimit();
 }
@@ -607,8 +863,49 @@ static void sk_trace_dump_visitor(const SkResourceCache::Rec& rec, void* context
     }
 }
 
+static void sk_trace_stats_visitor(void*, const SkResourceCache::NamespaceStats& stats,
+                                   void* context) {
+    if (!stats.fCategory) {
+        return;  // Only ever missed; nothing was added so we don't know what to call it.
+    }
+    // Namespaces sharing a category (and so its budget) are dumped together.
+    auto* categories = static_cast<THashMap<SkString, SkResourceCache::NamespaceStats>*>(context);
+    SkString category(stats.fCategory);
+    SkResourceCache::NamespaceStats* sum = categories->find(category);
+    if (!sum) {
+        sum = categories->set(category, SkResourceCache::NamespaceStats());
+        sum->fCategory = stats.fCategory;
+        sum->fByteLimit = stats.fByteLimit;
+    }
+    sum->fBytesUsed       += stats.fBytesUsed;
+    sum->fCount           += stats.fCount;
+    sum->fHits            += stats.fHits;
+    sum->fMisses          += stats.fMisses;
+    sum->fEvictions       += stats.fEvictions;
+    sum->fEvictionsCaused += stats.fEvictionsCaused;
+}
+
+static void sk_trace_dump_stats(const SkResourceCache::NamespaceStats& stats,
+                                SkTraceMemoryDump* dump) {
+    // These are aggregates of the per-Rec dumps, so avoid "size" (which would be double counted).
+    SkString dumpName = SkStringPrintf("skia/sk_resource_cache_stats/%s", stats.fCategory);
+    dump->dumpNumericValue(dumpName.c_str(), "bytes_used", "bytes", stats.fBytesUsed);
+    dump->dumpNumericValue(dumpName.c_str(), "byte_limit", "bytes", stats.fByteLimit);
+    dump->dumpNumericValue(dumpName.c_str(), "count", "objects", stats.fCount);
+    dump->dumpNumericValue(dumpName.c_str(), "hits", "objects", stats.fHits);
+    dump->dumpNumericValue(dumpName.c_str(), "misses", "objects", stats.fMisses);
+    dump->dumpNumericValue(dumpName.c_str(), "evictions", "objects", stats.fEvictions);
+    dump->dumpNumericValue(dumpName.c_str(), "evictions_caused", "objects",
+                           stats.fEvictionsCaused);
+}
+
 void SkResourceCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     // Since resource could be backed by malloc or discardable, the cache always dumps detailed
     // stats to be accurate.
     VisitAll(sk_trace_dump_visitor, dump);
+    THashMap<SkString, NamespaceStats> categories;
+    VisitNamespaceStats(sk_trace_stats_visitor, &categories);
+    categories.foreach([&](const SkString&, const NamespaceStats* stats) {
+        sk_trace_dump_stats(*stats, dump);
+    });
 }
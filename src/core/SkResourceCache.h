@@ -117,6 +117,23 @@ public:
 
     typedef const Rec* ID;
 
+    /**
+     *  Per-namespace accounting. Each Key namespace (i.e. each Key subclass) gets its own
+     *  counters, and may be given a sub-budget (by category) so that one client cannot flush
+     *  another client's entries out of the shared LRU. Namespaces of the same category share
+     *  its budget.
+     */
+    struct NamespaceStats {
+        const char* fCategory = nullptr;    // getCategory() of the first Rec added, if any
+        size_t      fBytesUsed = 0;
+        size_t      fByteLimit = 0;         // of the category; 0 means only the total applies
+        int         fCount = 0;
+        uint64_t    fHits = 0;
+        uint64_t    fMisses = 0;
+        uint64_t    fEvictions = 0;         // recs of this namespace purged to meet a budget
+        uint64_t    fEvictionsCaused = 0;   // recs (of any namespace) purged by our adds
+    };
+
     /**
      *  Callback function for find(). If called, the cache will have found a match for the
      *  specified Key, and will pass in the corresponding Rec, along with a caller-specified
@@ -167,6 +184,17 @@ public:
     static void PurgeAll();
     static void CheckMessages();
 
+    /**
+     *  Sub-budgets are keyed by Rec::getCategory(), e.g. "bitmap", "mipmap" or "rrect-blur".
+     *  A limit of 0 removes the sub-budget. Returns the previous limit.
+     */
+    static size_t SetCategoryByteLimit(const char* category, size_t newLimit);
+    static size_t GetCategoryByteLimit(const char* category);
+
+    typedef void (*StatsVisitor)(void* nameSpace, const NamespaceStats&, void* context);
+    // Call the visitor for every namespace the cache has seen (summed across shards).
+    static void VisitNamespaceStats(StatsVisitor, void* context);
+
     static void TestDumpMemoryStatistics();
 
     /** Dump memory usage statistics of every Rec in the cache using the
@@ -242,6 +270,18 @@ public:
      */
     size_t setTotalByteLimit(size_t newLimit);
 
+    /**
+     *  Set the maximum number of bytes that recs reporting this category may use. If the
+     *  current usage exceeds the new value, those recs (and only those) are purged to fit.
+     *  0 means the category is only bound by the total limit. Returns the previous value.
+     */
+    size_t setCategoryByteLimit(const char* category, size_t newLimit);
+    size_t getCategoryByteLimit(const char* category) const;
+
+    /** Returns the counters for the given namespace (all zero if it has not been seen). */
+    NamespaceStats getNamespaceStats(void* nameSpace) const;
+    void visitNamespaceStats(StatsVisitor, void* context) const;
+
     void purgeSharedID(uint64_t sharedID);
 
     void purgeAll() {
@@ -264,6 +304,15 @@ private:
     class Hash;
     Hash*   fHash;
 
+    struct Category;
+    struct Namespace;
+
+    class NamespaceMap;
+    NamespaceMap* fNamespaces;
+
+    class CategoryMap;
+    CategoryMap* fCategories;
+
     DiscardableFactory  fDiscardableFactory;
 
     size_t  fTotalBytesUsed;
@@ -274,7 +323,12 @@ private:
     SkMessageBus<PurgeSharedIDMessage, uint32_t>::Inbox fPurgeSharedIDInbox;
 
     void checkMessages();
-    void purgeAsNeeded(bool forcePurge = false);
+    // Returns the number of recs that were purged.
+    int purgeAsNeeded(bool forcePurge = false);
+    int purgeCategoryAsNeeded(Category*);
+
+    Namespace* findOrCreateNamespace(void* nameSpace);
+    Category* findOrCreateCategory(const char* name);
 
     // linklist management
     void moveToHead(Rec*);
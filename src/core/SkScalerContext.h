@@ -286,6 +286,12 @@ public:
     // DEPRECATED
     bool isVertical() const { return false; }
 
+    /** Returns true if scaler contexts for this typeface can make glyph images on several threads
+     *  at once without serializing on a lock shared between them, e.g. one around the font
+     *  library. Only then is it worth rasterizing a strike's glyphs in parallel.
+     */
+    virtual bool canGenerateImagesConcurrently() const { return false; }
+
     SkGlyph     makeGlyph(SkPackedGlyphID, SkArenaAlloc*);
     void        getImage(const SkGlyph&);
     void        getPath(SkGlyph&, SkArenaAlloc*);
@@ -8,6 +8,7 @@
 #include "src/core/SkStrike.h"
 
 #include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
@@ -21,14 +22,17 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <algorithm>
 #include <cctype>
 #include <new>
 #include <optional>
 #include <utility>
 
+using namespace skia_private;
 using namespace skglyph;
 
 static SkFontMetrics use_or_generate_metrics(
@@ -115,18 +119,29 @@ SkStrike::FlattenGlyphsByType(SkWriteBuffer& buffer,
 }
 
 bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
+    Monitor m{this};
+    return this->mergeGlyphsFromBuffer(buffer);
+}
+
+bool SkStrike::mergeFromBufferBeforeAttach(SkReadBuffer& buffer) {
+    SkASSERT(fPrev == nullptr && fNext == nullptr);
+    SkAutoMutexExclusive lock{fStrikeLock};
+    fMemoryIncrease = 0;
+    const bool merged = this->mergeGlyphsFromBuffer(buffer);
+    fMemoryUsed += fMemoryIncrease;
+    fMemoryIncrease = 0;
+    return merged;
+}
+
+bool SkStrike::mergeGlyphsFromBuffer(SkReadBuffer& buffer) {
     // Read glyphs with images for the current strike.
     const int imagesCount = buffer.readInt();
     if (imagesCount == 0 && !buffer.isValid()) {
         return false;
     }
-
-    {
-        Monitor m{this};
-        for (int curImage = 0; curImage < imagesCount; ++curImage) {
-            if (!this->mergeGlyphAndImageFromBuffer(buffer)) {
-                return false;
-            }
+    for (int curImage = 0; curImage < imagesCount; ++curImage) {
+        if (!this->mergeGlyphAndImageFromBuffer(buffer)) {
+            return false;
         }
     }
 
@@ -135,12 +150,9 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     if (pathsCount == 0 && !buffer.isValid()) {
         return false;
     }
-    {
-        Monitor m{this};
-        for (int curPath = 0; curPath < pathsCount; ++curPath) {
-            if (!this->mergeGlyphAndPathFromBuffer(buffer)) {
-                return false;
-            }
+    for (int curPath = 0; curPath < pathsCount; ++curPath) {
+        if (!this->mergeGlyphAndPathFromBuffer(buffer)) {
+            return false;
         }
     }
 
@@ -149,18 +161,30 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     if (drawablesCount == 0 && !buffer.isValid()) {
         return false;
     }
-    {
-        Monitor m{this};
-        for (int curDrawable = 0; curDrawable < drawablesCount; ++curDrawable) {
-            if (!this->mergeGlyphAndDrawableFromBuffer(buffer)) {
-                return false;
-            }
+    for (int curDrawable = 0; curDrawable < drawablesCount; ++curDrawable) {
+        if (!this->mergeGlyphAndDrawableFromBuffer(buffer)) {
+            return false;
         }
     }
 
     return true;
 }
 
+void SkStrike::flattenGlyphs(SkWriteBuffer& buffer) const {
+    std::vector<SkGlyph> images, paths;
+    SkAutoMutexExclusive lock{fStrikeLock};
+    for (const SkGlyph* glyph : fGlyphForIndex) {
+        if (glyph->setImageHasBeenCalled()) {
+            images.push_back(*glyph);
+        }
+        if (glyph->setPathHasBeenCalled()) {
+            paths.push_back(*glyph);
+        }
+    }
+    // Drawables are not kept; they are made again when needed.
+    FlattenGlyphsByType(buffer, images, paths, {});
+}
+
 SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromGlyph) {
     Monitor m{this};
     // TODO(herb): remove finding the glyph when setting the metrics and image are separated
@@ -255,6 +279,79 @@ SkSpan<const SkGlyph*> SkStrike::prepareDrawables(
     return {results, glyphIDs.size()};
 }
 
+void SkStrike::prefetchImages(SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor) {
+    // Find the glyphs that still need an image; making their metrics is cheap compared to
+    // rasterizing them.
+    std::vector<SkPackedGlyphID> missing;
+    {
+        Monitor m{this};
+        THashSet<SkPackedGlyphID> seen;
+        for (auto glyphID : glyphIDs) {
+            SkGlyph* glyph = this->glyph(glyphID);
+            if (!glyph->setImageHasBeenCalled() && !seen.contains(glyphID)) {
+                seen.add(glyphID);
+                missing.push_back(glyphID);
+            }
+        }
+
+        // Fanning out only pays when the scaler contexts don't all wait on one lock, as
+        // FreeType's do.
+        if (executor == nullptr || !fScalerContext->canGenerateImagesConcurrently() ||
+            missing.size() < 2 * kMinGlyphsPerPrefetchTask) {
+            for (auto glyphID : missing) {
+                this->prepareForImage(this->glyph(glyphID));
+            }
+            return;
+        }
+    }
+
+    struct Task {
+        SkSpan<const SkPackedGlyphID> fGlyphIDs;
+        std::vector<SkGlyph> fGlyphs;
+        SkArenaAlloc fAlloc{kMinAllocAmount};
+    };
+    const size_t taskCount = std::min(kMaxPrefetchTasks,
+                                      missing.size() / kMinGlyphsPerPrefetchTask);
+    std::vector<Task> tasks(taskCount);
+    for (size_t i = 0; i < taskCount; ++i) {
+        const size_t begin = missing.size() * i / taskCount,
+                     end = missing.size() * (i + 1) / taskCount;
+        tasks[i].fGlyphIDs = SkSpan(missing).subspan(begin, end - begin);
+    }
+
+    // The strike's scaler context can't be shared between threads, so each task makes its own
+    // from the descriptor. Glyphs made from the same descriptor have the same metrics.
+    SkTaskGroup group{*executor};
+    group.batch(SkToInt(taskCount), [&](int index) {
+        Task& task = tasks[index];
+        std::unique_ptr<SkScalerContext> scaler = fStrikeSpec.createScalerContext();
+        task.fGlyphs.reserve(task.fGlyphIDs.size());
+        for (auto glyphID : task.fGlyphIDs) {
+            task.fGlyphs.push_back(scaler->makeGlyph(glyphID, &task.fAlloc));
+            task.fGlyphs.back().setImage(&task.fAlloc, scaler.get());
+        }
+    });
+    group.wait();
+
+    Monitor m{this};
+    for (const Task& task : tasks) {
+        for (const SkGlyph& from : task.fGlyphs) {
+            SkGlyph* glyph = this->glyph(from.getPackedID());
+            if (glyph->setImageHasBeenCalled()) {
+                // Another thread prepared it in the meantime.
+                continue;
+            }
+            if (from.maskFormat() == glyph->maskFormat() &&
+                from.width() == glyph->width() && from.height() == glyph->height() &&
+                glyph->setImage(&fAlloc, from.image())) {
+                fMemoryIncrease += glyph->imageSize();
+            } else {
+                this->prepareForImage(glyph);
+            }
+        }
+    }
+}
+
 void SkStrike::glyphIDsToPaths(SkSpan<sktext::IDOrPath> idsOrPaths) {
     Monitor m{this};
     for (sktext::IDOrPath& idOrPath : idsOrPaths) {
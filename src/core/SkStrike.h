@@ -27,6 +27,7 @@
 
 class SkDescriptor;
 class SkDrawable;
+class SkExecutor;
 class SkPath;
 class SkReadBuffer;
 class SkStrikeCache;
@@ -57,6 +58,10 @@ public:
     bool prepareForDrawable(SkGlyph*) override SK_REQUIRES(fStrikeLock);
 
     bool mergeFromBuffer(SkReadBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+
+    // Write the glyphs that have images or paths in the format read by mergeFromBuffer.
+    void flattenGlyphs(SkWriteBuffer& buffer) const SK_EXCLUDES(fStrikeLock);
+
     static void FlattenGlyphsByType(SkWriteBuffer& buffer,
                                     SkSpan<SkGlyph> images,
                                     SkSpan<SkGlyph> paths,
@@ -99,6 +104,13 @@ public:
     SkSpan<const SkGlyph*> prepareDrawables(
             SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fStrikeLock);
 
+    // Make the images of the glyphs that don't have one yet. The images are rasterized in
+    // parallel on the executor, each task using its own scaler context, and are added to the
+    // strike under a single lock. With no executor, a scaler context that can't generate images
+    // concurrently, or only a few glyphs to rasterize, this does the same as prepareImages.
+    void prefetchImages(SkSpan<const SkPackedGlyphID> glyphIDs,
+                        SkExecutor* executor) SK_EXCLUDES(fStrikeLock);
+
     // SkStrikeForGPU APIs
     const SkDescriptor& getDescriptor() const override {
         return fStrikeSpec.descriptor();
@@ -135,6 +147,7 @@ public:
 
 private:
     friend class SkStrikeCache;
+    friend class SkStrikePersistentStore;
     friend class SkStrikeTestingPeer;
     class Monitor;
 
@@ -145,6 +158,11 @@ private:
     // Generate the glyph digest information and update structures to add the glyph.
     SkGlyphDigest* addGlyphAndDigest(SkGlyph* glyph) SK_REQUIRES(fStrikeLock);
 
+    // Like mergeFromBuffer, for a strike that is not in a cache yet. The memory used is added
+    // to fMemoryUsed directly, and the cache counts it when the strike is attached.
+    bool mergeFromBufferBeforeAttach(SkReadBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+
+    bool mergeGlyphsFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     SkGlyph* mergeGlyphFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndPathFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
@@ -195,6 +213,10 @@ private:
     inline static constexpr size_t kMinGlyphImageSize = 16 /* height */ * 8 /* width */;
     inline static constexpr size_t kMinAllocAmount = kMinGlyphImageSize * kMinGlyphCount;
 
+    // Making a scaler context is not free, so each prefetch task rasterizes at least this many.
+    inline static constexpr size_t kMinGlyphsPerPrefetchTask = 16;
+    inline static constexpr size_t kMaxPrefetchTasks = 8;
+
     SkArenaAlloc            fAlloc SK_GUARDED_BY(fStrikeLock) {kMinAllocAmount};
 
     // The following are protected by the SkStrikeCache's mutex.
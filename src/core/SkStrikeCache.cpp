@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 class SkScalerContext;
 struct SkFontMetrics;
@@ -37,10 +38,28 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 }
 
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
+    sk_sp<SkStrikePersistentStore> store;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
+        if (strike == nullptr && fPersistentStore == nullptr) {
+            strike = this->internalCreateStrike(strikeSpec);
+        }
+        if (strike != nullptr) {
+            this->internalPurge();
+            return strike;
+        }
+        store = fPersistentStore;
+    }
+
+    sk_sp<SkStrike> loaded = this->loadStrike(strikeSpec, nullptr, *store);
+
     SkAutoMutexExclusive ac(fLock);
+    // Another thread may have made the strike in the meantime.
     sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
     if (strike == nullptr) {
-        strike = this->internalCreateStrike(strikeSpec);
+        strike = std::move(loaded);
+        this->internalAttachToHead(strike);
     }
     this->internalPurge();
     return strike;
@@ -126,8 +145,21 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         const SkStrikeSpec& strikeSpec,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
+    sk_sp<SkStrikePersistentStore> store;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        // Pinned strikes are filled by their owners (e.g. remote glyph caches).
+        if (fPersistentStore == nullptr || pinner != nullptr) {
+            return this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+        }
+        store = fPersistentStore;
+    }
+
+    sk_sp<SkStrike> strike = this->loadStrike(strikeSpec, maybeMetrics, *store);
+
     SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    this->internalAttachToHead(strike);
+    return strike;
 }
 
 auto SkStrikeCache::internalCreateStrike(
@@ -141,6 +173,44 @@ auto SkStrikeCache::internalCreateStrike(
     return strike;
 }
 
+auto SkStrikeCache::loadStrike(
+        const SkStrikeSpec& strikeSpec,
+        SkFontMetrics* maybeMetrics,
+        const SkStrikePersistentStore& store) -> sk_sp<SkStrike> {
+    std::unique_ptr<SkScalerContext> scaler = strikeSpec.createScalerContext();
+    auto strike = sk_make_sp<SkStrike>(this, strikeSpec, std::move(scaler), maybeMetrics, nullptr);
+    store.load(strike.get());
+    return strike;
+}
+
+void SkStrikeCache::setPersistentStoreDirectory(const char* path) {
+    SkAutoMutexExclusive ac(fLock);
+    fPersistentStore = path != nullptr ? sk_make_sp<SkStrikePersistentStore>(SkString{path})
+                                       : nullptr;
+}
+
+void SkStrikeCache::writeToPersistentStore() {
+    sk_sp<SkStrikePersistentStore> store;
+    std::vector<sk_sp<SkStrike>> strikes;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        if (fPersistentStore == nullptr) {
+            return;
+        }
+        store = fPersistentStore;
+        for (SkStrike* strike = fHead; strike != nullptr; strike = strike->fNext) {
+            if (strike->fPinner == nullptr) {
+                strikes.push_back(sk_ref_sp(strike));
+            }
+        }
+    }
+
+    // The files are written without holding the cache lock.
+    for (const sk_sp<SkStrike>& strike : strikes) {
+        store->store(*strike);
+    }
+}
+
 void SkStrikeCache::purgePinned(size_t minBytesNeeded) {
     SkAutoMutexExclusive ac(fLock);
     this->internalPurge(minBytesNeeded, /* checkPinners= */ true);
@@ -13,6 +13,7 @@
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkThreadAnnotations.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkStrikePersistentStore.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
@@ -74,6 +75,13 @@ public:
     size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
     size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
 
+    // Strikes created after this get the glyphs stored in the directory by an earlier
+    // process. A null path turns this off.
+    void setPersistentStoreDirectory(const char* path) SK_EXCLUDES(fLock);
+
+    // Write the glyphs of the strikes in the cache to the persistent store, if there is one.
+    void writeToPersistentStore() SK_EXCLUDES(fLock);
+
 private:
     friend class SkStrike;  // for SkStrike::updateDelta
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
@@ -82,6 +90,11 @@ private:
             const SkStrikeSpec& strikeSpec,
             SkFontMetrics* maybeMetrics = nullptr,
             std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
+    // Makes a strike with the glyphs that the store has for it. The store reads files, so this
+    // must not hold the lock; the strike is attached by the caller.
+    sk_sp<SkStrike> loadStrike(const SkStrikeSpec& strikeSpec,
+                               SkFontMetrics* maybeMetrics,
+                               const SkStrikePersistentStore& store) SK_EXCLUDES(fLock);
 
     // The following methods can only be called when mutex is already held.
     void internalRemoveStrike(SkStrike* strike) SK_REQUIRES(fLock);
@@ -112,6 +125,8 @@ private:
     int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
     int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
     int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+
+    sk_sp<SkStrikePersistentStore> fPersistentStore SK_GUARDED_BY(fLock);
 };
 
 #endif  // SkStrikeCache_DEFINED
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikePersistentStore.h"
+
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrike.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace skia_private;
+
+#if defined(SK_BUILD_FOR_WIN)
+    #include "src/base/SkLeanWindows.h"
+    static uint32_t process_id() { return (uint32_t)GetCurrentProcessId(); }
+#else
+    #include <unistd.h>
+    static uint32_t process_id() { return (uint32_t)getpid(); }
+#endif
+
+// Bump the version when the format of SkGlyph::flatten* or of the descriptor changes.
+static constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 's');
+static constexpr uint32_t kVersion = 1;
+
+// The typeface properties that stay the same from one process to the next.
+static sk_sp<SkData> typeface_identity(const SkTypeface& typeface) {
+    // The 'head' table has the font revision, a checksum of the whole font and its dates.
+    constexpr SkFontTableTag kHeadTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    const size_t headSize = typeface.getTableSize(kHeadTag);
+    if (headSize == 0) {
+        return nullptr;
+    }
+    AutoTMalloc<uint8_t> head(headSize);
+    if (typeface.getTableData(kHeadTag, 0, headSize, head.get()) != headSize) {
+        return nullptr;
+    }
+
+    SkBinaryWriteBuffer buffer;
+    SkString familyName;
+    typeface.getFamilyName(&familyName);
+    buffer.writeString(familyName.c_str());
+    const SkFontStyle style = typeface.fontStyle();
+    buffer.writeInt(style.weight());
+    buffer.writeInt(style.width());
+    buffer.writeInt(style.slant());
+    buffer.writeInt(typeface.countGlyphs());
+    buffer.writeInt(typeface.getUnitsPerEm());
+    buffer.writeByteArray(head.get(), headSize);
+
+    const int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates(
+            std::max(axisCount, 0));
+    if (axisCount > 0) {
+        typeface.getVariationDesignPosition(coordinates.data(), axisCount);
+    }
+    buffer.writeByteArray(coordinates.data(), coordinates.size() * sizeof(coordinates[0]));
+
+    return buffer.snapshotAsData();
+}
+
+std::optional<SkStrikePersistentStore::Key> SkStrikePersistentStore::keyFor(
+        const SkStrike& strike) const {
+    sk_sp<SkData> identity = typeface_identity(strike.strikeSpec().typeface());
+    if (identity == nullptr) {
+        return std::nullopt;
+    }
+
+    // Clear the typeface ID, which is only unique within this process.
+    std::unique_ptr<SkDescriptor> descriptor = strike.getDescriptor().copy();
+    uint32_t recLength;
+    auto rec = static_cast<const SkScalerContextRec*>(
+            descriptor->findEntry(kRec_SkDescriptorTag, &recLength));
+    if (rec == nullptr || recLength != sizeof(SkScalerContextRec)) {
+        return std::nullopt;
+    }
+    const_cast<SkScalerContextRec*>(rec)->fTypefaceID = 0;
+    descriptor->computeChecksum();
+
+    SkString path = SkStringPrintf("%s/%08x%08x.skglyphs",
+                                   fDirectory.c_str(),
+                                   SkChecksum::Hash32(identity->data(), identity->size()),
+                                   descriptor->getChecksum());
+    return Key{std::move(path),
+               std::move(identity),
+               SkData::MakeWithCopy(descriptor.get(), descriptor->getLength())};
+}
+
+uint64_t SkStrikePersistentStore::MissKey(const SkStrike& strike) {
+    return (uint64_t)strike.strikeSpec().typeface().uniqueID() << 32 |
+           strike.getDescriptor().getChecksum();
+}
+
+bool SkStrikePersistentStore::load(SkStrike* strike) const {
+    const uint64_t missKey = MissKey(*strike);
+    {
+        SkAutoMutexExclusive lock(fMissesLock);
+        if (fMisses.contains(missKey)) {
+            return false;
+        }
+    }
+
+    auto loadGlyphs = [&] {
+        std::optional<Key> key = this->keyFor(*strike);
+        if (!key) {
+            return false;
+        }
+
+        // This maps the file.
+        sk_sp<SkData> data = SkData::MakeFromFileName(key->fPath.c_str());
+        if (data == nullptr) {
+            return false;
+        }
+
+        SkReadBuffer buffer{data->data(), data->size()};
+        if (buffer.readUInt() != kMagic || buffer.readUInt() != kVersion) {
+            return false;
+        }
+        // The file name is only a hash, so check it really is for this strike.
+        sk_sp<SkData> identity = buffer.readByteArrayAsData();
+        sk_sp<SkData> descriptor = buffer.readByteArrayAsData();
+        if (!buffer.isValid() ||
+            !identity->equals(key->fTypefaceIdentity.get()) ||
+            !descriptor->equals(key->fDescriptor.get())) {
+            return false;
+        }
+
+        return strike->mergeFromBufferBeforeAttach(buffer);
+    };
+    if (loadGlyphs()) {
+        return true;
+    }
+
+    SkAutoMutexExclusive lock(fMissesLock);
+    fMisses.add(missKey);
+    return false;
+}
+
+bool SkStrikePersistentStore::store(const SkStrike& strike) const {
+    std::optional<Key> key = this->keyFor(strike);
+    if (!key) {
+        return false;
+    }
+
+    SkBinaryWriteBuffer buffer;
+    buffer.writeUInt(kMagic);
+    buffer.writeUInt(kVersion);
+    buffer.writeDataAsByteArray(key->fTypefaceIdentity.get());
+    buffer.writeDataAsByteArray(key->fDescriptor.get());
+    strike.flattenGlyphs(buffer);
+
+    // Write to a temporary file and move it in place, so a reader never sees half a file. The
+    // temporary file is unique to this write, so processes or threads storing the same strike at
+    // once don't write into each other's file.
+    static std::atomic<uint32_t> gNextTempID{0};
+    SkString tempPath = key->fPath;
+    tempPath.appendf(".%u.%u.tmp",
+                     process_id(), gNextTempID.fetch_add(1, std::memory_order_relaxed));
+    {
+        SkFILEWStream stream{tempPath.c_str()};
+        if (!stream.isValid() || !buffer.writeToStream(&stream)) {
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), key->fPath.c_str()) != 0) {
+        // Some platforms won't replace an existing file.
+        std::remove(key->fPath.c_str());
+        if (std::rename(tempPath.c_str(), key->fPath.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // A strike made from now on can load what was just written.
+    SkAutoMutexExclusive lock(fMissesLock);
+    if (const uint64_t missKey = MissKey(strike); fMisses.contains(missKey)) {
+        fMisses.remove(missKey);
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikePersistentStore_DEFINED
+#define SkStrikePersistentStore_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkTHash.h"
+
+#include <cstdint>
+#include <optional>
+
+class SkStrike;
+
+// Keeps the glyphs of strikes in a directory, so that a later process can use them instead of
+// making them again with a scaler context. Each strike is a file named after a hash of its
+// descriptor and its typeface, and holds the glyph metrics, images and paths in the format of
+// SkStrike::FlattenGlyphsByType. Files are mapped when they are read.
+//
+// Typeface IDs are only unique within a process, so typefaces are identified by their names,
+// style, glyph count and 'head' table. Typefaces without a 'head' table are not stored.
+//
+// The store is thread-safe, so that strikes can be loaded without holding the cache's lock.
+// It remembers the strikes it had nothing for, so that it doesn't look for them again.
+class SkStrikePersistentStore : public SkNVRefCnt<SkStrikePersistentStore> {
+public:
+    explicit SkStrikePersistentStore(SkString directory) : fDirectory(std::move(directory)) {}
+
+    const SkString& directory() const { return fDirectory; }
+
+    // Add the glyphs stored for the strike. The strike must not be in a cache yet.
+    // Returns false if there are none or they can't be read.
+    bool load(SkStrike* strike) const SK_EXCLUDES(fMissesLock);
+
+    // Write the glyphs of the strike, replacing any stored for it before.
+    bool store(const SkStrike& strike) const SK_EXCLUDES(fMissesLock);
+
+private:
+    struct Key {
+        SkString fPath;
+        sk_sp<SkData> fTypefaceIdentity;
+        sk_sp<SkData> fDescriptor;
+    };
+    std::optional<Key> keyFor(const SkStrike& strike) const;
+
+    // The strikes are identified by their typeface's unique ID and their descriptor's checksum.
+    // A collision only costs a strike its stored glyphs.
+    static uint64_t MissKey(const SkStrike& strike);
+
+    const SkString fDirectory;
+    mutable SkMutex fMissesLock;
+    mutable skia_private::THashSet<uint64_t> fMisses SK_GUARDED_BY(fMissesLock);
+};
+
+#endif  // SkStrikePersistentStore_DEFINED
@@ -649,6 +649,59 @@ sk_sp<SkTextBlob> SkTextBlobBuilder::make() {
     return sk_sp<SkTextBlob>(blob);
 }
 
+bool SkTextBlobBuilderPriv::MakeLastRunHorizontal(SkTextBlobBuilder* builder) {
+    if (0 == builder->fLastRun) {
+        return false;
+    }
+
+    auto* run = reinterpret_cast<SkTextBlob::RunRecord*>(builder->fStorage.get() +
+                                                         builder->fLastRun);
+    if (run->positioning() != SkTextBlob::kFull_Positioning) {
+        return false;
+    }
+
+    const uint32_t count = run->glyphCount();
+    SkScalar* pos = run->posBuffer();
+    const SkScalar y = pos[1];
+    for (uint32_t i = 1; i < count; ++i) {
+        if (pos[2 * i + 1] != y) {
+            return false;
+        }
+    }
+
+    SkSafeMath safe;
+    const uint32_t textSize = run->textSize();
+    const size_t fullSize = SkTextBlob::RunRecord::StorageSize(
+            count, textSize, SkTextBlob::kFull_Positioning, &safe);
+    const size_t horizontalSize = SkTextBlob::RunRecord::StorageSize(
+            count, textSize, SkTextBlob::kHorizontal_Positioning, &safe);
+    SkASSERT(safe);
+
+    // The text size, clusters and text follow the positions, so they move down with them.
+    const uint32_t* extended = run->isExtended() ? run->textSizePtr() : nullptr;
+
+    // Pack the x coordinates; each one moves to a lower index, so this is safe in place.
+    for (uint32_t i = 0; i < count; ++i) {
+        pos[i] = pos[2 * i];
+    }
+    run->fFlags = (run->fFlags & ~SkTextBlob::RunRecord::kPositioning_Mask) |
+                  SkTextBlob::kHorizontal_Positioning;
+    // Fully positioned runs ignore the offset; horizontal ones take their y from it.
+    run->fOffset = {0, y};
+
+    if (extended) {
+        memmove(run->textSizePtr(), extended, sizeof(uint32_t) * (1 + count) + textSize);
+    }
+
+    builder->fStorageUsed -= fullSize - horizontalSize;
+    builder->fCurrentRunBuffer.pos = run->posBuffer();
+    builder->fCurrentRunBuffer.clusters = run->clusterBuffer();
+    builder->fCurrentRunBuffer.utf8text = run->textBuffer();
+
+    run->validate(builder->fStorage.get() + builder->fStorageUsed);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 void SkTextBlobPriv::Flatten(const SkTextBlob& blob, SkWriteBuffer& buffer) {
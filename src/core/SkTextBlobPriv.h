@@ -41,6 +41,17 @@ public:
     static bool HasRSXForm(const SkTextBlob& blob);
 };
 
+class SkTextBlobBuilderPriv {
+public:
+    /**
+     *  If the last run allocated by the builder is fully positioned and all of its glyphs share
+     *  the same y, rewrites it in place as a horizontally positioned run (one scalar per glyph
+     *  instead of two) and returns true. The buffers returned by the last alloc call are updated
+     *  to point at the rewritten run.
+     */
+    static bool MakeLastRunHorizontal(SkTextBlobBuilder*);
+};
+
 //
 // Textblob data is laid out into externally-managed storage as follows:
 //
@@ -147,6 +158,7 @@ public:
 
 private:
     friend class SkTextBlobBuilder;
+    friend class SkTextBlobBuilderPriv;
 
     enum Flags {
         kPositioning_Mask = 0x03, // bits 0-1 reserved for positioning
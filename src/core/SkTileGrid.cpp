@@ -0,0 +1,136 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkTileGrid.h"
+
+#include "include/private/base/SkFloatingPoint.h"
+#include "include/private/base/SkTPin.h"
+
+#include <algorithm>
+#include <cmath>
+
+SkTileGrid::SkTileGrid(SkScalar tileSize) : fTileSize(tileSize > 0 ? tileSize : 128) {}
+
+SkIPoint SkTileGrid::tile(SkScalar x, SkScalar y) const {
+    return {SkTPin(sk_float_floor2int((x - fBounds.fLeft) * fInvTileSize), 0, fXTiles - 1),
+            SkTPin(sk_float_floor2int((y - fBounds.fTop)  * fInvTileSize), 0, fYTiles - 1)};
+}
+
+void SkTileGrid::insert(const SkRect rects[], int N) {
+    SkASSERT(fRects.empty());
+    fRects.assign(rects, rects + N);
+
+    for (int i = 0; i < N; i++) {
+        if (!rects[i].isEmpty()) {
+            fBounds.join(rects[i]);
+            fCount++;
+        }
+    }
+    if (!fCount) {
+        return;
+    }
+
+    if (!fBounds.isFinite()) {
+        // There's no grid to lay over that, so every search goes through all the bounding boxes.
+        for (int i = 0; i < N; i++) {
+            if (!rects[i].isEmpty()) {
+                fLargeIndices.push_back(i);
+            }
+        }
+        return;
+    }
+
+    while (std::ceil(fBounds.width()  / fTileSize) *
+           std::ceil(fBounds.height() / fTileSize) > kMaxTiles) {
+        fTileSize *= 2;
+    }
+    fInvTileSize = 1 / fTileSize;
+    fXTiles = std::max(1, (int)std::ceil(fBounds.width()  / fTileSize));
+    fYTiles = std::max(1, (int)std::ceil(fBounds.height() / fTileSize));
+
+    // Count the bounding boxes of each tile, then list them.
+    const SkScalar maxSize = kMaxBoxTiles * fTileSize;
+    std::vector<int> tiles(N, -1);
+    fTileStarts.assign(fXTiles * fYTiles + 1, 0);
+    for (int i = 0; i < N; i++) {
+        const SkRect& rect = rects[i];
+        if (rect.isEmpty()) {
+            continue;
+        }
+        if (rect.width() > maxSize || rect.height() > maxSize) {
+            fLargeIndices.push_back(i);
+            continue;
+        }
+        fMaxWidth  = std::max(fMaxWidth,  rect.width());
+        fMaxHeight = std::max(fMaxHeight, rect.height());
+        const SkIPoint tile = this->tile(rect.fLeft, rect.fTop);
+        tiles[i] = tile.fY * fXTiles + tile.fX;
+        fTileStarts[tiles[i] + 1]++;
+    }
+    for (int t = 0; t < fXTiles * fYTiles; t++) {
+        fTileStarts[t + 1] += fTileStarts[t];
+    }
+
+    fTileIndices.resize(fTileStarts.back());
+    std::vector<int> ends(fTileStarts.begin(), fTileStarts.end() - 1);
+    for (int i = 0; i < N; i++) {
+        if (tiles[i] >= 0) {
+            fTileIndices[ends[tiles[i]]++] = i;
+        }
+    }
+}
+
+void SkTileGrid::search(const SkRect& query, std::vector<int>* results) const {
+    if (!fCount || !SkRect::Intersects(query, fBounds)) {
+        return;
+    }
+
+    // Each list is in increasing order, so the results only need sorting if several added to them.
+    const size_t firstResult = results->size();
+    int lists = 0;
+
+    if (fXTiles > 0) {
+        // Bounding boxes that overlap the query have their top left corner in these tiles.
+        const SkIPoint first = this->tile(query.fLeft - fMaxWidth, query.fTop - fMaxHeight),
+                       last  = this->tile(query.fRight, query.fBottom);
+        for (int y = first.fY; y <= last.fY; y++) {
+            for (int x = first.fX; x <= last.fX; x++) {
+                const int tile = y * fXTiles + x;
+                bool found = false;
+                for (int j = fTileStarts[tile]; j < fTileStarts[tile + 1]; j++) {
+                    const int index = fTileIndices[j];
+                    if (SkRect::Intersects(query, fRects[index])) {
+                        results->push_back(index);
+                        found = true;
+                    }
+                }
+                lists += found;
+            }
+        }
+    }
+
+    bool found = false;
+    for (int index : fLargeIndices) {
+        if (SkRect::Intersects(query, fRects[index])) {
+            results->push_back(index);
+            found = true;
+        }
+    }
+    lists += found;
+
+    if (lists > 1) {
+        std::sort(results->begin() + firstResult, results->end());
+    }
+}
+
+size_t SkTileGrid::bytesUsed() const {
+    return sizeof(SkTileGrid)
+         + fRects.capacity()        * sizeof(SkRect)
+         + fTileStarts.capacity()   * sizeof(int)
+         + fTileIndices.capacity()  * sizeof(int)
+         + fLargeIndices.capacity() * sizeof(int);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTileGrid_DEFINED
+#define SkTileGrid_DEFINED
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkScalar.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A grid of square tiles over the union of the bounding boxes, each listing the bounding boxes
+ * whose top left corner is in it. It's built with one pass to count each tile's bounding boxes
+ * and one to list them, and a search only goes through the tiles of the bounding boxes that could
+ * overlap the query, which are those under the query and up to the largest bounding box's size
+ * above and to the left of it.
+ *
+ * Bounding boxes wider or higher than kMaxBoxTiles tiles, e.g. those of ops that draw everywhere,
+ * are kept in one list that every search goes through, so that they don't widen every search.
+ */
+class SkTileGrid : public SkBBoxHierarchy {
+public:
+    // Tiles are tileSize wide and high, or larger if there would be more than kMaxTiles of them.
+    explicit SkTileGrid(SkScalar tileSize);
+
+    void insert(const SkRect[], int N) override;
+    void search(const SkRect& query, std::vector<int>* results) const override;
+    size_t bytesUsed() const override;
+
+    // Methods and constants below here are only public for tests.
+
+    // Insertion count of non-empty bounding boxes.
+    int getCount() const { return fCount; }
+    // The size of a tile, once bounding boxes are inserted.
+    SkScalar getTileSize() const { return fTileSize; }
+
+    static constexpr int kMaxTiles = 64 * 64;
+    static constexpr int kMaxBoxTiles = 4;
+
+private:
+    // The tile that x, y is in, clamped to the grid.
+    SkIPoint tile(SkScalar x, SkScalar y) const;
+
+    SkScalar fTileSize;
+    SkScalar fInvTileSize = 0;
+    SkRect fBounds = SkRect::MakeEmpty();
+    // The largest listed bounding box is no wider or higher than these.
+    SkScalar fMaxWidth = 0;
+    SkScalar fMaxHeight = 0;
+    int fXTiles = 0;
+    int fYTiles = 0;
+    int fCount = 0;
+
+    // The bounding boxes, by index.
+    std::vector<SkRect> fRects;
+    // The indices listed by tile t are fTileIndices[fTileStarts[t]] to [fTileStarts[t + 1] - 1],
+    // in increasing order.
+    std::vector<int> fTileStarts;
+    std::vector<int> fTileIndices;
+    // The indices of bounding boxes too large to list by tile, in increasing order.
+    std::vector<int> fLargeIndices;
+};
+
+#endif
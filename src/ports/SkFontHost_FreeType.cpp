@@ -1757,13 +1757,7 @@ void SkTypeface_FreeType::onCharsToGlyphs(const SkUnichar uni[], int count,
     {
         // Optimistically use a shared lock.
         SkAutoSharedMutexShared ama(fC2GCacheMutex);
-        for (i = 0; i < count; ++i) {
-            int index = fC2GCache.findGlyphIndex(uni[i]);
-            if (index < 0) {
-                break;
-            }
-            glyphs[i] = SkToU16(index);
-        }
+        i = fC2GCache.findGlyphs(uni, count, glyphs);
         if (i == count) {
             // we're done, no need to access the freetype objects
             return;
@@ -8,20 +8,198 @@
 #include "include/core/SkStream.h"
 #include "include/ports/SkFontMgr_directory.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkTHash.h"
 #include "src/ports/SkFontMgr_custom.h"
 #include "src/utils/SkOSPath.h"
 
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+/** The results of scanning the font files, kept in a file so that a font manager made later
+ *  only has to open the files that changed since. Files are known by path and are scanned
+ *  again when their size or modification time changes.
+ */
+class FontFileIndex {
+public:
+    struct Face {
+        SkString fFamilyName;
+        SkFontStyle fStyle;
+        bool fIsFixedPitch;
+        int fIndex;
+    };
+    struct File {
+        size_t fSize;
+        int64_t fModified;
+        std::vector<Face> fFaces;  // empty if it isn't a font
+        bool fSeen = false;
+    };
+
+    void read(const char path[]) {
+        std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(path);
+        if (!stream || !read_from(stream.get(), &fFiles)) {
+            fFiles.reset();
+        }
+    }
+
+    bool write(const char path[]) const {
+        SkDynamicMemoryWStream stream;
+        stream.write32(kMagic);
+        stream.write32(kVersion);
+        stream.writePackedUInt(fFiles.count());
+        fFiles.foreach([&stream](const SkString& filePath, const File& file) {
+            write_string(&stream, filePath);
+            uint64_t size = file.fSize;
+            stream.write(&size, sizeof(size));
+            stream.write(&file.fModified, sizeof(file.fModified));
+            stream.writePackedUInt(file.fFaces.size());
+            for (const Face& face : file.fFaces) {
+                write_string(&stream, face.fFamilyName);
+                stream.writePackedUInt(face.fStyle.weight());
+                stream.writePackedUInt(face.fStyle.width());
+                stream.writePackedUInt(face.fStyle.slant());
+                stream.writeBool(face.fIsFixedPitch);
+                stream.writePackedUInt(face.fIndex);
+            }
+        });
+
+        // Write to a temporary file and move it in place, so a reader never sees half a file.
+        SkString tempPath = SkStringPrintf("%s.tmp", path);
+        {
+            SkFILEWStream file(tempPath.c_str());
+            if (!file.isValid() || !stream.writeToStream(&file)) {
+                return false;
+            }
+        }
+        if (std::rename(tempPath.c_str(), path) != 0) {
+            // Some platforms won't replace an existing file.
+            std::remove(path);
+            if (std::rename(tempPath.c_str(), path) != 0) {
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns the file if it hasn't changed since it was scanned.
+    const File* find(const SkString& path, size_t size, int64_t modified) {
+        File* file = fFiles.find(path);
+        if (!file || file->fSize != size || file->fModified != modified) {
+            return nullptr;
+        }
+        file->fSeen = true;
+        return file;
+    }
+
+    const File* set(const SkString& path, File file) {
+        file.fSeen = true;
+        fChanged = true;
+        return fFiles.set(path, std::move(file));
+    }
+
+    // Forgets files that weren't looked for since the index was read, and returns true if the
+    // index is different from the one read.
+    bool removeUnseen() {
+        std::vector<SkString> unseen;
+        fFiles.foreach([&unseen](const SkString& path, const File* file) {
+            if (!file->fSeen) {
+                unseen.push_back(path);
+            }
+        });
+        for (const SkString& path : unseen) {
+            fFiles.remove(path);
+        }
+        return fChanged || !unseen.empty();
+    }
+
+private:
+    static constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'f', 'i');
+    static constexpr uint32_t kVersion = 1;
+
+    static void write_string(SkWStream* stream, const SkString& string) {
+        stream->writePackedUInt(string.size());
+        stream->write(string.c_str(), string.size());
+    }
+
+    static bool read_string(SkStream* stream, SkString* string) {
+        size_t length;
+        if (!stream->readPackedUInt(&length) || length > stream->getLength()) {
+            return false;
+        }
+        string->resize(length);
+        return stream->read(string->data(), length) == length;
+    }
+
+    static bool read_from(SkStreamAsset* stream,
+                          skia_private::THashMap<SkString, File>* files) {
+        uint32_t magic, version;
+        size_t fileCount;
+        if (!stream->readU32(&magic) || magic != kMagic ||
+            !stream->readU32(&version) || version != kVersion ||
+            !stream->readPackedUInt(&fileCount)) {
+            return false;
+        }
+        for (size_t i = 0; i < fileCount; ++i) {
+            SkString path;
+            File file;
+            uint64_t size;
+            size_t faceCount;
+            if (!read_string(stream, &path) ||
+                stream->read(&size, sizeof(size)) != sizeof(size) ||
+                stream->read(&file.fModified, sizeof(file.fModified)) != sizeof(file.fModified) ||
+                !stream->readPackedUInt(&faceCount) || faceCount > stream->getLength()) {
+                return false;
+            }
+            file.fSize = size;
+            for (size_t j = 0; j < faceCount; ++j) {
+                Face face;
+                size_t weight, width, slant, index;
+                if (!read_string(stream, &face.fFamilyName) ||
+                    !stream->readPackedUInt(&weight) ||
+                    !stream->readPackedUInt(&width) ||
+                    !stream->readPackedUInt(&slant) || slant > SkFontStyle::kOblique_Slant ||
+                    !stream->readBool(&face.fIsFixedPitch) ||
+                    !stream->readPackedUInt(&index)) {
+                    return false;
+                }
+                face.fStyle = SkFontStyle(weight, width, (SkFontStyle::Slant)slant);
+                face.fIndex = SkToInt(index);
+                file.fFaces.push_back(std::move(face));
+            }
+            files->set(std::move(path), std::move(file));
+        }
+        return true;
+    }
+
+    skia_private::THashMap<SkString, File> fFiles;
+    bool fChanged = false;
+};
+
+}  // namespace
+
 class DirectorySystemFontLoader : public SkFontMgr_Custom::SystemFontLoader {
 public:
-    DirectorySystemFontLoader(const char* dir) : fBaseDirectory(dir) { }
+    DirectorySystemFontLoader(const char* dir, const char* indexPath)
+        : fBaseDirectory(dir), fIndexPath(indexPath) { }
 
     void loadSystemFonts(const SkTypeface_FreeType::Scanner& scanner,
                          SkFontMgr_Custom::Families* families) const override
     {
-        load_directory_fonts(scanner, fBaseDirectory, ".ttf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".ttc", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".otf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".pfb", families);
+        FontFileIndex index;
+        if (!fIndexPath.isEmpty()) {
+            index.read(fIndexPath.c_str());
+        }
+
+        load_directory_fonts(scanner, fBaseDirectory, ".ttf", families, &index);
+        load_directory_fonts(scanner, fBaseDirectory, ".ttc", families, &index);
+        load_directory_fonts(scanner, fBaseDirectory, ".otf", families, &index);
+        load_directory_fonts(scanner, fBaseDirectory, ".pfb", families, &index);
+
+        if (!fIndexPath.isEmpty() && index.removeUnseen()) {
+            index.write(fIndexPath.c_str());
+        }
 
         if (families->empty()) {
             SkFontStyleSet_Custom* family = new SkFontStyleSet_Custom(SkString());
@@ -42,47 +220,74 @@ private:
         return nullptr;
     }
 
+    static FontFileIndex::File scan_file(const SkTypeface_FreeType::Scanner& scanner,
+                                         const SkString& filename)
+    {
+        FontFileIndex::File file;
+        std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(filename.c_str());
+        if (!stream) {
+            // SkDebugf("---- failed to open <%s>\n", filename.c_str());
+            return file;
+        }
+
+        int numFaces;
+        if (!scanner.recognizedFont(stream.get(), &numFaces)) {
+            // SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
+            return file;
+        }
+
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
+            bool isFixedPitch;
+            SkString realname;
+            SkFontStyle style = SkFontStyle(); // avoid uninitialized warning
+            if (!scanner.scanFont(stream.get(), faceIndex,
+                                  &realname, &style, &isFixedPitch, nullptr))
+            {
+                // SkDebugf("---- failed to open <%s> <%d> as a font\n",
+                //          filename.c_str(), faceIndex);
+                continue;
+            }
+            file.fFaces.push_back({std::move(realname), style, isFixedPitch, faceIndex});
+        }
+        return file;
+    }
+
     static void load_directory_fonts(const SkTypeface_FreeType::Scanner& scanner,
                                      const SkString& directory, const char* suffix,
-                                     SkFontMgr_Custom::Families* families)
+                                     SkFontMgr_Custom::Families* families,
+                                     FontFileIndex* index)
     {
         SkOSFile::Iter iter(directory.c_str(), suffix);
         SkString name;
 
         while (iter.next(&name, false)) {
             SkString filename(SkOSPath::Join(directory.c_str(), name.c_str()));
-            std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(filename.c_str());
-            if (!stream) {
-                // SkDebugf("---- failed to open <%s>\n", filename.c_str());
-                continue;
-            }
 
-            int numFaces;
-            if (!scanner.recognizedFont(stream.get(), &numFaces)) {
-                // SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
+            // Only files that changed since they were indexed are opened.
+            size_t size;
+            int64_t modified;
+            if (!sk_filestat(filename.c_str(), &size, &modified)) {
                 continue;
             }
+            const FontFileIndex::File* file = index->find(filename, size, modified);
+            if (!file) {
+                FontFileIndex::File scanned = scan_file(scanner, filename);
+                scanned.fSize = size;
+                scanned.fModified = modified;
+                file = index->set(filename, std::move(scanned));
+            }
 
-            for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
-                bool isFixedPitch;
-                SkString realname;
-                SkFontStyle style = SkFontStyle(); // avoid uninitialized warning
-                if (!scanner.scanFont(stream.get(), faceIndex,
-                                      &realname, &style, &isFixedPitch, nullptr))
-                {
-                    // SkDebugf("---- failed to open <%s> <%d> as a font\n",
-                    //          filename.c_str(), faceIndex);
-                    continue;
-                }
-
-                SkFontStyleSet_Custom* addTo = find_family(*families, realname.c_str());
+            for (const FontFileIndex::Face& face : file->fFaces) {
+                SkFontStyleSet_Custom* addTo = find_family(*families, face.fFamilyName.c_str());
                 if (nullptr == addTo) {
-                    addTo = new SkFontStyleSet_Custom(realname);
+                    addTo = new SkFontStyleSet_Custom(face.fFamilyName);
                     families->push_back().reset(addTo);
                 }
-                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(style, isFixedPitch, true,
-                                                                  realname, filename.c_str(),
-                                                                  faceIndex));
+                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(face.fStyle,
+                                                                  face.fIsFixedPitch, true,
+                                                                  face.fFamilyName,
+                                                                  filename.c_str(),
+                                                                  face.fIndex));
             }
         }
 
@@ -92,13 +297,18 @@ private:
                 continue;
             }
             SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
-            load_directory_fonts(scanner, dirname, suffix, families);
+            load_directory_fonts(scanner, dirname, suffix, families, index);
         }
     }
 
     SkString fBaseDirectory;
+    SkString fIndexPath;
 };
 
 SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir) {
-    return sk_make_sp<SkFontMgr_Custom>(DirectorySystemFontLoader(dir));
+    return SkFontMgr_New_Custom_Directory(dir, nullptr);
+}
+
+SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath) {
+    return sk_make_sp<SkFontMgr_Custom>(DirectorySystemFontLoader(dir, indexPath));
 }
@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkTo.h"
 #include "src/core/SkOSFile.h"
 
 #include <errno.h>
@@ -156,6 +157,16 @@ bool sk_isdir(const char *path) {
     return SkToBool(status.st_mode & S_IFDIR);
 }
 
+bool sk_filestat(const char* path, size_t* size, int64_t* modified) {
+    struct stat status;
+    if (0 != stat(path, &status)) {
+        return false;
+    }
+    *size = SkToSizeT(status.st_size);
+    *modified = status.st_mtime;
+    return true;
+}
+
 bool sk_mkdir(const char* path) {
     if (sk_isdir(path)) {
         return true;
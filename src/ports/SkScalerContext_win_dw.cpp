@@ -428,6 +428,10 @@ SkScalerContext_DW::SkScalerContext_DW(sk_sp<DWriteFontTypeface> typefaceRef,
 SkScalerContext_DW::~SkScalerContext_DW() {
 }
 
+bool SkScalerContext_DW::canGenerateImagesConcurrently() const {
+    return maybe_dw_mutex(*static_cast<DWriteFontTypeface*>(this->getTypeface())) == nullptr;
+}
+
 bool SkScalerContext_DW::generateAdvance(SkGlyph* glyph) {
     glyph->fAdvanceX = 0;
     glyph->fAdvanceY = 0;
@@ -27,6 +27,8 @@ public:
                        const SkDescriptor*);
     ~SkScalerContext_DW() override;
 
+    bool canGenerateImagesConcurrently() const override;
+
 protected:
     bool generateAdvance(SkGlyph* glyph) override;
     void generateMetrics(SkGlyph* glyph, SkArenaAlloc*) override;
@@ -7,6 +7,10 @@
 
 #include "src/utils/SkCharToGlyphCache.h"
 
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+
 SkCharToGlyphCache::SkCharToGlyphCache() {
     this->reset();
 }
@@ -14,6 +18,7 @@ SkCharToGlyphCache::SkCharToGlyphCache() {
 SkCharToGlyphCache::~SkCharToGlyphCache() {}
 
 void SkCharToGlyphCache::reset() {
+    fDense.reset();
     fK32.reset();
     fV16.reset();
 
@@ -93,6 +98,13 @@ static int find_with_slope(const SkUnichar base[], int count, SkUnichar value, d
 }
 
 int SkCharToGlyphCache::findGlyphIndex(SkUnichar unichar) const {
+    if ((uint32_t)unichar < (uint32_t)kDenseCount) {
+        if (fDense && fDense[unichar] != kNotInDense) {
+            return fDense[unichar];
+        }
+        return ~0;  // insertCharAndGlyph doesn't use the index for the dense range
+    }
+
     const int count = fK32.size();
     int index;
     if (count <= kSmallCountLimit) {
@@ -106,7 +118,55 @@ int SkCharToGlyphCache::findGlyphIndex(SkUnichar unichar) const {
     return index;
 }
 
+int SkCharToGlyphCache::findGlyphs(const SkUnichar unichars[], int count,
+                                   SkGlyphID glyphs[]) const {
+    using U32x8 = skvx::Vec<8, uint32_t>;
+    using U16x8 = skvx::Vec<8, uint16_t>;
+
+    int i = 0;
+    while (i < count) {
+        if (fDense) {
+            for (; i + 8 <= count; i += 8) {
+                const U32x8 c = U32x8::Load(unichars + i);
+                if (any(c >= (uint32_t)kDenseCount)) {
+                    break;
+                }
+                for (int j = 0; j < 8; ++j) {
+                    glyphs[i + j] = fDense[c[j]];
+                }
+                if (any(U16x8::Load(glyphs + i) == kNotInDense)) {
+                    break;
+                }
+            }
+        }
+        if (i == count) {
+            break;
+        }
+
+        // One at a time until the next run of eight.
+        const int stop = std::min(count, i + 8);
+        for (; i < stop; ++i) {
+            const int index = this->findGlyphIndex(unichars[i]);
+            if (index < 0) {
+                return i;
+            }
+            glyphs[i] = SkToU16(index);
+        }
+    }
+    return count;
+}
+
 void SkCharToGlyphCache::insertCharAndGlyph(int index, SkUnichar unichar, SkGlyphID glyph) {
+    if ((uint32_t)unichar < (uint32_t)kDenseCount) {
+        SkASSERT(glyph != kNotInDense);
+        if (!fDense) {
+            fDense = std::make_unique<SkGlyphID[]>(kDenseCount);
+            std::fill_n(fDense.get(), kDenseCount, kNotInDense);
+        }
+        fDense[unichar] = glyph;
+        return;
+    }
+
     SkASSERT(fK32.size() == fV16.size());
     SkASSERT(index < fK32.size());
     SkASSERT(unichar < fK32[index]);
@@ -13,13 +13,14 @@
 #include "include/private/base/SkTo.h"
 
 #include <cstdint>
+#include <memory>
 
 class SkCharToGlyphCache {
 public:
     SkCharToGlyphCache();
     ~SkCharToGlyphCache();
 
-    // return number of unichars cached
+    // return number of unichars cached outside of the dense range
     int count() const {
         return fK32.size();
     }
@@ -40,6 +41,13 @@ public:
      */
     int findGlyphIndex(SkUnichar c) const;
 
+    /**
+     *  Look up the glyphIDs of the unichars in order, stopping at the first one not in the cache.
+     *  Returns the number of glyphs written. Runs of unichars in the dense range are looked up
+     *  several at a time.
+     */
+    int findGlyphs(const SkUnichar unichars[], int count, SkGlyphID glyphs[]) const;
+
     /**
      *  Insert a new char/glyph pair into the cache at the specified index.
      *  See charToGlyph() for how to compute the bit-not of the index.
@@ -57,6 +65,13 @@ public:
     }
 
 private:
+    // Unichars below this (Latin-1 and Latin Extended-A and B) are kept in a table indexed by
+    // unichar, so the text that is most common doesn't have to be searched for.
+    static constexpr SkUnichar kDenseCount = 0x250;
+    // Never a glyphID: fonts have at most 0xFFFF glyphs.
+    static constexpr SkGlyphID kNotInDense = 0xFFFF;
+
+    std::unique_ptr<SkGlyphID[]> fDense;  // allocated on the first insert in the dense range
     SkTDArray<int32_t>   fK32;
     SkTDArray<uint16_t>  fV16;
     double               fDenom;
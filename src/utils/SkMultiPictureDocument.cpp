@@ -10,16 +10,23 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDocument.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkTypes.h"
+#include "include/encode/SkPngEncoder.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTo.h"
 #include "include/utils/SkNWayCanvas.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkTHash.h"
+#include "src/image/SkImage_Base.h"
 #include "src/utils/SkMultiPictureDocumentPriv.h"
 
 #include <algorithm>
@@ -34,13 +41,19 @@ using namespace skia_private;
   File format:
       BEGINNING_OF_FILE:
         kMagic
-        uint32_t version_number (==2)
+        uint32_t version_number (==3)
         uint32_t page_count
         {
           float sizeX
           float sizeY
         } * page_count
         skp file
+
+  The pages are played back one after the other into the picture of the skp file, each followed
+  by a kEndPage annotation, so they share its paths, images and text blobs. Since version 3 each
+  image and typeface is also written once, tagged kDefineResource and with an id, the first time
+  its contents are seen. Others with the same contents, in any page or nested picture, are
+  written as kReferResource and that id.
 */
 
 namespace {
@@ -49,7 +62,12 @@ static constexpr char kMagic[] = "Skia Multi-Picture Doc\n\n";
 
 static constexpr char kEndPage[] = "SkMultiPictureEndPage";
 
-const uint32_t kVersion = 2;
+const uint32_t kVersion = 3;
+// Documents written before resources were shared can still be read.
+const uint32_t kMinVersion = 2;
+
+static constexpr uint32_t kDefineResource = SkSetFourByteTag('m', 's', 'k', 'd');
+static constexpr uint32_t kReferResource = SkSetFourByteTag('m', 's', 'k', 'r');
 
 static SkSize join(const TArray<SkSize>& sizes) {
     SkSize joined = {0, 0};
@@ -59,6 +77,213 @@ static SkSize join(const TArray<SkSize>& sizes) {
     return joined;
 }
 
+// Gives an id to each distinct payload, known by its bytes.
+class PayloadIds {
+public:
+    // Returns true if the same bytes were added before, with the id they were given.
+    bool findOrAdd(sk_sp<SkData> data, uint32_t* id) {
+        Payload payload{std::move(data), 0};
+        payload.fHash = SkChecksum::Hash32(payload.fData->data(), payload.fData->size());
+        if (const uint32_t* found = fIds.find(payload)) {
+            *id = *found;
+            return true;
+        }
+        *id = SkToU32(fIds.count());
+        fIds.set(std::move(payload), *id);
+        return false;
+    }
+
+private:
+    struct Payload {
+        sk_sp<SkData> fData;
+        uint32_t fHash;
+
+        bool operator==(const Payload& that) const {
+            return fHash == that.fHash && fData->equals(that.fData.get());
+        }
+    };
+    struct PayloadHash {
+        uint32_t operator()(const Payload& payload) const { return payload.fHash; }
+    };
+
+    THashMap<Payload, uint32_t, PayloadHash> fIds;
+};
+
+// Wraps the procs the document was made with, so that images and typefaces are written once
+// however many pages use them, and however many objects have the same contents.
+class SharingSerialProcs {
+public:
+    explicit SharingSerialProcs(const SkSerialProcs& procs) : fProcs(procs) {
+        fSharingProcs = procs;
+        fSharingProcs.fImageProc = SerializeImage;
+        fSharingProcs.fImageCtx = this;
+        fSharingProcs.fTypefaceProc = SerializeTypeface;
+        fSharingProcs.fTypefaceCtx = this;
+    }
+
+    const SkSerialProcs* procs() const { return &fSharingProcs; }
+
+private:
+    static sk_sp<SkData> Refer(uint32_t id) {
+        SkDynamicMemoryWStream stream;
+        stream.write32(kReferResource);
+        stream.write32(id);
+        return stream.detachAsData();
+    }
+
+    // Returns what to write for the payload, defining it only if it's the first of its kind.
+    static sk_sp<SkData> Share(PayloadIds* ids, sk_sp<SkData> payload, uint32_t* id) {
+        if (ids->findOrAdd(payload, id)) {
+            return Refer(*id);
+        }
+        SkDynamicMemoryWStream stream;
+        stream.write32(kDefineResource);
+        stream.write32(*id);
+        stream.write(payload->data(), payload->size());
+        return stream.detachAsData();
+    }
+
+    static sk_sp<SkData> SerializeImage(SkImage* image, void* ctx) {
+        auto self = static_cast<SharingSerialProcs*>(ctx);
+        // An image is only encoded the first time it's seen.
+        if (const uint32_t* id = self->fImageIds.find(image->uniqueID())) {
+            return Refer(*id);
+        }
+        sk_sp<SkData> encoded;
+        if (self->fProcs.fImageProc) {
+            encoded = self->fProcs.fImageProc(image, self->fProcs.fImageCtx);
+        }
+        if (!encoded) {
+            encoded = image->refEncodedData();
+        }
+        if (!encoded) {
+            // As SkWriteBuffer does, a texture-backed image is read back with its own context.
+            encoded = SkPngEncoder::Encode(as_IB(image)->directContext(), image, {});
+        }
+        if (!encoded) {
+            return nullptr;
+        }
+        uint32_t id;
+        sk_sp<SkData> data = Share(&self->fImagePayloads, std::move(encoded), &id);
+        self->fImageIds.set(image->uniqueID(), id);
+        return data;
+    }
+
+    static sk_sp<SkData> SerializeTypeface(SkTypeface* typeface, void* ctx) {
+        auto self = static_cast<SharingSerialProcs*>(ctx);
+        // Pictures already write each typeface object once, so only the contents are compared.
+        sk_sp<SkData> serialized;
+        if (self->fProcs.fTypefaceProc) {
+            serialized = self->fProcs.fTypefaceProc(typeface, self->fProcs.fTypefaceCtx);
+        }
+        if (!serialized) {
+            serialized = typeface->serialize();
+        }
+        uint32_t id;
+        return Share(&self->fTypefacePayloads, std::move(serialized), &id);
+    }
+
+    const SkSerialProcs fProcs;
+    SkSerialProcs fSharingProcs;
+    THashMap<uint32_t, uint32_t> fImageIds;  // by SkImage::uniqueID()
+    PayloadIds fImagePayloads;
+    PayloadIds fTypefacePayloads;
+};
+
+// Reads what SharingSerialProcs wrote, with the procs the document is read with. Each image is
+// made once and shared by every page that uses it.
+class SharingDeserialProcs {
+public:
+    explicit SharingDeserialProcs(const SkDeserialProcs& procs) : fProcs(procs) {
+        fSharingProcs = procs;
+        fSharingProcs.fImageProc = DeserializeImage;
+        fSharingProcs.fImageCtx = this;
+        fSharingProcs.fTypefaceProc = DeserializeTypeface;
+        fSharingProcs.fTypefaceCtx = this;
+        // The maps of what has been read aren't locked, so images are decoded one at a time.
+        fSharingProcs.fExecutor = nullptr;
+    }
+
+    const SkDeserialProcs* procs() const { return &fSharingProcs; }
+
+private:
+    static sk_sp<SkImage> DeserializeImage(const void* data, size_t length, void* ctx) {
+        auto self = static_cast<SharingDeserialProcs*>(ctx);
+        uint32_t tag, id;
+        if (length < sizeof(tag) + sizeof(id)) {
+            return self->fProcs.fImageProc
+                           ? self->fProcs.fImageProc(data, length, self->fProcs.fImageCtx)
+                           : nullptr;
+        }
+        memcpy(&tag, data, sizeof(tag));
+        memcpy(&id, static_cast<const char*>(data) + sizeof(tag), sizeof(id));
+        if (tag == kReferResource) {
+            const sk_sp<SkImage>* image = self->fImages.find(id);
+            return image ? *image : nullptr;
+        }
+        if (tag != kDefineResource) {
+            return self->fProcs.fImageProc
+                           ? self->fProcs.fImageProc(data, length, self->fProcs.fImageCtx)
+                           : nullptr;
+        }
+
+        const void* encoded = static_cast<const char*>(data) + sizeof(tag) + sizeof(id);
+        const size_t encodedLength = length - sizeof(tag) - sizeof(id);
+        sk_sp<SkImage> image;
+        if (self->fProcs.fImageProc) {
+            image = self->fProcs.fImageProc(encoded, encodedLength, self->fProcs.fImageCtx);
+        }
+        if (!image) {
+            image = SkImages::DeferredFromEncodedData(SkData::MakeWithCopy(encoded,
+                                                                           encodedLength));
+        }
+        if (image) {
+            self->fImages.set(id, image);
+        }
+        return image;
+    }
+
+    static sk_sp<SkTypeface> DeserializeTypeface(const void* data, size_t length, void* ctx) {
+        auto self = static_cast<SharingDeserialProcs*>(ctx);
+        // Typefaces are only written to the table of the top level picture, where the proc is
+        // given the stream to read them from.
+        if (length != sizeof(SkStream*)) {
+            return self->fProcs.fTypefaceProc
+                           ? self->fProcs.fTypefaceProc(data, length, self->fProcs.fTypefaceCtx)
+                           : nullptr;
+        }
+        SkStream* stream = *static_cast<SkStream* const*>(data);
+        uint32_t tag, id;
+        if (!stream->readU32(&tag) || !stream->readU32(&id)) {
+            return nullptr;
+        }
+        if (tag == kReferResource) {
+            const sk_sp<SkTypeface>* typeface = self->fTypefaces.find(id);
+            return typeface ? *typeface : nullptr;
+        }
+        if (tag != kDefineResource) {
+            return nullptr;
+        }
+
+        sk_sp<SkTypeface> typeface;
+        if (self->fProcs.fTypefaceProc) {
+            typeface = self->fProcs.fTypefaceProc(&stream, sizeof(stream),
+                                                  self->fProcs.fTypefaceCtx);
+        } else {
+            typeface = SkTypeface::MakeDeserialize(stream);
+        }
+        if (typeface) {
+            self->fTypefaces.set(id, typeface);
+        }
+        return typeface;
+    }
+
+    const SkDeserialProcs fProcs;
+    SkDeserialProcs fSharingProcs;
+    THashMap<uint32_t, sk_sp<SkImage>> fImages;
+    THashMap<uint32_t, sk_sp<SkTypeface>> fTypefaces;
+};
+
 struct MultiPictureDocument final : public SkDocument {
     const SkSerialProcs fProcs;
     SkPictureRecorder fPictureRecorder;
@@ -98,12 +323,17 @@ struct MultiPictureDocument final : public SkDocument {
         SkSize bigsize = join(fSizes);
         SkCanvas* c = fPictureRecorder.beginRecording(SkRect::MakeSize(bigsize));
         for (const sk_sp<SkPicture>& page : fPages) {
-            c->drawPicture(page);
+            // Played back rather than drawn as a nested picture, so that the pages share one
+            // table of paths, images and text blobs.
+            c->save();
+            page->playback(c);
+            c->restore();
             // Annotations must include some data.
             c->drawAnnotation(SkRect::MakeEmpty(), kEndPage, SkData::MakeWithCString("X"));
         }
         sk_sp<SkPicture> p = fPictureRecorder.finishRecordingAsPicture();
-        p->serialize(wStream, &fProcs);
+        SharingSerialProcs procs(fProcs);
+        p->serialize(wStream, procs.procs());
         fPages.clear();
         fSizes.clear();
         return;
@@ -122,7 +352,7 @@ sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* wStream, const SkSerialP
 
 ////////////////////////////////////////////////////////////////////////////////
 
-int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
+static int read_page_count(SkStreamSeekable* stream, uint32_t* versionNumber) {
     if (!stream) {
         return 0;
     }
@@ -133,8 +363,8 @@ int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
         stream = nullptr;
         return 0;
     }
-    uint32_t versionNumber;
-    if (!stream->readU32(&versionNumber) || versionNumber != kVersion) {
+    if (!stream->readU32(versionNumber) || *versionNumber < kMinVersion ||
+        *versionNumber > kVersion) {
         return 0;
     }
     uint32_t pageCount;
@@ -145,13 +375,19 @@ int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
     return SkTo<int>(pageCount);
 }
 
-bool SkMultiPictureDocumentReadPageSizes(SkStreamSeekable* stream,
-                                         SkDocumentPage* dstArray,
-                                         int dstArrayCount) {
+int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
+    uint32_t versionNumber;
+    return read_page_count(stream, &versionNumber);
+}
+
+static bool read_page_sizes(SkStreamSeekable* stream,
+                            SkDocumentPage* dstArray,
+                            int dstArrayCount,
+                            uint32_t* versionNumber) {
     if (!dstArray || dstArrayCount < 1) {
         return false;
     }
-    int pageCount = SkMultiPictureDocumentReadPageCount(stream);
+    int pageCount = read_page_count(stream, versionNumber);
     if (pageCount < 1 || pageCount != dstArrayCount) {
         return false;
     }
@@ -165,6 +401,13 @@ bool SkMultiPictureDocumentReadPageSizes(SkStreamSeekable* stream,
     return true;
 }
 
+bool SkMultiPictureDocumentReadPageSizes(SkStreamSeekable* stream,
+                                         SkDocumentPage* dstArray,
+                                         int dstArrayCount) {
+    uint32_t versionNumber;
+    return read_page_sizes(stream, dstArray, dstArrayCount, &versionNumber);
+}
+
 namespace {
 struct PagerCanvas : public SkNWayCanvas {
     SkPictureRecorder fRecorder;
@@ -200,7 +443,8 @@ bool SkMultiPictureDocumentRead(SkStreamSeekable* stream,
                                 SkDocumentPage* dstArray,
                                 int dstArrayCount,
                                 const SkDeserialProcs* procs) {
-    if (!SkMultiPictureDocumentReadPageSizes(stream, dstArray, dstArrayCount)) {
+    uint32_t versionNumber;
+    if (!read_page_sizes(stream, dstArray, dstArrayCount, &versionNumber)) {
         return false;
     }
     SkSize joined = {0.0f, 0.0f};
@@ -209,7 +453,13 @@ bool SkMultiPictureDocumentRead(SkStreamSeekable* stream,
                         std::max(joined.height(), dstArray[i].fSize.height())};
     }
 
-    auto picture = SkPicture::MakeFromStream(stream, procs);
+    sk_sp<SkPicture> picture;
+    if (versionNumber >= 3) {
+        SharingDeserialProcs sharingProcs(procs ? *procs : SkDeserialProcs());
+        picture = SkPicture::MakeFromStream(stream, sharingProcs.procs());
+    } else {
+        picture = SkPicture::MakeFromStream(stream, procs);
+    }
     if (!picture) {
         return false;
     }
@@ -24,6 +24,10 @@ struct SkSerialProcs;
 /**
  *  Writes into a file format that is similar to SkPicture::serialize()
  *  Accepts a callback for endPage behavior
+ *
+ *  Images and typefaces are written once, however many pages use them: the serial procs are
+ *  called once per image, and images or typefaces whose serialized bytes are the same as ones
+ *  written before are written as references to them.
  */
 SK_SPI sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* dst, const SkSerialProcs* = nullptr,
   std::function<void(const SkPicture*)> onEndPage = nullptr);
@@ -42,6 +46,9 @@ SK_SPI int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* src);
  *  Read the SkMultiPictureDocument into the provided array of pages.
  *  dstArrayCount must equal SkMultiPictureDocumentReadPageCount().
  *  Return false on error.
+ *
+ *  Each image written once is made once, with the deserial procs if they're set, and shared by
+ *  the pages.
  */
 SK_SPI bool SkMultiPictureDocumentRead(SkStreamSeekable* src,
                                        SkDocumentPage* dstArray,
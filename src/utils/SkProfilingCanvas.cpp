@@ -0,0 +1,573 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkProfilingCanvas.h"
+
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurface.h" // IWYU pragma: keep
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkTime.h"
+#include "include/core/SkVertices.h"
+#include "include/private/chromium/Slug.h"
+#include "include/private/base/SkTo.h"
+#include "include/utils/SkEventTracer.h"
+#include "include/utils/SkTraceEventPhase.h"
+#include "src/base/SkMathPriv.h"
+#include "src/core/SkTraceEvent.h"
+#include "src/shaders/SkShaderBase.h"
+#include "src/text/GlyphRun.h"
+#include "src/utils/SkJSONWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+class SkData;
+class SkDrawable;
+class SkPicture;
+struct SkDrawShadowRec;
+
+namespace {
+
+using Op = SkProfilingCanvas::Op;
+using PaintKind = SkProfilingCanvas::PaintKind;
+
+PaintKind paint_kind(const SkPaint* paint) {
+    if (!paint) {
+        return PaintKind::kNone;
+    }
+    if (paint->getImageFilter() || paint->getMaskFilter()) {
+        return PaintKind::kFiltered;
+    }
+    const SkShader* shader = paint->getShader();
+    if (!shader) {
+        return PaintKind::kColor;
+    }
+    switch (as_SB(shader)->asGradient()) {
+        case SkShaderBase::GradientType::kNone:  break;
+        case SkShaderBase::GradientType::kColor: return PaintKind::kColor;
+        default:                                 return PaintKind::kGradient;
+    }
+    return shader->isAImage() ? PaintKind::kImage : PaintKind::kOther;
+}
+
+int area_bucket(double area) {
+    if (area < 1) {
+        return 0;
+    }
+    // Each bucket is for twice the width and height of the one before it.
+    const int log2 = SkPrevLog2(static_cast<uint32_t>(std::min<double>(area, UINT32_MAX)));
+    return std::min(1 + log2 / 2, SkProfilingCanvas::kAreaBuckets - 1);
+}
+
+bool traced(const uint8_t* category) {
+    return *category & (SkEventTracer::kEnabledForRecording_CategoryGroupEnabledFlags |
+                        SkEventTracer::kEnabledForEventCallback_CategoryGroupEnabledFlags);
+}
+
+}  // namespace
+
+// Times a draw from its construction to its destruction, and adds it to the stats.
+class SkProfilingCanvas::AutoProfile {
+public:
+    AutoProfile(SkProfilingCanvas* canvas, Op op, const SkPaint* paint, const SkRect* bounds)
+            : AutoProfile(canvas, op, paint_kind(paint), canvas->deviceArea(bounds, paint)) {}
+
+    AutoProfile(SkProfilingCanvas* canvas, Op op, PaintKind kind, double area)
+            : fCanvas(canvas)
+            , fOp(op)
+            , fKind(kind)
+            , fAreaBucket(area_bucket(area)) {
+        if (traced(canvas->fTraceCategory)) {
+            fTraceHandle = skia_private::AddTraceEvent(
+                    TRACE_EVENT_PHASE_COMPLETE, canvas->fTraceCategory, OpName(op),
+                    skia_private::kNoEventId, TRACE_EVENT_FLAG_NONE,
+                    "paint", PaintKindName(kind), "area", static_cast<uint64_t>(area));
+            fTraced = true;
+        }
+        // Anything that's not the draw itself is done before this.
+        fStart = SkTime::GetNSecs();
+    }
+
+    ~AutoProfile() {
+        const double nanos = SkTime::GetNSecs() - fStart;
+        Stats& stats = fCanvas->fStats[StatsIndex(fOp, fKind, fAreaBucket)];
+        stats.fCount++;
+        stats.fTotalNanos += nanos;
+        stats.fMaxNanos = std::max(stats.fMaxNanos, nanos);
+        if (fTraced) {
+            TRACE_EVENT_API_UPDATE_TRACE_EVENT_DURATION(fCanvas->fTraceCategory, OpName(fOp),
+                                                        fTraceHandle);
+        }
+    }
+
+private:
+    SkProfilingCanvas* fCanvas;
+    const Op fOp;
+    const PaintKind fKind;
+    const int fAreaBucket;
+    bool fTraced = false;
+    SkEventTracer::Handle fTraceHandle = 0;
+    double fStart;
+};
+
+SkProfilingCanvas::SkProfilingCanvas(SkCanvas* canvas)
+        : SkCanvasVirtualEnforcer<SkNWayCanvas>(canvas->imageInfo().width(),
+                                                canvas->imageInfo().height())
+        , fStats(kOpCount * kPaintKindCount * kAreaBuckets) {
+    // Transfer matrix & clip state before adding the target canvas, without profiling it.
+    static constexpr uint8_t kNotTraced = 0;
+    fTraceCategory = &kNotTraced;
+    this->clipRect(SkRect::Make(canvas->getDeviceClipBounds()));
+    this->setMatrix(canvas->getLocalToDevice());
+    this->resetStats();
+
+    this->addCanvas(canvas);
+    fTraceCategory = SkEventTracer::GetInstance()->getCategoryGroupEnabled(
+            TRACE_CATEGORY_PREFIX "skia.profile");
+}
+
+SkProfilingCanvas::Stats SkProfilingCanvas::stats(Op op) const {
+    Stats opStats;
+    for (int kind = 0; kind < kPaintKindCount; kind++) {
+        for (int bucket = 0; bucket < kAreaBuckets; bucket++) {
+            const Stats& stats = this->stats(op, static_cast<PaintKind>(kind), bucket);
+            opStats.fCount += stats.fCount;
+            opStats.fTotalNanos += stats.fTotalNanos;
+            opStats.fMaxNanos = std::max(opStats.fMaxNanos, stats.fMaxNanos);
+        }
+    }
+    return opStats;
+}
+
+void SkProfilingCanvas::resetStats() {
+    std::fill(fStats.begin(), fStats.end(), Stats());
+}
+
+void SkProfilingCanvas::writeJSON(SkWStream* stream) const {
+    std::vector<int> drawn;
+    int count = 0;
+    double totalNanos = 0;
+    for (int i = 0; i < (int)fStats.size(); i++) {
+        if (fStats[i].fCount) {
+            drawn.push_back(i);
+            count += fStats[i].fCount;
+            totalNanos += fStats[i].fTotalNanos;
+        }
+    }
+    std::stable_sort(drawn.begin(), drawn.end(), [this](int a, int b) {
+        return fStats[a].fTotalNanos > fStats[b].fTotalNanos;
+    });
+
+    SkJSONWriter writer(stream, SkJSONWriter::Mode::kPretty);
+    writer.beginObject();
+    writer.appendS32("count", count);
+    writer.appendDouble("totalNanos", totalNanos);
+    writer.beginArray("stats");
+    for (int i : drawn) {
+        const int bucket = i % kAreaBuckets;
+        const Stats& stats = fStats[i];
+        writer.beginObject(nullptr, false);
+        writer.appendCString("op", OpName(static_cast<Op>(i / kAreaBuckets / kPaintKindCount)));
+        writer.appendCString("paint",
+                             PaintKindName(static_cast<PaintKind>(i / kAreaBuckets %
+                                                                  kPaintKindCount)));
+        writer.appendDouble("minArea", bucket ? std::ldexp(1.0, 2 * (bucket - 1)) : 0);
+        if (bucket < kAreaBuckets - 1) {
+            writer.appendDouble("maxArea", std::ldexp(1.0, 2 * bucket));
+        }
+        writer.appendS32("count", stats.fCount);
+        writer.appendDouble("totalNanos", stats.fTotalNanos);
+        writer.appendDouble("maxNanos", stats.fMaxNanos);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+const char* SkProfilingCanvas::OpName(Op op) {
+    switch (op) {
+        case Op::kDrawPaint:          return "DrawPaint";
+        case Op::kDrawBehind:         return "DrawBehind";
+        case Op::kDrawPoints:         return "DrawPoints";
+        case Op::kDrawRect:           return "DrawRect";
+        case Op::kDrawRRect:          return "DrawRRect";
+        case Op::kDrawDRRect:         return "DrawDRRect";
+        case Op::kDrawRegion:         return "DrawRegion";
+        case Op::kDrawOval:           return "DrawOval";
+        case Op::kDrawArc:            return "DrawArc";
+        case Op::kDrawPath:           return "DrawPath";
+        case Op::kDrawImage:          return "DrawImage";
+        case Op::kDrawImageRect:      return "DrawImageRect";
+        case Op::kDrawImageLattice:   return "DrawImageLattice";
+        case Op::kDrawAtlas:          return "DrawAtlas";
+        case Op::kDrawVertices:       return "DrawVertices";
+        case Op::kDrawMesh:           return "DrawMesh";
+        case Op::kDrawPatch:          return "DrawPatch";
+        case Op::kDrawTextBlob:       return "DrawTextBlob";
+        case Op::kDrawSlug:           return "DrawSlug";
+        case Op::kDrawShadowRec:      return "DrawShadowRec";
+        case Op::kDrawEdgeAAQuad:     return "DrawEdgeAAQuad";
+        case Op::kDrawEdgeAAImageSet: return "DrawEdgeAAImageSet";
+        case Op::kSaveLayer:          return "SaveLayer";
+        case Op::kRestore:            return "Restore";
+        case Op::kRestoreLayer:       return "RestoreLayer";
+        case Op::kClipRect:           return "ClipRect";
+        case Op::kClipRRect:          return "ClipRRect";
+        case Op::kClipPath:           return "ClipPath";
+        case Op::kClipShader:         return "ClipShader";
+        case Op::kClipRegion:         return "ClipRegion";
+    }
+    SkUNREACHABLE;
+}
+
+const char* SkProfilingCanvas::PaintKindName(PaintKind kind) {
+    switch (kind) {
+        case PaintKind::kNone:     return "None";
+        case PaintKind::kColor:    return "Color";
+        case PaintKind::kGradient: return "Gradient";
+        case PaintKind::kImage:    return "Image";
+        case PaintKind::kOther:    return "Other";
+        case PaintKind::kFiltered: return "Filtered";
+    }
+    SkUNREACHABLE;
+}
+
+double SkProfilingCanvas::deviceArea(const SkRect* localBounds, const SkPaint* paint) {
+    if (fDeviceStateDirty) {
+        fClipBounds = this->getDeviceClipBounds();
+        fLocalToDevice = this->getLocalToDeviceAs3x3();
+        fDeviceStateDirty = false;
+    }
+    SkIRect area = fClipBounds;
+    if (localBounds && (!paint || paint->canComputeFastBounds())) {
+        SkRect storage;
+        const SkRect& bounds = paint ? paint->computeFastBounds(*localBounds, &storage)
+                                     : *localBounds;
+        const SkRect device = fLocalToDevice.mapRect(bounds);
+        if (device.isFinite() && !area.intersect(device.roundOut())) {
+            return 0;
+        }
+    }
+    return static_cast<double>(area.width()) * area.height();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkProfilingCanvas::willSave() {
+    fSaves.push_back({false, PaintKind::kNone, 0});
+    this->SkNWayCanvas::willSave();
+}
+
+SkCanvas::SaveLayerStrategy SkProfilingCanvas::getSaveLayerStrategy(const SaveLayerRec& rec) {
+    const PaintKind kind = rec.fBackdrop ? PaintKind::kFiltered : paint_kind(rec.fPaint);
+    const double area = this->deviceArea(rec.fBounds, rec.fPaint);
+    fSaves.push_back({true, kind, area});
+    fDeviceStateDirty = true;
+
+    AutoProfile ap(this, Op::kSaveLayer, kind, area);
+    return this->SkNWayCanvas::getSaveLayerStrategy(rec);
+}
+
+bool SkProfilingCanvas::onDoSaveBehind(const SkRect* bounds) {
+    fSaves.push_back({false, PaintKind::kNone, 0});
+    return this->SkNWayCanvas::onDoSaveBehind(bounds);
+}
+
+void SkProfilingCanvas::willRestore() {
+    SaveRec save = {false, PaintKind::kNone, 0};
+    if (!fSaves.empty()) {
+        save = fSaves.back();
+        fSaves.pop_back();
+    }
+    {
+        AutoProfile ap(this, save.fLayer ? Op::kRestoreLayer : Op::kRestore, save.fKind,
+                       save.fLayer ? save.fArea : this->deviceArea(nullptr, nullptr));
+        this->SkNWayCanvas::willRestore();
+    }
+    // This canvas's own matrix and clip are restored right after this.
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::didConcat44(const SkM44& m) {
+    fDeviceStateDirty = true;
+    this->SkNWayCanvas::didConcat44(m);
+}
+
+void SkProfilingCanvas::didSetM44(const SkM44& m) {
+    fDeviceStateDirty = true;
+    this->SkNWayCanvas::didSetM44(m);
+}
+
+void SkProfilingCanvas::didScale(SkScalar x, SkScalar y) {
+    fDeviceStateDirty = true;
+    this->SkNWayCanvas::didScale(x, y);
+}
+
+void SkProfilingCanvas::didTranslate(SkScalar x, SkScalar y) {
+    fDeviceStateDirty = true;
+    this->SkNWayCanvas::didTranslate(x, y);
+}
+
+void SkProfilingCanvas::onDrawPaint(const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawPaint, &paint, nullptr);
+    this->SkNWayCanvas::onDrawPaint(paint);
+}
+
+void SkProfilingCanvas::onDrawBehind(const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawBehind, &paint, nullptr);
+    this->SkNWayCanvas::onDrawBehind(paint);
+}
+
+void SkProfilingCanvas::onDrawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                                     const SkPaint& paint) {
+    SkRect bounds;
+    const bool hasBounds = bounds.setBoundsCheck(pts, SkToInt(count));
+    AutoProfile ap(this, Op::kDrawPoints, &paint, hasBounds ? &bounds : nullptr);
+    this->SkNWayCanvas::onDrawPoints(mode, count, pts, paint);
+}
+
+void SkProfilingCanvas::onDrawRect(const SkRect& rect, const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawRect, &paint, &rect);
+    this->SkNWayCanvas::onDrawRect(rect, paint);
+}
+
+void SkProfilingCanvas::onDrawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawRRect, &paint, &rrect.getBounds());
+    this->SkNWayCanvas::onDrawRRect(rrect, paint);
+}
+
+void SkProfilingCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
+                                     const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawDRRect, &paint, &outer.getBounds());
+    this->SkNWayCanvas::onDrawDRRect(outer, inner, paint);
+}
+
+void SkProfilingCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
+    const SkRect bounds = SkRect::Make(region.getBounds());
+    AutoProfile ap(this, Op::kDrawRegion, &paint, &bounds);
+    this->SkNWayCanvas::onDrawRegion(region, paint);
+}
+
+void SkProfilingCanvas::onDrawOval(const SkRect& rect, const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawOval, &paint, &rect);
+    this->SkNWayCanvas::onDrawOval(rect, paint);
+}
+
+void SkProfilingCanvas::onDrawArc(const SkRect& rect, SkScalar startAngle, SkScalar sweepAngle,
+                                  bool useCenter, const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawArc, &paint, &rect);
+    this->SkNWayCanvas::onDrawArc(rect, startAngle, sweepAngle, useCenter, paint);
+}
+
+void SkProfilingCanvas::onDrawPath(const SkPath& path, const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawPath, &paint,
+                   path.isInverseFillType() ? nullptr : &path.getBounds());
+    this->SkNWayCanvas::onDrawPath(path, paint);
+}
+
+void SkProfilingCanvas::onDrawImage2(const SkImage* image, SkScalar left, SkScalar top,
+                                     const SkSamplingOptions& sampling, const SkPaint* paint) {
+    const SkRect bounds = SkRect::MakeXYWH(left, top, image->width(), image->height());
+    AutoProfile ap(this, Op::kDrawImage, paint, &bounds);
+    this->SkNWayCanvas::onDrawImage2(image, left, top, sampling, paint);
+}
+
+void SkProfilingCanvas::onDrawImageRect2(const SkImage* image, const SkRect& src,
+                                         const SkRect& dst, const SkSamplingOptions& sampling,
+                                         const SkPaint* paint, SrcRectConstraint constraint) {
+    AutoProfile ap(this, Op::kDrawImageRect, paint, &dst);
+    this->SkNWayCanvas::onDrawImageRect2(image, src, dst, sampling, paint, constraint);
+}
+
+void SkProfilingCanvas::onDrawImageLattice2(const SkImage* image, const Lattice& lattice,
+                                            const SkRect& dst, SkFilterMode filter,
+                                            const SkPaint* paint) {
+    AutoProfile ap(this, Op::kDrawImageLattice, paint, &dst);
+    this->SkNWayCanvas::onDrawImageLattice2(image, lattice, dst, filter, paint);
+}
+
+void SkProfilingCanvas::onDrawAtlas2(const SkImage* image, const SkRSXform xform[],
+                                     const SkRect tex[], const SkColor colors[], int count,
+                                     SkBlendMode bmode, const SkSamplingOptions& sampling,
+                                     const SkRect* cull, const SkPaint* paint) {
+    AutoProfile ap(this, Op::kDrawAtlas, paint, cull);
+    this->SkNWayCanvas::onDrawAtlas2(image, xform, tex, colors, count, bmode, sampling, cull,
+                                     paint);
+}
+
+void SkProfilingCanvas::onDrawVerticesObject(const SkVertices* vertices, SkBlendMode bmode,
+                                             const SkPaint& paint) {
+    AutoProfile ap(this, Op::kDrawVertices, &paint, &vertices->bounds());
+    this->SkNWayCanvas::onDrawVerticesObject(vertices, bmode, paint);
+}
+
+#ifdef SK_ENABLE_SKSL
+void SkProfilingCanvas::onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender,
+                                   const SkPaint& paint) {
+    const SkRect bounds = mesh.bounds();
+    AutoProfile ap(this, Op::kDrawMesh, &paint, &bounds);
+    // SkNWayCanvas doesn't forward meshes.
+    this->proxy()->drawMesh(mesh, std::move(blender), paint);
+}
+#endif
+
+void SkProfilingCanvas::onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                                    const SkPoint texCoords[4], SkBlendMode bmode,
+                                    const SkPaint& paint) {
+    SkRect bounds;
+    const bool hasBounds = bounds.setBoundsCheck(cubics, 12);
+    AutoProfile ap(this, Op::kDrawPatch, &paint, hasBounds ? &bounds : nullptr);
+    this->SkNWayCanvas::onDrawPatch(cubics, colors, texCoords, bmode, paint);
+}
+
+void SkProfilingCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
+                                      const SkPaint* paint) {
+    // Play the picture back into this canvas, rather than forwarding it, to time its draws.
+    this->SkCanvas::onDrawPicture(picture, matrix, paint);
+}
+
+void SkProfilingCanvas::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
+    this->SkCanvas::onDrawDrawable(drawable, matrix);
+}
+
+void SkProfilingCanvas::onDrawGlyphRunList(const sktext::GlyphRunList& list,
+                                           const SkPaint& paint) {
+    const SkRect bounds = list.sourceBoundsWithOrigin();
+    AutoProfile ap(this, Op::kDrawTextBlob, &paint, &bounds);
+    this->SkNWayCanvas::onDrawGlyphRunList(list, paint);
+}
+
+void SkProfilingCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                       const SkPaint& paint) {
+    const SkRect bounds = blob->bounds().makeOffset(x, y);
+    AutoProfile ap(this, Op::kDrawTextBlob, &paint, &bounds);
+    this->SkNWayCanvas::onDrawTextBlob(blob, x, y, paint);
+}
+
+#if defined(SK_GANESH)
+void SkProfilingCanvas::onDrawSlug(const sktext::gpu::Slug* slug) {
+    const SkRect bounds = slug->sourceBoundsWithOrigin();
+    AutoProfile ap(this, Op::kDrawSlug, &slug->initialPaint(), &bounds);
+    this->SkNWayCanvas::onDrawSlug(slug);
+}
+#endif
+
+void SkProfilingCanvas::onDrawAnnotation(const SkRect& rect, const char key[], SkData* value) {
+    // Annotations don't draw, so they're not timed.
+    this->SkNWayCanvas::onDrawAnnotation(rect, key, value);
+}
+
+void SkProfilingCanvas::onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
+    // Shadows reach beyond the path, so they may touch the whole clip.
+    AutoProfile ap(this, Op::kDrawShadowRec, PaintKind::kNone, this->deviceArea(nullptr, nullptr));
+    this->SkNWayCanvas::onDrawShadowRec(path, rec);
+}
+
+void SkProfilingCanvas::onDrawEdgeAAQuad(const SkRect& rect, const SkPoint clip[4],
+                                         QuadAAFlags aa, const SkColor4f& color,
+                                         SkBlendMode mode) {
+    AutoProfile ap(this, Op::kDrawEdgeAAQuad, PaintKind::kColor, this->deviceArea(&rect, nullptr));
+    this->SkNWayCanvas::onDrawEdgeAAQuad(rect, clip, aa, color, mode);
+}
+
+void SkProfilingCanvas::onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count,
+                                              const SkPoint dstClips[],
+                                              const SkMatrix preViewMatrices[],
+                                              const SkSamplingOptions& sampling,
+                                              const SkPaint* paint,
+                                              SrcRectConstraint constraint) {
+    AutoProfile ap(this, Op::kDrawEdgeAAImageSet, paint, nullptr);
+    this->SkNWayCanvas::onDrawEdgeAAImageSet2(set, count, dstClips, preViewMatrices, sampling,
+                                              paint, constraint);
+}
+
+void SkProfilingCanvas::onClipRect(const SkRect& rect, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    AutoProfile ap(this, Op::kClipRect, nullptr, op == SkClipOp::kIntersect ? &rect : nullptr);
+    this->SkNWayCanvas::onClipRect(rect, op, edgeStyle);
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::onClipRRect(const SkRRect& rrect, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    AutoProfile ap(this, Op::kClipRRect, nullptr,
+                   op == SkClipOp::kIntersect ? &rrect.getBounds() : nullptr);
+    this->SkNWayCanvas::onClipRRect(rrect, op, edgeStyle);
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    const bool bounded = op == SkClipOp::kIntersect && !path.isInverseFillType();
+    AutoProfile ap(this, Op::kClipPath, nullptr, bounded ? &path.getBounds() : nullptr);
+    this->SkNWayCanvas::onClipPath(path, op, edgeStyle);
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::onClipShader(sk_sp<SkShader> shader, SkClipOp op) {
+    AutoProfile ap(this, Op::kClipShader, nullptr, nullptr);
+    this->SkNWayCanvas::onClipShader(std::move(shader), op);
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::onClipRegion(const SkRegion& region, SkClipOp op) {
+    // The region is in device space.
+    AutoProfile ap(this, Op::kClipRegion, nullptr, nullptr);
+    this->SkNWayCanvas::onClipRegion(region, op);
+    fDeviceStateDirty = true;
+}
+
+void SkProfilingCanvas::onResetClip() {
+    this->SkNWayCanvas::onResetClip();
+    fDeviceStateDirty = true;
+}
+
+sk_sp<SkSurface> SkProfilingCanvas::onNewSurface(const SkImageInfo& info,
+                                                 const SkSurfaceProps& props) {
+    return this->proxy()->makeSurface(info, &props);
+}
+
+bool SkProfilingCanvas::onPeekPixels(SkPixmap* pixmap) {
+    return this->proxy()->peekPixels(pixmap);
+}
+
+bool SkProfilingCanvas::onAccessTopLayerPixels(SkPixmap* pixmap) {
+    SkImageInfo info;
+    size_t rowBytes;
+
+    void* addr = this->proxy()->accessTopLayerPixels(&info, &rowBytes);
+    if (!addr) {
+        return false;
+    }
+
+    pixmap->reset(info, addr, rowBytes);
+    return true;
+}
+
+SkImageInfo SkProfilingCanvas::onImageInfo() const {
+    return this->proxy()->imageInfo();
+}
+
+bool SkProfilingCanvas::onGetProps(SkSurfaceProps* props, bool top) const {
+    if (props) {
+        *props = top ? this->proxy()->getTopProps() : this->proxy()->getBaseProps();
+    }
+    return true;
+}
@@ -23,8 +23,10 @@
 #include "include/private/base/SkTemplates.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkAAClip.h"
+#include "src/core/SkAAClipCache.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkRasterClip.h"
+#include "src/core/SkResourceCache.h"
 #include "tests/Test.h"
 
 #include <cstdint>
@@ -450,3 +452,142 @@ DEF_TEST(AAClip, reporter) {
     test_crbug_422693(reporter);
     test_huge(reporter);
 }
+
+static bool operator==(const SkAAClip& a, const SkAAClip& b) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return a.isEmpty() == b.isEmpty();
+    }
+    SkMask mask0, mask1;
+    a.copyToMask(&mask0);
+    b.copyToMask(&mask1);
+    SkAutoMaskFreeImage free0(mask0.fImage);
+    SkAutoMaskFreeImage free1(mask1.fImage);
+    return mask0 == mask1;
+}
+
+// A star with curved edges, complex enough for SkAAClipCache::ShouldCache().
+static SkPath make_star_path(int points) {
+    SkPath path;
+    for (int i = 0; i < 2 * points; ++i) {
+        SkScalar angle = i * SK_ScalarPI / points;
+        SkScalar r = (i & 1) ? 20.3f : 47.7f;
+        SkPoint pt = {50 + r * SkScalarCos(angle), 50 + r * SkScalarSin(angle)};
+        if (i == 0) {
+            path.moveTo(pt);
+        } else {
+            path.quadTo({50, 50}, pt);
+        }
+    }
+    path.close();
+    return path;
+}
+
+DEF_TEST(AAClipCache, reporter) {
+    SkResourceCache cache(1024 * 1024);
+    SkPath path = make_star_path(12);
+    const SkMatrix matrix = SkMatrix::Scale(1.5f, 1.25f).postTranslate(3.25f, 7.5f);
+    REPORTER_ASSERT(reporter, SkAAClipCache::ShouldCache(path, matrix));
+    REPORTER_ASSERT(reporter, !SkAAClipCache::ShouldCache(SkPath::Circle(10, 10, 5), matrix));
+
+    SkPath devPath;
+    path.transform(matrix, &devPath);
+    const SkIRect bounds = SkIRect::MakeLTRB(0, 0, 200, 200);
+    REPORTER_ASSERT(reporter, bounds.contains(devPath.getBounds().roundOut()));
+
+    SkAAClip found;
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(path, matrix, bounds, true, &found, &cache));
+
+    SkAAClip built;
+    built.setPath(devPath, bounds, true);
+    SkAAClipCache::Add(path, matrix, bounds, true, built, &cache);
+
+    REPORTER_ASSERT(reporter, SkAAClipCache::Find(path, matrix, bounds, true, &found, &cache));
+    REPORTER_ASSERT(reporter, found == built);
+
+    // A different matrix, fill type or AA setting must not hit.
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(path, SkMatrix::I(), bounds, true, &found,
+                                                   &cache));
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(path, matrix, bounds, false, &found, &cache));
+    SkPath inverse = path;
+    inverse.toggleInverseFillType();
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(inverse, matrix, bounds, true, &found,
+                                                   &cache));
+
+    // Other bounds that still hold the whole path reuse the entry.
+    for (SkIRect other : {bounds.makeOutset(50, 50), bounds.makeOffset(-20, -30),
+                          devPath.getBounds().roundOut()}) {
+        REPORTER_ASSERT(reporter, SkAAClipCache::Find(path, matrix, other, true, &found, &cache));
+        SkAAClip expected;
+        expected.setPath(devPath, other, true);
+        REPORTER_ASSERT(reporter, found == expected);
+    }
+
+    // Bounds that cut through the path only hit an entry built for exactly those bounds.
+    SkRandom rand;
+    for (int i = 0; i < 20; ++i) {
+        SkIRect sub = SkIRect::MakeLTRB(rand.nextRangeU(0, 60), rand.nextRangeU(0, 60),
+                                        rand.nextRangeU(61, 120), rand.nextRangeU(61, 120));
+        REPORTER_ASSERT(reporter, !SkAAClipCache::Find(path, matrix, sub, true, &found, &cache));
+        SkAAClip expected;
+        expected.setPath(devPath, sub, true);
+        SkAAClipCache::Add(path, matrix, sub, true, expected, &cache);
+        REPORTER_ASSERT(reporter, SkAAClipCache::Find(path, matrix, sub, true, &found, &cache));
+        REPORTER_ASSERT(reporter, found == expected);
+    }
+
+    // Inverse fills always depend on the bounds.
+    SkPath devInverse;
+    inverse.transform(matrix, &devInverse);
+    built.setPath(devInverse, bounds, true);
+    SkAAClipCache::Add(inverse, matrix, bounds, true, built, &cache);
+    REPORTER_ASSERT(reporter, SkAAClipCache::Find(inverse, matrix, bounds, true, &found, &cache));
+    REPORTER_ASSERT(reporter, found == built);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(inverse, matrix, bounds.makeOutset(1, 1), true,
+                                                   &found, &cache));
+
+    // Editing a path gives it a new generation ID, and purges the old entries.
+    SkPath edited = make_star_path(12);
+    SkAAClipCache::Add(edited, matrix, bounds, true, built, &cache);
+    const size_t bytesBefore = cache.getTotalBytesUsed();
+    edited.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(edited, matrix, bounds, true, &found, &cache));
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() < bytesBefore);
+}
+
+DEF_TEST(AAClipCache_RasterClip, reporter) {
+    // Clipping to the same path repeatedly, through shrinking device bounds, must give the same
+    // result as without the cache.
+    SkPath path = make_star_path(16);
+    path.setIsVolatile(true);
+    SkPath cachedPath = make_star_path(16);
+
+    // The second round of bounds finds the clips cached by the first.
+    for (int n = 0; n < 8; ++n) {
+        const int i = n % 4;
+        const SkIRect bounds = SkIRect::MakeLTRB(5 * i, 3 * i, 100 - 7 * i, 100 - 2 * i);
+        const SkMatrix matrix = SkMatrix::Translate(0.5f, 0.25f);
+        SkRasterClip expected(bounds), actual(bounds);
+        expected.op(path, matrix, SkClipOp::kIntersect, true);
+        actual.op(cachedPath, matrix, SkClipOp::kIntersect, true);
+        REPORTER_ASSERT(reporter, expected == actual);
+
+        // The non-rect clip case builds a separate SkRasterClip for the path.
+        SkRasterClip expected2(bounds), actual2(bounds);
+        const SkRect hole = SkRect::MakeLTRB(40, 40, 60, 60);
+        expected2.op(hole, SkMatrix::I(), SkClipOp::kDifference, false);
+        actual2.op(hole, SkMatrix::I(), SkClipOp::kDifference, false);
+        expected2.op(path, matrix, SkClipOp::kIntersect, true);
+        actual2.op(cachedPath, matrix, SkClipOp::kIntersect, true);
+        REPORTER_ASSERT(reporter, expected2 == actual2);
+    }
+
+    // The clip must be cached under the bounds it was clipped to, not the bounds of its result.
+    SkPath star = make_star_path(16);
+    star.moveTo(110, 110);  // widens the path's bounds, but not its coverage
+    SkRasterClip rc(SkIRect::MakeWH(120, 120));
+    rc.op(star, SkMatrix::I(), SkClipOp::kIntersect, true);
+    SkAAClip found;
+    REPORTER_ASSERT(reporter, SkAAClipCache::Find(star, SkMatrix::I(), SkIRect::MakeWH(130, 130),
+                                                  true, &found));
+    REPORTER_ASSERT(reporter, found.getBounds() == rc.getBounds());
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
+#include "include/ports/SkFontMgr_directory.h"
+#include "src/core/SkOSFile.h"
+#include "src/utils/SkOSPath.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+
+#include <cstdio>
+#include <set>
+#include <string>
+
+static bool copy_resource(const char* resource, const SkString& path) {
+    sk_sp<SkData> data = GetResourceAsData(resource);
+    SkFILEWStream stream(path.c_str());
+    return data && stream.isValid() && stream.write(data->data(), data->size());
+}
+
+static std::set<std::string> family_names(SkFontMgr* fontMgr) {
+    std::set<std::string> names;
+    for (int i = 0; i < fontMgr->countFamilies(); ++i) {
+        SkString name;
+        fontMgr->getFamilyName(i, &name);
+        names.insert(name.c_str());
+    }
+    return names;
+}
+
+DEF_TEST(FontMgrCustomDirectory_Index, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString fontDir = SkOSPath::Join(tmpDir.c_str(), "FontMgrCustomDirectory_Index");
+    sk_mkdir(fontDir.c_str());
+    SkString indexPath = SkOSPath::Join(tmpDir.c_str(), "FontMgrCustomDirectory_Index.skfi");
+    std::remove(indexPath.c_str());
+
+    SkString robotoPath = SkOSPath::Join(fontDir.c_str(), "Roboto-Regular.ttf");
+    SkString emPath = SkOSPath::Join(fontDir.c_str(), "Em.ttf");
+    std::remove(emPath.c_str());
+    if (!copy_resource("fonts/Roboto-Regular.ttf", robotoPath)) {
+        ERRORF(reporter, "Could not copy the font.");
+        return;
+    }
+
+    // The first font manager scans the files and writes the index.
+    sk_sp<SkFontMgr> scanned = SkFontMgr_New_Custom_Directory(fontDir.c_str());
+    sk_sp<SkFontMgr> indexing = SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                               indexPath.c_str());
+    REPORTER_ASSERT(reporter, sk_exists(indexPath.c_str()));
+    REPORTER_ASSERT(reporter, family_names(indexing.get()) == family_names(scanned.get()));
+
+    // The next one finds the same fonts from the index, and they work.
+    sk_sp<SkFontMgr> indexed = SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                              indexPath.c_str());
+    REPORTER_ASSERT(reporter, family_names(indexed.get()) == family_names(scanned.get()));
+    sk_sp<SkTypeface> typeface = indexed->matchFamilyStyle("Roboto", SkFontStyle());
+    REPORTER_ASSERT(reporter, typeface);
+    if (typeface) {
+        REPORTER_ASSERT(reporter, typeface->countGlyphs() > 0);
+        SkString familyName;
+        typeface->getFamilyName(&familyName);
+        REPORTER_ASSERT(reporter, familyName.equals("Roboto"));
+    }
+
+    // Files added and removed since are noticed.
+    if (!copy_resource("fonts/Em.ttf", emPath)) {
+        ERRORF(reporter, "Could not copy the font.");
+        return;
+    }
+    sk_sp<SkFontMgr> added = SkFontMgr_New_Custom_Directory(fontDir.c_str(), indexPath.c_str());
+    REPORTER_ASSERT(reporter, added->countFamilies() == scanned->countFamilies() + 1);
+    REPORTER_ASSERT(reporter, family_names(added.get()) ==
+                              family_names(SkFontMgr_New_Custom_Directory(fontDir.c_str()).get()));
+
+    std::remove(emPath.c_str());
+    sk_sp<SkFontMgr> removed = SkFontMgr_New_Custom_Directory(fontDir.c_str(), indexPath.c_str());
+    REPORTER_ASSERT(reporter, family_names(removed.get()) == family_names(scanned.get()));
+
+    // A damaged index is scanned again.
+    {
+        SkFILEWStream stream(indexPath.c_str());
+        stream.write("skfi garbage", 12);
+    }
+    sk_sp<SkFontMgr> rescanned = SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                                indexPath.c_str());
+    REPORTER_ASSERT(reporter, family_names(rescanned.get()) == family_names(scanned.get()));
+}
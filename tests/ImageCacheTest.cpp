@@ -14,14 +14,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace {
 static void* gGlobalAddress;
+static void* gOtherGlobalAddress;
+static void* gSameCategoryAddress;  // Another namespace in gGlobalAddress's category.
 struct TestingKey : public SkResourceCache::Key {
     intptr_t    fValue;
 
-    TestingKey(intptr_t value, uint64_t sharedID = 0) : fValue(value) {
-        this->init(&gGlobalAddress, sharedID, sizeof(fValue));
+    TestingKey(intptr_t value, uint64_t sharedID = 0, void* nameSpace = &gGlobalAddress)
+            : fValue(value) {
+        this->init(nameSpace, sharedID, sizeof(fValue));
     }
 };
 struct TestingRec : public SkResourceCache::Rec {
@@ -32,7 +36,9 @@ struct TestingRec : public SkResourceCache::Rec {
 
     const Key& getKey() const override { return fKey; }
     size_t bytesUsed() const override { return sizeof(fKey) + sizeof(fValue); }
-    const char* getCategory() const override { return "test_cache"; }
+    const char* getCategory() const override {
+        return fKey.getNamespace() == &gOtherGlobalAddress ? "other_test_cache" : "test_cache";
+    }
     SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
 
     static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
@@ -154,3 +160,108 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+DEF_TEST(ImageCache_namespaceStats, r) {
+    SkResourceCache cache(4096);
+
+    // Missing in a namespace that has never had a rec doesn't start tracking it.
+    intptr_t value = -1;
+    REPORTER_ASSERT(r, !cache.find(TestingKey(0), TestingRec::Visitor, &value));
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gGlobalAddress).fMisses == 0);
+    int namespaces = 0;
+    cache.visitNamespaceStats([](void*, const SkResourceCache::NamespaceStats&, void* context) {
+        *static_cast<int*>(context) += 1;
+    }, &namespaces);
+    REPORTER_ASSERT(r, namespaces == 0);
+
+    cache.add(new TestingRec(TestingKey(0), 0));
+    cache.add(new TestingRec(TestingKey(1, 0, &gOtherGlobalAddress), 1));
+    REPORTER_ASSERT(r, !cache.find(TestingKey(2), TestingRec::Visitor, &value));
+    REPORTER_ASSERT(r, cache.find(TestingKey(0), TestingRec::Visitor, &value));
+    REPORTER_ASSERT(r, cache.find(TestingKey(0), TestingRec::Visitor, &value));
+
+    SkResourceCache::NamespaceStats stats = cache.getNamespaceStats(&gGlobalAddress);
+    REPORTER_ASSERT(r, !strcmp(stats.fCategory, "test_cache"));
+    REPORTER_ASSERT(r, stats.fCount == 1);
+    REPORTER_ASSERT(r, stats.fHits == 2);
+    REPORTER_ASSERT(r, stats.fMisses == 1);
+    REPORTER_ASSERT(r, stats.fBytesUsed == sizeof(TestingKey) + sizeof(intptr_t));
+
+    SkResourceCache::NamespaceStats other = cache.getNamespaceStats(&gOtherGlobalAddress);
+    REPORTER_ASSERT(r, !strcmp(other.fCategory, "other_test_cache"));
+    REPORTER_ASSERT(r, other.fCount == 1);
+    REPORTER_ASSERT(r, other.fHits == 0 && other.fMisses == 0);
+    REPORTER_ASSERT(r, stats.fBytesUsed + other.fBytesUsed == cache.getTotalBytesUsed());
+
+    cache.purgeAll();
+    stats = cache.getNamespaceStats(&gGlobalAddress);
+    REPORTER_ASSERT(r, stats.fCount == 0 && stats.fBytesUsed == 0);
+    REPORTER_ASSERT(r, stats.fEvictions == 0);  // purgeAll is not budget driven
+}
+
+DEF_TEST(ImageCache_categoryByteLimit, r) {
+    const size_t recSize = sizeof(TestingKey) + sizeof(intptr_t);
+    SkResourceCache cache(1024 * 1024);
+
+    // Some entries in the other namespace, older than everything that follows.
+    for (int i = 0; i < COUNT; ++i) {
+        cache.add(new TestingRec(TestingKey(i, 0, &gOtherGlobalAddress), i));
+    }
+
+    cache.setCategoryByteLimit("test_cache", 3 * recSize);
+    REPORTER_ASSERT(r, cache.getCategoryByteLimit("test_cache") == 3 * recSize);
+    for (int i = 0; i < COUNT; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+    }
+
+    // Only the newest three fit in the sub-budget, and the other namespace was left alone.
+    SkResourceCache::NamespaceStats stats = cache.getNamespaceStats(&gGlobalAddress);
+    REPORTER_ASSERT(r, stats.fCount == 3);
+    REPORTER_ASSERT(r, stats.fByteLimit == 3 * recSize);
+    REPORTER_ASSERT(r, stats.fEvictions == COUNT - 3);
+    REPORTER_ASSERT(r, stats.fEvictionsCaused == COUNT - 3);
+    for (int i = 0; i < COUNT; ++i) {
+        intptr_t value = -1;
+        REPORTER_ASSERT(r, cache.find(TestingKey(i), TestingRec::Visitor, &value) ==
+                           (i >= COUNT - 3));
+    }
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gOtherGlobalAddress).fCount == COUNT);
+
+    // Tightening the limit purges immediately; removing it lets the category grow again.
+    cache.setCategoryByteLimit("test_cache", recSize);
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gGlobalAddress).fCount == 1);
+    REPORTER_ASSERT(r, cache.setCategoryByteLimit("test_cache", 0) == recSize);
+    cache.add(new TestingRec(TestingKey(100), 100));
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gGlobalAddress).fCount == 2);
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gOtherGlobalAddress).fCount == COUNT);
+}
+
+DEF_TEST(ImageCache_categoryByteLimitSharedByNamespaces, r) {
+    const size_t recSize = sizeof(TestingKey) + sizeof(intptr_t);
+    SkResourceCache cache(1024 * 1024);
+
+    // Both namespaces are in "test_cache", so together they only get its limit.
+    cache.setCategoryByteLimit("test_cache", 4 * recSize);
+    for (int i = 0; i < COUNT; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+        cache.add(new TestingRec(TestingKey(i, 0, &gSameCategoryAddress), i));
+    }
+    SkResourceCache::NamespaceStats stats = cache.getNamespaceStats(&gGlobalAddress);
+    SkResourceCache::NamespaceStats same = cache.getNamespaceStats(&gSameCategoryAddress);
+    REPORTER_ASSERT(r, stats.fBytesUsed + same.fBytesUsed == 4 * recSize);
+    REPORTER_ASSERT(r, stats.fCount == 2 && same.fCount == 2);
+    REPORTER_ASSERT(r, stats.fEvictions + same.fEvictions == 2 * COUNT - 4);
+
+    // The oldest recs of the category go first, whichever namespace they are in.
+    for (int i = 0; i < COUNT; ++i) {
+        intptr_t value = -1;
+        const bool newest = i >= COUNT - 2;
+        REPORTER_ASSERT(r, cache.find(TestingKey(i), TestingRec::Visitor, &value) == newest);
+        REPORTER_ASSERT(r, cache.find(TestingKey(i, 0, &gSameCategoryAddress),
+                                      TestingRec::Visitor, &value) == newest);
+    }
+
+    cache.setCategoryByteLimit("test_cache", recSize);
+    REPORTER_ASSERT(r, cache.getNamespaceStats(&gGlobalAddress).fCount +
+                       cache.getNamespaceStats(&gSameCategoryAddress).fCount == 1);
+}
@@ -31,6 +31,7 @@
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/gpu/ganesh/GrColorInfo.h" // IWYU pragma: keep
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
 #include "src/gpu/ganesh/GrSurfaceProxy.h"
@@ -145,6 +146,56 @@ static void test_internal_purge(skiatest::Reporter* reporter, const sk_sp<SkSpec
     REPORTER_ASSERT(reporter, !cache->get(key1, &foundImage));
 }
 
+// A value that was read since it was added survives the next purge, even if it is the oldest.
+static void test_recently_used_survives_purge(skiatest::Reporter* reporter,
+                                              const sk_sp<SkSpecialImage>& image) {
+    const size_t kCacheSize = 2 * image->getSize() + 10;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    SkImageFilterCacheKey key1(0, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey key2(1, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey key3(2, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+
+    SkIPoint offset = SkIPoint::Make(3, 4);
+    auto filter = make_filter();
+    cache->set(key1, filter.get(), skif::FilterResult(image, skif::LayerSpace<SkIPoint>(offset)));
+    cache->set(key2, filter.get(), skif::FilterResult(image, skif::LayerSpace<SkIPoint>(offset)));
+
+    skif::FilterResult foundImage;
+    REPORTER_ASSERT(reporter, cache->get(key1, &foundImage));
+
+    // This should knock out key2, since key1 was used more recently
+    cache->set(key3, filter.get(), skif::FilterResult(image, skif::LayerSpace<SkIPoint>(offset)));
+
+    REPORTER_ASSERT(reporter, cache->get(key1, &foundImage));
+    REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
+    REPORTER_ASSERT(reporter, cache->get(key3, &foundImage));
+}
+
+// Eviction is by age across the whole cache, whichever shards the keys land in.
+static void test_oldest_purged_first(skiatest::Reporter* reporter,
+                                     const sk_sp<SkSpecialImage>& image) {
+    static constexpr int kNumKeys = 16;
+    const size_t kCacheSize = kNumKeys / 2 * image->getSize() + 10;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    auto filter = make_filter();
+    for (int i = 0; i < kNumKeys; ++i) {
+        SkImageFilterCacheKey key(i, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+        cache->set(key, filter.get(),
+                   skif::FilterResult(image, skif::LayerSpace<SkIPoint>({0, 0})));
+    }
+
+    // Only the newest half fit.
+    for (int i = 0; i < kNumKeys; ++i) {
+        SkImageFilterCacheKey key(i, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+        skif::FilterResult foundImage;
+        REPORTER_ASSERT(reporter, cache->get(key, &foundImage) == (i >= kNumKeys / 2), "%d", i);
+    }
+}
+
 // Exercise the purgeByKey and purge methods
 static void test_explicit_purging(skiatest::Reporter* reporter,
                                   const sk_sp<SkSpecialImage>& image,
@@ -197,9 +248,40 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_recently_used_survives_purge(reporter, fullImg);
+    test_oldest_purged_first(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
 
+DEF_TEST(ImageFilterCache_Threaded, reporter) {
+    SkBitmap srcBM = create_bm();
+    const SkIRect& full = SkIRect::MakeWH(kFullSize, kFullSize);
+    sk_sp<SkSpecialImage> image(SkSpecialImage::MakeFromRaster(full, srcBM, SkSurfaceProps()));
+
+    // Room for half of the keys, so that readers race with evictions.
+    static constexpr int kNumKeys = 32;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kNumKeys / 2 * image->getSize()));
+    auto filter = make_filter();
+
+    SkTaskGroup().batch(8, [&](int thread) {
+        SkIRect clip = SkIRect::MakeWH(100, 100);
+        for (int i = 0; i < 200; ++i) {
+            SkImageFilterCacheKey key((thread + i) % kNumKeys, SkMatrix::I(), clip,
+                                      image->uniqueID(), image->subset());
+            skif::FilterResult found;
+            if (!cache->get(key, &found)) {
+                cache->set(key, filter.get(),
+                           skif::FilterResult(image, skif::LayerSpace<SkIPoint>({0, 0})));
+            } else {
+                REPORTER_ASSERT(reporter, found.image() == image.get());
+            }
+        }
+    });
+    SkDEBUGCODE(REPORTER_ASSERT(reporter, cache->count() <= kNumKeys / 2);)
+
+    cache->purgeByImageFilter(filter.get());
+    SkDEBUGCODE(REPORTER_ASSERT(reporter, 0 == cache->count());)
+}
 
 // Shared test code for both the raster and gpu-backed image cases
 static void test_image_backed(skiatest::Reporter* reporter,
@@ -218,6 +300,8 @@ static void test_image_backed(skiatest::Reporter* reporter,
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_recently_used_survives_purge(reporter, fullImg);
+    test_oldest_purged_first(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
 
@@ -319,5 +403,7 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(ImageFilterCache_GPUBacked,
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_recently_used_survives_purge(reporter, fullImg);
+    test_oldest_purged_first(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Images are written as their index in fImages, and counted when they're read.
+struct ImageRegistry {
+    std::vector<sk_sp<SkImage>> fImages;
+    int fReads = 0;
+
+    SkSerialProcs serialProcs() {
+        SkSerialProcs procs;
+        procs.fImageProc = [](SkImage* image, void* ctx) -> sk_sp<SkData> {
+            auto registry = static_cast<ImageRegistry*>(ctx);
+            for (uint32_t i = 0; i < registry->fImages.size(); ++i) {
+                if (registry->fImages[i].get() == image) {
+                    return SkData::MakeWithCopy(&i, sizeof(i));
+                }
+            }
+            return nullptr;
+        };
+        procs.fImageCtx = this;
+        return procs;
+    }
+
+    SkDeserialProcs deserialProcs() {
+        SkDeserialProcs procs;
+        procs.fImageProc = [](const void* data, size_t length, void* ctx) -> sk_sp<SkImage> {
+            auto registry = static_cast<ImageRegistry*>(ctx);
+            uint32_t i;
+            if (length != sizeof(i)) {
+                return nullptr;
+            }
+            memcpy(&i, data, sizeof(i));
+            registry->fReads++;
+            return i < registry->fImages.size() ? registry->fImages[i] : nullptr;
+        };
+        procs.fImageCtx = this;
+        return procs;
+    }
+};
+
+sk_sp<SkImage> make_image(SkColor color) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(color);
+    bitmap.setImmutable();
+    return bitmap.asImage();
+}
+
+sk_sp<SkPicture> make_picture(ImageRegistry* registry) {
+    registry->fImages = {make_image(SK_ColorRED), make_image(SK_ColorGREEN)};
+
+    // Big enough to be drawn as a picture rather than unrolled.
+    SkPictureRecorder nestedRecorder;
+    SkCanvas* nested = nestedRecorder.beginRecording(SkRect::MakeWH(100, 100));
+    for (int i = 0; i < 10; ++i) {
+        SkPaint paint;
+        paint.setColor(SkColorSetARGB(0xFF, 0, 0, 25 * i));
+        nested->drawRect(SkRect::MakeXYWH(10 * i, 10 * i, 10, 10), paint);
+    }
+    nested->drawImage(registry->fImages[1], 50, 0);
+    sk_sp<SkPicture> nestedPicture = nestedRecorder.finishRecordingAsPicture();
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(400, 400));
+    canvas->drawImage(registry->fImages[0], 10, 10);
+
+    SkPath path;
+    path.moveTo(200, 20);
+    path.lineTo(280, 60);
+    path.lineTo(220, 90);
+    path.close();
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    paint.setAntiAlias(true);
+    canvas->drawPath(path, paint);
+
+    canvas->save();
+    canvas->translate(250, 250);
+    canvas->clipRect(SkRect::MakeWH(80, 80));
+    canvas->drawPicture(nestedPicture);
+    canvas->restore();
+
+    canvas->save();
+    canvas->rotate(10);
+    paint.setColor(SK_ColorMAGENTA);
+    canvas->drawOval(SkRect::MakeXYWH(30, 200, 120, 60), paint);
+    canvas->restore();
+    return recorder.finishRecordingAsPicture();
+}
+
+SkBitmap draw(const SkPicture* picture, const SkRect& clip) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(400, 400);
+    bitmap.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bitmap);
+    canvas.clipRect(clip);
+    canvas.drawPicture(picture);
+    return bitmap;
+}
+
+}  // namespace
+
+DEF_TEST(Picture_Indexed, reporter) {
+    ImageRegistry registry;
+    sk_sp<SkPicture> picture = make_picture(&registry);
+    SkSerialProcs serialProcs = registry.serialProcs();
+    sk_sp<SkData> data = picture->serializeIndexed(&serialProcs);
+    REPORTER_ASSERT(reporter, data);
+    SkDeserialProcs deserialProcs = registry.deserialProcs();
+
+    // Drawing everything reads everything, and draws the same.
+    {
+        sk_sp<SkPicture> indexed = SkPicture::MakeFromIndexedData(data, &deserialProcs);
+        REPORTER_ASSERT(reporter, indexed);
+        REPORTER_ASSERT(reporter, indexed->cullRect() == picture->cullRect());
+        REPORTER_ASSERT(reporter, registry.fReads == 0);
+
+        const SkRect all = SkRect::MakeWH(400, 400);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(draw(picture.get(), all),
+                                                          draw(indexed.get(), all)));
+        REPORTER_ASSERT(reporter, registry.fReads == 2);
+    }
+
+    // Only what is inside of the clip is read.
+    registry.fReads = 0;
+    {
+        sk_sp<SkPicture> indexed = SkPicture::MakeFromIndexedData(data, &deserialProcs);
+        const SkRect topLeft = SkRect::MakeWH(100, 100);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(draw(picture.get(), topLeft),
+                                                          draw(indexed.get(), topLeft)));
+        REPORTER_ASSERT(reporter, registry.fReads == 1);
+
+        // The nested picture's image is read when it's drawn.
+        const SkRect bottomRight = SkRect::MakeLTRB(250, 250, 400, 400);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(draw(picture.get(), bottomRight),
+                                                          draw(indexed.get(), bottomRight)));
+        REPORTER_ASSERT(reporter, registry.fReads == 2);
+
+        // Some of the oval is outside of its unrotated bounds.
+        const SkRect oval = SkRect::MakeLTRB(0, 200, 150, 300);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(draw(picture.get(), oval),
+                                                          draw(indexed.get(), oval)));
+    }
+
+    // Data that isn't all there, or isn't an indexed picture, is rejected.
+    REPORTER_ASSERT(reporter, !SkPicture::MakeFromIndexedData(nullptr));
+    REPORTER_ASSERT(reporter,
+                    !SkPicture::MakeFromIndexedData(SkData::MakeSubset(data.get(), 0,
+                                                                       data->size() - 4)));
+    REPORTER_ASSERT(reporter, !SkPicture::MakeFromIndexedData(picture->serialize(&serialProcs)));
+}
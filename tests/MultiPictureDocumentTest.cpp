@@ -8,8 +8,10 @@
  * And that the pictures within it are re-created accurately
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkData.h"
 #include "include/core/SkDocument.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
@@ -178,6 +180,85 @@ DEF_TEST(SkMultiPictureDocument_Serialize_and_deserialize, reporter) {
     }
 }
 
+// Images with the same pixels are written and read once, whichever page draws them.
+DEF_TEST(SkMultiPictureDocument_SharedImages, reporter) {
+    struct Counts {
+        int fEncoded = 0;
+        int fDecoded = 0;
+    } counts;
+
+    // Images are written as their pixels.
+    SkSerialProcs procs;
+    procs.fImageProc = [](SkImage* image, void* ctx) -> sk_sp<SkData> {
+        static_cast<Counts*>(ctx)->fEncoded++;
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(image->width(), image->height());
+        if (!image->readPixels(nullptr, bitmap.pixmap(), 0, 0)) {
+            return nullptr;
+        }
+        return SkData::MakeWithCopy(bitmap.getPixels(), bitmap.computeByteSize());
+    };
+    procs.fImageCtx = &counts;
+    SkDeserialProcs dprocs;
+    dprocs.fImageProc = [](const void* data, size_t length, void* ctx) -> sk_sp<SkImage> {
+        static_cast<Counts*>(ctx)->fDecoded++;
+        SkImageInfo info = SkImageInfo::MakeN32Premul(10, 10);
+        if (length != info.computeMinByteSize()) {
+            return nullptr;
+        }
+        return SkImages::RasterFromData(info, SkData::MakeWithCopy(data, length),
+                                        info.minRowBytes());
+    };
+    dprocs.fImageCtx = &counts;
+
+    static const int NUM_PAGES = 4;
+    SkDynamicMemoryWStream stream;
+    sk_sp<SkDocument> doc = SkMakeMultiPictureDocument(&stream, &procs);
+    std::vector<sk_sp<SkPicture>> expectedPages;
+    SkPath path;
+    path.cubicTo(100, 0, -50, 25, 25, 25);
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        // A new image on every page, all with the same pixels.
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(10, 10);
+        bitmap.eraseColor(SK_ColorBLUE);
+        bitmap.setImmutable();
+        sk_sp<SkImage> image = bitmap.asImage();
+
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(50, 50);
+        canvas->drawImage(image, i, i);
+        canvas->drawPath(path, SkPaint());
+        canvas->drawString("Page", 0, 40, SkFont(), SkPaint());
+        sk_sp<SkPicture> expected = recorder.finishRecordingAsPicture();
+
+        doc->beginPage(50, 50)->drawPicture(expected);
+        doc->endPage();
+        expectedPages.push_back(std::move(expected));
+    }
+    doc->close();
+    REPORTER_ASSERT(reporter, counts.fEncoded == NUM_PAGES);
+
+    std::unique_ptr<SkStreamAsset> written = stream.detachAsStream();
+    int pageCount = SkMultiPictureDocumentReadPageCount(written.get());
+    REPORTER_ASSERT(reporter, pageCount == NUM_PAGES);
+    std::vector<SkDocumentPage> pages(pageCount);
+    REPORTER_ASSERT(reporter,
+                    SkMultiPictureDocumentRead(written.get(), pages.data(), pageCount, &dprocs));
+    REPORTER_ASSERT(reporter, counts.fDecoded == 1);
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(50, 50);
+    for (int i = 0; i < pageCount; ++i) {
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        expected.eraseColor(SK_ColorWHITE);
+        actual.eraseColor(SK_ColorWHITE);
+        SkCanvas(expected).drawPicture(expectedPages[i]);
+        SkCanvas(actual).drawPicture(pages[i].fPicture);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+    }
+}
 
 #if defined(SK_GANESH) && defined(SK_BUILD_FOR_ANDROID) && __ANDROID_API__ >= 26
 
@@ -15,7 +15,11 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
+#include "include/effects/SkImageFilters.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdint>
 
 class PictureBBHTestBase {
 public:
@@ -38,16 +42,20 @@ public:
         // With an R-Tree
         SkRTreeFactory RTreeFactory;
         this->run(&RTreeFactory, reporter);
+
+        // With a tile grid of approximate bounds
+        SkTileGridFactory tileGridFactory;
+        this->run(&tileGridFactory, reporter, SkPictureRecorder::kApproximateBounds_RecordFlag);
     }
 
 private:
-    void run(SkBBHFactory* factory, skiatest::Reporter* reporter) {
+    void run(SkBBHFactory* factory, skiatest::Reporter* reporter, uint32_t recordFlags = 0) {
         SkCanvas playbackCanvas(fResultBitmap);
         playbackCanvas.clear(SK_ColorGREEN);
         SkPictureRecorder recorder;
-        SkCanvas* recordCanvas = recorder.beginRecording(SkIntToScalar(fPictureWidth),
-                                                         SkIntToScalar(fPictureHeight),
-                                                         factory);
+        SkCanvas* recordCanvas = recorder.beginRecording(
+                SkRect::MakeWH(SkIntToScalar(fPictureWidth), SkIntToScalar(fPictureHeight)),
+                factory, recordFlags);
         this->doTest(playbackCanvas, *recordCanvas);
         sk_sp<SkPicture> picture(recorder.finishRecordingAsPicture());
         playbackCanvas.drawPicture(picture);
@@ -101,6 +109,8 @@ DEF_TEST(PictureNegativeSpace, r) {
     SkPictureRecorder recorder;
 
     SkRect cull = {-200,-200,+200,+200};
+    SkPaint aa;
+    aa.setAntiAlias(true);
 
     {
         sk_sp<SkBBoxHierarchy> bbh = factory();
@@ -108,7 +118,8 @@ DEF_TEST(PictureNegativeSpace, r) {
             canvas->save();
             canvas->clipRect(cull);
             canvas->drawRect({-20,-20,-10,-10}, SkPaint{});
-            canvas->drawRect({-20,-20,-10,-10}, SkPaint{});
+            // Anti-aliased, so that it doesn't hide the first rect.
+            canvas->drawRect({-20,-20,-10,-10}, aa);
             canvas->restore();
         auto pic = recorder.finishRecordingAsPicture();
         REPORTER_ASSERT(r, pic->approximateOpCount() == 5);
@@ -119,9 +130,50 @@ DEF_TEST(PictureNegativeSpace, r) {
         auto canvas = recorder.beginRecording(cull, &factory);
             canvas->clipRect(cull);
             canvas->drawRect({-20,-20,-10,-10}, SkPaint{});
-            canvas->drawRect({-20,-20,-10,-10}, SkPaint{});
+            canvas->drawRect({-20,-20,-10,-10}, aa);
         auto pic = recorder.finishRecordingAsPicture();
         REPORTER_ASSERT(r, pic->approximateOpCount() == 3);
         REPORTER_ASSERT(r, pic->cullRect() == (SkRect{-20,-20,-10,-10}));
     }
 }
+
+DEF_TEST(PictureBBH_ApproximateTileGrid, r) {
+    auto record = [](SkBBHFactory* factory, uint32_t recordFlags) {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(200, 200), factory, recordFlags);
+        SkPaint shadow;
+        shadow.setImageFilter(SkImageFilters::DropShadow(30, 10, 2, 2, SK_ColorBLACK, nullptr));
+        for (int i = 0; i < 100; i++) {
+            SkPaint paint;
+            paint.setColor(SkColorSetARGB(0xFF, 2 * i, 255 - 2 * i, 0x80));
+            canvas->save();
+            canvas->translate(SkIntToScalar((i * 37) % 180), SkIntToScalar((i * 53) % 180));
+            if (i % 10 == 0) {
+                canvas->saveLayer(nullptr, &shadow);
+                canvas->drawOval(SkRect::MakeWH(12, 8), paint);
+                canvas->restore();
+            } else {
+                canvas->drawRect(SkRect::MakeWH(10, 15), paint);
+            }
+            canvas->restore();
+        }
+        return recorder.finishRecordingAsPicture();
+    };
+    auto draw = [](const sk_sp<SkPicture>& picture, const SkRect& clip) {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(200, 200);
+        SkCanvas canvas(bitmap);
+        canvas.clear(SK_ColorWHITE);
+        canvas.clipRect(clip);
+        canvas.drawPicture(picture);
+        return bitmap;
+    };
+
+    SkTileGridFactory factory(32);
+    sk_sp<SkPicture> expected = record(nullptr, 0),
+                     actual = record(&factory, SkPictureRecorder::kApproximateBounds_RecordFlag);
+    for (const SkRect& clip : {SkRect::MakeWH(200, 200), SkRect::MakeXYWH(30, 40, 50, 20),
+                               SkRect::MakeXYWH(100, 0, 25, 200)}) {
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(expected, clip), draw(actual, clip)));
+    }
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkResourceCache.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdint>
+
+namespace {
+
+sk_sp<SkPicture> make_picture() {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(50, 50));
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeXYWH(5, 5, 20, 30), paint);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeXYWH(20, 15, 25, 25), paint);
+    return recorder.finishRecordingAsPicture();
+}
+
+sk_sp<SkSurface> make_surface(bool cachePictures) {
+    const SkSurfaceProps props(cachePictures ? SkSurfaceProps::kCachePictures_Flag : 0,
+                               kUnknown_SkPixelGeometry);
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100), &props);
+    surface->getCanvas()->clear(SK_ColorWHITE);
+    return surface;
+}
+
+SkBitmap read_pixels(SkSurface* surface) {
+    SkBitmap bitmap;
+    bitmap.allocPixels(surface->imageInfo());
+    surface->readPixels(bitmap, 0, 0);
+    return bitmap;
+}
+
+int count_cached(uint64_t sharedID) {
+    struct Data {
+        uint64_t fSharedID;
+        int fCount;
+    } data = {sharedID, 0};
+    SkResourceCache::VisitAll([](const SkResourceCache::Rec& rec, void* context) {
+        auto data = static_cast<Data*>(context);
+        if (rec.getKey().getSharedID() == data->fSharedID) {
+            data->fCount++;
+        }
+    }, &data);
+    return data.fCount;
+}
+
+class CountingDrawable : public SkDrawable {
+public:
+    int fDraws = 0;
+
+private:
+    SkRect onGetBounds() override { return SkRect::MakeWH(40, 40); }
+    void onDraw(SkCanvas* canvas) override {
+        fDraws++;
+        SkPaint paint;
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawRect(SkRect::MakeXYWH(10, 10, 20, 20), paint);
+    }
+};
+
+}  // namespace
+
+DEF_TEST(PictureRasterCache_Picture, reporter) {
+    sk_sp<SkPicture> picture = make_picture();
+    const uint64_t sharedID = SkPicturePriv::MakeSharedID(picture->uniqueID());
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 0);
+
+    // Drawing from the cache draws the same, at any translation.
+    for (SkScalar dx : {0.f, 10.f, 12.5f}) {
+        sk_sp<SkSurface> expected = make_surface(false);
+        sk_sp<SkSurface> cached = make_surface(true);
+        for (SkSurface* surface : {expected.get(), cached.get()}) {
+            surface->getCanvas()->translate(dx, 20);
+            surface->getCanvas()->drawPicture(picture);
+        }
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(read_pixels(expected.get()),
+                                                          read_pixels(cached.get())));
+    }
+    // The whole pixel translations share an image, and the picture is only analyzed once.
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 1 + 2);
+
+    // Another scale or clip is another image.
+    sk_sp<SkSurface> surface = make_surface(true);
+    surface->getCanvas()->drawPicture(picture);
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 1 + 2);
+    surface->getCanvas()->scale(2, 2);
+    surface->getCanvas()->drawPicture(picture);
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 1 + 3);
+    surface->getCanvas()->clipRect(SkRect::MakeWH(10, 10));
+    surface->getCanvas()->drawPicture(picture);
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 1 + 4);
+
+    // The images are purged with the picture.
+    picture.reset();
+    SkResourceCache::CheckMessages();
+    REPORTER_ASSERT(reporter, count_cached(sharedID) == 0);
+}
+
+DEF_TEST(PictureRasterCache_NotSrcOver, reporter) {
+    auto record = [](auto&& draw) {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(50, 50));
+        SkPaint paint;
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawRect(SkRect::MakeXYWH(20, 15, 25, 25), paint);
+        draw(canvas);
+        return recorder.finishRecordingAsPicture();
+    };
+    auto drawWithBlendMode = [](SkCanvas* canvas, SkBlendMode mode) {
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        paint.setBlendMode(mode);
+        canvas->drawRect(SkRect::MakeXYWH(5, 5, 20, 30), paint);
+    };
+    sk_sp<SkPicture> inner = record([](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setBlendMode(SkBlendMode::kClear);
+        canvas->drawRect(SkRect::MakeXYWH(0, 0, 30, 30), paint);
+    });
+    const sk_sp<SkPicture> pictures[] = {
+        record([](SkCanvas* canvas) { canvas->drawColor(SK_ColorRED, SkBlendMode::kSrc); }),
+        record([&](SkCanvas* canvas) { drawWithBlendMode(canvas, SkBlendMode::kDstIn); }),
+        record([&](SkCanvas* canvas) { drawWithBlendMode(canvas, SkBlendMode::kXor); }),
+        record([](SkCanvas* canvas) {
+            SkPaint paint;
+            paint.setBlendMode(SkBlendMode::kMultiply);
+            canvas->saveLayer(nullptr, &paint);
+            canvas->drawColor(SK_ColorGREEN);
+            canvas->restore();
+        }),
+        record([&](SkCanvas* canvas) { canvas->drawPicture(inner); }),
+    };
+
+    for (const sk_sp<SkPicture>& picture : pictures) {
+        sk_sp<SkSurface> expected = make_surface(false);
+        sk_sp<SkSurface> cached = make_surface(true);
+        for (SkSurface* surface : {expected.get(), cached.get()}) {
+            surface->getCanvas()->drawColor(SK_ColorYELLOW);
+            surface->getCanvas()->translate(10, 20);
+            surface->getCanvas()->drawPicture(picture);
+            surface->getCanvas()->drawPicture(picture);
+        }
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(read_pixels(expected.get()),
+                                                          read_pixels(cached.get())));
+        // Only the analysis is cached, not an image.
+        const uint64_t sharedID = SkPicturePriv::MakeSharedID(picture->uniqueID());
+        REPORTER_ASSERT(reporter, count_cached(sharedID) == 1);
+    }
+}
+
+DEF_TEST(PictureRasterCache_Drawable, reporter) {
+    sk_sp<CountingDrawable> drawable = sk_make_sp<CountingDrawable>();
+
+    // Without the flag, the drawable draws every time.
+    sk_sp<SkSurface> expected = make_surface(false);
+    expected->getCanvas()->drawDrawable(drawable.get());
+    expected->getCanvas()->drawDrawable(drawable.get());
+    REPORTER_ASSERT(reporter, drawable->fDraws == 2);
+
+    sk_sp<SkSurface> cached = make_surface(true);
+    cached->getCanvas()->drawDrawable(drawable.get());
+    cached->getCanvas()->drawDrawable(drawable.get());
+    REPORTER_ASSERT(reporter, drawable->fDraws == 3);
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(read_pixels(expected.get()),
+                                                      read_pixels(cached.get())));
+
+    // It draws again once it has changed...
+    drawable->notifyDrawingChanged();
+    cached->getCanvas()->drawDrawable(drawable.get());
+    cached->getCanvas()->drawDrawable(drawable.get());
+    REPORTER_ASSERT(reporter, drawable->fDraws == 4);
+
+    // ... or at another scale.
+    const SkMatrix scale = SkMatrix::Scale(2, 2);
+    cached->getCanvas()->drawDrawable(drawable.get(), &scale);
+    cached->getCanvas()->drawDrawable(drawable.get(), &scale);
+    REPORTER_ASSERT(reporter, drawable->fDraws == 5);
+}
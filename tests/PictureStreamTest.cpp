@@ -0,0 +1,263 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
+#include "src/core/SkPictureStream.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+
+namespace {
+
+sk_sp<SkImage> make_image() {
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(8, 8));
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    surface->getCanvas()->drawRect(SkRect::MakeWH(4, 4), SkPaint(SkColors::kMagenta));
+    return surface->makeImageSnapshot();
+}
+
+sk_sp<SkPicture> make_nested_picture() {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(10, 10));
+    canvas->drawOval(SkRect::MakeWH(10, 10), SkPaint(SkColors::kYellow));
+    canvas->drawRect(SkRect::MakeWH(3, 3), SkPaint(SkColors::kCyan));
+    return recorder.finishRecordingAsPicture();
+}
+
+// Long enough to fill many small chunks, with saves, clips and matrices that last across them.
+void draw_scene(SkCanvas* canvas, const sk_sp<SkImage>& image, const sk_sp<SkPicture>& picture) {
+    SkPath path;
+    path.moveTo(0, 0);
+    path.lineTo(12, 3);
+    path.lineTo(4, 10);
+    path.close();
+
+    canvas->save();
+    canvas->clipRect(SkRect::MakeXYWH(2, 2, 90, 90));
+    canvas->translate(3, 1);
+    for (int i = 0; i < 50; ++i) {
+        SkPaint paint;
+        paint.setColor(SkColorSetARGB(0xFF, 5 * i, 255 - 5 * i, 0x80));
+        paint.setAntiAlias(i % 2 == 0);
+        canvas->save();
+        canvas->translate(SkIntToScalar((i % 8) * 11), SkIntToScalar((i / 8) * 13));
+        switch (i % 4) {
+            case 0: canvas->drawRect(SkRect::MakeWH(9, 7), paint); break;
+            case 1: canvas->drawPath(path, paint); break;
+            case 2: canvas->drawImage(image, 0, 0); break;
+            case 3: canvas->drawPicture(picture); break;
+        }
+        canvas->restore();
+    }
+    canvas->setMatrix(SkMatrix::Scale(2, 2));
+    canvas->clipPath(path);
+    canvas->drawPaint(SkPaint(SkColors::kBlue));
+    canvas->restore();
+}
+
+SkBitmap draw(const std::function<void(SkCanvas*)>& drawFn) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(100, 100);
+    SkCanvas canvas(bitmap);
+    canvas.clear(SK_ColorWHITE);
+    canvas.translate(4, 2);
+    drawFn(&canvas);
+    return bitmap;
+}
+
+// Images are written as an index into the test's own table, and counted.
+struct Images {
+    sk_sp<SkImage> fImage;
+    int fWritten = 0;
+
+    SkSerialProcs serialProcs() {
+        SkSerialProcs procs;
+        procs.fImageProc = [](SkImage*, void* ctx) {
+            static_cast<Images*>(ctx)->fWritten++;
+            return SkData::MakeWithCString("image");
+        };
+        procs.fImageCtx = this;
+        procs.fPictureProc = [](SkPicture*, void* ctx) -> sk_sp<SkData> {
+            static_cast<Images*>(ctx)->fWritten += 100;
+            return nullptr;
+        };
+        procs.fPictureCtx = this;
+        return procs;
+    }
+
+    SkDeserialProcs deserialProcs() {
+        SkDeserialProcs procs;
+        procs.fImageProc = [](const void*, size_t, void* ctx) {
+            return static_cast<Images*>(ctx)->fImage;
+        };
+        procs.fImageCtx = this;
+        return procs;
+    }
+};
+
+}  // namespace
+
+DEF_TEST(PictureStream, reporter) {
+    Images images{make_image()};
+    const sk_sp<SkPicture> nested = make_nested_picture();
+    const SkRect cull = SkRect::MakeWH(100, 100);
+
+    SkPictureRecorder recorder;
+    draw_scene(recorder.beginRecording(cull), images.fImage, nested);
+    const sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    const SkBitmap expected = draw([&](SkCanvas* canvas) { canvas->drawPicture(picture); });
+
+    SkDynamicMemoryWStream stream;
+    const SkSerialProcs serialProcs = images.serialProcs();
+    {
+        SkPictureStreamRecorder streamRecorder(&stream, cull, &serialProcs, /*chunkSize=*/256);
+        draw_scene(streamRecorder.getRecordingCanvas(), images.fImage, nested);
+        REPORTER_ASSERT(reporter, streamRecorder.finish());
+        REPORTER_ASSERT(reporter, !streamRecorder.getRecordingCanvas());
+    }
+    // The image and the nested picture are in many chunks, but written once.
+    REPORTER_ASSERT(reporter, images.fWritten == 101);
+
+    sk_sp<SkData> data = stream.detachAsData();
+    const SkDeserialProcs deserialProcs = images.deserialProcs();
+    SkMemoryStream readStream(data);
+    std::unique_ptr<SkPictureStreamPlayer> player =
+            SkPictureStreamPlayer::Make(&readStream, &deserialProcs);
+    REPORTER_ASSERT(reporter, player);
+    REPORTER_ASSERT(reporter, player->cullRect() == cull);
+
+    int saveCount = -1;
+    const SkBitmap actual = draw([&](SkCanvas* canvas) {
+        saveCount = canvas->getSaveCount();
+        REPORTER_ASSERT(reporter, player->playback(canvas));
+        REPORTER_ASSERT(reporter, canvas->getSaveCount() == saveCount);
+    });
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+
+    // A stream cut short in a chunk draws the chunks before it.
+    SkMemoryStream cutStream(SkData::MakeSubset(data.get(), 0, data->size() / 2));
+    player = SkPictureStreamPlayer::Make(&cutStream, &deserialProcs);
+    REPORTER_ASSERT(reporter, player);
+    draw([&](SkCanvas* canvas) { REPORTER_ASSERT(reporter, !player->playback(canvas)); });
+
+    SkMemoryStream notAStream(nested->serialize());
+    REPORTER_ASSERT(reporter, !SkPictureStreamPlayer::Make(&notAStream));
+}
+
+DEF_TEST(PictureStream_Flush, reporter) {
+    SkDynamicMemoryWStream stream;
+    SkPictureStreamRecorder recorder(&stream, SkRect::MakeWH(100, 100));
+    SkCanvas* canvas = recorder.getRecordingCanvas();
+    canvas->save();
+    canvas->translate(10, 10);
+    canvas->drawRect(SkRect::MakeWH(20, 20), SkPaint(SkColors::kRed));
+
+    // What's flushed can be played back while recording goes on, and draws the same as the
+    // picture of what's been recorded so far.
+    REPORTER_ASSERT(reporter, recorder.flush());
+    sk_sp<SkData> flushed = stream.detachAsData();
+    SkMemoryStream readStream(flushed);
+    std::unique_ptr<SkPictureStreamPlayer> player = SkPictureStreamPlayer::Make(&readStream);
+    REPORTER_ASSERT(reporter, player);
+
+    const SkBitmap expected = draw([](SkCanvas* c) {
+        c->translate(10, 10);
+        c->drawRect(SkRect::MakeWH(20, 20), SkPaint(SkColors::kRed));
+    });
+    const SkBitmap actual = draw([&](SkCanvas* c) {
+        REPORTER_ASSERT(reporter, player->playback(c));
+    });
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+
+    canvas->drawRect(SkRect::MakeWH(5, 5), SkPaint(SkColors::kBlue));
+    REPORTER_ASSERT(reporter, recorder.finish());
+    REPORTER_ASSERT(reporter, stream.bytesWritten() > 0);
+}
+
+DEF_TEST(PictureStream_RetainedResources, reporter) {
+    sk_sp<SkImage> images[4];
+    for (int i = 0; i < 4; ++i) {
+        sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(8, 8));
+        surface->getCanvas()->clear(SkColorSetARGB(0xFF, 60 * i, 0, 255 - 60 * i));
+        images[i] = surface->makeImageSnapshot();
+    }
+    // Each image is drawn in its own chunk, and only the last two are referred to.
+    auto drawImages = [&](SkCanvas* canvas) {
+        for (int i : {0, 1, 2, 3, 0, 3}) {
+            canvas->drawImage(images[i], 10 * i, 0);
+        }
+    };
+    const SkBitmap expected = draw(drawImages);
+
+    // Images are written as their index into the array.
+    struct Ctx {
+        sk_sp<SkImage>* fImages;
+        int fWritten = 0;
+    } ctx{images};
+    SkSerialProcs serialProcs;
+    serialProcs.fImageProc = [](SkImage* image, void* ctx) {
+        auto c = static_cast<Ctx*>(ctx);
+        c->fWritten++;
+        for (int i = 0; i < 4; ++i) {
+            if (c->fImages[i].get() == image) {
+                return SkData::MakeWithCopy(&i, sizeof(i));
+            }
+        }
+        return SkData::MakeEmpty();
+    };
+    serialProcs.fImageCtx = &ctx;
+    SkDeserialProcs deserialProcs;
+    deserialProcs.fImageProc = [](const void* data, size_t size, void* ctx) -> sk_sp<SkImage> {
+        int i;
+        if (size != sizeof(i)) {
+            return nullptr;
+        }
+        memcpy(&i, data, sizeof(i));
+        return static_cast<Ctx*>(ctx)->fImages[i];
+    };
+    deserialProcs.fImageCtx = &ctx;
+
+    SkDynamicMemoryWStream stream;
+    {
+        SkPictureStreamRecorder recorder(&stream, SkRect::MakeWH(100, 100), &serialProcs,
+                                         /*chunkSize=*/1, /*retainedResources=*/2);
+        drawImages(recorder.getRecordingCanvas());
+        REPORTER_ASSERT(reporter, recorder.finish());
+    }
+    // The first image was no longer retained when it was drawn again, but the last one was.
+    REPORTER_ASSERT(reporter, ctx.fWritten == 5, "%d", ctx.fWritten);
+
+    SkMemoryStream readStream(stream.detachAsData());
+    std::unique_ptr<SkPictureStreamPlayer> player =
+            SkPictureStreamPlayer::Make(&readStream, &deserialProcs);
+    REPORTER_ASSERT(reporter, player);
+    const SkBitmap actual = draw([&](SkCanvas* canvas) {
+        REPORTER_ASSERT(reporter, player->playback(canvas));
+    });
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+    // The player let go of the images that are no longer retained.
+    REPORTER_ASSERT(reporter, images[1]->unique() && images[2]->unique());
+    REPORTER_ASSERT(reporter, !images[3]->unique());
+}
@@ -921,7 +921,8 @@ DEF_TEST(Picture_nested_op_count, r) {
             if (pic) {
                 c->drawPicture(pic);
             } else {
-                c->drawRect({0,0, 100,100}, SkPaint{});
+                // Translucent, so that no rect hides the ones drawn before it.
+                c->drawRect({0,0, 100,100}, SkPaint{SkColor4f{0, 0, 0, 0.5f}});
             }
         }
         return rec.finishRecordingAsPicture();
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/utils/SkProfilingCanvas.h"
+#include "src/utils/SkJSON.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <iterator>
+
+using Op = SkProfilingCanvas::Op;
+using PaintKind = SkProfilingCanvas::PaintKind;
+
+namespace {
+
+sk_sp<SkPicture> make_picture() {
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(8, 8));
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> image = surface->makeImageSnapshot();
+
+    SkPictureRecorder nestedRecorder;
+    SkCanvas* nestedCanvas = nestedRecorder.beginRecording(SkRect::MakeWH(10, 10));
+    nestedCanvas->drawOval(SkRect::MakeWH(10, 10), SkPaint(SkColors::kYellow));
+    nestedCanvas->drawOval(SkRect::MakeWH(5, 5), SkPaint(SkColors::kCyan));
+    sk_sp<SkPicture> nested = nestedRecorder.finishRecordingAsPicture();
+
+    const SkPoint pts[] = {{0, 0}, {10, 0}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    SkPaint gradient;
+    gradient.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+    for (int i = 0; i < 3; i++) {
+        canvas->drawRect(SkRect::MakeXYWH(10 * i, 0, 10, 10), gradient);
+    }
+    canvas->drawRect(SkRect::MakeXYWH(0, 20, 50, 50), SkPaint(SkColors::kBlue));
+    canvas->drawImage(image, 60, 60);
+    canvas->saveLayerAlphaf(nullptr, 0.5f);
+    canvas->clipRect(SkRect::MakeXYWH(30, 30, 40, 40));
+    canvas->translate(30, 30);
+    // The nested picture has too many ops for drawPicture to unroll it.
+    canvas->drawPicture(nested);
+    canvas->drawPicture(nested);
+    canvas->restore();
+    return recorder.finishRecordingAsPicture();
+}
+
+SkBitmap make_bitmap() {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(100, 100);
+    bitmap.eraseColor(SK_ColorWHITE);
+    return bitmap;
+}
+
+}  // namespace
+
+DEF_TEST(ProfilingCanvas, reporter) {
+    const sk_sp<SkPicture> picture = make_picture();
+
+    SkBitmap expected = make_bitmap();
+    SkCanvas(expected).drawPicture(picture);
+
+    SkBitmap actual = make_bitmap();
+    SkCanvas canvas(actual);
+    SkProfilingCanvas profiler(&canvas);
+    profiler.drawPicture(picture);
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+
+    // The nested pictures' draws are timed too.
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect).fCount == 4);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawOval).fCount == 4);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawImage).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kSaveLayer).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kRestoreLayer).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kClipRect).fCount == 1);
+
+    // 10x10 rects are in the [64, 256) pixel bucket and 50x50 ones in [1024, 4096).
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect, PaintKind::kGradient, 4).fCount == 3);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect, PaintKind::kColor, 6).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawImage, PaintKind::kNone, 4).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawOval, PaintKind::kColor, 4).fCount == 2);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawOval, PaintKind::kColor, 3).fCount == 2);
+
+    const SkProfilingCanvas::Stats rects = profiler.stats(Op::kDrawRect);
+    REPORTER_ASSERT(reporter, rects.fTotalNanos >= rects.fMaxNanos && rects.fMaxNanos >= 0);
+
+    SkDynamicMemoryWStream stream;
+    profiler.writeJSON(&stream);
+    sk_sp<SkData> data = stream.detachAsData();
+    skjson::DOM dom(static_cast<const char*>(data->data()), data->size());
+    const skjson::ObjectValue* root = dom.root();
+    REPORTER_ASSERT(reporter, root);
+    if (!root) {
+        return;
+    }
+    auto number = [](const skjson::ObjectValue& object, const char* name) {
+        const skjson::NumberValue* value = object[name];
+        return value ? **value : -1;
+    };
+    const skjson::ArrayValue* stats = (*root)["stats"];
+    REPORTER_ASSERT(reporter, stats);
+    if (!stats) {
+        return;
+    }
+    // The stats are by decreasing total time, and add up to the total count.
+    double count = 0, lastNanos = -1;
+    bool foundGradientRects = false;
+    for (const skjson::ObjectValue* entry : *stats) {
+        REPORTER_ASSERT(reporter, entry);
+        const double nanos = number(*entry, "totalNanos");
+        REPORTER_ASSERT(reporter, nanos >= 0 && (lastNanos < 0 || nanos <= lastNanos));
+        lastNanos = nanos;
+        count += number(*entry, "count");
+
+        const skjson::StringValue* op = (*entry)["op"];
+        const skjson::StringValue* paint = (*entry)["paint"];
+        REPORTER_ASSERT(reporter, op && paint);
+        if (op->str() == "DrawRect" && paint->str() == "Gradient") {
+            foundGradientRects = number(*entry, "count") == 3 &&
+                                 number(*entry, "minArea") == 64 &&
+                                 number(*entry, "maxArea") == 256;
+        }
+    }
+    REPORTER_ASSERT(reporter, foundGradientRects);
+    REPORTER_ASSERT(reporter, count == number(*root, "count"));
+
+    profiler.resetStats();
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect).fCount == 0);
+}
+
+DEF_TEST(ProfilingCanvas_Areas, reporter) {
+    SkBitmap bitmap = make_bitmap();
+    SkCanvas canvas(bitmap);
+    canvas.translate(10, 10);
+    SkProfilingCanvas profiler(&canvas);
+
+    // Areas are in device pixels, with the current matrix and clip.
+    const SkRect rect = SkRect::MakeWH(10, 10);
+    profiler.drawRect(rect, SkPaint());                   // 100 pixels
+    profiler.scale(2, 2);
+    profiler.drawRect(rect, SkPaint());                   // 400
+    profiler.save();
+    profiler.translate(100, 100);
+    profiler.drawRect(rect, SkPaint());                   // Outside the canvas.
+    profiler.restore();
+    profiler.drawOval(rect, SkPaint());                   // 400
+    profiler.clipRect(SkRect::MakeWH(5, 5));
+    profiler.drawPaint(SkPaint());                        // ~100
+
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect, PaintKind::kColor, 4).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect, PaintKind::kColor, 5).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawRect, PaintKind::kColor, 0).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawOval, PaintKind::kColor, 5).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawPaint, PaintKind::kColor, 4).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kRestore).fCount == 1);
+}
+
+#ifdef SK_ENABLE_SKSL
+DEF_TEST(ProfilingCanvas_Mesh, reporter) {
+    using Attribute = SkMeshSpecification::Attribute;
+    const Attribute attributes[] = {{Attribute::Type::kFloat2, 0, SkString("position")}};
+    auto [spec, error] = SkMeshSpecification::Make(
+            attributes, sizeof(SkPoint), /*varyings=*/{},
+            SkString("Varyings main(const Attributes a) {"
+                     "    Varyings v;"
+                     "    v.position = a.position;"
+                     "    return v;"
+                     "}"),
+            SkString("float2 main(const Varyings v) { return v.position; }"));
+    REPORTER_ASSERT(reporter, spec, "%s", error.c_str());
+    if (!spec) {
+        return;
+    }
+    const SkPoint triangle[] = {{10, 10}, {30, 10}, {10, 30}};
+    auto [mesh, meshError] = SkMesh::Make(
+            spec, SkMesh::Mode::kTriangles,
+            SkMesh::MakeVertexBuffer(nullptr, triangle, sizeof(triangle)), std::size(triangle),
+            /*vertexOffset=*/0, /*uniforms=*/nullptr, SkRect::MakeLTRB(10, 10, 30, 30));
+    REPORTER_ASSERT(reporter, mesh.isValid(), "%s", meshError.c_str());
+
+    SkBitmap expected = make_bitmap();
+    SkCanvas(expected).drawMesh(mesh, nullptr, SkPaint(SkColors::kBlue));
+
+    SkBitmap actual = make_bitmap();
+    SkCanvas canvas(actual);
+    SkProfilingCanvas profiler(&canvas);
+    profiler.drawMesh(mesh, nullptr, SkPaint(SkColors::kBlue));
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, actual));
+
+    // The mesh's bounds are 400 pixels.
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawMesh).fCount == 1);
+    REPORTER_ASSERT(reporter, profiler.stats(Op::kDrawMesh, PaintKind::kColor, 5).fCount == 1);
+}
+#endif
@@ -12,7 +12,6 @@
 #include "src/core/SkRTree.h"
 #include "tests/Test.h"
 
-#include <cmath>
 #include <cstddef>
 #include <vector>
 
@@ -63,20 +62,11 @@ static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rec
 }
 
 DEF_TEST(RTree, reporter) {
-    int expectedDepthMin = -1;
-    int tmp = NUM_RECTS;
-    while (tmp > 0) {
-        tmp -= static_cast<int>(pow(static_cast<double>(SkRTree::kMaxChildren),
-                                    static_cast<double>(expectedDepthMin + 1)));
-        ++expectedDepthMin;
-    }
-
-    int expectedDepthMax = -1;
-    tmp = NUM_RECTS;
-    while (tmp > 0) {
-        tmp -= static_cast<int>(pow(static_cast<double>(SkRTree::kMinChildren),
-                                    static_cast<double>(expectedDepthMax + 1)));
-        ++expectedDepthMax;
+    // Every node but the last of each level is full.
+    int expectedDepth = 0;
+    for (int nodes = NUM_RECTS; expectedDepth == 0 || nodes > 1; ) {
+        nodes = (nodes + SkRTree::kFanout - 1) / SkRTree::kFanout;
+        ++expectedDepth;
     }
 
     SkRandom rand;
@@ -93,7 +83,33 @@ DEF_TEST(RTree, reporter) {
 
         run_queries(reporter, rand, rects.data(), rtree);
         REPORTER_ASSERT(reporter, NUM_RECTS == rtree.getCount());
-        REPORTER_ASSERT(reporter, expectedDepthMin <= rtree.getDepth() &&
-                                  expectedDepthMax >= rtree.getDepth());
+        REPORTER_ASSERT(reporter, expectedDepth == rtree.getDepth());
+    }
+}
+
+DEF_TEST(RTree_Visit, reporter) {
+    SkRandom rand;
+    AutoTArray<SkRect> rects(NUM_RECTS);
+    for (int i = 0; i < NUM_RECTS; i++) {
+        // Every third rect is empty, and is never found.
+        rects[i] = i % 3 ? random_rect(rand) : SkRect::MakeXYWH(i, i, 0, 10);
+    }
+    SkRTree rtree;
+    rtree.insert(rects.data(), NUM_RECTS);
+    REPORTER_ASSERT(reporter, NUM_RECTS - (NUM_RECTS + 2) / 3 == rtree.getCount());
+
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        SkRect query = random_rect(rand);
+        std::vector<int> searched, visited;
+        rtree.search(query, &searched);
+        rtree.visit(query, [&visited](int index) { visited.push_back(index); });
+        REPORTER_ASSERT(reporter, verify_query(query, rects.data(), searched));
+        REPORTER_ASSERT(reporter, searched == visited);
     }
+
+    // Empty queries find nothing, even where the query's edges are inside of rects.
+    std::vector<int> hits;
+    rtree.search(SkRect::MakeLTRB(500, 500, 500, 600), &hits);
+    rtree.search(SkRect::MakeLTRB(500, 600, 600, 500), &hits);
+    REPORTER_ASSERT(reporter, hits.empty());
 }
@@ -200,6 +200,37 @@ DEF_TEST(RecordDraw_SaveLayerAffectsClipBounds, r) {
     REPORTER_ASSERT(r, sloppy_rect_eq(bounds[3], SkRect::MakeLTRB(0, 0, 40, 40)));
 }
 
+DEF_TEST(RecordDraw_ApproximateBounds, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, 50, 50);
+
+    SkPaint paint;
+    paint.setImageFilter(SkImageFilters::DropShadow(20, 0, 0, 0, SK_ColorBLACK,  nullptr));
+
+    recorder.saveLayer(nullptr, &paint);
+        recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+        recorder.drawRect(SkRect::MakeXYWH(0, 30, 10, 10), SkPaint());
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeXYWH(45, 45, 5, 5), SkPaint());
+
+    AutoTArray<SkRect> exact(record.count()), approximate(record.count());
+    AutoTMalloc<SkBBoxHierarchy::Metadata> meta(record.count());
+    SkRecordFillBounds(SkRect::MakeWH(50, 50), record, exact.data(), meta);
+    SkRecordFillApproximateBounds(SkRect::MakeWH(50, 50), record, approximate.data(), meta);
+
+    // Each rect inside the layer is bounded by all that the layer draws, with its shadows.
+    REPORTER_ASSERT(r, sloppy_rect_eq(exact[1], SkRect::MakeLTRB(0,  0, 30, 10)));
+    REPORTER_ASSERT(r, sloppy_rect_eq(exact[2], SkRect::MakeLTRB(0, 30, 30, 40)));
+    for (int i = 0; i < 4; i++) {
+        REPORTER_ASSERT(r, sloppy_rect_eq(approximate[i], SkRect::MakeLTRB(0, 0, 30, 40)));
+    }
+    REPORTER_ASSERT(r, sloppy_rect_eq(exact[4], approximate[4]));
+
+    REPORTER_ASSERT(r, !meta[0].isDraw);  // saveLayer
+    REPORTER_ASSERT(r,  meta[1].isDraw);  //   drawRect
+    REPORTER_ASSERT(r,  meta[3].isDraw);  // restore
+}
+
 DEF_TEST(RecordDraw_Metadata, r) {
     SkRecord record;
     SkRecorder recorder(&record, 50, 50);
@@ -5,17 +5,21 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
@@ -28,6 +32,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 static const int W = 1920, H = 1080;
 
@@ -197,7 +202,11 @@ DEF_TEST(RecordOpts_NoopSaveLayerDrawRestore, r) {
 
     const SkRecords::DrawRect* drawRect = assert_type<SkRecords::DrawRect>(r, record, 16);
     REPORTER_ASSERT(r, drawRect != nullptr);
-    REPORTER_ASSERT(r, drawRect->paint.getColor() == 0x03020202);
+    REPORTER_ASSERT(r, drawRect->paint->getColor() == 0x03020202);
+
+    // The draws that shared the paint before it was folded still have it.
+    const SkRecords::DrawRect* sharedRect = assert_type<SkRecords::DrawRect>(r, record, 10);
+    REPORTER_ASSERT(r, sharedRect->paint->getColor() == 0xFF020202);
 
     // saveLayer w/ backdrop should NOT go away
     sk_sp<SkImageFilter> filter(SkImageFilters::Blur(3, 3, nullptr));
@@ -359,6 +368,144 @@ DEF_TEST(RecordOpts_MergeSvgOpacityAndFilterLayers, r) {
     index += 4;
 }
 
+DEF_TEST(RecordOpts_NoopRedundantState, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.save();
+        recorder.translate(10, 10);                        // Replaced by the setMatrix.
+        recorder.setMatrix(SkMatrix::Scale(2, 2));
+        recorder.clipRect(SkRect::MakeWH(100, 100));
+        recorder.clipRect(SkRect::MakeWH(200, 200));       // Contains the first clip.
+        recorder.clipRect(SkRect::MakeWH(50, 50), true);   // Anti-aliased, unlike the first.
+        recorder.drawRect(SkRect::MakeWH(300, 300), SkPaint());
+        recorder.translate(5, 5);                          // Undone by the restore.
+    recorder.restore();
+
+    SkRecordNoopRedundantState(&record);
+    assert_type<SkRecords::Save>    (r, record, 0);
+    assert_type<SkRecords::NoOp>    (r, record, 1);
+    assert_type<SkRecords::SetM44>  (r, record, 2);
+    assert_type<SkRecords::ClipRect>(r, record, 3);
+    assert_type<SkRecords::NoOp>    (r, record, 4);
+    assert_type<SkRecords::ClipRect>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::NoOp>    (r, record, 7);
+    assert_type<SkRecords::Restore> (r, record, 8);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint aa;
+    aa.setAntiAlias(true);
+    SkPaint translucent;
+    translucent.setAlpha(0x80);
+    SkPaint hairline;
+    hairline.setStyle(SkPaint::kStroke_Style);
+
+    recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());             // Occluded.
+    recorder.drawOval(SkRect::MakeLTRB(10, 10, 90, 90), SkPaint());   // Occluded.
+    recorder.drawRect(SkRect::MakeWH(50, 50), aa);                    // Anti-aliased.
+    recorder.drawRect(SkRect::MakeWH(50, 50), hairline);              // A hairline.
+    recorder.drawRect(SkRect::MakeWH(150, 50), SkPaint());            // Outside of the occluder.
+    recorder.drawRect(SkRect::MakeWH(100, 100), translucent);         // Occluded.
+    recorder.drawRect(SkRect::MakeWH(100, 100), SkPaint());           // The occluder.
+    recorder.clipRect(SkRect::MakeWH(500, 500));
+    recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());             // After a clip.
+    recorder.drawRect(SkRect::MakeWH(100, 100), translucent);         // Not opaque.
+
+    SkRecordNoopOccludedDraws(&record);
+    assert_type<SkRecords::NoOp>    (r, record, 0);
+    assert_type<SkRecords::NoOp>    (r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    assert_type<SkRecords::NoOp>    (r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::ClipRect>(r, record, 7);
+    assert_type<SkRecords::DrawRect>(r, record, 8);
+    assert_type<SkRecords::DrawRect>(r, record, 9);
+}
+
+DEF_TEST(RecordOpts_BatchImageRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(10, 10);
+    bitmap.eraseColor(SK_ColorRED);
+    sk_sp<SkImage> image = bitmap.asImage();
+    SkPaint translucent;
+    translucent.setAlpha(0x80);
+
+    for (int i = 0; i < 3; ++i) {
+        recorder.drawImageRect(image, SkRect::MakeXYWH(20 * i, 0, 10, 10), SkSamplingOptions(),
+                               &translucent);
+    }
+    recorder.drawImageRect(image, SkRect::MakeXYWH(60, 0, 10, 10), SkSamplingOptions(),
+                           nullptr);
+
+    SkRecordBatchImageRects(&record);
+    auto set = assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 0);
+    REPORTER_ASSERT(r, set->count == 3);
+    REPORTER_ASSERT(r, set->paint && *set->paint == translucent);
+    REPORTER_ASSERT(r, set->set[2].fDstRect == SkRect::MakeXYWH(40, 0, 10, 10));
+    assert_type<SkRecords::NoOp>         (r, record, 1);
+    assert_type<SkRecords::NoOp>         (r, record, 2);
+    assert_type<SkRecords::DrawImageRect>(r, record, 3);
+}
+
+// The optimized picture draws the same as the canvas calls it was recorded from.
+DEF_TEST(RecordOpts_OptimizedPictureDrawsTheSame, r) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(8, 8);
+    bitmap.eraseColor(SK_ColorGREEN);
+    bitmap.erase(SK_ColorBLUE, SkIRect::MakeWH(4, 4));
+    sk_sp<SkImage> image = bitmap.asImage();
+
+    auto draw = [&](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeLTRB(2.5f, 2.5f, 20.5f, 20.5f), paint);
+        canvas->save();
+        canvas->translate(3, 3);
+        canvas->clipRect(SkRect::MakeWH(40, 40));
+        canvas->clipRect(SkRect::MakeWH(60, 60));
+        for (int i = 0; i < 4; ++i) {
+            canvas->drawImageRect(image, SkRect::MakeXYWH(10 * i, 30, 8.5f, 8), SkSamplingOptions());
+        }
+        canvas->restore();
+        // Covers the red rect exactly.
+        canvas->drawImageRect(image, SkRect::MakeLTRB(2.5f, 2.5f, 20.5f, 20.5f),
+                              SkSamplingOptions(SkFilterMode::kLinear));
+        canvas->rotate(10);
+        canvas->drawOval(SkRect::MakeLTRB(30.3f, 5.7f, 50.1f, 20.2f), paint);
+        paint.setColor(SK_ColorYELLOW);
+        canvas->drawRect(SkRect::MakeLTRB(30.3f, 5.7f, 50.1f, 20.2f), paint);
+    };
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(64, 64);
+    sk_sp<SkSurface> expected = SkSurfaces::Raster(info);
+    expected->getCanvas()->clear(SK_ColorWHITE);
+    draw(expected->getCanvas());
+
+    SkPictureRecorder recorder;
+    draw(recorder.beginRecording(64, 64));
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    sk_sp<SkSurface> actual = SkSurfaces::Raster(info);
+    actual->getCanvas()->clear(SK_ColorWHITE);
+    actual->getCanvas()->drawPicture(picture);
+
+    SkBitmap a, b;
+    a.allocPixels(info);
+    b.allocPixels(info);
+    expected->readPixels(a, 0, 0);
+    actual->readPixels(b, 0, 0);
+    REPORTER_ASSERT(r, 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()));
+}
+
 static void do_draw(SkCanvas* canvas, SkColor color, bool doLayer) {
     canvas->drawColor(SK_ColorWHITE);
 
@@ -5,8 +5,12 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkColor.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkScalar.h"
+#include "src/core/SkPaintPriv.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecords.h"
 #include "tests/RecordTestUtils.h"
@@ -62,7 +66,7 @@ DEF_TEST(Record, r) {
     // Add a simple DrawRect command.
     SkRect rect = SkRect::MakeWH(10, 10);
     SkPaint paint;
-    APPEND(record, SkRecords::DrawRect, paint, rect);
+    APPEND(record, SkRecords::DrawRect, record.intern(paint), rect);
 
     // Its area should be 100.
     AreaSummer summer;
@@ -117,3 +121,40 @@ DEF_TEST(Record_Alignment, r) {
         REPORTER_ASSERT(r, is_aligned(record.alloc<uint64_t>()));
     }
 }
+
+DEF_TEST(Record_Intern, r) {
+    SkRecord record;
+
+    SkPaint red, blue;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+    const SkPaint* interned = record.intern(red);
+    REPORTER_ASSERT(r, interned != &red && *interned == red);
+    REPORTER_ASSERT(r, record.intern(blue) != interned);
+    REPORTER_ASSERT(r, record.intern(red) == interned);
+
+    SkPaint copy = red;
+    REPORTER_ASSERT(r, record.intern(copy) == interned);
+    copy.setAntiAlias(true);
+    REPORTER_ASSERT(r, record.intern(copy) != interned);
+
+    // -0 equals 0, so they hash the same and share a paint, even when others come in between.
+    SkPaint zero, negativeZero;
+    zero.setStrokeWidth(0);
+    negativeZero.setStrokeWidth(-0.f);
+    REPORTER_ASSERT(r, SkPaintPriv::Hash(zero) == SkPaintPriv::Hash(negativeZero));
+    const SkPaint* internedZero = record.intern(zero);
+    record.intern(blue);
+    REPORTER_ASSERT(r, record.intern(negativeZero) == internedZero);
+
+    // A NaN isn't equal to itself, so it's never shared.
+    SkPaint nan;
+    nan.setColor(SkColor4f{SK_ScalarNaN, 0, 0, 1});
+    REPORTER_ASSERT(r, record.intern(nan) != record.intern(nan));
+
+    const SkMatrix translate = SkMatrix::Translate(10, 20);
+    const SkRecords::TypedMatrix* matrix = record.intern(translate);
+    REPORTER_ASSERT(r, *matrix == translate);
+    REPORTER_ASSERT(r, record.intern(SkMatrix::Translate(10, 20)) == matrix);
+    REPORTER_ASSERT(r, record.intern(SkMatrix::I()) != matrix);
+}
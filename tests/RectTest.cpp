@@ -16,9 +16,12 @@
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTypes.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkCanvasPriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
 
@@ -397,3 +400,93 @@ DEF_TEST(big_tiled_rect_crbug_927075, reporter) {
         canvas->drawRect(r, paint);
     }
 }
+
+// SkCanvasPriv::DrawRects (and drawRegion, which uses it) must produce the same pixels as drawing
+// each rect on its own, whichever path the batch ends up taking.
+DEF_TEST(Rect_DrawRects, reporter) {
+    const auto info = SkImageInfo::MakeN32Premul(64, 64);
+    auto batched = SkSurfaces::Raster(info);
+    auto single = SkSurfaces::Raster(info);
+
+    SkRandom rand;
+    SkRect rects[40];
+    SkColor4f colors[40];
+    for (int i = 0; i < 40; ++i) {
+        SkScalar x = rand.nextRangeF(-8, 60), y = rand.nextRangeF(-8, 60);
+        rects[i] = SkRect::MakeXYWH(x, y, rand.nextRangeF(0, 24), rand.nextRangeF(0, 24));
+        // Runs of equal colors share a blitter, so repeat some of them.
+        colors[i] = (i % 3 == 0) ? SkColor4f::FromColor(rand.nextU() | 0xFF000000)
+                                 : colors[i - i % 3];
+    }
+    // A rect that doesn't fit in fixed point, and one that is too big to draw at all.
+    rects[5] = {-1e6f, 30, 1e6f, 34};
+    rects[6] = {-1e30f, 10, 1e30f, 12};
+
+    auto check = [&](const char* label, auto setup, const SkPaint& paint, bool useColors) {
+        for (auto* surf : {batched.get(), single.get()}) {
+            surf->getCanvas()->restoreToCount(1);
+            surf->getCanvas()->clear(SK_ColorTRANSPARENT);
+            surf->getCanvas()->save();
+            setup(surf->getCanvas());
+        }
+        SkCanvasPriv::DrawRects(batched->getCanvas(), rects, useColors ? colors : nullptr, paint);
+        SkPaint rectPaint(paint);
+        for (int i = 0; i < 40; ++i) {
+            if (useColors) {
+                rectPaint.setColor4f(colors[i]);
+            }
+            single->getCanvas()->drawRect(rects[i], rectPaint);
+        }
+
+        SkBitmap a, b;
+        a.allocPixels(info);
+        b.allocPixels(info);
+        batched->readPixels(a, 0, 0);
+        single->readPixels(b, 0, 0);
+        REPORTER_ASSERT(reporter, 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()),
+                        "%s aa=%d colors=%d", label, paint.isAntiAlias(), useColors);
+    };
+
+    auto identity = [](SkCanvas*) {};
+    auto scale = [](SkCanvas* c) { c->translate(3.5f, -2.25f); c->scale(1.3f, 0.7f); };
+    auto rotate = [](SkCanvas* c) { c->rotate(20, 32, 32); };
+    auto clipRect = [](SkCanvas* c) { c->clipRect({5.5f, 7, 50, 41.25f}, true); };
+    auto clipPath = [](SkCanvas* c) { c->clipPath(SkPath::Circle(32, 32, 25), true); };
+
+    for (bool aa : {false, true}) {
+        for (bool useColors : {false, true}) {
+            SkPaint paint;
+            paint.setAntiAlias(aa);
+            paint.setColor(SK_ColorBLUE);
+            check("identity", identity, paint, useColors);
+            check("scale", scale, paint, useColors);
+            check("rotate", rotate, paint, useColors);
+            check("clipRect", clipRect, paint, useColors);
+            check("clipPath", clipPath, paint, useColors);
+
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(2);
+            check("stroke", identity, paint, useColors);
+        }
+    }
+
+    SkRegion region;
+    for (int i = 0; i < 40; ++i) {
+        region.op(rects[i].roundOut(), SkRegion::kUnion_Op);
+    }
+    region.op({-4, -4, 70, 70}, SkRegion::kIntersect_Op);
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    batched->getCanvas()->clear(SK_ColorTRANSPARENT);
+    single->getCanvas()->clear(SK_ColorTRANSPARENT);
+    batched->getCanvas()->drawRegion(region, paint);
+    for (SkRegion::Iterator it(region); !it.done(); it.next()) {
+        single->getCanvas()->drawRect(SkRect::Make(it.rect()), paint);
+    }
+    SkBitmap a, b;
+    a.allocPixels(info);
+    b.allocPixels(info);
+    batched->readPixels(a, 0, 0);
+    single->readPixels(b, 0, 0);
+    REPORTER_ASSERT(reporter, 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()));
+}
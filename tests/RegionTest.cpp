@@ -15,14 +15,17 @@
 #include "include/core/SkScalar.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkAutoMalloc.h"
 #include "src/base/SkRandom.h"
+#include "src/core/SkRegionPriv.h"
 #include "src/core/SkScan.h"
 #include "tests/Test.h"
 
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 static void Union(SkRegion* rgn, const SkIRect& rect) {
     rgn->op(rect, SkRegion::kUnion_Op);
@@ -584,3 +587,124 @@ DEF_TEST(region_very_large, reporter) {
     REPORTER_ASSERT(reporter, smallRegion.contains(499, 0));
     REPORTER_ASSERT(reporter, smallRegion.contains(499, 499));
 }
+
+// Many small, mostly disjoint rects give scanlines with long runs of intervals that lie entirely
+// before the other region's next interval, which is where Oper() copies or skips them in bulk.
+// The rects are also painted into 'pixels', one byte per pixel of kGridArea, so that the ops can
+// be checked against an oracle that does not use SkRegion.
+static constexpr SkIRect kGridArea = {0, 0, 264, 72};
+
+static void rand_grid_rgn(SkRandom& rand, SkRegion* rgn, int n, std::vector<uint8_t>* pixels) {
+    rgn->setEmpty();
+    pixels->assign(kGridArea.width() * kGridArea.height(), 0);
+    for (int i = 0; i < n; ++i) {
+        int x = (rand.nextU() % 64) * 4;
+        int y = (rand.nextU() % 16) * 4;
+        SkIRect r = SkIRect::MakeXYWH(x, y, 1 + rand.nextU() % 6, 1 + rand.nextU() % 6);
+        rgn->op(r, SkRegion::kUnion_Op);
+        for (int py = r.fTop; py < r.fBottom; ++py) {
+            for (int px = r.fLeft; px < r.fRight; ++px) {
+                (*pixels)[py * kGridArea.width() + px] = 1;
+            }
+        }
+    }
+}
+
+// Paints the region's rects, as walked by SkRegion::Iterator, into one byte per pixel.
+static bool rasterize_rgn(const SkRegion& rgn, std::vector<uint8_t>* pixels) {
+    pixels->assign(kGridArea.width() * kGridArea.height(), 0);
+    for (SkRegion::Iterator iter(rgn); !iter.done(); iter.next()) {
+        const SkIRect& r = iter.rect();
+        if (!kGridArea.contains(r)) {
+            return false;
+        }
+        for (int py = r.fTop; py < r.fBottom; ++py) {
+            for (int px = r.fLeft; px < r.fRight; ++px) {
+                (*pixels)[py * kGridArea.width() + px] = 1;
+            }
+        }
+    }
+    return true;
+}
+
+DEF_TEST(Region_op_many_intervals, reporter) {
+    const SkRegion::Op kOps[] = { SkRegion::kDifference_Op, SkRegion::kIntersect_Op,
+                                  SkRegion::kUnion_Op, SkRegion::kXOR_Op };
+    SkRandom rand;
+    std::vector<uint8_t> aPixels, bPixels, resultPixels;
+    for (int i = 0; i < 40; ++i) {
+        SkRegion a, b;
+        rand_grid_rgn(rand, &a, 20 + i * 8, &aPixels);
+        rand_grid_rgn(rand, &b, 20 + i * 8, &bPixels);
+
+        for (SkRegion::Op op : kOps) {
+            SkRegion result;
+            result.op(a, b, op);
+            REPORTER_ASSERT(reporter, result.computeRegionComplexity() >= 0);
+            if (!rasterize_rgn(result, &resultPixels)) {
+                ERRORF(reporter, "op %d result is outside of the grid", (int)op);
+                return;
+            }
+            for (size_t p = 0; p < aPixels.size(); ++p) {
+                bool inA = aPixels[p], inB = bPixels[p], expected;
+                switch (op) {
+                    case SkRegion::kDifference_Op: expected = inA && !inB; break;
+                    case SkRegion::kIntersect_Op:  expected = inA && inB;  break;
+                    case SkRegion::kUnion_Op:      expected = inA || inB;  break;
+                    default:                       expected = inA != inB;  break;
+                }
+                if (SkToBool(resultPixels[p]) != expected) {
+                    ERRORF(reporter, "op %d mismatch at (%d, %d)", (int)op,
+                           (int)(p % kGridArea.width()), (int)(p / kGridArea.width()));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(Region_contains_long_scanline, reporter) {
+    // One band with 100 intervals: [0,2) [4,6) ... [396,398)
+    SkRegion rgn;
+    for (int i = 0; i < 100; ++i) {
+        rgn.op(SkIRect::MakeXYWH(i * 4, 10, 2, 5), SkRegion::kUnion_Op);
+    }
+    for (int x = -4; x < 404; ++x) {
+        bool expected = x >= 0 && x < 398 && (x % 4) < 2;
+        REPORTER_ASSERT(reporter, rgn.contains(x, 12) == expected, "x = %d", x);
+    }
+}
+
+DEF_TEST(Region_VisitBands, reporter) {
+    SkRegion rgn;
+    rgn.op(SkIRect::MakeLTRB(0, 0, 10, 10), SkRegion::kUnion_Op);
+    rgn.op(SkIRect::MakeLTRB(20, 5, 30, 15), SkRegion::kUnion_Op);
+    rgn.op(SkIRect::MakeLTRB(40, 20, 50, 30), SkRegion::kUnion_Op);
+
+    // Every band's intervals, re-expanded to rects, must give back the same region.
+    SkRegion rebuilt;
+    int bands = 0, prevBottom = SK_MinS32;
+    SkRegionPriv::VisitBands(rgn, [&](int top, int bottom, const int32_t pairs[], int count) {
+        REPORTER_ASSERT(reporter, top < bottom && top >= prevBottom);
+        REPORTER_ASSERT(reporter, count > 0);
+        for (int i = 0; i < count; ++i) {
+            rebuilt.op(SkIRect::MakeLTRB(pairs[2 * i], top, pairs[2 * i + 1], bottom),
+                       SkRegion::kUnion_Op);
+        }
+        prevBottom = bottom;
+        bands += 1;
+    });
+    REPORTER_ASSERT(reporter, bands == 4);  // [0,5) [5,10) [10,15) [20,30)
+    REPORTER_ASSERT(reporter, rebuilt == rgn);
+
+    bands = 0;
+    SkRegionPriv::VisitBands(SkRegion(SkIRect::MakeWH(3, 4)),
+                             [&](int top, int bottom, const int32_t pairs[], int count) {
+        REPORTER_ASSERT(reporter, top == 0 && bottom == 4);
+        REPORTER_ASSERT(reporter, count == 1 && pairs[0] == 0 && pairs[1] == 3);
+        bands += 1;
+    });
+    REPORTER_ASSERT(reporter, bands == 1);
+    SkRegionPriv::VisitBands(SkRegion(), [&](int, int, const int32_t[], int) { bands += 1; });
+    REPORTER_ASSERT(reporter, bands == 1);
+}
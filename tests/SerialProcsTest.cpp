@@ -5,10 +5,12 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
@@ -19,6 +21,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSerialProcs.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTileMode.h"
 #include "include/core/SkTypeface.h"
@@ -30,9 +33,11 @@
 #include "tools/ToolUtils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <iterator>
+#include <memory>
 
 static sk_sp<SkImage> picture_to_image(sk_sp<SkPicture> pic) {
     SkIRect r = pic->cullRect().round();
@@ -232,3 +237,86 @@ DEF_TEST(serial_typeface, reporter) {
     REPORTER_ASSERT(reporter, counter == 2);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Images are written as their dimensions followed by their N32 pixels.
+static sk_sp<SkData> raw_serial_image_proc(SkImage* img, void*) {
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocN32Pixels(img->width(), img->height()) ||
+        !img->readPixels(nullptr, bitmap.pixmap(), 0, 0)) {
+        return nullptr;
+    }
+    SkDynamicMemoryWStream stream;
+    stream.write32(img->width());
+    stream.write32(img->height());
+    stream.write(bitmap.getPixels(), bitmap.computeByteSize());
+    return stream.detachAsData();
+}
+
+static sk_sp<SkImage> raw_deserial_image_proc(const void* data, size_t length, void* ctx) {
+    static_cast<std::atomic<int>*>(ctx)->fetch_add(1);
+    int32_t wh[2];
+    if (length < sizeof(wh)) {
+        return nullptr;
+    }
+    memcpy(wh, data, sizeof(wh));
+    SkImageInfo info = SkImageInfo::MakeN32Premul(wh[0], wh[1]);
+    if (info.isEmpty() || length - sizeof(wh) != info.computeMinByteSize()) {
+        return nullptr;
+    }
+    return SkImages::RasterFromData(
+            info,
+            SkData::MakeWithCopy(static_cast<const char*>(data) + sizeof(wh), length - sizeof(wh)),
+            info.minRowBytes());
+}
+
+DEF_TEST(serial_procs_image_executor, reporter) {
+    auto make_image = [](SkColor color) {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(16, 16);
+        bitmap.eraseColor(color);
+        bitmap.setImmutable();
+        return bitmap.asImage();
+    };
+
+    // Big enough that drawPicture() doesn't unroll it.
+    auto nested = make_pic([&](SkCanvas* c) {
+        for (int i = 0; i < 10; ++i) {
+            c->drawImage(make_image(SkColorSetARGB(0xFF, 0, 0, 20 * i)), 8 * i, 64);
+        }
+    });
+    auto pic = make_pic([&](SkCanvas* c) {
+        for (int i = 0; i < 8; ++i) {
+            c->drawImage(make_image(SkColorSetARGB(0xFF, 30 * i, 0, 0)), 16 * i, 0);
+        }
+        c->drawPicture(nested);
+    });
+
+    SkSerialProcs sprocs;
+    sprocs.fImageProc = raw_serial_image_proc;
+    sk_sp<SkData> data = pic->serialize(&sprocs);
+
+    std::atomic<int> decodes{0};
+    SkDeserialProcs dprocs;
+    dprocs.fImageProc = raw_deserial_image_proc;
+    dprocs.fImageCtx = &decodes;
+    sk_sp<SkPicture> serial = SkPicture::MakeFromData(data.get(), &dprocs);
+    REPORTER_ASSERT(reporter, serial);
+    REPORTER_ASSERT(reporter, decodes == 18);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    dprocs.fExecutor = executor.get();
+    decodes = 0;
+    sk_sp<SkPicture> parallel = SkPicture::MakeFromData(data.get(), &dprocs);
+    REPORTER_ASSERT(reporter, parallel);
+    REPORTER_ASSERT(reporter, decodes == 18);
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(picture_to_image(serial).get(),
+                                                      picture_to_image(parallel).get()));
+
+    // Data that is cut short is still rejected, whether or not its images were started.
+    for (size_t size : {data->size() / 2, data->size() - 8}) {
+        sk_sp<SkData> truncated = SkData::MakeSubset(data.get(), 0, size);
+        REPORTER_ASSERT(reporter, !SkPicture::MakeFromData(truncated.get(), &dprocs));
+    }
+}
@@ -12,13 +12,23 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
+#include "include/core/SkString.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkOSFile.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -60,3 +70,148 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+DEF_TEST(SkStrikeCache_PersistentStore, reporter) {
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (!typeface || tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "strike_store");
+    sk_mkdir(dir.c_str());
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSize(24);
+    font.setTypeface(typeface);
+    SkPaint defaultPaint;
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    std::vector<SkGlyphID> glyphIDs;
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = 'A'; c <= 'z'; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+        packedIDs.emplace_back(glyphIDs.back());
+    }
+    std::vector<const SkGlyph*> glyphs(glyphIDs.size());
+
+    // A cache without the store, for the memory use of an empty strike.
+    size_t emptyStrikeMemory;
+    {
+        SkStrikeCache cache;
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        emptyStrikeMemory = cache.getTotalMemoryUsed();
+    }
+
+    // The first process makes the images and paths, and writes them.
+    std::vector<std::vector<uint8_t>> images;
+    {
+        SkStrikeCache cache;
+        cache.setPersistentStoreDirectory(dir.c_str());
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        strike->preparePaths(glyphIDs, glyphs.data());
+        strike->prepareImages(packedIDs, glyphs.data());
+        for (const SkGlyph* glyph : glyphs) {
+            auto image = static_cast<const uint8_t*>(glyph->image());
+            images.emplace_back(image, image + (image ? glyph->imageSize() : 0));
+        }
+        cache.writeToPersistentStore();
+    }
+
+    // The next one starts with them.
+    {
+        SkStrikeCache cache;
+        cache.setPersistentStoreDirectory(dir.c_str());
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() > emptyStrikeMemory);
+        const size_t loadedMemory = cache.getTotalMemoryUsed();
+
+        strike->preparePaths(glyphIDs, glyphs.data());
+        strike->prepareImages(packedIDs, glyphs.data());
+        // Nothing had to be made again.
+        REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() == loadedMemory);
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            auto image = static_cast<const uint8_t*>(glyphs[i]->image());
+            REPORTER_ASSERT(reporter, images[i].size() == (image ? glyphs[i]->imageSize() : 0));
+            REPORTER_ASSERT(reporter, images[i].empty() ||
+                                      memcmp(images[i].data(), image, images[i].size()) == 0);
+        }
+    }
+
+    // Strikes for other typefaces don't pick them up.
+    {
+        SkFont otherFont = font;
+        otherFont.setTypeface(MakeResourceAsTypeface("fonts/Roboto2-Regular_NoEmbed.ttf"));
+        if (otherFont.getTypeface()) {
+            SkStrikeSpec otherSpec = SkStrikeSpec::MakeMask(
+                    otherFont, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I());
+            SkStrikeCache cache;
+            cache.setPersistentStoreDirectory(dir.c_str());
+            sk_sp<SkStrike> strike = otherSpec.findOrCreateStrike(&cache);
+            REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() == emptyStrikeMemory);
+        }
+    }
+}
+
+DEF_TEST(SkStrikeCache_PersistentStoreMisses, reporter) {
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (!typeface || tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "strike_store_misses");
+    sk_mkdir(dir.c_str());
+    // Start without what earlier runs stored.
+    SkOSFile::Iter iter(dir.c_str(), ".skglyphs");
+    for (SkString name; iter.next(&name);) {
+        remove(SkOSPath::Join(dir.c_str(), name.c_str()).c_str());
+    }
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSize(31);
+    font.setTypeface(typeface);
+    SkPaint defaultPaint;
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = 'A'; c <= 'z'; c++) {
+        packedIDs.emplace_back(font.unicharToGlyph(c));
+    }
+    std::vector<const SkGlyph*> glyphs(packedIDs.size());
+
+    auto writeStrike = [&](SkStrikeCache* cache) {
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(cache);
+        strike->prepareImages(packedIDs, glyphs.data());
+        cache->writeToPersistentStore();
+    };
+
+    // Nothing is stored for the strike yet.
+    SkStrikeCache cache;
+    cache.setPersistentStoreDirectory(dir.c_str());
+    sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+    const size_t emptyStrikeMemory = cache.getTotalMemoryUsed();
+    strike = nullptr;
+    cache.purgeAll();
+
+    // Another cache stores it, but this one remembers that there was nothing and doesn't look.
+    {
+        SkStrikeCache other;
+        other.setPersistentStoreDirectory(dir.c_str());
+        writeStrike(&other);
+    }
+    strike = strikeSpec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() == emptyStrikeMemory);
+    strike = nullptr;
+    cache.purgeAll();
+
+    // What it stores itself is loaded again.
+    writeStrike(&cache);
+    cache.purgeAll();
+    strike = strikeSpec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() > emptyStrikeMemory);
+}
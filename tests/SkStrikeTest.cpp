@@ -194,6 +194,52 @@ public:
     }
 };
 
+DEF_TEST(SkStrike_PrefetchImages, reporter) {
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setSize(48);
+    font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+
+    // Every glyph twice, with different subpixel positions the second time.
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (SkUnichar c = ' '; c < 'z'; c++) {
+            packedIDs.emplace_back(font.unicharToGlyph(c), SkTo<uint32_t>(2 * pass), 0u);
+            packedIDs.emplace_back(font.unicharToGlyph(c), SkTo<uint32_t>(2 * pass), 0u);
+        }
+    }
+
+    SkPaint defaultPaint;
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    SkStrikeCache strikeCache;
+    SkStrike expected{&strikeCache, strikeSpec, strikeSpec.createScalerContext(), nullptr, nullptr};
+    SkStrike prefetched{&strikeCache, strikeSpec, strikeSpec.createScalerContext(), nullptr,
+                        nullptr};
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    prefetched.prefetchImages(packedIDs, executor.get());
+    // Everything is there already, so this one has nothing to do.
+    prefetched.prefetchImages(packedIDs, executor.get());
+
+    std::vector<const SkGlyph*> expectedGlyphs(packedIDs.size());
+    expected.prepareImages(packedIDs, expectedGlyphs.data());
+    for (size_t i = 0; i < packedIDs.size(); ++i) {
+        const SkGlyph* want = expectedGlyphs[i];
+        const SkGlyph* got = SkStrikeTestingPeer::GetGlyph(&prefetched, packedIDs[i]);
+        REPORTER_ASSERT(reporter, got->setImageHasBeenCalled());
+        REPORTER_ASSERT(reporter, got->maskFormat() == want->maskFormat());
+        REPORTER_ASSERT(reporter, got->width() == want->width() &&
+                                  got->height() == want->height());
+        REPORTER_ASSERT(reporter, (got->image() == nullptr) == (want->image() == nullptr));
+        if (got->image() != nullptr && want->image() != nullptr) {
+            REPORTER_ASSERT(reporter, memcmp(got->image(), want->image(), want->imageSize()) == 0);
+        }
+    }
+}
+
 DEF_TEST(SkStrike_FlattenByType, reporter) {
     std::vector<SkGlyph> imagesToSend;
     std::vector<SkGlyph> pathsToSend;
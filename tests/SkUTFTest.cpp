@@ -5,9 +5,11 @@
 #include "src/base/SkUTF.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 DEF_TEST(SkUTF_UTF16, reporter) {
     // Test non-basic-multilingual-plane unicode.
@@ -145,3 +147,42 @@ DEF_TEST(SkUTF_NextUTF8_ToUTF8, r) {
 #undef LEADING_THREE_BYTE
 #undef LEADING_FOUR_BYTE
 #undef INVALID_BYTE
+
+DEF_TEST(SkUTF_UTF8ToUTF32, r) {
+    // Long enough for the runs of ASCII to be decoded together, with other code points between
+    // and after them.
+    std::string utf8;
+    std::vector<SkUnichar> expected;
+    for (int i = 0; i < 100; ++i) {
+        const SkUnichar uni = (i % 23 == 0) ? 0x80 + i * 0x391 : 0x20 + i % 0x5F;
+        char buff[SkUTF::kMaxBytesInUTF8Sequence];
+        utf8.append(buff, SkUTF::ToUTF8(uni, buff));
+        expected.push_back(uni);
+    }
+
+    for (size_t length : {(size_t)0, (size_t)15, (size_t)16, (size_t)40, utf8.size()}) {
+        // Stop on a code point boundary.
+        while (length > 0 && (utf8[length] & 0xC0) == 0x80) {
+            --length;
+        }
+        const int count = SkUTF::CountUTF8(utf8.data(), length);
+        REPORTER_ASSERT(r, count >= 0);
+        REPORTER_ASSERT(r, count == SkUTF::UTF8ToUTF32(nullptr, 0, utf8.data(), length));
+
+        std::vector<SkUnichar> utf32(count + 1, -2);
+        REPORTER_ASSERT(r, count == SkUTF::UTF8ToUTF32(utf32.data(), count, utf8.data(), length));
+        REPORTER_ASSERT(r, std::equal(utf32.begin(), utf32.begin() + count, expected.begin()));
+        REPORTER_ASSERT(r, utf32[count] == -2);
+
+        // A short dst is filled up to its capacity.
+        std::vector<SkUnichar> shortUTF32(count / 2 + 1, -2);
+        REPORTER_ASSERT(r, count == SkUTF::UTF8ToUTF32(shortUTF32.data(), count / 2,
+                                                       utf8.data(), length));
+        REPORTER_ASSERT(r, std::equal(shortUTF32.begin(), shortUTF32.begin() + count / 2,
+                                      expected.begin()));
+        REPORTER_ASSERT(r, shortUTF32[count / 2] == -2);
+    }
+
+    const std::string invalid = std::string(20, 'a') + "\xFC" + std::string(20, 'a');
+    REPORTER_ASSERT(r, -1 == SkUTF::UTF8ToUTF32(nullptr, 0, invalid.data(), invalid.size()));
+}
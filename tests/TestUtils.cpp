@@ -348,3 +348,41 @@ DEF_TEST(chartoglyph_cache, reporter) {
         }
     }
 }
+
+DEF_TEST(chartoglyph_cache_findGlyphs, reporter) {
+    SkCharToGlyphCache cache;
+
+    // Mostly the dense range, with a few unichars past it.
+    SkUnichar text[100];
+    for (int i = 0; i < 100; ++i) {
+        text[i] = (i % 17 == 16) ? 0x4E00 + i : 0x20 + (i * 7) % 0x200;
+    }
+
+    SkGlyphID glyphs[100];
+    REPORTER_ASSERT(reporter, cache.findGlyphs(text, 100, glyphs) == 0);
+
+    // Stops at the first unichar that isn't cached.
+    for (int i = 0; i < 60; ++i) {
+        cache.addCharAndGlyph(text[i], hash_to_glyph(text[i]));
+    }
+    int found = cache.findGlyphs(text, 100, glyphs);
+    REPORTER_ASSERT(reporter, found >= 60 && found < 100);
+    REPORTER_ASSERT(reporter, cache.findGlyphIndex(text[found]) < 0);
+    for (int i = 0; i < found; ++i) {
+        REPORTER_ASSERT(reporter, glyphs[i] == hash_to_glyph(text[i]));
+    }
+
+    for (int i = 60; i < 100; ++i) {
+        cache.addCharAndGlyph(text[i], hash_to_glyph(text[i]));
+    }
+    REPORTER_ASSERT(reporter, cache.findGlyphs(text, 100, glyphs) == 100);
+    for (int i = 0; i < 100; ++i) {
+        REPORTER_ASSERT(reporter, glyphs[i] == hash_to_glyph(text[i]));
+    }
+
+    // Only the unichars past the dense range are searched for, and counted.
+    REPORTER_ASSERT(reporter, cache.count() == 2 + 5);
+
+    cache.reset();
+    REPORTER_ASSERT(reporter, cache.findGlyphs(text, 100, glyphs) == 0);
+}
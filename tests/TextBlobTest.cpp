@@ -364,6 +364,52 @@ DEF_TEST(TextBlob_extended, reporter) {
     }
 }
 
+DEF_TEST(TextBlob_makeLastRunHorizontal, reporter) {
+    SkTextBlobBuilder builder;
+    SkFont font;
+    const char text[] = "Horizontal";
+    const int count = SkToInt(strlen(text));
+
+    // A run with text and clusters where all the glyphs share y
+    auto run = builder.allocRunTextPos(font, count, count);
+    for (int i = 0; i < count; ++i) {
+        run.glyphs[i] = SkToU16(i + 1);
+        run.points()[i] = {10.0f * i, 7};
+        run.clusters[i] = SkToU32(i);
+    }
+    memcpy(run.utf8text, text, count);
+    REPORTER_ASSERT(reporter, SkTextBlobBuilderPriv::MakeLastRunHorizontal(&builder));
+    REPORTER_ASSERT(reporter, !SkTextBlobBuilderPriv::MakeLastRunHorizontal(&builder));
+
+    // A run where the glyphs do not share y stays fully positioned
+    run = builder.allocRunPos(font, 2);
+    run.glyphs[0] = run.glyphs[1] = 1;
+    run.points()[0] = {0, 1};
+    run.points()[1] = {5, 2};
+    REPORTER_ASSERT(reporter, !SkTextBlobBuilderPriv::MakeLastRunHorizontal(&builder));
+
+    sk_sp<SkTextBlob> blob(builder.make());
+    REPORTER_ASSERT(reporter, blob);
+
+    SkTextBlobRunIterator it(blob.get());
+    REPORTER_ASSERT(reporter, SkTextBlobRunIterator::kHorizontal_Positioning == it.positioning());
+    REPORTER_ASSERT(reporter, it.glyphCount() == (uint32_t)count);
+    REPORTER_ASSERT(reporter, it.offset().y() == 7);
+    for (int i = 0; i < count; ++i) {
+        REPORTER_ASSERT(reporter, it.glyphs()[i] == i + 1);
+        REPORTER_ASSERT(reporter, it.pos()[i] == 10.0f * i);
+        REPORTER_ASSERT(reporter, it.clusters()[i] == SkToU32(i));
+    }
+    REPORTER_ASSERT(reporter, it.textSize() == (uint32_t)count);
+    REPORTER_ASSERT(reporter, 0 == strncmp(text, it.text(), it.textSize()));
+
+    it.next();
+    REPORTER_ASSERT(reporter, SkTextBlobRunIterator::kFull_Positioning == it.positioning());
+    REPORTER_ASSERT(reporter, it.points()[1] == (SkPoint{5, 2}));
+    it.next();
+    REPORTER_ASSERT(reporter, it.done());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 static void add_run(SkTextBlobBuilder* builder, const char text[], SkScalar x, SkScalar y,
                     sk_sp<SkTypeface> tf) {
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkRect.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkTileGrid.h"
+#include "tests/Test.h"
+
+#include <vector>
+
+static const int NUM_RECTS = 300;
+static const int NUM_QUERIES = 100;
+
+static SkRect random_rect(SkRandom& rand, float maxSize) {
+    const float x = rand.nextRangeF(0, 1000),
+                y = rand.nextRangeF(0, 1000);
+    return SkRect::MakeXYWH(x, y, rand.nextRangeF(1, maxSize), rand.nextRangeF(1, maxSize));
+}
+
+static std::vector<int> brute_force(const SkRect& query, const std::vector<SkRect>& rects) {
+    std::vector<int> expected;
+    for (int i = 0; i < (int)rects.size(); ++i) {
+        if (SkRect::Intersects(query, rects[i])) {
+            expected.push_back(i);
+        }
+    }
+    return expected;
+}
+
+DEF_TEST(TileGrid, reporter) {
+    SkRandom rand;
+    for (float tileSize : {10.f, 64.f, 256.f, 5000.f}) {
+        // Mostly small rects, some that span many tiles, some empty ones and one that spans all.
+        std::vector<SkRect> rects;
+        for (int i = 0; i < NUM_RECTS; ++i) {
+            switch (i % 10) {
+                case 0:  rects.push_back(SkRect::MakeXYWH(i, i, 0, 10)); break;
+                case 1:  rects.push_back(random_rect(rand, 600)); break;
+                default: rects.push_back(random_rect(rand, 40)); break;
+            }
+        }
+        rects.push_back(SkRect::MakeLTRB(-50, -50, 2000, 2000));
+
+        SkTileGrid grid(tileSize);
+        grid.insert(rects.data(), (int)rects.size());
+        REPORTER_ASSERT(reporter, grid.getCount() == (int)rects.size() - NUM_RECTS / 10);
+        REPORTER_ASSERT(reporter, grid.getTileSize() >= tileSize);
+
+        // Each rect is found once, in order, however many tiles the query spans.
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            const SkRect query = random_rect(rand, i % 2 ? 20 : 500);
+            std::vector<int> found;
+            grid.search(query, &found);
+            REPORTER_ASSERT(reporter, found == brute_force(query, rects));
+        }
+
+        // Empty queries, and those outside of everything, find nothing.
+        std::vector<int> found;
+        grid.search(SkRect::MakeLTRB(500, 500, 500, 600), &found);
+        grid.search(SkRect::MakeLTRB(3000, 3000, 3100, 3100), &found);
+        REPORTER_ASSERT(reporter, found.empty());
+    }
+}
+
+DEF_TEST(TileGrid_Empty, reporter) {
+    const SkRect rects[] = { SkRect::MakeEmpty(), SkRect::MakeXYWH(10, 10, 0, 0) };
+    SkTileGrid grid(256);
+    grid.insert(rects, std::size(rects));
+    REPORTER_ASSERT(reporter, grid.getCount() == 0);
+
+    std::vector<int> found;
+    grid.search(SkRect::MakeLTRB(-100, -100, 100, 100), &found);
+    REPORTER_ASSERT(reporter, found.empty());
+}
@@ -75,6 +75,7 @@ CPU_ONLY_TESTS = [
     "ImageFrom565Bitmap.cpp",
     "ImageGeneratorTest.cpp",
     "IncrTopoSortTest.cpp",
+    "IndexedPictureTest.cpp",
     "InfRectTest.cpp",
     "InsetConvexPolyTest.cpp",
     "InvalidIndexedPngTest.cpp",
@@ -110,12 +111,15 @@ CPU_ONLY_TESTS = [
     "PathMeasureTest.cpp",
     "PathTest.cpp",
     "PictureBBHTest.cpp",
+    "PictureRasterCacheTest.cpp",
     "PictureShaderTest.cpp",
+    "PictureStreamTest.cpp",
     "PictureTest.cpp",
     "PixelRefTest.cpp",
     "Point3Test.cpp",
     "PointTest.cpp",
     "PolyUtilsTest.cpp",
+    "ProfilingCanvasTest.cpp",
     "QuadRootsTest.cpp",
     "QuickRejectTest.cpp",
     "RRectInPathTest.cpp",
@@ -182,6 +186,7 @@ CPU_ONLY_TESTS = [
     "TLazyTest.cpp",
     "TemplatesTest.cpp",
     "TextBlobTest.cpp",
+    "TileGridTest.cpp",
     "TracingTest.cpp",
     "TypefaceTest.cpp",
     "UnicodeTest.cpp",
@@ -255,6 +255,9 @@ public:
         this->forceGenerateImageFromPath();
     }
 
+    // The glyphs are the typeface's paths, which are only ever read.
+    bool canGenerateImagesConcurrently() const override { return true; }
+
 protected:
     TestTypeface* getTestTypeface() const {
         return static_cast<TestTypeface*>(this->getTypeface());